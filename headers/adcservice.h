@@ -0,0 +1,51 @@
+#ifndef ADCSERVICE_H_
+#define ADCSERVICE_H_
+
+#include <cstdint>
+
+#include "types.h"
+
+#define ADC_SERVICE_FIRST_PIN 26
+#define ADC_SERVICE_INPUTS 4        // GPIO 26-29
+#define ADC_SERVICE_RING_SIZE 128   // samples, power of two
+#define ADC_SERVICE_MAX_SAMPLES 16  // most samples per input a read can average
+#ifndef ADC_SERVICE_OVERSAMPLE
+#define ADC_SERVICE_OVERSAMPLE 4    // latest samples per input averaged by read()
+#endif
+
+// Shared free-running ADC sampling for the analog, turbo dial and hall effect trigger add-ons
+//
+// Add-ons register their ADC pins in setup(). Once GP2040 starts the service, the ADC converts the registered inputs
+// in round-robin order and a DMA channel writes every result into a ring, so reading an input is a few memory loads
+// instead of a select + blocking conversion. Sample n of the run always belongs to the n % count-th registered input,
+// which is how a ring position is mapped back to its input. The newest sample of an input is at most one round old
+// (count * 2 us at the default ADC clock) and all inputs of a round are taken within those few microseconds.
+//
+// Web-config mode never starts the service, so the blocking reads there keep working as before.
+namespace ADCService {
+    // Registers an ADC pin for round-robin sampling, only allowed before start()
+    bool addChannel(Pin_t pin);
+    // Starts free-running sampling of the registered pins, does nothing if none were registered
+    void start();
+    bool isRunning();
+
+    // Average of the latest ADC_SERVICE_OVERSAMPLE samples of a registered pin, blocking conversions while the service
+    // is not running
+    uint16_t read(Pin_t pin);
+    // Same with a sample count of its own, up to ADC_SERVICE_MAX_SAMPLES
+    uint16_t read(Pin_t pin, uint32_t samples);
+    // Single blocking conversion of any ADC pin. Stops and restarts sampling around it if the service is running
+    uint16_t readBlocking(Pin_t pin);
+    // Average of several back to back blocking conversions
+    uint16_t readBlocking(Pin_t pin, uint32_t samples);
+
+    // Stops sampling so a caller can do several blocking conversions in a row (e.g. behind an external mux).
+    // read() keeps returning the samples taken before the pause.
+    void pause();
+    void resume();
+
+    // Conversions completed since start(), for staleness checks
+    uint32_t getSampleCount();
+}
+
+#endif
@@ -2,6 +2,7 @@
 #define _ADDONMANAGER_H_
 
 #include "gpaddon.h"
+#include "memorytracker.h"
 
 #include <vector>
 
@@ -15,6 +16,7 @@ enum ADDON_PROCESS {
 struct AddonBlock {
     GPAddon * ptr;
     ADDON_PROCESS process;
+    MemoryTracker::Tag memoryTag;
 };
 
 class AddonManager {
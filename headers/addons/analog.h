@@ -6,6 +6,7 @@
 #include "BoardConfig.h"
 #include "enums.pb.h"
 #include "types.h"
+#include "analogfilter.h"
 
 #ifndef ANALOG_INPUT_ENABLED
 #define ANALOG_INPUT_ENABLED 0
@@ -91,6 +92,22 @@
 #define SMOOTHING_FACTOR2 5
 #endif
 
+#ifndef ANALOG_FILTER_MIN_CUTOFF
+#define ANALOG_FILTER_MIN_CUTOFF 10
+#endif
+
+#ifndef ANALOG_FILTER_MIN_CUTOFF2
+#define ANALOG_FILTER_MIN_CUTOFF2 10
+#endif
+
+#ifndef ANALOG_FILTER_BETA
+#define ANALOG_FILTER_BETA 100
+#endif
+
+#ifndef ANALOG_FILTER_BETA2
+#define ANALOG_FILTER_BETA2 100
+#endif
+
 #ifndef ANALOG_ERROR
 #define ANALOG_ERROR 1000
 #endif
@@ -108,24 +125,20 @@ typedef struct
 {
     Pin_t x_pin;
     Pin_t y_pin;
-    Pin_t x_pin_adc;
-    Pin_t y_pin_adc;
-    float x_value;
-    float y_value;
+    int32_t x_value;            // stick positions are fixed point, 0 to ANALOG_MAX
+    int32_t y_value;
     uint16_t x_center;
     uint16_t y_center;
-    float xy_magnitude;
-    float x_magnitude;
-    float y_magnitude;
+    int32_t xy_magnitude;
+    int32_t x_magnitude;
+    int32_t y_magnitude;
     InvertMode analog_invert;
     DpadMode analog_dpad;
-    float x_ema;
-    float y_ema;
-    bool ema_option;
-    float ema_smoothing;
-    float error_rate;
-    float in_deadzone;
-    float out_deadzone;
+    AnalogFilter x_filter;
+    AnalogFilter y_filter;
+    uint16_t error_rate;        // per mille
+    int32_t in_deadzone;
+    int32_t deadzone_range;     // outer - inner deadzone
     bool auto_calibration;
     bool forced_circularity;
     uint32_t joystick_center_x;
@@ -142,10 +155,9 @@ public:
     virtual void reinit() {}
     virtual std::string name() { return AnalogName; }
 private:
-    float readPin(int stick_num, Pin_t pin, uint16_t center);
-    float emaCalculation(int stick_num, float ema_value, float ema_previous);
+    int32_t readPin(int stick_num, Pin_t pin, uint16_t center);
     uint16_t map(uint16_t x, uint16_t in_min, uint16_t in_max, uint16_t out_min, uint16_t out_max);
-    float magnitudeCalculation(int stick_num, adc_instance & adc_inst);
+    int32_t magnitudeCalculation(int stick_num, adc_instance & adc_inst);
     void radialDeadzone(int stick_num, adc_instance & adc_inst);
     adc_instance adc_pairs[ADC_COUNT];
 };
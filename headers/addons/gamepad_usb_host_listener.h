@@ -6,6 +6,7 @@
 #include "host/usbh.h"
 #include "drivers/ps4/PS4Descriptors.h"
 #include "drivers/switchpro/SwitchProDescriptors.h"
+#include "drivers/shared/hid_report_plan.h"
 
 #define GAMEPAD_HOST_DEBUG false
 #define GAMEPAD_HOST_USE_FEATURES true
@@ -124,8 +125,8 @@ typedef struct __attribute__((packed)) {
 class GamepadUSBHostListener : public USBListener {
     public:// USB Listener Features
         virtual void setup();
-        virtual void mount(uint8_t dev_addr, uint8_t instance, uint8_t const* desc_report, uint16_t desc_len);
-        virtual void xmount(uint8_t dev_addr, uint8_t instance, uint8_t controllerType, uint8_t subtype);
+        virtual bool mount(uint8_t dev_addr, uint8_t instance, uint8_t const* desc_report, uint16_t desc_len);
+        virtual bool xmount(uint8_t dev_addr, uint8_t instance, uint8_t controllerType, uint8_t subtype);
         virtual void unmount(uint8_t dev_addr);
         virtual void report_received(uint8_t dev_addr, uint8_t instance, uint8_t const* report, uint16_t len);
         virtual void report_sent(uint8_t dev_addr, uint8_t instance, uint8_t const* report, uint16_t len) {}
@@ -178,6 +179,10 @@ class GamepadUSBHostListener : public USBListener {
 
         void process_ultrastik360(uint8_t const* report, uint16_t len);
 
+        // any other HID gamepad, decoded with the plan compiled from its report descriptor at mount
+        HIDReportPlan hidReportPlan;
+        void process_generic_hid(uint8_t const* report, uint16_t len);
+
         void xbox360_set_led(uint8_t dev_addr, uint8_t instance, uint8_t quadrant);
         // universal xinput rumble packet
         void xinput_set_rumble(uint8_t dev_addr, uint8_t instance, uint8_t left, uint8_t right);
@@ -2,6 +2,8 @@
 #define _HE_Trigger_H
 
 #include "gpaddon.h"
+#include "analogfilter.h"
+#include "rapidtrigger.h"
 
 #define HETRIGGER_COUNT 32
 
@@ -39,6 +41,12 @@
 #define HETRIGGER_ADC3 -1
 #endif
 
+// Time the mux output needs to settle after a select switch, in us. 5 us is nine time constants of a 10k source
+// into 50 pF, the conversions and filtering of the previous channel hide most of it
+#ifndef HETRIGGER_MUX_SETTLE_TIME
+#define HETRIGGER_MUX_SETTLE_TIME 5
+#endif
+
 #ifndef HETRIGGER_SMOOTHING_ENABLED
 #define HETRIGGER_SMOOTHING_ENABLED 1
 #endif
@@ -47,6 +55,14 @@
 #define HETRIGGER_SMOOTHING_FACTOR 5
 #endif
 
+#ifndef HETRIGGER_FILTER_MIN_CUTOFF
+#define HETRIGGER_FILTER_MIN_CUTOFF 10
+#endif
+
+#ifndef HETRIGGER_FILTER_BETA
+#define HETRIGGER_FILTER_BETA 100
+#endif
+
 #ifndef HETRIGGER_DEFAULT_IDLE
 #define HETRIGGER_DEFAULT_IDLE 150
 #endif
@@ -857,26 +873,41 @@ public:
     virtual void postprocess(bool sent) {}
     virtual void reinit() {}
     virtual std::string name() { return HETriggerAddonName; }
+
+    // Time the last full scan of all triggers took, in us
+    uint32_t getScanPeriod() const { return scanPeriod; }
 private:
     void selectChannel(uint8_t channel);
-    uint16_t emaSmoothing(uint16_t value, uint16_t previous);
+    uint16_t readTrigger(const HETriggerOptions & options, uint8_t he);
+    uint16_t filterTrigger(uint8_t he, uint16_t value, uint32_t now);
+    void storeTravel(uint8_t he, uint16_t reading, uint32_t now);
+    void scanMux(const HETriggerOptions & options, uint32_t now);
+    void mapAction(uint8_t he, GpioAction action);
+    void applyKeys(Gamepad * gamepad, const HETriggerOptions & options, uint32_t pressed);
     int muxTotal;
     int selectPins;
     Pin_t muxPinArray[4];
     Pin_t selectPinArray[4];
-    Pin_t lastADCSelected;
 
-    uint16_t emaSmoothingReads[32];
-    bool triggerActive[32];
-    uint16_t lastIncrement[32];
-    float emaSmoothingFactor;
+    // Mux scan schedule, only the select channels that have a trigger on at least one mux
+    uint8_t scanChannels[16];
+    uint8_t scanChannelCount;
+    uint32_t settleTime;
+    uint32_t switchedAt;    // time_us_32() of the last select switch
+    uint32_t scanPeriod;
+
+    AnalogFilter filters[32];
+    RapidTrigger rapidTrigger;
+    uint16_t travel[32];    // filtered readings, deeper is larger
+    uint32_t polarizedKeys;
 
-    // Used during processing
-    uint32_t mux;
-    uint32_t channel;
-    uint16_t value;
-    uint16_t activationThreshold;
-    uint16_t releaseThreshold;
+    // Gamepad bits of each trigger's action
+    uint8_t keyDpad[32];
+    uint32_t keyButtons[32];
+    uint16_t keyAux[32];
+    uint32_t analogKeys;    // triggers that move a stick instead
+    uint32_t menuKeys;      // triggers that navigate the menu
+    uint32_t lastPressed;
 };
 
 #endif  // _HE_Trigger_H
\ No newline at end of file
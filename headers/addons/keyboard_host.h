@@ -23,6 +23,10 @@
 #define KEYBOARD_HOST_MOUSE_MOVEMENT 0
 #endif
 
+#ifndef KEYBOARD_HOST_MOUSE_ACCELERATION
+#define KEYBOARD_HOST_MOUSE_ACCELERATION MOUSE_ACCELERATION_NONE
+#endif
+
 // KeyboardHost Module Name
 #define KeyboardHostName "KeyboardHost"
 
@@ -26,8 +26,8 @@ struct KeyboardButtonMapping
 class KeyboardHostListener : public USBListener {
 public:// USB Listener Features
     virtual void setup();
-    virtual void mount(uint8_t dev_addr, uint8_t instance, uint8_t const* desc_report, uint16_t desc_len);
-    virtual void xmount(uint8_t dev_addr, uint8_t instance, uint8_t controllerType, uint8_t subtype) {}
+    virtual bool mount(uint8_t dev_addr, uint8_t instance, uint8_t const* desc_report, uint16_t desc_len);
+    virtual bool xmount(uint8_t dev_addr, uint8_t instance, uint8_t controllerType, uint8_t subtype) { return false; }
     virtual void unmount(uint8_t dev_addr);
     virtual void report_received(uint8_t dev_addr, uint8_t instance, uint8_t const* report, uint16_t len);
     virtual void report_sent(uint8_t dev_addr, uint8_t instance, uint8_t const* report, uint16_t len) {}
@@ -35,11 +35,12 @@ public:// USB Listener Features
     virtual void get_report_complete(uint8_t dev_addr, uint8_t instance, uint8_t report_id, uint8_t report_type, uint16_t len) {}
     void process();
 private:
-    uint8_t getKeycodeFromModifier(uint8_t modifier);
+    void buildKeycodeTables();
     void preprocess_report();
     void process_kbd_report(uint8_t dev_addr, hid_keyboard_report_t const *report);
     void process_mouse_report(uint8_t dev_addr, hid_mouse_report_t const *report);
-    uint16_t scaleMouseToJoystick(int8_t mouseVal);
+    void buildMouseGainTable(uint8_t acceleration);
+    uint16_t scaleMouseToJoystick(int8_t mouseVal, int32_t & remainder);
     KeyboardButtonMapping _keyboard_host_mapDpadUp;
     KeyboardButtonMapping _keyboard_host_mapDpadDown;
     KeyboardButtonMapping _keyboard_host_mapDpadLeft;
@@ -60,6 +61,11 @@ private:
     KeyboardButtonMapping _keyboard_host_mapButtonA2;
     KeyboardButtonMapping _keyboard_host_mapButtonA3;
     KeyboardButtonMapping _keyboard_host_mapButtonA4;
+    // Masks per HID keycode and per modifier bit, built from the mappings above so a report is a few table loads
+    uint16_t keycodeButtons[256];
+    uint8_t keycodeDpad[256];
+    uint16_t modifierButtons[8];
+    uint8_t modifierDpad[8];
     GamepadState _keyboard_host_state;
     bool _keyboard_host_mounted;
     uint8_t _keyboard_dev_addr;
@@ -72,10 +78,14 @@ private:
     uint16_t mouseRightMapping;
     uint32_t mouseSensitivity;
     uint8_t mouseMovementMode;
-    float mouseSensitivityScale;
+    // Q16 joystick counts per mouse count magnitude, sensitivity and acceleration folded in
+    int32_t mouseGain[129];
+    // Q16 fraction of a joystick count carried between reports so slow movement is not lost
+    int32_t mouseRemainderX;
+    int32_t mouseRemainderY;
     uint32_t mouseResetMS;
     uint32_t mouseResetNextTimer;
-    int16_t joystickMid;
+    uint16_t joystickMid;
     int16_t mouseX;
     int16_t mouseY;
     int16_t mouseZ;
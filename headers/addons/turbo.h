@@ -125,7 +125,7 @@ private:
     uint32_t chargeState;       // Turbo Charge Button States
     bool bTurboFlicker;         // Turbo Enable Buttons Toggle OFF Flag ??
     uint64_t nextTimer;         // Turbo Timer
-    uint8_t adcShmupDial;       // Turbo ADC Dial Input
+    Pin_t shmupDialPin;         // Turbo ADC Dial Pin
     uint64_t nextAdcRead;       // ADC read timer
     bool hasShmupDial;          // Flag for shmup dial presence
     uint16_t dialValue;         // Turbo Dial Value (Raw)
@@ -0,0 +1,50 @@
+#ifndef ANALOGFILTER_H_
+#define ANALOGFILTER_H_
+
+#include <cstdint>
+
+#include "enums.pb.h"
+
+#define ANALOG_FILTER_BITS 20           // filtered values are fixed point, full scale is 1 << ANALOG_FILTER_BITS
+#define ANALOG_FILTER_STATE_BITS 10     // extra low-pass state bits, so slow filters don't stall on rounding
+#define ANALOG_FILTER_SAMPLES 16        // ADC samples averaged per read in oversample mode
+
+// Noise versus latency trade-off for one analog channel, selected per stick or trigger in the config
+//
+// Values are in full scale fixed point, so the same settings behave alike on a stick axis and a trigger. Group delay
+// of each mode, for a loop period T and an ADC round period R (number of ADC inputs * 2 us):
+//   NONE        no delay
+//   EMA         (1 - a) / a * T with a = smoothing / 1000, 199 T for the default factor of 5
+//   OVERSAMPLE  (ANALOG_FILTER_SAMPLES - 1) / 2 * R at the source, a few tens of microseconds. White noise drops
+//               by a factor of 4, the value is still a single 12-bit reading per loop
+//   ONE_EURO    1 / (2 pi minCutoff) at rest, shrinking as the cutoff rises by beta per full scale per second of
+//               speed. About 160 ms at rest with the default 1 Hz, a couple of ms on a fast flick with the default beta
+//   MEDIAN      median of the last 3 values, 1 T on a ramp and a single sample spike is removed entirely
+class AnalogFilter {
+public:
+    // smoothing in per mille (EMA), minCutoff in tenths of Hz and beta in tenths of Hz per full scale per second
+    // (one euro)
+    void setup(AnalogFilterMode mode, uint16_t smoothing, uint16_t minCutoff, uint16_t beta);
+    // Starts the filter over at value. The first filter() call after setup() does this with its own value
+    void reset(int32_t value);
+    // Filters the newest value, now is a microsecond timestamp of the reading
+    int32_t filter(int32_t value, uint32_t now);
+
+    AnalogFilterMode getMode() const { return mode; }
+    // ADC samples the caller should average for each reading
+    uint8_t getOversample() const { return mode == AnalogFilterMode::ANALOG_FILTER_OVERSAMPLE ? ANALOG_FILTER_SAMPLES : 1; }
+private:
+    int32_t lowPass(int32_t value, uint32_t alpha, uint8_t alphaBits);
+
+    AnalogFilterMode mode = AnalogFilterMode::ANALOG_FILTER_NONE;
+    uint32_t emaAlpha = 0;          // Q24
+    uint32_t minCutoff = 0;         // mHz
+    uint32_t beta = 0;              // mHz per full scale per second
+    bool primed = false;
+    int32_t state = 0;              // low-pass output, ANALOG_FILTER_STATE_BITS finer than a value
+    int32_t speed = 0;              // one euro speed estimate, Q16 full scale per second
+    uint32_t lastTime = 0;
+    int32_t history[2] = {};        // median inputs, newest first
+};
+
+#endif
@@ -0,0 +1,39 @@
+#ifndef BOOTARENA_H_
+#define BOOTARENA_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
+
+// Bump allocator for objects that are created during boot and live for the whole program
+// (add-ons, the input driver, gamepads and their button mappings)
+//
+// Keeping these out of the general heap means they cannot be interleaved with transient allocations and fragment it.
+// Arena memory is never returned, the only exception being the most recent allocation, so that an object which turns
+// out not to be needed right after creation (e.g. an add-on that is not available) can be discarded again.
+// If the arena is exhausted allocations fall back to the heap; getOverflow() reports how much larger it should be.
+namespace BootArena {
+    // Returns memory for an object of the given size and alignment, from the heap if the arena is full
+    void* allocate(size_t size, size_t alignment);
+    // Called by operator delete for arena pointers. Rolls back the most recent allocation, any other
+    // pointer is counted in getInvalidFrees() and its memory is kept.
+    void release(void* ptr);
+    // Returns true if ptr points into the arena
+    bool contains(const void* ptr);
+
+    uint32_t getSize();
+    uint32_t getUsed();
+    // Returns the bytes that had to be allocated from the heap because the arena was full
+    uint32_t getOverflow();
+    // Returns the number of attempts to free arena memory other than the most recent allocation
+    uint32_t getInvalidFrees();
+
+    template <typename T, typename... Args>
+    T* create(Args&&... args)
+    {
+        return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+}
+
+#endif
@@ -12,6 +12,8 @@ namespace ConfigUtils {
 
     std::string toJSON(const Config& config);
     bool fromJSON(Config& config, const char* data, size_t dataLen);
+    bool toProtobuf(Config& config, std::string& data);
+    bool fromProtobuf(Config& config, const uint8_t* data, size_t dataLen);
     bool fromLegacyStorage(Config& config);
 }
 
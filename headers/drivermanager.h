@@ -4,6 +4,9 @@
 #include "enums.pb.h"
 #include "gpdriver.h"
 
+// Large enough for the biggest configuration descriptor of any driver
+#define DRIVER_CONFIG_DESCRIPTOR_MAX_SIZE 256
+
 class GPDriver;
 
 class DriverManager {
@@ -18,10 +21,18 @@ public:
     void setup(InputMode);
     InputMode getInputMode(){ return inputMode; }
     bool isConfigMode(){ return (inputMode == INPUT_MODE_CONFIG); }
+    // Returns the driver's configuration descriptor, with the polling interval override and telemetry interface applied
+    const uint8_t * getConfigurationDescriptor(uint8_t index);
+    // Runs the driver's process() and passes sent reports, with the cycles they took to build, on to USB telemetry
+    bool process(Gamepad * gamepad);
 private:
     DriverManager() {}
+    bool copyConfigurationDescriptor();
+    void patchPollingInterval(uint8_t interval);
     GPDriver * driver;
     InputMode inputMode;
+    uint8_t configDescriptor[DRIVER_CONFIG_DESCRIPTOR_MAX_SIZE];
+    bool configDescriptorPatched = false;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,73 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * SPDX-FileCopyrightText: Copyright (c) 2024 OpenStickCommunity (gp2040-ce.info)
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include "tusb.h"
+#include "drivers/hid/HIDDescriptors.h"
+#include "drivers/keyboard/KeyboardDescriptors.h"
+
+// The GP2040 HID IDs. bcdDevice differs from the HID mode, Windows caches the interfaces per VID/PID/bcdDevice
+#define COMPOSITE_VENDOR_ID  VENDOR_ID
+#define COMPOSITE_PRODUCT_ID PRODUCT_ID
+
+static const uint8_t composite_string_language[]     = { 0x09, 0x04 };
+static const uint8_t composite_string_manufacturer[] = "Open Stick Community";
+static const uint8_t composite_string_product[]      = "GP2040-CE (Composite)";
+static const uint8_t composite_string_version[]      = "1.0";
+
+static const uint8_t *composite_string_descriptors[] __attribute__((unused)) =
+{
+	composite_string_language,
+	composite_string_manufacturer,
+	composite_string_product,
+	composite_string_version
+};
+
+static const uint8_t composite_device_descriptor[] =
+{
+	sizeof(tusb_desc_device_t),	// bLength
+	TUSB_DESC_DEVICE,			// bDescriptorType
+	0x00, 0x02,					// bcdUSB
+	0x00,						// bDeviceClass (defined per interface)
+	0x00,						// bDeviceSubClass
+	0x00,						// bDeviceProtocol
+	CFG_TUD_ENDPOINT0_SIZE,		// bMaxPacketSize0
+	LSB(COMPOSITE_VENDOR_ID), MSB(COMPOSITE_VENDOR_ID),		// idVendor
+	LSB(COMPOSITE_PRODUCT_ID), MSB(COMPOSITE_PRODUCT_ID),	// idProduct
+	0x00, 0x02,					// bcdDevice
+	0x01,						// iManufacturer
+	0x02,						// iProduct
+	0x00,						// iSerialNumber
+	0x01						// bNumConfigurations
+};
+
+// Interface numbers double as the TinyUSB HID instance of each interface
+enum
+{
+	ITF_NUM_COMPOSITE_GAMEPAD,
+	ITF_NUM_COMPOSITE_KEYBOARD,
+	ITF_NUM_COMPOSITE_TOTAL
+};
+
+#define COMPOSITE_CONFIG_TOTAL_LEN  (TUD_CONFIG_DESC_LEN + (ITF_NUM_COMPOSITE_TOTAL * TUD_HID_DESC_LEN))
+
+// Every interface has its own IN endpoint so a busy one never holds back the others
+#define COMPOSITE_EPNUM_GAMEPAD   0x81
+#define COMPOSITE_EPNUM_KEYBOARD  0x82
+
+static const uint8_t composite_configuration_descriptor[] =
+{
+	// Config number, interface count, string index, total length, attribute, power in mA
+	TUD_CONFIG_DESCRIPTOR(1, ITF_NUM_COMPOSITE_TOTAL, 0, COMPOSITE_CONFIG_TOTAL_LEN, TUSB_DESC_CONFIG_ATT_REMOTE_WAKEUP, 100),
+
+	// Interface number, string index, protocol, report descriptor len, EP In address, size & polling interval
+	TUD_HID_DESCRIPTOR(ITF_NUM_COMPOSITE_GAMEPAD, 0, HID_ITF_PROTOCOL_NONE, sizeof(hid_report_descriptor), COMPOSITE_EPNUM_GAMEPAD, CFG_TUD_HID_EP_BUFSIZE, 1),
+	TUD_HID_DESCRIPTOR(ITF_NUM_COMPOSITE_KEYBOARD, 0, HID_ITF_PROTOCOL_KEYBOARD, sizeof(keyboard_report_descriptor), COMPOSITE_EPNUM_KEYBOARD, CFG_TUD_HID_EP_BUFSIZE, 1)
+};
+
+static_assert(sizeof(composite_configuration_descriptor) == COMPOSITE_CONFIG_TOTAL_LEN, "Composite configuration descriptor length mismatch");
+static_assert(ITF_NUM_COMPOSITE_TOTAL <= CFG_TUD_HID, "CFG_TUD_HID must cover every composite interface");
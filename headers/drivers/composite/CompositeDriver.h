@@ -0,0 +1,47 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * SPDX-FileCopyrightText: Copyright (c) 2024 OpenStickCommunity (gp2040-ce.info)
+ */
+
+#ifndef _COMPOSITE_DRIVER_H_
+#define _COMPOSITE_DRIVER_H_
+
+#include "gpdriver.h"
+#include "drivers/composite/CompositeDescriptors.h"
+#include "drivers/hid/HIDDriver.h"
+#include "drivers/keyboard/KeyboardDriver.h"
+
+// Enumerates as one device with a HID gamepad and a HID keyboard interface
+//
+// Each interface is driven by the regular driver for that mode, pointed at its own HID instance. All of
+// them build their reports from the same processed gamepad in one pass and send on their own endpoint,
+// an interface whose endpoint is still busy retries on the next pass without holding back the others.
+class CompositeDriver : public GPDriver {
+public:
+    virtual void initialize();
+    virtual bool process(Gamepad * gamepad);
+    virtual void initializeAux() {}
+    virtual void processAux() {}
+    virtual uint16_t get_report(uint8_t report_id, hid_report_type_t report_type, uint8_t *buffer, uint16_t reqlen);
+    virtual void set_report(uint8_t report_id, hid_report_type_t report_type, uint8_t const *buffer, uint16_t bufsize);
+    virtual uint16_t get_hid_report(uint8_t itf, uint8_t report_id, hid_report_type_t report_type, uint8_t *buffer, uint16_t reqlen);
+    virtual void set_hid_report(uint8_t itf, uint8_t report_id, hid_report_type_t report_type, uint8_t const *buffer, uint16_t bufsize);
+    virtual bool vendor_control_xfer_cb(uint8_t rhport, uint8_t stage, tusb_control_request_t const *request);
+    virtual const uint16_t * get_descriptor_string_cb(uint8_t index, uint16_t langid);
+    virtual const uint8_t * get_descriptor_device_cb();
+    virtual const uint8_t * get_hid_descriptor_report_cb(uint8_t itf);
+    virtual const uint8_t * get_descriptor_configuration_cb(uint8_t index);
+    virtual const uint8_t * get_descriptor_device_qualifier_cb();
+    virtual uint16_t GetJoystickMidValue();
+    virtual USBListener * get_usb_auth_listener() { return nullptr; }
+    virtual bool supports_polling_interval_override() { return true; }
+    virtual bool supports_telemetry() { return true; }
+    virtual uint8_t get_report_endpoint() { return COMPOSITE_EPNUM_GAMEPAD; }
+private:
+    HIDDriver gamepadInterface;
+    KeyboardDriver keyboardInterface;
+    GPDriver * interfaces[ITF_NUM_COMPOSITE_TOTAL];
+    uint8_t deviceDescriptor[sizeof(composite_device_descriptor)];
+};
+
+#endif // _COMPOSITE_DRIVER_H_
@@ -25,9 +25,16 @@ public:
     virtual const uint8_t * get_descriptor_device_qualifier_cb();
     virtual uint16_t GetJoystickMidValue();
     virtual USBListener * get_usb_auth_listener() { return nullptr; }
+    virtual bool supports_polling_interval_override() { return true; }
+    virtual bool supports_telemetry() { return true; }
+    virtual uint8_t get_report_endpoint() { return GAMEPAD_ENDPOINT | TUSB_DIR_IN_MASK; }
+    // TinyUSB HID instance the reports go out on, set when the driver is one interface of CompositeDriver
+    void setHIDInstance(uint8_t instance) { hidInstance = instance; }
 private:
     uint8_t last_report[CFG_TUD_ENDPOINT0_SIZE] = { };
     HIDReport hidReport;
+    uint8_t deviceDescriptor[sizeof(hid_device_descriptor)];
+    uint8_t hidInstance = 0;
 };
 
 #endif // _HID_DRIVER_H_
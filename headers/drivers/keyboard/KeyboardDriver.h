@@ -27,15 +27,18 @@ public:
     virtual uint16_t GetJoystickMidValue();
     virtual USBListener * get_usb_auth_listener() { return nullptr; }
     void handleEncoder(GPEvent* e); // for Volume - rotary encoder
+    // TinyUSB HID instance the reports go out on, set when the driver is one interface of CompositeDriver
+    void setHIDInstance(uint8_t instance) { hidInstance = instance; }
 private:
     void releaseAllKeys(void);
 	void pressKey(uint8_t code);
     uint8_t getModifier(uint8_t code);
     uint8_t getMultimedia(uint8_t code);
     uint8_t last_report[CFG_TUD_ENDPOINT0_SIZE] = { };
-    uint16_t last_report_size;
+    uint16_t last_report_size = 0;
     KeyboardReport keyboardReport;
     int8_t volumeChange;
+    uint8_t hidInstance = 0;
 };
 
 #endif // _KEYBOARD_DRIVER_H_
@@ -8,8 +8,8 @@
 class P5GeneralAuthUSBListener : public USBListener {
 public:
     virtual void setup();
-    virtual void mount(uint8_t dev_addr, uint8_t instance, uint8_t const* desc_report, uint16_t desc_len);
-    virtual void xmount(uint8_t dev_addr, uint8_t instance, uint8_t controllerType, uint8_t subtype){}
+    virtual bool mount(uint8_t dev_addr, uint8_t instance, uint8_t const* desc_report, uint16_t desc_len);
+    virtual bool xmount(uint8_t dev_addr, uint8_t instance, uint8_t controllerType, uint8_t subtype) { return false; }
     virtual void unmount(uint8_t dev_addr);
     virtual void report_received(uint8_t dev_addr, uint8_t instance, uint8_t const* report, uint16_t len);
     virtual void report_sent(uint8_t dev_addr, uint8_t instance, uint8_t const* report, uint16_t len) {}
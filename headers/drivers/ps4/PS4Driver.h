@@ -7,11 +7,15 @@
 #define _PS4_DRIVER_H_
 
 #include "gpdriver.h"
+#include "drivers/shared/keepalive_timer.h"
 #include "drivers/ps4/PS4Descriptors.h"
 
 // Authentication
 #include "drivers/ps4/PS4Auth.h"
 
+// force a report to be sent every X ms
+#define PS4_KEEPALIVE_TIMER 5
+
 typedef enum
 {
     PS4_GET_CALIBRATION      = 0x02,    // PS4 Controller Calibration
@@ -52,6 +56,7 @@ public:
     virtual const uint8_t * get_descriptor_device_qualifier_cb();
     virtual uint16_t GetJoystickMidValue();
     virtual USBListener * get_usb_auth_listener();
+    virtual bool supports_polling_interval_override() { return true; }
     bool getAuthSent() { return authsent;}
     bool getDongleAuthRequired();
 private:
@@ -61,7 +66,7 @@ private:
     PS4Report ps4Report;
     TouchpadData touchpadData;
     PSSensorData sensorData;
-    uint32_t last_report_timer;
+    KeepAliveTimer keepAliveTimer {PS4_KEEPALIVE_TIMER};
     PS4Auth * ps4AuthDriver;
     PS4AuthData * ps4AuthData;      // PS4 Authentication Data
     uint8_t cur_nonce_chunk;            // PS4 Encryption Nonce Chunk (Max 19)
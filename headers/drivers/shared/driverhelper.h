@@ -1,26 +1,21 @@
 #ifndef _DRIVER_HELPER_H_
 #define _DRIVER_HELPER_H_
 
-static uint16_t * getStringDescriptor(const char * value, uint8_t index)
-{
-	static uint16_t descriptorStringBuffer[128]; // Max 256 bytes, 127 unicode characters
-	size_t charCount;
-	if ( index == 0 ) // language always has a character count of 1
-		charCount = 1;
-	else {
-		charCount = strlen(value);
-		if (charCount > 127)
-			charCount = 127;
-	}
-	// Fill descriptionStringBuffer[1] .. [32]
-	for (uint8_t i = 0; i < charCount; i++)
-		descriptorStringBuffer[i + 1] = value[i];
+#include <stdint.h>
 
-	// first byte (descriptionStringBuffer[0]) is length (including header), second byte is string type
-	descriptorStringBuffer[0] = (0x03 << 8) | (2 * (uint8_t)charCount + 2);
+// String descriptor indices DriverManager materializes right after the driver is set up
+// (language, manufacturer, product, serial)
+#define USB_STRING_DESCRIPTOR_PRELOAD 4
 
-	// Cast temp buffer to final result
-	return descriptorStringBuffer;
-}
+// Returns the USB string descriptor (UTF-16) for value
+//
+// The first request for an index converts the string into a shared pool, every later request
+// for that index returns the stored descriptor as is. The strings of a driver do not change
+// once it is set up, a new driver needs a reboot.
+const uint16_t * getStringDescriptor(const char * value, uint8_t index);
+
+// Sets bInterval of every interrupt endpoint (in ms at full speed) of a configuration descriptor, walking it up to
+// wTotalLength
+void setPollingInterval(uint8_t * configDescriptor, uint8_t interval);
 
 #endif // _DRIVER_HELPER_H_
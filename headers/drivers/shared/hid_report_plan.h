@@ -0,0 +1,80 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * SPDX-FileCopyrightText: Copyright (c) 2024 OpenStickCommunity (gp2040-ce.info)
+ */
+
+#ifndef _HID_REPORT_PLAN_H_
+#define _HID_REPORT_PLAN_H_
+
+#include <cstdint>
+
+#include "gamepad/GamepadState.h"
+
+// Worst case is one run per button, e.g. the Stadia controller lists its buttons out of order
+#define HID_REPORT_PLAN_MAX_BUTTON_RUNS 32
+
+typedef enum {
+    HID_REPORT_TARGET_HAT,
+    HID_REPORT_TARGET_LX,
+    HID_REPORT_TARGET_LY,
+    HID_REPORT_TARGET_RX,
+    HID_REPORT_TARGET_RY,
+    HID_REPORT_TARGET_LT,
+    HID_REPORT_TARGET_RT,
+    HID_REPORT_TARGET_COUNT
+} HIDReportTarget;
+
+// Bit offsets count from the first byte after the report ID
+typedef struct {
+    uint16_t bitOffset;
+    uint8_t bitSize;
+    uint8_t target;         // HIDReportTarget
+    uint8_t isSigned;
+    int32_t logicalMin;
+    int32_t logicalMax;
+    uint32_t scale;         // axes: Q16 factor from the logical range to the GamepadState range, hats: step per value
+} HIDReportField;
+
+// Consecutive 1 bit buttons with consecutive numbers
+typedef struct {
+    uint16_t bitOffset;
+    uint8_t count;
+    uint8_t firstButton;    // HID button number - 1 of the first bit
+} HIDReportButtonRun;
+
+// Field extraction plan for a generic HID gamepad/joystick
+//
+// compile() walks the report descriptor once at mount and keeps only the input fields GamepadState has a place
+// for, so decoding a report is a walk over a handful of precomputed bit offsets instead of re-parsing the
+// descriptor. Buttons use the order of our own HID mode (1 = B3, 2 = B1, 3 = B2, 4 = B4, ... 17-20 = d-pad).
+class HIDReportPlan {
+public:
+    // Returns false if the descriptor has no gamepad or joystick input report
+    bool compile(const uint8_t * desc, uint16_t descLen);
+    // Overwrites buttons, d-pad and the axes present in the report, returns false for other or short reports
+    bool decode(const uint8_t * report, uint16_t len, GamepadState & state) const;
+    void reset() { fieldCount = 0; buttonRunCount = 0; }
+
+    bool isValid() const { return fieldCount != 0 || buttonRunCount != 0; }
+    bool hasAnalog() const { return analog; }
+    uint8_t getReportId() const { return reportId; }
+    uint8_t getFieldCount() const { return fieldCount; }
+    uint8_t getButtonRunCount() const { return buttonRunCount; }
+private:
+    void addInput(uint16_t bitOffset, uint8_t reportSize, uint8_t reportCount,
+                  const uint32_t * usages, uint8_t usageCount, uint32_t usageMin, uint32_t usageMax,
+                  int32_t logicalMin, int32_t logicalMax);
+    void addField(const HIDReportField & field);
+    void addButton(uint16_t bitOffset, uint8_t button);
+
+    HIDReportField fields[HID_REPORT_TARGET_COUNT]; // at most one field per target
+    HIDReportButtonRun buttonRuns[HID_REPORT_PLAN_MAX_BUTTON_RUNS];
+    uint8_t fieldCount = 0;
+    uint8_t buttonRunCount = 0;
+    uint8_t reportId = 0;   // 0 when the device does not use report IDs
+    uint8_t reportBytes = 0; // smallest report that holds every field, without the report ID
+    uint8_t targets = 0;    // bit per HIDReportTarget already assigned
+    bool analog = false;
+};
+
+#endif // _HID_REPORT_PLAN_H_
@@ -0,0 +1,29 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * SPDX-FileCopyrightText: Copyright (c) 2024 OpenStickCommunity (gp2040-ce.info)
+ */
+
+#ifndef _KEEPALIVE_TIMER_H_
+#define _KEEPALIVE_TIMER_H_
+
+#include <cstdint>
+
+// Deadline for drivers that have to send a report periodically even when the input does not change
+//
+// The deadline is computed once when a report goes out, so checking it is a single compare against the
+// time DriverManager reads at the start of every process() call. Comparisons are safe across the
+// millisecond counter wrapping around.
+class KeepAliveTimer {
+public:
+    explicit KeepAliveTimer(uint32_t intervalMs) : interval(intervalMs), deadline(0) {}
+
+    // Call whenever a report was sent, the next keepalive is due one interval later
+    void reset(uint32_t now) { deadline = now + interval; }
+    // True once more than one interval has passed since the last reset()
+    bool expired(uint32_t now) const { return (int32_t)(now - deadline) > 0; }
+private:
+    uint32_t interval;
+    uint32_t deadline;
+};
+
+#endif // _KEEPALIVE_TIMER_H_
@@ -0,0 +1,61 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * SPDX-FileCopyrightText: Copyright (c) 2024 OpenStickCommunity (gp2040-ce.info)
+ */
+
+#ifndef _SPSC_RING_H_
+#define _SPSC_RING_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Bounded single-producer / single-consumer ring buffer
+//
+// Storage is fixed at compile time so pushing never allocates. The producer only writes head and the consumer only
+// writes tail, which keeps it safe between an endpoint callback and the driver loop without disabling interrupts.
+// N must be a power of two.
+template <typename T, size_t N>
+class SPSCRing {
+public:
+    static_assert(N > 0 && (N & (N - 1)) == 0, "SPSCRing size must be a power of two");
+
+    // Producer: returns a slot to fill in, or nullptr if the ring is full. The slot is published by commit()
+    T* reserve() {
+        const uint32_t h = head.load(std::memory_order_relaxed);
+        if (h - tail.load(std::memory_order_acquire) >= N) {
+            return nullptr;
+        }
+        return &items[h & (N - 1)];
+    }
+    void commit() { head.store(head.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+
+    // Consumer: returns the oldest item without removing it, or nullptr if the ring is empty
+    T* front() { return peek(0); }
+    // Consumer: returns the item index places after the oldest one, or nullptr if there are not that many
+    T* peek(size_t index) {
+        const uint32_t t = tail.load(std::memory_order_relaxed);
+        if (head.load(std::memory_order_acquire) - t <= index) {
+            return nullptr;
+        }
+        return &items[(t + index) & (N - 1)];
+    }
+    // Consumer: removes the count oldest items, at most size() of them
+    void pop(size_t count = 1) { tail.store(tail.load(std::memory_order_relaxed) + count, std::memory_order_release); }
+
+    bool empty() const { return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire); }
+    bool full() const { return (head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire)) >= N; }
+    size_t size() const { return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire); }
+
+    // Only safe while neither side is active (e.g. on USB reset)
+    void clear() {
+        head.store(0, std::memory_order_relaxed);
+        tail.store(0, std::memory_order_relaxed);
+    }
+private:
+    T items[N];
+    std::atomic<uint32_t> head {0};
+    std::atomic<uint32_t> tail {0};
+};
+
+#endif // _SPSC_RING_H_
@@ -88,7 +88,9 @@ public:
     void incrementSequence();                   // Add 1 to sequence
     bool setData(const uint8_t* data, uint16_t len); // Set data (buf and length)
     uint8_t * generatePacket();                 // Generate output packet (chunk will generate on-going packet)
+    uint16_t generatePacket(uint8_t * out);     // Generate output packet into out, returns its length
     uint8_t * generateAckPacket();              // Generate an ack for the last received packet
+    uint16_t generateAckPacket(uint8_t * out);  // Generate an ack into out, returns its length
     bool validateAck(XGIPProtocol & ackPacket); // Validate an incoming ack packet against 
     uint8_t getCommand();                       // Get command of a parsed packet
     uint8_t getSequence();                      // Get sequence of a parsed packet
@@ -25,6 +25,7 @@ public:
     virtual const uint8_t * get_descriptor_device_qualifier_cb();
     virtual uint16_t GetJoystickMidValue();
     virtual USBListener * get_usb_auth_listener() { return nullptr; }
+    virtual bool supports_polling_interval_override() { return true; }
 private:
     uint8_t last_report[CFG_TUD_ENDPOINT0_SIZE] = { };
     SwitchReport switchReport;
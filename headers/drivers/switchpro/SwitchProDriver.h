@@ -9,8 +9,10 @@
 #include <map>
 #include <vector>
 #include "gpdriver.h"
+#include "drivers/shared/keepalive_timer.h"
 #include "drivers/switchpro/SwitchProDescriptors.h"
 
+// force a report to be sent every X ms
 #define SWITCH_PRO_KEEPALIVE_TIMER 5
 
 class SwitchProDriver : public GPDriver {
@@ -34,7 +36,7 @@ private:
     uint8_t last_report[SWITCH_PRO_ENDPOINT_SIZE] = { };
     SwitchProReport switchReport;
     uint8_t last_report_counter;
-    uint32_t last_report_timer;
+    KeepAliveTimer keepAliveTimer {SWITCH_PRO_KEEPALIVE_TIMER};
     bool isReady = false;
     bool isInitialized = false;
     bool isReportQueued = false;
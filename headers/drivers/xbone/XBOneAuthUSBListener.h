@@ -9,8 +9,8 @@
 class XBOneAuthUSBListener : public USBListener {
 public:
     virtual void setup();
-    virtual void mount(uint8_t dev_addr, uint8_t instance, uint8_t const* desc_report, uint16_t desc_len){}
-    virtual void xmount(uint8_t dev_addr, uint8_t instance, uint8_t controllerType, uint8_t subtype);
+    virtual bool mount(uint8_t dev_addr, uint8_t instance, uint8_t const* desc_report, uint16_t desc_len) { return false; }
+    virtual bool xmount(uint8_t dev_addr, uint8_t instance, uint8_t controllerType, uint8_t subtype);
     virtual void unmount(uint8_t dev_addr);
     virtual void report_received(uint8_t dev_addr, uint8_t instance, uint8_t const* report, uint16_t len);
     virtual void report_sent(uint8_t dev_addr, uint8_t instance, uint8_t const* report, uint16_t len){}
@@ -19,7 +19,7 @@ public:
     void process();
     void setAuthData(XboxOneAuthData *);
 private:
-    void queue_host_report(void* report, uint16_t len);
+    void queue_host_packet(XGIPProtocol & xgip, bool ack);
     void process_report_queue();
     uint8_t xbone_dev_addr;
     uint8_t xbone_instance;
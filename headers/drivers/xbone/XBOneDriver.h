@@ -7,10 +7,14 @@
 #define _XBONE_DRIVER_H_
 
 #include "gpdriver.h"
+#include "drivers/shared/keepalive_timer.h"
 #include "drivers/xbone/XBOneDescriptors.h"
 #include "drivers/shared/xgip_protocol.h"
 #include "drivers/shared/gpauthdriver.h"
 
+// Send Keep-Alive every 15 seconds
+#define XBONE_KEEPALIVE_TIMER 15000
+
 class XBOneDriver : public GPDriver {
 public:
     virtual void initialize();
@@ -30,13 +34,13 @@ public:
     bool getAuthSent();
 private:
     virtual void update();
-    void process_report_queue(uint32_t now);
     bool send_xbone_usb(uint8_t const *buffer, uint16_t bufsize);
+    bool send_xbone_input(uint8_t const *buffer, uint16_t bufsize);
     void set_ack_wait();
     uint8_t last_report[CFG_TUD_ENDPOINT0_SIZE] = { };
     uint8_t last_report_counter;
     XboxOneGamepad_Data_t xboneReport;
-    uint32_t keep_alive_timer;
+    KeepAliveTimer keepAliveTimer {XBONE_KEEPALIVE_TIMER};
     uint8_t keep_alive_sequence;
     uint8_t virtual_keycode_sequence;
     bool xb1_guide_pressed;
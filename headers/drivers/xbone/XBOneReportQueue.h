@@ -0,0 +1,100 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * SPDX-FileCopyrightText: Copyright (c) 2024 OpenStickCommunity (gp2040-ce.info)
+ */
+
+#ifndef _XBONE_REPORT_QUEUE_H_
+#define _XBONE_REPORT_QUEUE_H_
+
+#include <cstdint>
+
+#include "drivers/shared/spsc_ring.h"
+
+#define XBONE_ACK_QUEUE_SIZE 4
+#define XBONE_CONTROL_QUEUE_SIZE 8
+#define XBONE_QUEUED_PACKET_SIZE 64
+
+// Control packets go out at least this many milliseconds apart, the console and PC drop descriptor and auth chunks
+// that follow each other more closely
+#define XBONE_CONTROL_PACKET_GAP 35
+
+typedef enum {
+    XBONE_QUEUE_ACK,        // acknowledgements of packets from the console
+    XBONE_QUEUE_CONTROL,    // announce, descriptor and auth chunks
+} XboxOneQueuePriority;
+
+typedef struct {
+    uint8_t report[XBONE_QUEUED_PACKET_SIZE];
+    uint16_t len;
+} report_queue_t;
+
+// XGIP packets of the Xbox One driver other than input reports
+//
+// Acks go out before control packets, and nothing is released while an input report waits for the endpoint, so input
+// never waits behind queued traffic. Every IN completion releases the next packet straight away, only control packets
+// keep XBONE_CONTROL_PACKET_GAP between each other.
+class XBOneReportQueue {
+public:
+    // Producer: slot for the next packet of a priority, or nullptr if its ring is full. Published by commit()
+    report_queue_t * reserve(XboxOneQueuePriority priority) {
+        return priority == XBONE_QUEUE_ACK ? acks.reserve() : control.reserve();
+    }
+    void commit(XboxOneQueuePriority priority) {
+        if (priority == XBONE_QUEUE_ACK) {
+            acks.commit();
+        } else {
+            control.commit();
+        }
+    }
+    bool full(XboxOneQueuePriority priority) const {
+        return priority == XBONE_QUEUE_ACK ? acks.full() : control.full();
+    }
+
+    // An input report could not be sent because the endpoint was busy
+    void setInputPending(bool pending) { inputPending = pending; }
+
+    // Consumer: the packet to send now, or nullptr if nothing may go out yet. Remove it with sent() once the endpoint
+    // took it
+    report_queue_t * next(uint32_t now) {
+        nextIsAck = false;
+        if (inputPending) {
+            return nullptr;
+        }
+        report_queue_t * packet = acks.front();
+        if (packet != nullptr) {
+            nextIsAck = true;
+            return packet;
+        }
+        if (controlSent && (now - lastControl) < XBONE_CONTROL_PACKET_GAP) {
+            return nullptr;
+        }
+        return control.front();
+    }
+    void sent(uint32_t now) {
+        if (nextIsAck) {
+            acks.pop();
+        } else {
+            control.pop();
+            lastControl = now;
+            controlSent = true;
+        }
+    }
+
+    // Only safe while the endpoint is idle (e.g. on USB reset)
+    void clear() {
+        acks.clear();
+        control.clear();
+        inputPending = false;
+        nextIsAck = false;
+        controlSent = false;
+    }
+private:
+    SPSCRing<report_queue_t, XBONE_ACK_QUEUE_SIZE> acks;
+    SPSCRing<report_queue_t, XBONE_CONTROL_QUEUE_SIZE> control;
+    bool inputPending = false;
+    bool nextIsAck = false;
+    bool controlSent = false;   // lastControl is only valid once a control packet went out
+    uint32_t lastControl = 0;
+};
+
+#endif // _XBONE_REPORT_QUEUE_H_
@@ -9,6 +9,7 @@
 #include <pico/unique_id.h>
 
 #define XINPUT_ENDPOINT_SIZE 20
+#define XINPUT_ENDPOINT_IN 0x81
 
 // Buttons 1 (8 bits)
 // TODO: Consider using an enum class here.
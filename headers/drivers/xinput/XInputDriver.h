@@ -30,6 +30,9 @@ public:
     virtual const uint8_t * get_descriptor_device_qualifier_cb();
     virtual uint16_t GetJoystickMidValue();
     virtual USBListener * get_usb_auth_listener();
+    virtual bool supports_polling_interval_override() { return true; }
+    virtual bool supports_telemetry() { return true; }
+    virtual uint8_t get_report_endpoint() { return XINPUT_ENDPOINT_IN; }
     bool getAuthSent();
 private:
     uint8_t last_report[CFG_TUD_ENDPOINT0_SIZE] = { };
@@ -41,6 +44,7 @@ private:
 
     InputModeDeviceType deviceType;
     uint8_t configDescriptor[sizeof(xinput_configuration_descriptor)];
+    uint8_t deviceDescriptor[sizeof(xinput_device_descriptor)];
 
     GamepadButtonMapping *buttonGas;
     GamepadButtonMapping *buttonBrake;
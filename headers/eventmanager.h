@@ -42,7 +42,10 @@ class EventManager {
 
         void registerEventHandler(GPEventType eventType, EventFunction handler);
         void unregisterEventHandler(GPEventType eventType, EventFunction handler);
+        // Takes ownership of the event and deletes it once every handler has run
         void triggerEvent(GPEvent* event);
+        // Same for an event the caller owns, e.g. one on the stack of a hot path
+        void triggerEvent(GPEvent& event);
     private:
         EventManager(){}
 
@@ -72,6 +72,25 @@ public:
 		return (state.dpad & mask) == mask;
 	}
 
+	/**
+	 * @brief Pressure of a single button for reports with analog buttons: its published analog value while an analog
+	 * source drives it, full scale while it is pressed otherwise and zero while it is released.
+	 */
+	inline uint8_t __attribute__((always_inline)) pressureButton(const uint32_t mask) {
+		if ((state.buttons & mask) == 0)
+			return 0;
+		return (auxState.analogButtons.buttons & mask) ? auxState.analogButtons.buttonValues[__builtin_ctz(mask)] : 0xFF;
+	}
+
+	/**
+	 * @brief Pressure of a single dpad direction. Same idea as `pressureButton`.
+	 */
+	inline uint8_t __attribute__((always_inline)) pressureDpad(const uint8_t mask) {
+		if ((state.dpad & mask) == 0)
+			return 0;
+		return (auxState.analogButtons.dpad & mask) ? auxState.analogButtons.dpadValues[__builtin_ctz(mask)] : 0xFF;
+	}
+
 	/**
 	 * @brief Check for an aux button press. Same idea as `pressedButton`.
 	 */
@@ -196,6 +215,17 @@ public:
 
 	uint32_t lastReinitProfileNumber = 0;
 
+	/**
+	 * @brief Bump the state generation if any reported input changed since the last call.
+	 *
+	 * Called once per loop after all add-ons have processed the state, so drivers can skip
+	 * building their report when getStateGeneration() matches the one they last sent.
+	 */
+	void updateStateGeneration();
+	uint32_t getStateGeneration() const { return stateGeneration; }
+	// time_us_32() of the read() that produced the current state generation
+	uint32_t getStateGenerationTime() const { return stateGenerationTime; }
+
 	// These are special to SOCD
 	inline static const SOCDMode resolveSOCDMode(const GamepadOptions& options) {
 		return (options.socdMode == SOCD_MODE_BYPASS &&
@@ -218,6 +248,12 @@ private:
 	GamepadHotkey lastAction = HOTKEY_NONE;
 
 	absolute_time_t disableFocusModeTimeout = nil_time;
+
+	GamepadState generationState;
+	GamepadAuxAnalogButtons generationAnalogButtons; // pressure reaches PS3/Xbox reports without a digital change
+	uint32_t stateGeneration = 1; // drivers start at 0 so the first report is always built
+	uint32_t stateGenerationTime = 0;
+	uint32_t readTime = 0;
 };
 
 #endif
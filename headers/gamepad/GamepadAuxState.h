@@ -148,6 +148,39 @@ struct GamepadAuxHaptics
     GamepadAuxHapticChannel rightTrigger;
 };
 
+// Pressure of buttons driven by an analog source (e.g. hall effect triggers), indexed by the bit of their
+// GAMEPAD_MASK_* value. Only the buttons set in the masks have a value, the source rewrites them every loop
+struct GamepadAuxAnalogButtons
+{
+    uint32_t buttons = 0;
+    uint8_t dpad = 0;
+    uint8_t buttonValues[32] = {};
+    uint8_t dpadValues[4] = {};
+
+    void clear() { buttons = 0; dpad = 0; }
+
+    // Several sources on one button or direction publish the deepest press
+    void setButton(uint32_t mask, uint8_t value) {
+        const uint8_t bit = __builtin_ctz(mask);
+        if (!(buttons & mask) || buttonValues[bit] < value)
+            buttonValues[bit] = value;
+        buttons |= mask;
+    }
+
+    void setDpad(uint8_t mask, uint8_t value) {
+        const uint8_t bit = __builtin_ctz(mask);
+        if (!(dpad & mask) || dpadValues[bit] < value)
+            dpadValues[bit] = value;
+        dpad |= mask;
+    }
+
+    // Buttons and directions a digital input also holds go back to full pressure
+    void clearDigital(uint32_t buttonMask, uint8_t dpadMask) {
+        buttons &= ~buttonMask;
+        dpad &= ~dpadMask;
+    }
+};
+
 struct GamepadAuxState
 {
     GamepadAuxPlayerID playerID;
@@ -162,4 +195,6 @@ struct GamepadAuxState
     GamepadAuxTurbo turbo;
 
     GamepadAuxPower power;
+
+    GamepadAuxAnalogButtons analogButtons;
 };
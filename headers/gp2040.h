@@ -64,6 +64,7 @@ private:
         SET_INPUT_MODE_PSCLASSIC,
         SET_INPUT_MODE_XBOXORIGINAL,
         SET_INPUT_MODE_SWITCH_PRO,
+        SET_INPUT_MODE_COMPOSITE,
     };
     BootAction getBootAction();
     void getReinitGamepad(Gamepad * gamepad);
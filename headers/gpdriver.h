@@ -40,8 +40,29 @@ public:
     virtual uint16_t GetJoystickMidValue() = 0;
     const usbd_class_driver_t * get_class_driver() { return &class_driver; }
     virtual USBListener * get_usb_auth_listener() = 0;
+    // HID GET_REPORT/SET_REPORT for the HID instance itf, drivers with several HID interfaces dispatch on it
+    virtual uint16_t get_hid_report(uint8_t itf, uint8_t report_id, hid_report_type_t report_type, uint8_t *buffer, uint16_t reqlen) {
+        return get_report(report_id, report_type, buffer, reqlen);
+    }
+    virtual void set_hid_report(uint8_t itf, uint8_t report_id, hid_report_type_t report_type, uint8_t const *buffer, uint16_t bufsize) {
+        set_report(report_id, report_type, buffer, bufsize);
+    }
+    // Drivers whose hosts accept any interrupt endpoint bInterval can opt in to the polling interval override
+    virtual bool supports_polling_interval_override() { return false; }
+    // Drivers whose hosts ignore extra vendor interfaces can carry the USB latency telemetry interface
+    virtual bool supports_telemetry() { return false; }
+    // IN endpoint of the input reports, the poll rate and telemetry only follow transfers on it. 0 follows every IN endpoint
+    virtual uint8_t get_report_endpoint() { return 0; }
+    // Set by DriverManager before every process() call, so drivers share a single clock read per loop
+    void setProcessTime(uint32_t now) { processTime = now; }
 protected:
+    // Drivers whose report only depends on GamepadState use these to skip building identical reports
+    bool stateChanged(Gamepad * gamepad) { return gamepad->getStateGeneration() != sentStateGeneration; }
+    void markStateSent(Gamepad * gamepad) { sentStateGeneration = gamepad->getStateGeneration(); }
+
     usbd_class_driver_t class_driver;
+    uint32_t sentStateGeneration = 0;
+    uint32_t processTime = 0; // milliseconds since boot at the start of process()
 };
 
 #endif
@@ -0,0 +1,64 @@
+#ifndef MEMORYTRACKER_H_
+#define MEMORYTRACKER_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#define MEMORY_TRACKER_MAX_TAGS 32
+#define MEMORY_TRACKER_TAG_NAME_LENGTH 16
+
+// Heap attribution for operator new/delete
+//
+// Every allocation made through operator new is prefixed with a small header that records its size and the tag that
+// was active on the allocating core. Frees are always credited back to the tag that made the allocation, so memory
+// that is allocated by one subsystem and released by another (e.g. events) is still attributed correctly.
+namespace MemoryTracker {
+    typedef uint8_t Tag;
+
+    enum BuiltinTag : Tag {
+        TAG_UNTAGGED = 0,
+        TAG_DRIVER,
+        TAG_WEBCONFIG,
+        TAG_EVENTS,
+        TAG_BUILTIN_COUNT
+    };
+
+    struct TagStats {
+        char name[MEMORY_TRACKER_TAG_NAME_LENGTH];
+        uint32_t liveBytes;     // bytes currently allocated
+        uint32_t peakBytes;     // high-water mark of liveBytes
+        uint32_t liveCount;     // allocations currently outstanding
+        uint32_t allocCount;    // allocations made since boot
+    };
+
+    // Returns the tag registered under name, registering it if required
+    // Returns TAG_UNTAGGED if all MEMORY_TRACKER_MAX_TAGS tags are in use
+    Tag registerTag(const char* name);
+    // Sets the tag used for allocations on the calling core and returns the previous one
+    Tag setCurrentTag(Tag tag);
+
+    uint32_t getTagCount();
+    // Copies the statistics of a single tag, returns false for unknown tags
+    bool getTagStats(Tag tag, TagStats& stats);
+    // Returns the bytes currently allocated through operator new across all tags
+    uint32_t getLiveBytes();
+    // Returns the high-water mark of getLiveBytes()
+    uint32_t getPeakBytes();
+
+    // Tracked malloc(), returns nullptr when the heap is exhausted. operator new panics instead
+    void* allocate(size_t size);
+    void release(void* ptr);
+
+    // Tags all allocations on the calling core for the lifetime of the scope
+    class Scope {
+    public:
+        explicit Scope(Tag tag) : previous(setCurrentTag(tag)) {}
+        ~Scope() { setCurrentTag(previous); }
+        Scope(Scope const&) = delete;
+        void operator=(Scope const&) = delete;
+    private:
+        Tag previous;
+    };
+}
+
+#endif
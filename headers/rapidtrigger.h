@@ -0,0 +1,51 @@
+#ifndef RAPIDTRIGGER_H_
+#define RAPIDTRIGGER_H_
+
+#include <cstdint>
+
+#define RAPID_TRIGGER_KEYS 32
+
+// Actuation and rapid trigger state of up to 32 hall effect keys
+//
+// Key state is kept as one array per field and one bit per key. An update is one pass over the plain keys and one over
+// the rapid trigger keys, so the loops never branch on the configuration of a key. Travel is in ADC counts, larger is
+// deeper, the caller flips polarized sensors before passing values in.
+//
+// A plain key is pressed while its travel is past the actuation point. A rapid trigger key follows the direction of
+// travel instead: it presses once it has moved deeper than the reset distance from the highest point since it let go,
+// as long as it is at or past actuation, and lets go once it has come back up by the reset distance from its deepest
+// point, as long as it is at or above the release point. A stroke from the release point minus the reset distance to
+// the actuation point plus the reset distance therefore always gives one press and one release.
+//
+// The pressure of a key maps its travel between the calibrated idle and full press readings to 0..255, for reports
+// with analog buttons.
+class RapidTrigger {
+public:
+    // Removes every key
+    void clear();
+    void setKey(uint8_t key, uint16_t actuation, uint16_t release, uint16_t resetDistance, bool rapid);
+    // Starts a key over from a travel reading, released
+    void reset(uint8_t key, uint16_t travel);
+    // A key without a usable range (pressed not deeper than idle) reports full pressure
+    void setPressureRange(uint8_t key, uint16_t idle, uint16_t pressed);
+    // Pressure of a pressed key, never 0 so a pressed button doesn't report as released
+    uint8_t getPressure(uint8_t key, uint16_t travel) const;
+
+    // Updates every configured key from travel[key], returns the pressed keys as a bitmask
+    uint32_t update(const uint16_t * travel);
+
+    uint32_t getKeys() const { return keys; }
+    uint32_t getPressed() const { return pressed; }
+private:
+    uint32_t keys = 0;          // configured keys
+    uint32_t rapid = 0;         // keys with rapid trigger
+    uint32_t pressed = 0;
+    uint16_t actuation[RAPID_TRIGGER_KEYS] = {};
+    uint16_t release[RAPID_TRIGGER_KEYS] = {};
+    uint16_t resetDistance[RAPID_TRIGGER_KEYS] = {};
+    uint16_t extreme[RAPID_TRIGGER_KEYS] = {};  // travel where the key last turned around
+    uint16_t pressureIdle[RAPID_TRIGGER_KEYS] = {};
+    uint32_t pressureScale[RAPID_TRIGGER_KEYS] = {};    // pressure per count of travel past idle, Q16
+};
+
+#endif
@@ -16,6 +16,11 @@ namespace System {
     uint32_t getTotalHeap();
     // Returns the about of heap memory currently allocated in bytes
     uint32_t getUsedHeap();
+    // Returns the size of the contiguous free block at the top of the heap in bytes
+    // Freed chunks below it are not included, see getFragmentedHeap()
+    uint32_t getLargestFreeHeapBlock();
+    // Returns the amount of free heap memory in bytes that is scattered between allocated chunks
+    uint32_t getFragmentedHeap();
 
     enum class BootMode : uint32_t {
         DEFAULT = 0,
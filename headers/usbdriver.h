@@ -1,7 +1,11 @@
 #ifndef _USB_DRIVER_H_
 #define _USB_DRIVER_H_
 
+#include <stdint.h>
+
 bool get_usb_mounted(void);
 bool get_usb_suspended(void);
+// Returns completed IN transfers per second, which is the host poll rate while a report is ready every poll
+uint32_t get_usb_poll_rate(void);
 
 #endif // #ifndef _USB_DRIVER_H_
\ No newline at end of file
@@ -2,6 +2,7 @@
 #define _USBHOSTMANAGER_H_
 
 #include "usblistener.h"
+#include "drivers/shared/spsc_ring.h"
 #include <vector>
 
 #include "pio_usb.h"
@@ -9,6 +10,46 @@
 #include "host/usbh.h"
 #include "host/usbh_pvt.h"
 
+// Every mounted HID or XInput interface that a listener claimed gets a registry slot with its own report queue.
+// The TinyUSB host callbacks queue into the slot and process() hands the events to the claiming listeners only,
+// taking turns between devices until the time budget runs out so a chatty device cannot starve the others
+#define USB_HOST_DEVICE_MAX 8         // CFG_TUH_HID interfaces plus XInput interfaces behind a hub
+#define USB_HOST_DEVICE_QUEUE_SIZE 4
+#define USB_HOST_LISTENER_MAX 32      // one claim bit per listener
+#define USB_HOST_EVENT_REPORT_SIZE 64 // CFG_TUH_HID_EPIN_BUFSIZE and CFG_TUH_XINPUT_EPIN_BUFSIZE
+
+// Boards can override this in their BoardConfig.h
+#ifndef USB_HOST_PROCESS_BUDGET_US
+#define USB_HOST_PROCESS_BUDGET_US 250
+#endif
+
+typedef enum {
+    USB_HOST_EVENT_HID_REPORT_RECEIVED,
+    USB_HOST_EVENT_HID_SET_REPORT_COMPLETE,
+    USB_HOST_EVENT_HID_GET_REPORT_COMPLETE,
+    USB_HOST_EVENT_XINPUT_REPORT_RECEIVED,
+    USB_HOST_EVENT_XINPUT_REPORT_SENT,
+} USBHostEventType;
+
+typedef struct {
+    USBHostEventType type;
+    uint8_t dev_addr;
+    uint8_t instance;
+    uint8_t report_id;
+    uint8_t report_type;
+    uint16_t len;
+    uint8_t report[USB_HOST_EVENT_REPORT_SIZE];
+} USBHostEvent;
+
+typedef struct {
+    uint8_t dev_addr;
+    uint8_t instance;
+    bool xinput;                // XInput and HID instance numbers overlap
+    uint32_t listeners;         // listeners that claimed the interface on mount, 0 while the slot is free
+    uint32_t queueOverflows;    // events handed to the listeners early because this queue was full
+    SPSCRing<USBHostEvent, USB_HOST_DEVICE_QUEUE_SIZE> events;
+} USBHostDevice;
+
 // USB Host manager decides on TinyUSB Host driver
 usbh_class_driver_t const* usbh_app_driver_get_cb(uint8_t *driver_count);
 
@@ -24,24 +65,35 @@ public:
     void shutdown();            // Called on system reboot
     void pushListener(USBListener *); // If anything needs to update in the gpconfig driver
     void process();
+    // Queues a listener callback for a claimed interface, only called from the TinyUSB host callbacks
+    void queueEvent(USBHostEventType type, uint8_t dev_addr, uint8_t instance, uint8_t const* report, uint16_t len, uint8_t report_id = 0, uint8_t report_type = 0);
+    // Hands every queued event to the listeners, mounts and unmounts must not overtake queued reports
+    void flushEvents();
+    uint32_t getMaxProcessUs() { return maxProcessUs; }
+    uint32_t getQueueOverflows();
+    uint32_t getUnclaimedEvents() { return unclaimedEvents; }
+    uint8_t getDeviceCount();
     void hid_mount_cb(uint8_t dev_addr, uint8_t instance, uint8_t const* desc_report, uint16_t desc_len);
     void hid_umount_cb(uint8_t daddr, uint8_t instance);
-    void hid_report_received_cb(uint8_t dev_addr, uint8_t instance, uint8_t const* report, uint16_t len);
-    void hid_set_report_complete_cb(uint8_t dev_addr, uint8_t instance, uint8_t report_id, uint8_t report_type, uint16_t len);
-    void hid_get_report_complete_cb(uint8_t dev_addr, uint8_t instance, uint8_t report_id, uint8_t report_type, uint16_t len);
     void xinput_mount_cb(uint8_t dev_addr, uint8_t instance, uint8_t controllerType, uint8_t subtype);
-    void xinput_umount_cb(uint8_t dev_addr);
-    void xinput_report_received_cb(uint8_t dev_addr, uint8_t instance, uint8_t const* report, uint16_t len);
-    void xinput_report_sent_cb(uint8_t dev_addr, uint8_t instance, uint8_t const* report, uint16_t len);
+    void xinput_umount_cb(uint8_t dev_addr, uint8_t instance);
     
 private:
-    USBHostManager() : tuh_ready(false), core0Ready(false), core1Ready(false) {}
+    USBHostManager() : tuh_ready(false), core0Ready(false), core1Ready(false), devices(), nextDevice(0), maxProcessUs(0), unclaimedEvents(0) {}
+    USBHostDevice * findDevice(uint8_t dev_addr, uint8_t instance, bool xinput);
+    void registerDevice(uint8_t dev_addr, uint8_t instance, bool xinput, uint32_t claims);
+    void releaseDevice(USBHostDevice * device);
+    bool dispatchEvent(USBHostDevice * device);
     std::vector<USBListener*> listeners;
     usb_device_t *usb_device;
     uint8_t dataPin;
     bool tuh_ready;
     bool core0Ready;
     bool core1Ready;
+    USBHostDevice devices[USB_HOST_DEVICE_MAX];
+    uint8_t nextDevice;         // slot process() starts from, so every device gets its turn first
+    uint32_t maxProcessUs;      // longest process() call, including tuh_task()
+    uint32_t unclaimedEvents;   // callbacks for interfaces no listener claimed, dropped without a copy
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,68 @@
+#ifndef USBTELEMETRY_H_
+#define USBTELEMETRY_H_
+
+#include <cstdint>
+
+#include "tusb.h"
+#include "device/usbd_pvt.h"
+
+class Gamepad;
+
+// Vendor interface subclass/protocol so host tools can find the telemetry interface
+#define USB_TELEMETRY_SUBCLASS 0x47
+#define USB_TELEMETRY_PROTOCOL 0x54
+#define USB_TELEMETRY_DESC_LEN (sizeof(tusb_desc_interface_t) + sizeof(tusb_desc_endpoint_t))
+
+// One record per report that reached the host, all times are time_us_32() on the device
+typedef struct __attribute__((packed)) {
+    uint32_t edgeUs;        // when the input change carried by this report was read
+    uint32_t queuedUs;      // when the driver handed the report to TinyUSB
+    uint32_t completeUs;    // when the host picked it up (IN transfer completed)
+    uint16_t sequence;      // report counter, gaps mean records were dropped because the ring was full
+    uint16_t generation;    // Gamepad state generation, repeats for keepalive reports without an input change
+} USBTelemetryRecord;
+
+static_assert(sizeof(USBTelemetryRecord) == 16, "USBTelemetryRecord is part of the host protocol");
+
+// Vendor IN request to the telemetry interface, answered with USBTelemetryStatus
+#define USB_TELEMETRY_REQUEST_STATUS 0x01
+
+typedef struct __attribute__((packed)) {
+    uint32_t dropped;           // records lost on the device, see USBTelemetry::getDropped()
+    uint32_t inputScanUs;       // last full scan of the hall effect triggers, 0 without them
+    uint32_t inputScanMaxUs;    // longest full scan since boot
+    uint32_t pollRate;          // completed IN transfers per second on the report endpoint, see get_usb_poll_rate()
+    uint32_t reportBuildNs;     // mean time of the driver process() calls that sent a report, since boot
+    uint32_t reportBuildMaxNs;  // longest of them
+} USBTelemetryStatus;
+
+// Optional vendor bulk interface that streams input-to-USB latency records
+//
+// DriverManager appends the interface to the configuration descriptor when gamepadOptions.usbTelemetry is set
+// and the driver supports it. Records are completed from the driver's IN transfer callback, kept in a lock-free
+// ring and sent in 64 byte packets whenever the telemetry endpoint is idle, so the input reports never wait on it.
+namespace USBTelemetry {
+    // Appends the interface and its bulk IN endpoint to a configuration descriptor of at most maxLength bytes.
+    // Returns false, leaving the descriptor untouched, if it does not fit.
+    bool appendInterface(uint8_t * desc, uint16_t maxLength);
+    bool isEnabled();
+    const usbd_class_driver_t * getClassDriver();
+
+    // Called by DriverManager after the driver queued a report
+    void reportQueued(const Gamepad * gamepad);
+    // Called by DriverManager with the CPU cycles of a driver process() call that sent a report
+    void reportBuilt(uint32_t cycles);
+    // Called for every completed IN transfer on the input report endpoint
+    void reportCompleted();
+    // Sends buffered records if the telemetry endpoint is idle
+    void process();
+
+    // Records lost because the ring was full or a report was queued before the previous one completed
+    uint32_t getDropped();
+
+    // Called by add-ons that read their inputs in one scan per loop (hall effect trigger muxes) with the time it took,
+    // so gamepad mode can report the scan period along with the latency records
+    void inputScanned(uint32_t us);
+}
+
+#endif
@@ -161,19 +161,24 @@ bool tud_network_recv_cb(const uint8_t *src, uint16_t size)
 
   if (size)
   {
+    /* copy the frame out of the USB buffer: lwip may keep a received frame for a long time (tcp ooseq queue,
+    partial http request) and pointers into the payload must stay valid after the buffer is renewed.
+    TinyUSB has a single receive buffer, so lending it to lwip until pbuf_free() would stall the endpoint
+    while a frame is queued, and moving a queued frame would leave lwip's pointers behind: keep the copy */
     struct pbuf *p = pbuf_alloc(PBUF_RAW, size, PBUF_POOL);
 
     if (p)
     {
       /* pbuf_alloc() has already initialized struct; all we need to do is copy the data */
-      memcpy(p->payload, src, size);
-
-      /* store away the pointer for service_traffic() to later handle */
-      received_frame = p;
+      pbuf_take(p, src, size);
     }
+
+    /* store away the pointer for service_traffic() to later handle */
+    received_frame = p;
   }
 
-  return true;
+  /* if we could not take the frame, TinyUSB drops it and renews the buffer on our behalf */
+  return received_frame != NULL;
 }
 
 uint16_t tud_network_xmit_cb(uint8_t *dst, void *ref, uint16_t arg)
@@ -190,12 +195,14 @@ static void service_traffic(void)
   /* handle any packet received by tud_network_recv_cb() */
   if (received_frame)
   {
-    err_t ret = ethernet_input(received_frame, &netif_data);
-    pbuf_free(received_frame);
+    struct pbuf *p = received_frame;
     received_frame = NULL;
-    if ( ret == ERR_OK ) {
-      tud_network_recv_renew();
-    }
+
+    if (ethernet_input(p, &netif_data) != ERR_OK)
+      pbuf_free(p);
+
+    /* the frame was copied in tud_network_recv_cb(), the USB buffer can take the next one */
+    tud_network_recv_renew();
   }
 
   sys_check_timeouts();
@@ -0,0 +1,220 @@
+#include "adcservice.h"
+
+#include "hardware/adc.h"
+#include "hardware/dma.h"
+
+#define ADC_SERVICE_RING_BITS 8             // log2(ADC_SERVICE_RING_SIZE * sizeof(uint16_t))
+#define ADC_SERVICE_DMA_COUNT 0xFFFFFFFFu
+#define ADC_SERVICE_RESTART_COUNT 0x80000000u // re-arm the DMA long before its transfer count runs out (~1h)
+
+static_assert((ADC_SERVICE_RING_SIZE * sizeof(uint16_t)) == (1u << ADC_SERVICE_RING_BITS), "ADC ring must match its DMA ring size");
+static_assert(ADC_SERVICE_OVERSAMPLE <= ADC_SERVICE_MAX_SAMPLES, "ADC oversampling is limited by the ring");
+static_assert(ADC_SERVICE_RING_SIZE >= 2 * ADC_SERVICE_INPUTS * ADC_SERVICE_MAX_SAMPLES, "ADC ring must hold several rounds");
+
+// DMA ring writes wrap on an address boundary of the ring size
+static uint16_t ring[ADC_SERVICE_RING_SIZE] __attribute__((aligned(ADC_SERVICE_RING_SIZE * sizeof(uint16_t))));
+
+static uint8_t channelMask = 0;
+static uint8_t channelCount = 0;
+static uint8_t order[ADC_SERVICE_INPUTS];   // ADC input converted at each position of a round
+static uint8_t position[ADC_SERVICE_INPUTS]; // position of each ADC input in a round
+
+static int dmaChannel = -1;
+static bool running = false;
+static bool paused = false;
+static uint32_t base = 0;       // sample index the current DMA run started at
+static uint32_t pausedAt = 0;   // samples written when sampling was paused
+static uint32_t folded = 0;     // samples taken off the index by launch(), keeps getSampleCount() monotonic
+
+static inline bool isADCPin(Pin_t pin) {
+    return pin >= ADC_SERVICE_FIRST_PIN && pin < ADC_SERVICE_FIRST_PIN + ADC_SERVICE_INPUTS;
+}
+
+static inline uint32_t samplesWritten() {
+    return base + (ADC_SERVICE_DMA_COUNT - dma_channel_hw_addr(dmaChannel)->transfer_count);
+}
+
+// Continues sampling at index from. Round-robin goes up from the selected input, so selecting the input that owns
+// index from keeps every ring position on the same input across restarts. The index is folded back by a multiple
+// of both the round and the ring so it never wraps around 32 bits, keeping one such period so the samples already
+// in the ring still have an index
+static void launch(uint32_t from) {
+    const uint32_t period = (uint32_t)channelCount * ADC_SERVICE_RING_SIZE;
+    if (from >= 2 * period) {
+        const uint32_t fold = from - (from % period) - period;
+        folded += fold;
+        from -= fold;
+    }
+    adc_fifo_setup(true, true, 1, false, false);
+    adc_fifo_drain();
+    adc_set_round_robin(channelMask);
+    adc_select_input(order[from % channelCount]);
+
+    dma_channel_config config = dma_channel_get_default_config(dmaChannel);
+    channel_config_set_transfer_data_size(&config, DMA_SIZE_16);
+    channel_config_set_read_increment(&config, false);
+    channel_config_set_write_increment(&config, true);
+    channel_config_set_ring(&config, true, ADC_SERVICE_RING_BITS);
+    channel_config_set_dreq(&config, DREQ_ADC);
+    base = from;
+    dma_channel_configure(dmaChannel, &config, &ring[from & (ADC_SERVICE_RING_SIZE - 1)], &adc_hw->fifo, ADC_SERVICE_DMA_COUNT, true);
+
+    adc_run(true);
+}
+
+// Stops sampling once the last conversion has reached the ring, returns the number of samples written
+static uint32_t halt() {
+    adc_run(false);
+    while (!(adc_hw->cs & ADC_CS_READY_BITS)) {
+        tight_loop_contents();
+    }
+    while (adc_fifo_get_level() > 0) {
+        tight_loop_contents(); // DMA takes what is left
+    }
+    const uint32_t written = samplesWritten();
+    dma_channel_abort(dmaChannel);
+    adc_set_round_robin(0);
+    adc_fifo_setup(false, false, 0, false, false);
+    return written;
+}
+
+static uint16_t average(uint8_t input, uint32_t written, uint32_t oversample) {
+    const uint8_t slot = position[input];
+    if (written <= slot) {
+        return 0;
+    }
+
+    // Newest index that belongs to this input, then walk back one round at a time
+    uint32_t index = written - 1 - ((written - 1 - slot) % channelCount);
+    const uint32_t available = (index - slot) / channelCount + 1;
+    const uint32_t samples = available < oversample ? available : oversample;
+    uint32_t sum = 0;
+    for (uint32_t i = 0; i < samples; i++, index -= channelCount) {
+        sum += ring[index & (ADC_SERVICE_RING_SIZE - 1)];
+    }
+    return sum / samples;
+}
+
+bool ADCService::addChannel(Pin_t pin) {
+    if (!isADCPin(pin) || running || paused) {
+        return false;
+    }
+
+    adc_gpio_init(pin);
+    channelMask |= (1 << (pin - ADC_SERVICE_FIRST_PIN));
+
+    // Rebuild the round order, the ADC always goes up from the selected input
+    channelCount = 0;
+    for (uint8_t input = 0; input < ADC_SERVICE_INPUTS; input++) {
+        if (channelMask & (1 << input)) {
+            position[input] = channelCount;
+            order[channelCount++] = input;
+        }
+    }
+    return true;
+}
+
+void ADCService::start() {
+    if (channelCount == 0 || running) {
+        return;
+    }
+    if (dmaChannel < 0) {
+        dmaChannel = dma_claim_unused_channel(true);
+    }
+    launch(0);
+    running = true;
+    paused = false;
+
+    // Wait for one sample per input so read() never sees an empty ring
+    while (samplesWritten() < channelCount) {
+        tight_loop_contents();
+    }
+}
+
+bool ADCService::isRunning() {
+    return running;
+}
+
+uint16_t ADCService::read(Pin_t pin) {
+    return read(pin, ADC_SERVICE_OVERSAMPLE);
+}
+
+uint16_t ADCService::read(Pin_t pin, uint32_t samples) {
+    if (!isADCPin(pin)) {
+        return 0;
+    }
+    if (samples == 0) {
+        samples = 1;
+    } else if (samples > ADC_SERVICE_MAX_SAMPLES) {
+        samples = ADC_SERVICE_MAX_SAMPLES;
+    }
+    const uint8_t input = pin - ADC_SERVICE_FIRST_PIN;
+    if (!(channelMask & (1 << input))) {
+        return readBlocking(pin, samples);
+    }
+    if (paused) {
+        return average(input, pausedAt, samples);
+    }
+    if (!running) {
+        return readBlocking(pin, samples);
+    }
+
+    uint32_t written = samplesWritten();
+    if ((written - base) >= ADC_SERVICE_RESTART_COUNT) {
+        launch(halt());
+        written = samplesWritten();
+    }
+    return average(input, written, samples);
+}
+
+uint16_t ADCService::readBlocking(Pin_t pin) {
+    return readBlocking(pin, 1);
+}
+
+uint16_t ADCService::readBlocking(Pin_t pin, uint32_t samples) {
+    if (!isADCPin(pin)) {
+        return 0;
+    }
+    if (samples == 0) {
+        samples = 1;
+    }
+
+    const bool wasRunning = running;
+    if (wasRunning) {
+        pause();
+    }
+    adc_select_input(pin - ADC_SERVICE_FIRST_PIN);
+    uint32_t sum = 0;
+    for (uint32_t i = 0; i < samples; i++) {
+        sum += adc_read();
+    }
+    if (wasRunning) {
+        resume();
+    }
+    return sum / samples;
+}
+
+void ADCService::pause() {
+    if (!running) {
+        return;
+    }
+    pausedAt = halt();
+    running = false;
+    paused = true;
+}
+
+void ADCService::resume() {
+    if (!paused) {
+        return;
+    }
+    launch(pausedAt);
+    running = true;
+    paused = false;
+}
+
+uint32_t ADCService::getSampleCount() {
+    if (paused) {
+        return folded + pausedAt;
+    }
+    return running ? folded + samplesWritten() : 0;
+}
@@ -1,10 +1,15 @@
 #include "addonmanager.h"
 #include "usbhostmanager.h"
+#include "bootarena.h"
 
 bool AddonManager::LoadAddon(GPAddon* addon) {
     if (addon->available()) {
-        AddonBlock * block = new AddonBlock;
-        addon->setup();
+        AddonBlock * block = BootArena::create<AddonBlock>();
+        block->memoryTag = MemoryTracker::registerTag(addon->name().c_str());
+        {
+            MemoryTracker::Scope memoryScope(block->memoryTag);
+            addon->setup();
+        }
         block->ptr = addon;
         addons.push_back(block);
         return true;
@@ -25,6 +30,7 @@ bool AddonManager::LoadUSBAddon(GPAddon* addon) {
 void AddonManager::ReinitializeAddons() {
     // Loop through all addons and process any that match our type
     for (std::vector<AddonBlock*>::iterator it = addons.begin(); it != addons.end(); it++) {
+        MemoryTracker::Scope memoryScope((*it)->memoryTag);
         (*it)->ptr->reinit();
     }
 }
@@ -32,6 +38,7 @@ void AddonManager::ReinitializeAddons() {
 void AddonManager::PreprocessAddons() {
     // Loop through all addons and process any that match our type
     for (std::vector<AddonBlock*>::iterator it = addons.begin(); it != addons.end(); it++) {
+        MemoryTracker::Scope memoryScope((*it)->memoryTag);
         (*it)->ptr->preprocess();
     }
 }
@@ -39,6 +46,7 @@ void AddonManager::PreprocessAddons() {
 void AddonManager::ProcessAddons() {
     // Loop through all addons and process any that match our type
     for (std::vector<AddonBlock*>::iterator it = addons.begin(); it != addons.end(); it++) {
+        MemoryTracker::Scope memoryScope((*it)->memoryTag);
         (*it)->ptr->process();
     }
 }
@@ -46,6 +54,7 @@ void AddonManager::ProcessAddons() {
 void AddonManager::PostprocessAddons(bool reportSent) {
     // Loop through all addons and process any that match our type
     for (std::vector<AddonBlock*>::iterator it = addons.begin(); it != addons.end(); it++) {
+        MemoryTracker::Scope memoryScope((*it)->memoryTag);
         (*it)->ptr->postprocess(reportSent);
     }
 }
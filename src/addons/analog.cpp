@@ -1,18 +1,62 @@
 #include "addons/analog.h"
 #include "config.pb.h"
 #include "enums.pb.h"
-#include "hardware/adc.h"
+#include "adcservice.h"
+#include "analogfilter.h"
 #include "helper.h"
 #include "storagemanager.h"
 #include "drivermanager.h"
 
-#include <math.h>
+#include <algorithm>
 
 #define ADC_MAX ((1 << 12) - 1) // 4095
-#define ADC_PIN_OFFSET 26
-#define ANALOG_MAX 1.0f
-#define ANALOG_CENTER 0.5f
-#define ANALOG_MINIMUM 0.0f
+
+// Stick math is fixed point: a position runs from 0 to ANALOG_MAX, which stands for 1.0. 20 fraction bits keep the
+// output within one step of the old float pipeline, and squared offsets still fit 64 bits.
+#define ANALOG_FRACTION_BITS 20
+#define ANALOG_MAX (1 << ANALOG_FRACTION_BITS)
+#define ANALOG_CENTER (ANALOG_MAX / 2)
+#define ANALOG_MINIMUM 0
+#define ANALOG_SCALE_BITS 22    // fraction bits of the radial deadzone factor
+
+static_assert(ANALOG_FRACTION_BITS == ANALOG_FILTER_BITS, "Stick positions are filtered as they are");
+
+// Bit by bit square root in 32-bit steps without branches, every operation is a single M0+ instruction
+static uint32_t isqrt32(uint32_t value) {
+    uint32_t root = 0;
+    for (uint32_t bit = 1u << 30; bit != 0; bit >>= 2) {
+        const uint32_t trial = root + bit;
+        const uint32_t fits = -(uint32_t)(value >= trial);
+        value -= trial & fits;
+        root = (root >> 1) + (bit & fits);
+    }
+    return root;
+}
+
+// Square root of a sum of squared offsets, within one of the exact root. Values past 32 bits drop their low bits in
+// pairs, and the remainder of the 32-bit root restores the root bits that were dropped with them.
+static uint32_t isqrt(uint64_t value) {
+    uint32_t shift = 0;
+    while ((value >> shift) > 0xFFFFFFFFull) {
+        shift += 2;
+    }
+    const uint32_t reduced = (uint32_t)(value >> shift);
+    uint32_t root = isqrt32(reduced);
+    if (shift != 0) {
+        const uint32_t half = shift / 2;
+        root = (root << half) + (((reduced - root * root) << half) / (2 * root + 1));
+    }
+    return root;
+}
+
+static inline int32_t percentToAnalog(uint32_t percent) {
+    return (percent * ANALOG_MAX + 50) / 100;
+}
+
+// value * perMille / 1000 without overflowing 32 bits, two hardware divides
+static inline int32_t scalePerMille(int32_t value, uint16_t perMille) {
+    return (value / 1000) * perMille + ((value % 1000) * perMille) / 1000;
+}
 
 bool AnalogInput::available() {
     return Storage::getInstance().getAddonOptions().analogOptions.enabled;
@@ -26,11 +70,12 @@ void AnalogInput::setup() {
     adc_pairs[0].y_pin = analogOptions.analogAdc1PinY;
     adc_pairs[0].analog_invert = analogOptions.analogAdc1Invert;
     adc_pairs[0].analog_dpad = analogOptions.analogAdc1Mode;
-    adc_pairs[0].ema_option = analogOptions.analog_smoothing;
-    adc_pairs[0].ema_smoothing = analogOptions.smoothing_factor / 1000.0f;
-    adc_pairs[0].error_rate = analogOptions.analog_error / 1000.0f;
-    adc_pairs[0].in_deadzone = analogOptions.inner_deadzone / 100.0f;
-    adc_pairs[0].out_deadzone = analogOptions.outer_deadzone / 100.0f;
+    adc_pairs[0].x_filter.setup(analogOptions.analog_filter, (uint16_t)(analogOptions.smoothing_factor + 0.5f),
+        analogOptions.filter_min_cutoff, analogOptions.filter_beta);
+    adc_pairs[0].y_filter = adc_pairs[0].x_filter;
+    adc_pairs[0].error_rate = analogOptions.analog_error;
+    adc_pairs[0].in_deadzone = percentToAnalog(analogOptions.inner_deadzone);
+    adc_pairs[0].deadzone_range = percentToAnalog(analogOptions.outer_deadzone) - adc_pairs[0].in_deadzone;
     adc_pairs[0].auto_calibration = analogOptions.auto_calibrate;
     adc_pairs[0].forced_circularity = analogOptions.forced_circularity;
     adc_pairs[0].joystick_center_x = analogOptions.joystick_center_x;
@@ -39,11 +84,12 @@ void AnalogInput::setup() {
     adc_pairs[1].y_pin = analogOptions.analogAdc2PinY;
     adc_pairs[1].analog_invert = analogOptions.analogAdc2Invert;
     adc_pairs[1].analog_dpad = analogOptions.analogAdc2Mode;
-    adc_pairs[1].ema_option = analogOptions.analog_smoothing2;
-    adc_pairs[1].ema_smoothing = analogOptions.smoothing_factor2 / 1000.0f;
-    adc_pairs[1].error_rate = analogOptions.analog_error2 / 1000.0f;
-    adc_pairs[1].in_deadzone = analogOptions.inner_deadzone2 / 100.0f;
-    adc_pairs[1].out_deadzone = analogOptions.outer_deadzone2 / 100.0f;
+    adc_pairs[1].x_filter.setup(analogOptions.analog_filter2, (uint16_t)(analogOptions.smoothing_factor2 + 0.5f),
+        analogOptions.filter_min_cutoff2, analogOptions.filter_beta2);
+    adc_pairs[1].y_filter = adc_pairs[1].x_filter;
+    adc_pairs[1].error_rate = analogOptions.analog_error2;
+    adc_pairs[1].in_deadzone = percentToAnalog(analogOptions.inner_deadzone2);
+    adc_pairs[1].deadzone_range = percentToAnalog(analogOptions.outer_deadzone2) - adc_pairs[1].in_deadzone;
     adc_pairs[1].auto_calibration = analogOptions.auto_calibrate2;
     adc_pairs[1].forced_circularity = analogOptions.forced_circularity2;
     adc_pairs[1].joystick_center_x = analogOptions.joystick_center_x2;
@@ -52,34 +98,32 @@ void AnalogInput::setup() {
 
     // Setup defaults and helpers
     for (int i = 0; i < ADC_COUNT; i++) {
-        adc_pairs[i].x_pin_adc = adc_pairs[i].x_pin - ADC_PIN_OFFSET;
-        adc_pairs[i].y_pin_adc = adc_pairs[i].y_pin - ADC_PIN_OFFSET;
         adc_pairs[i].x_value = ANALOG_CENTER;
         adc_pairs[i].y_value = ANALOG_CENTER;
-        adc_pairs[i].xy_magnitude = 0.0f;
-        adc_pairs[i].x_magnitude = 0.0f;
-        adc_pairs[i].y_magnitude = 0.0f;
-        adc_pairs[i].x_ema = 0.0f;
-        adc_pairs[i].y_ema = 0.0f;
+        adc_pairs[i].xy_magnitude = 0;
+        adc_pairs[i].x_magnitude = 0;
+        adc_pairs[i].y_magnitude = 0;
+        // Equal deadzones would divide by zero, a one step range snaps straight from center to the edge instead
+        if (adc_pairs[i].deadzone_range == 0) {
+            adc_pairs[i].deadzone_range = 1;
+        }
     }
 
     // Intialize and auto center X/Y for each pair
     for (int i = 0; i < ADC_COUNT; i++) {
         if(isValidPin(adc_pairs[i].x_pin)) {
-            adc_gpio_init(adc_pairs[i].x_pin);
+            ADCService::addChannel(adc_pairs[i].x_pin);
             if (adc_pairs[i].auto_calibration) {
-                adc_select_input(adc_pairs[i].x_pin - ADC_PIN_OFFSET);
-                adc_pairs[i].x_center = adc_read();
+                adc_pairs[i].x_center = ADCService::read(adc_pairs[i].x_pin);
             } else {
                 // if auto calibration is disabled, attempt to use stored manual calibration value
                 adc_pairs[i].x_center = adc_pairs[i].joystick_center_x;
             }
         }
         if(isValidPin(adc_pairs[i].y_pin)) {
-            adc_gpio_init(adc_pairs[i].y_pin);
+            ADCService::addChannel(adc_pairs[i].y_pin);
             if (adc_pairs[i].auto_calibration) {
-                adc_select_input(adc_pairs[i].y_pin - ADC_PIN_OFFSET);
-                adc_pairs[i].y_center = adc_read();
+                adc_pairs[i].y_center = ADCService::read(adc_pairs[i].y_pin);
             } else {
                 // if auto calibration is disabled, attempt to use stored manual calibration value
                 adc_pairs[i].y_center = adc_pairs[i].joystick_center_y;
@@ -97,35 +141,30 @@ void AnalogInput::process() {
         joystickMid = DriverManager::getInstance().getDriver()->GetJoystickMidValue();
         joystickMax = joystickMid * 2; // 0x8000 mid must be 0x10000 max, but we reduce by 1 if we're maxed out
     }
+    const uint32_t now = (uint32_t)getMicro();
 
     for(int i = 0; i < ADC_COUNT; i++) {
         // Read X-Axis
         if (isValidPin(adc_pairs[i].x_pin)) {
-            adc_pairs[i].x_value = readPin(i, adc_pairs[i].x_pin_adc, adc_pairs[i].x_center);
+            adc_pairs[i].x_value = readPin(i, adc_pairs[i].x_pin, adc_pairs[i].x_center);
             if (adc_pairs[i].analog_invert == InvertMode::INVERT_X || 
                 adc_pairs[i].analog_invert == InvertMode::INVERT_XY) {
                 adc_pairs[i].x_value = ANALOG_MAX - adc_pairs[i].x_value;
             }
-            if (adc_pairs[i].ema_option) {
-                adc_pairs[i].x_value = emaCalculation(i, adc_pairs[i].x_value, adc_pairs[i].x_ema);
-                adc_pairs[i].x_ema = adc_pairs[i].x_value;
-            }
+            adc_pairs[i].x_value = adc_pairs[i].x_filter.filter(adc_pairs[i].x_value, now);
         }
         // Read Y-Axis
         if (isValidPin(adc_pairs[i].y_pin)) {
-            adc_pairs[i].y_value = readPin(i, adc_pairs[i].y_pin_adc, adc_pairs[i].y_center);
+            adc_pairs[i].y_value = readPin(i, adc_pairs[i].y_pin, adc_pairs[i].y_center);
             if (adc_pairs[i].analog_invert == InvertMode::INVERT_Y || 
                 adc_pairs[i].analog_invert == InvertMode::INVERT_XY) {
                 adc_pairs[i].y_value = ANALOG_MAX - adc_pairs[i].y_value;
             }
-            if (adc_pairs[i].ema_option) {
-                adc_pairs[i].y_value = emaCalculation(i, adc_pairs[i].y_value, adc_pairs[i].y_ema);
-                adc_pairs[i].y_ema = adc_pairs[i].y_value;
-            }
+            adc_pairs[i].y_value = adc_pairs[i].y_filter.filter(adc_pairs[i].y_value, now);
         }
         // Look for dead-zones and circularity
         adc_pairs[i].xy_magnitude = magnitudeCalculation(i, adc_pairs[i]);
-        if (adc_pairs[i].xy_magnitude < adc_pairs[i].in_deadzone) {
+        if (adc_pairs[i].xy_magnitude < adc_pairs[i].in_deadzone || adc_pairs[i].xy_magnitude == 0) {
             adc_pairs[i].x_value = ANALOG_CENTER;
             adc_pairs[i].y_value = ANALOG_CENTER;
         } else {
@@ -133,8 +172,8 @@ void AnalogInput::process() {
         }
 
         // If MID is 0x8000, clamp our max to 0xFFFF incase we are at 0x10000. 0x7FFF will max at 0xFFFE
-        uint16_t clampedX = (uint16_t)std::min((uint32_t)(joystickMax * std::min(adc_pairs[i].x_value, 1.0f)), (uint32_t)0xFFFF);
-        uint16_t clampedY = (uint16_t)std::min((uint32_t)(joystickMax * std::min(adc_pairs[i].y_value, 1.0f)), (uint32_t)0xFFFF);
+        uint16_t clampedX = (uint16_t)std::min((uint32_t)(((uint64_t)joystickMax * adc_pairs[i].x_value) >> ANALOG_FRACTION_BITS), (uint32_t)0xFFFF);
+        uint16_t clampedY = (uint16_t)std::min((uint32_t)(((uint64_t)joystickMax * adc_pairs[i].y_value) >> ANALOG_FRACTION_BITS), (uint32_t)0xFFFF);
 
         if (adc_pairs[i].analog_dpad == DpadMode::DPAD_MODE_LEFT_ANALOG) {
             gamepad->state.lx = clampedX;
@@ -146,9 +185,8 @@ void AnalogInput::process() {
     }
 }
 
-float AnalogInput::readPin(int stick_num, Pin_t pin_adc, uint16_t center) {
-    adc_select_input(pin_adc);
-    uint16_t adc_value = adc_read();
+int32_t AnalogInput::readPin(int stick_num, Pin_t pin, uint16_t center) {
+    uint16_t adc_value = ADCService::read(pin, adc_pairs[stick_num].x_filter.getOversample());
     // Apply calibration only if auto calibration is enabled or manual calibration has been performed
     // Manual calibration is considered performed if the center value is not 0 (default)
     if (adc_pairs[stick_num].auto_calibration || center != 0) {
@@ -160,30 +198,30 @@ float AnalogInput::readPin(int stick_num, Pin_t pin_adc, uint16_t center) {
             adc_value = map(adc_value, 0, center, 0, ADC_MAX / 2);
         }
     }
-    return ((float)adc_value) / ADC_MAX;
-}
-
-float AnalogInput::emaCalculation(int stick_num, float ema_value, float ema_previous) {
-    return (adc_pairs[stick_num].ema_smoothing * ema_value) + ((1.0f - adc_pairs[stick_num].ema_smoothing) * ema_previous);
+    return ((uint32_t)adc_value << ANALOG_FRACTION_BITS) / ADC_MAX;
 }
 
 uint16_t AnalogInput::map(uint16_t x, uint16_t in_min, uint16_t in_max, uint16_t out_min, uint16_t out_max) {
     return (x - in_min) * (out_max - out_min) / (in_max - in_min) + out_min;
 }
 
-float AnalogInput::magnitudeCalculation(int stick_num, adc_instance & adc_inst) {
+int32_t AnalogInput::magnitudeCalculation(int stick_num, adc_instance & adc_inst) {
     adc_inst.x_magnitude = adc_inst.x_value - ANALOG_CENTER;
     adc_inst.y_magnitude = adc_inst.y_value - ANALOG_CENTER;
-    return adc_pairs[stick_num].error_rate * std::sqrt((adc_inst.x_magnitude * adc_inst.x_magnitude) + (adc_inst.y_magnitude * adc_inst.y_magnitude));
+    const uint64_t squared = (int64_t)adc_inst.x_magnitude * adc_inst.x_magnitude + (int64_t)adc_inst.y_magnitude * adc_inst.y_magnitude;
+    return scalePerMille(isqrt(squared), adc_pairs[stick_num].error_rate);
 }
 
 void AnalogInput::radialDeadzone(int stick_num, adc_instance & adc_inst) {
-    float scaling_factor = (adc_inst.xy_magnitude - adc_pairs[stick_num].in_deadzone) / (adc_pairs[stick_num].out_deadzone - adc_pairs[stick_num].in_deadzone);
-    if (adc_pairs[stick_num].forced_circularity == true) {
-        scaling_factor = std::fmin(scaling_factor, ANALOG_CENTER);
+    // One factor per stick from center offset to output offset: (magnitude - inner) / (range * magnitude),
+    // capped at 0.5 / magnitude when forced circularity is on
+    const int32_t scaled = adc_inst.xy_magnitude - adc_pairs[stick_num].in_deadzone;
+    int64_t scaling_factor;
+    if (adc_pairs[stick_num].forced_circularity == true && 2 * scaled > adc_pairs[stick_num].deadzone_range) {
+        scaling_factor = ((int64_t)1 << (ANALOG_FRACTION_BITS + ANALOG_SCALE_BITS - 1)) / adc_inst.xy_magnitude;
+    } else {
+        scaling_factor = ((int64_t)scaled << (ANALOG_FRACTION_BITS + ANALOG_SCALE_BITS)) / ((int64_t)adc_pairs[stick_num].deadzone_range * adc_inst.xy_magnitude);
     }
-    adc_inst.x_value = ((adc_inst.x_magnitude / adc_inst.xy_magnitude) * scaling_factor) + ANALOG_CENTER;
-    adc_inst.y_value = ((adc_inst.y_magnitude / adc_inst.xy_magnitude) * scaling_factor) + ANALOG_CENTER;
-    adc_inst.x_value = std::clamp(adc_inst.x_value, ANALOG_MINIMUM, ANALOG_MAX);
-    adc_inst.y_value = std::clamp(adc_inst.y_value, ANALOG_MINIMUM, ANALOG_MAX);
+    adc_inst.x_value = std::clamp<int64_t>(ANALOG_CENTER + ((adc_inst.x_magnitude * scaling_factor) >> ANALOG_SCALE_BITS), ANALOG_MINIMUM, ANALOG_MAX);
+    adc_inst.y_value = std::clamp<int64_t>(ANALOG_CENTER + ((adc_inst.y_magnitude * scaling_factor) >> ANALOG_SCALE_BITS), ANALOG_MINIMUM, ANALOG_MAX);
 }
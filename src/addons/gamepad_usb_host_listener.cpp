@@ -11,6 +11,28 @@
 #include "drivers/switchpro/SwitchProDescriptors.h"
 #include "drivers/shared/xinput_host.h"
 
+// Controllers with their own report handling below, everything else is decoded through the report descriptor
+static bool hasDedicatedReportHandler(uint16_t pid) {
+    switch (pid) {
+        case PS4_PRODUCT_ID:
+        case 0x00EE:
+        case PS4_WHEEL_PRODUCT_ID:
+        case 0xB67B:
+        case DS4_ORG_PRODUCT_ID:
+        case DS4_PRODUCT_ID:
+        case 0x0CE6:
+        case 0xC294:
+        case 0xC29A:
+        case SWITCH_PRO_PRODUCT_ID:
+        case 0x9400:
+        case 0x0510:
+        case 0x0511:
+            return true;
+        default:
+            return false;
+    }
+}
+
 void GamepadUSBHostListener::setup() {
     _controller_host_enabled = false;
 #if GAMEPAD_HOST_DEBUG
@@ -38,7 +60,7 @@ void GamepadUSBHostListener::process() {
     }
 }
 
-void GamepadUSBHostListener::mount(uint8_t dev_addr, uint8_t instance, uint8_t const* desc_report, uint16_t desc_len) {
+bool GamepadUSBHostListener::mount(uint8_t dev_addr, uint8_t instance, uint8_t const* desc_report, uint16_t desc_len) {
     uint16_t vid = 0;
     uint16_t pid = 0;
     tuh_vid_pid_get(dev_addr, &vid, &pid);
@@ -52,7 +74,23 @@ void GamepadUSBHostListener::mount(uint8_t dev_addr, uint8_t instance, uint8_t c
 #ifdef GAMEPAD_HOST_DEBUG
         printf("Ignoring mount twice (XInput -> HID) on VID_%04x PID_%04x\n", vid, pid);
 #endif
-        return;
+        return false;
+    }
+
+    // Keyboards and mice belong to the keyboard host add-on, and only one controller is tracked at a time
+    uint8_t const itf_protocol = tuh_hid_interface_protocol(dev_addr, instance);
+    if (itf_protocol == HID_ITF_PROTOCOL_KEYBOARD || itf_protocol == HID_ITF_PROTOCOL_MOUSE) {
+        return false;
+    }
+    if (_controller_host_enabled && _controller_dev_addr != dev_addr) {
+        return false;
+    }
+    // A generic pad is claimed for the first interface with a gamepad report, a later interface of the same device
+    // would replace the layout the first one is decoded with
+    if (!hasDedicatedReportHandler(pid)) {
+        if (hidReportPlan.isValid() || !hidReportPlan.compile(desc_report, desc_len)) {
+            return false;
+        }
     }
 
     _controller_host_enabled = true;
@@ -114,12 +152,18 @@ void GamepadUSBHostListener::mount(uint8_t dev_addr, uint8_t instance, uint8_t c
         case 0x9400:               // Google Stadia controller
         case 0x0510:               // pre-2015 Ultrakstik 360
         case 0x0511:               // Ultrakstik 360
+            break;
         default:
             break;
     }
+    return true;
 }
 
-void GamepadUSBHostListener::xmount(uint8_t dev_addr, uint8_t instance, uint8_t controllerType, uint8_t subtype) {
+bool GamepadUSBHostListener::xmount(uint8_t dev_addr, uint8_t instance, uint8_t controllerType, uint8_t subtype) {
+    if (_controller_host_enabled && _controller_dev_addr != dev_addr) {
+        return false;
+    }
+
     _controller_host_enabled = true;
     _controller_dev_addr = dev_addr;
     _controller_instance = instance;
@@ -150,6 +194,7 @@ void GamepadUSBHostListener::xmount(uint8_t dev_addr, uint8_t instance, uint8_t
         }
         setup_xinput(dev_addr, instance);
     }
+    return true;
 }
 
 void GamepadUSBHostListener::unmount(uint8_t dev_addr) {
@@ -168,6 +213,7 @@ void GamepadUSBHostListener::unmount(uint8_t dev_addr) {
     switchProState = SwitchOutputSubtypes::IDENTIFY;
     switchReportCounter = 0;
     lastSwitchLed = 0;
+    hidReportPlan.reset();
 }
 
 void GamepadUSBHostListener::report_received(uint8_t dev_addr, uint8_t instance, uint8_t const* report, uint16_t len) {
@@ -186,12 +232,7 @@ void GamepadUSBHostListener::report_received(uint8_t dev_addr, uint8_t instance,
             break;
     }
 
-    // Interface protocol (hid_interface_protocol_enum_t)
-    uint8_t const itf_protocol = tuh_hid_interface_protocol(dev_addr, instance);
-
-    // stop execution if a keyboard or mouse is mounted
-    if ( itf_protocol == HID_ITF_PROTOCOL_KEYBOARD ) return;
-
+    // keyboards and mice are never claimed in mount(), so their reports do not reach this listener
     process_ctrlr_report(dev_addr, report, len);
 }
 
@@ -240,6 +281,7 @@ void GamepadUSBHostListener::process_ctrlr_report(uint8_t dev_addr, uint8_t cons
             process_ultrastik360(report, len);
             break;
         default:
+            process_generic_hid(report, len);
             break;
     }
 }
@@ -810,6 +852,12 @@ void GamepadUSBHostListener::process_ultrastik360(uint8_t const* report, uint16_
     if (controller_report.BTN_GamePadButton8 == 1) _controller_host_state.buttons |= GAMEPAD_MASK_R2;
 }
 
+void GamepadUSBHostListener::process_generic_hid(uint8_t const* report, uint16_t len) {
+    if (hidReportPlan.isValid() && hidReportPlan.decode(report, len, _controller_host_state)) {
+        _controller_host_analog = hidReportPlan.hasAnalog();
+    }
+}
+
 void GamepadUSBHostListener::xbox360_set_led(uint8_t dev_addr, uint8_t instance, uint8_t quadrant) {
     uint8_t out[32] = { 0 };
 
@@ -1,7 +1,11 @@
 #include "addons/he_trigger.h"
 #include "storagemanager.h"
+#include "eventmanager.h"
 
+#include "adcservice.h"
+#include "usbtelemetry.h"
 #include "hardware/adc.h"
+#include "pico/stdlib.h"
 
 #define ADC_MAX ((1 << 12) - 1) // 4095
 
@@ -20,11 +24,6 @@ void HETriggerAddon::setup() {
     muxPinArray[1] = options.muxADCPin1;
     muxPinArray[2] = options.muxADCPin2;
     muxPinArray[3] = options.muxADCPin3;
-    for(int i = 0; i < muxTotal; i++) {
-        if ( muxPinArray[i] >= 26 && muxPinArray[i] <= 29 ) {
-            adc_gpio_init(muxPinArray[i]);
-        }
-    }
 
     // Init our select pins
     switch(options.muxChannels) {
@@ -55,27 +54,132 @@ void HETriggerAddon::setup() {
         }
     }
 
-    lastADCSelected = -1;
+    // Direct ADC pins are sampled by the shared ADC service, a mux needs its select pins set before each conversion
+    for(int i = 0; i < muxTotal; i++) {
+        if ( muxPinArray[i] >= 26 && muxPinArray[i] <= 29 ) {
+            if ( selectPins == 0 ) {
+                ADCService::addChannel(muxPinArray[i]);
+            } else {
+                adc_gpio_init(muxPinArray[i]);
+            }
+        }
+    }
+
+    // Read all ADC values once, which also primes each trigger's filter and rapid trigger state
+    settleTime = options.muxSettleTime;
+    const uint32_t now = (uint32_t)getMicro();
+    rapidTrigger.clear();
+    polarizedKeys = 0;
+    analogKeys = 0;
+    menuKeys = 0;
+    lastPressed = 0;
+    for(int i = 0; i < 32; i++) {
+        keyDpad[i] = 0;
+        keyButtons[i] = 0;
+        keyAux[i] = 0;
+        // Ignore triggers with no actions
+        if (options.triggers[i].action == -10 )
+            continue;
+        // EMA smoothing factor is in percent, 99 = max smoothing factor
+        filters[i].setup(options.triggers[i].filter, options.smoothingFactor * 10, options.filterMinCutoff, options.filterBeta);
 
-    if ( options.emaSmoothing == 1 ) {
-        // Read all ADC values once
-        for(int i = 0; i < 32; i++) {
-            // Ignore triggers with no actions
-            if (options.triggers[i].action == -10 )
-                continue;
-            mux = (i / options.muxChannels);
-            channel = (i % options.muxChannels);
-            selectChannel(channel);
-            // Only Switch ADC if we are not currently on the mux ADC
-            if ( lastADCSelected != muxPinArray[mux]) {
-                adc_select_input(muxPinArray[mux]-26);
-                lastADCSelected = muxPinArray[mux];
+        // Thresholds are flipped along with the readings of polarized sensors, so deeper is always larger
+        uint16_t activationThreshold = (uint16_t)options.triggers[i].active;
+        uint16_t releaseThreshold = options.triggers[i].rapidTrigger ? (uint16_t)options.triggers[i].release : activationThreshold;
+        uint16_t idleTravel = (uint16_t)options.triggers[i].idle;
+        uint16_t pressedTravel = (uint16_t)options.triggers[i].pressed;
+        if (options.triggers[i].is_polarized) {
+            polarizedKeys |= (1u << i);
+            activationThreshold = ADC_MAX - activationThreshold;
+            releaseThreshold = ADC_MAX - releaseThreshold;
+            idleTravel = ADC_MAX - idleTravel;
+            pressedTravel = ADC_MAX - pressedTravel;
+        }
+        // Pressure goes from 0 at the calibrated idle reading to 255 at the calibrated full press
+        rapidTrigger.setPressureRange(i, idleTravel, pressedTravel);
+        rapidTrigger.setKey(i, activationThreshold, releaseThreshold, (uint16_t)options.triggers[i].noise, options.triggers[i].rapidTrigger);
+        storeTravel(i, readTrigger(options, i), now);
+        rapidTrigger.reset(i, travel[i]);
+        mapAction(i, options.triggers[i].action);
+    }
+
+    // Scan a mux by select channel, every mux is converted on a channel before switching to the next one
+    scanChannelCount = 0;
+    if ( selectPins > 0 ) {
+        for(int channel = 0; channel < options.muxChannels; channel++) {
+            for(int i = 0; i < muxTotal; i++) {
+                const int he = i * options.muxChannels + channel;
+                if ( he < 32 && options.triggers[he].action != -10 ) {
+                    scanChannels[scanChannelCount++] = channel;
+                    break;
+                }
             }
-            emaSmoothingReads[i] = adc_read();
-            lastIncrement[i] = adc_read();
-            triggerActive[i] = false;
         }
-        emaSmoothingFactor = (float)options.smoothingFactor / 100.f; // 99 = max smoothing factor
+    }
+    scanPeriod = 0;
+    if ( scanChannelCount > 0 ) {
+        selectChannel(scanChannels[0]);
+    }
+    switchedAt = time_us_32();
+}
+
+// Digital actions become masks that are OR-ed into the gamepad state, so applying pressed keys needs no switch. Analog
+// directions and menu navigation are left to applyKeys()
+void HETriggerAddon::mapAction(uint8_t he, GpioAction action) {
+    switch (action) {
+        case GpioAction::BUTTON_PRESS_UP: keyDpad[he] = GAMEPAD_MASK_UP; break;
+        case GpioAction::BUTTON_PRESS_DOWN: keyDpad[he] = GAMEPAD_MASK_DOWN; break;
+        case GpioAction::BUTTON_PRESS_LEFT: keyDpad[he] = GAMEPAD_MASK_LEFT; break;
+        case GpioAction::BUTTON_PRESS_RIGHT: keyDpad[he] = GAMEPAD_MASK_RIGHT; break;
+        case GpioAction::BUTTON_PRESS_B1: keyButtons[he] = GAMEPAD_MASK_B1; break;
+        case GpioAction::BUTTON_PRESS_B2: keyButtons[he] = GAMEPAD_MASK_B2; break;
+        case GpioAction::BUTTON_PRESS_B3: keyButtons[he] = GAMEPAD_MASK_B3; break;
+        case GpioAction::BUTTON_PRESS_B4: keyButtons[he] = GAMEPAD_MASK_B4; break;
+        case GpioAction::BUTTON_PRESS_L1: keyButtons[he] = GAMEPAD_MASK_L1; break;
+        case GpioAction::BUTTON_PRESS_R1: keyButtons[he] = GAMEPAD_MASK_R1; break;
+        case GpioAction::BUTTON_PRESS_L2: keyButtons[he] = GAMEPAD_MASK_L2; break;
+        case GpioAction::BUTTON_PRESS_R2: keyButtons[he] = GAMEPAD_MASK_R2; break;
+        case GpioAction::BUTTON_PRESS_S1: keyButtons[he] = GAMEPAD_MASK_S1; break;
+        case GpioAction::BUTTON_PRESS_S2: keyButtons[he] = GAMEPAD_MASK_S2; break;
+        case GpioAction::BUTTON_PRESS_L3: keyButtons[he] = GAMEPAD_MASK_L3; break;
+        case GpioAction::BUTTON_PRESS_R3: keyButtons[he] = GAMEPAD_MASK_R3; break;
+        case GpioAction::BUTTON_PRESS_A1: keyButtons[he] = GAMEPAD_MASK_A1; break;
+        case GpioAction::BUTTON_PRESS_A2: keyButtons[he] = GAMEPAD_MASK_A2; break;
+        case GpioAction::BUTTON_PRESS_A3: keyButtons[he] = GAMEPAD_MASK_A3; break;
+        case GpioAction::BUTTON_PRESS_A4: keyButtons[he] = GAMEPAD_MASK_A4; break;
+        case GpioAction::BUTTON_PRESS_E1: keyButtons[he] = GAMEPAD_MASK_E1; break;
+        case GpioAction::BUTTON_PRESS_E2: keyButtons[he] = GAMEPAD_MASK_E2; break;
+        case GpioAction::BUTTON_PRESS_E3: keyButtons[he] = GAMEPAD_MASK_E3; break;
+        case GpioAction::BUTTON_PRESS_E4: keyButtons[he] = GAMEPAD_MASK_E4; break;
+        case GpioAction::BUTTON_PRESS_E5: keyButtons[he] = GAMEPAD_MASK_E5; break;
+        case GpioAction::BUTTON_PRESS_E6: keyButtons[he] = GAMEPAD_MASK_E6; break;
+        case GpioAction::BUTTON_PRESS_E7: keyButtons[he] = GAMEPAD_MASK_E7; break;
+        case GpioAction::BUTTON_PRESS_E8: keyButtons[he] = GAMEPAD_MASK_E8; break;
+        case GpioAction::BUTTON_PRESS_E9: keyButtons[he] = GAMEPAD_MASK_E9; break;
+        case GpioAction::BUTTON_PRESS_E10: keyButtons[he] = GAMEPAD_MASK_E10; break;
+        case GpioAction::BUTTON_PRESS_E11: keyButtons[he] = GAMEPAD_MASK_E11; break;
+        case GpioAction::BUTTON_PRESS_E12: keyButtons[he] = GAMEPAD_MASK_E12; break;
+        case GpioAction::BUTTON_PRESS_FN: keyAux[he] = AUX_MASK_FUNCTION; break;
+        case GpioAction::ANALOG_DIRECTION_LS_X_NEG:
+        case GpioAction::ANALOG_DIRECTION_LS_X_POS:
+        case GpioAction::ANALOG_DIRECTION_LS_Y_NEG:
+        case GpioAction::ANALOG_DIRECTION_LS_Y_POS:
+        case GpioAction::ANALOG_DIRECTION_RS_X_NEG:
+        case GpioAction::ANALOG_DIRECTION_RS_X_POS:
+        case GpioAction::ANALOG_DIRECTION_RS_Y_NEG:
+        case GpioAction::ANALOG_DIRECTION_RS_Y_POS:
+            analogKeys |= (1u << he);
+            break;
+        case GpioAction::MENU_NAVIGATION_UP:
+        case GpioAction::MENU_NAVIGATION_DOWN:
+        case GpioAction::MENU_NAVIGATION_LEFT:
+        case GpioAction::MENU_NAVIGATION_RIGHT:
+        case GpioAction::MENU_NAVIGATION_SELECT:
+        case GpioAction::MENU_NAVIGATION_BACK:
+        case GpioAction::MENU_NAVIGATION_TOGGLE:
+            menuKeys |= (1u << he);
+            break;
+        default: break;
     }
 }
 
@@ -87,118 +191,132 @@ void HETriggerAddon::selectChannel(uint8_t channel) {
     }
 }
 
-uint16_t HETriggerAddon::emaSmoothing(uint16_t value, uint16_t previous) {
-    float ema_value = (float)value / ADC_MAX;
-    float ema_previous = (float)previous / ADC_MAX;
-    return ((emaSmoothingFactor*ema_value) + ((1.0f-emaSmoothingFactor) * ema_previous)) * ADC_MAX;
+uint16_t HETriggerAddon::readTrigger(const HETriggerOptions & options, uint8_t he) {
+    const uint8_t mux = (he / options.muxChannels);
+    const uint8_t channel = (he % options.muxChannels);
+    if ( selectPins == 0 ) {
+        return ADCService::read(muxPinArray[mux], filters[he].getOversample());
+    }
+    selectChannel(channel);
+    busy_wait_us_32(settleTime);
+    return ADCService::readBlocking(muxPinArray[mux], filters[he].getOversample());
+}
+
+// Filters run in full scale fixed point, the thresholds stay in ADC counts
+uint16_t HETriggerAddon::filterTrigger(uint8_t he, uint16_t value, uint32_t now) {
+    const int32_t filtered = filters[he].filter(((uint32_t)value << ANALOG_FILTER_BITS) / ADC_MAX, now);
+    return ((uint32_t)filtered * ADC_MAX + (1 << (ANALOG_FILTER_BITS - 1))) >> ANALOG_FILTER_BITS;
+}
+
+// Readings of polarized sensors are flipped, so deeper travel is always a larger value
+void HETriggerAddon::storeTravel(uint8_t he, uint16_t reading, uint32_t now) {
+    const uint16_t value = filterTrigger(he, reading, now);
+    travel[he] = (polarizedKeys & (1u << he)) ? ADC_MAX - value : value;
 }
 
 void HETriggerAddon::preprocess() {
     Gamepad * gamepad = Storage::getInstance().GetGamepad();
     HETriggerOptions & options = Storage::getInstance().getAddonOptions().heTriggerOptions;
-    for (uint8_t he = 0; he < 32; he++) {
-        // Ignore triggers with no actions
-        if (options.triggers[he].action == -10 )
-            continue;
-        mux = (he / options.muxChannels);
-        channel = (he % options.muxChannels);
-        selectChannel(channel);
-        // Only Switch ADC if we are not currently on the mux ADC
-        if ( lastADCSelected != muxPinArray[mux]) {
-            adc_select_input(muxPinArray[mux]-26);
-            lastADCSelected = muxPinArray[mux];
+    const uint32_t now = (uint32_t)getMicro();
+    const uint32_t scanStart = time_us_32();
+    if ( selectPins > 0 ) {
+        scanMux(options, now);
+    } else {
+        for (uint8_t he = 0; he < 32; he++) {
+            // Ignore triggers with no actions
+            if (options.triggers[he].action == -10 )
+                continue;
+            storeTravel(he, readTrigger(options, he), now);
         }
+    }
+    scanPeriod = time_us_32() - scanStart;
+    USBTelemetry::inputScanned(scanPeriod);
+
+    applyKeys(gamepad, options, rapidTrigger.update(travel));
+}
 
-        value = adc_read();
-        activationThreshold = (uint16_t)options.triggers[he].active;
-        releaseThreshold = (uint16_t)options.triggers[he].active;
+// Select switches are pipelined: as soon as every mux has been converted on a channel the next channel is selected,
+// and it settles while the readings just taken are filtered. The last channel selects the first one again, so the
+// scan starts on a settled channel after the rest of the main loop. Only waiting left over from that is spent busy.
+void HETriggerAddon::scanMux(const HETriggerOptions & options, uint32_t now) {
+    uint16_t readings[4];
 
-        if ( options.triggers[he].rapidTrigger ) {
-            releaseThreshold = (uint16_t)options.triggers[he].release;
+    // Hold the shared ADC sampling once for the whole mux scan instead of around every conversion
+    ADCService::pause();
+    for (uint8_t step = 0; step < scanChannelCount; step++) {
+        const uint8_t channel = scanChannels[step];
+        // The timer is read in whole us, wait for one more tick so at least settleTime has passed
+        if ( settleTime > 0 ) {
+            while ( (time_us_32() - switchedAt) <= settleTime ) {
+                tight_loop_contents();
+            }
         }
 
-        // EMA Smoothing
-        if ( options.emaSmoothing == 1 ) {
-            value = emaSmoothing(value, emaSmoothingReads[he]);
-            emaSmoothingReads[he] = value;
+        for (int i = 0; i < muxTotal; i++) {
+            const uint8_t he = i * options.muxChannels + channel;
+            if ( he < 32 && options.triggers[he].action != -10 ) {
+                readings[i] = ADCService::readBlocking(muxPinArray[i], filters[he].getOversample());
+            }
         }
 
-        if (options.triggers[he].is_polarized) {
-            // effectively inverting value and thresholds
-            value = ADC_MAX - value;
-            activationThreshold = ADC_MAX - activationThreshold;
-            releaseThreshold = ADC_MAX - releaseThreshold;
+        const uint8_t next = scanChannels[(step + 1) % scanChannelCount];
+        if ( next != channel ) {
+            selectChannel(next);
+            switchedAt = time_us_32();
         }
 
-        if (!options.triggers[he].rapidTrigger) {
-            // no rapid trigger
-            triggerActive[he] = value > activationThreshold;
-        } else {
-            // chad rapid trigger
-            bool pressing = (value > lastIncrement[he]) && (value - lastIncrement[he]) > options.triggers[he].noise;
-            bool releasing = (lastIncrement[he] > value) && (lastIncrement[he] - value) > options.triggers[he].noise;
-            if (pressing || releasing) {
-                lastIncrement[he] = value;
+        for (int i = 0; i < muxTotal; i++) {
+            const uint8_t he = i * options.muxChannels + channel;
+            if ( he < 32 && options.triggers[he].action != -10 ) {
+                storeTravel(he, readings[i], now);
             }
+        }
+    }
+    ADCService::resume();
+}
 
-            if ( !triggerActive[he] && pressing && value >= activationThreshold) {
-                triggerActive[he] = true;
-            } else if (triggerActive[he] && releasing && value <= releaseThreshold) {
-                triggerActive[he] = false;
-            }
+void HETriggerAddon::applyKeys(Gamepad * gamepad, const HETriggerOptions & options, uint32_t pressed) {
+    const uint32_t newlyPressed = pressed & ~lastPressed;
+    lastPressed = pressed;
+
+    // Buttons already held by digital inputs stay at full pressure. Input macros clear the pressure of the buttons
+    // they press later, expander and controller add-ons press theirs after the gamepad is processed
+    const uint32_t digitalButtons = gamepad->state.buttons;
+    const uint8_t digitalDpad = gamepad->state.dpad;
+    GamepadAuxAnalogButtons & analogButtons = gamepad->auxState.analogButtons;
+    analogButtons.clear();
+
+    for (uint32_t keys = pressed; keys != 0; keys &= keys - 1) {
+        const uint8_t he = __builtin_ctz(keys);
+        gamepad->state.dpad |= keyDpad[he];
+        gamepad->state.buttons |= keyButtons[he];
+        gamepad->state.aux |= keyAux[he];
+
+        if (keyButtons[he] != 0) {
+            analogButtons.setButton(keyButtons[he], rapidTrigger.getPressure(he, travel[he]));
+        } else if (keyDpad[he] != 0) {
+            analogButtons.setDpad(keyDpad[he], rapidTrigger.getPressure(he, travel[he]));
         }
-        if (triggerActive[he]) {
-            switch (options.triggers[he].action) {
-                case GpioAction::BUTTON_PRESS_UP: gamepad->state.dpad |= GAMEPAD_MASK_UP; break;
-                case GpioAction::BUTTON_PRESS_DOWN: gamepad->state.dpad |= GAMEPAD_MASK_DOWN; break;
-                case GpioAction::BUTTON_PRESS_LEFT: gamepad->state.dpad |= GAMEPAD_MASK_LEFT; break;
-                case GpioAction::BUTTON_PRESS_RIGHT: gamepad->state.dpad |= GAMEPAD_MASK_RIGHT; break;
-                case GpioAction::BUTTON_PRESS_B1: gamepad->state.buttons |= GAMEPAD_MASK_B1; break;
-                case GpioAction::BUTTON_PRESS_B2: gamepad->state.buttons |= GAMEPAD_MASK_B2; break;
-                case GpioAction::BUTTON_PRESS_B3: gamepad->state.buttons |= GAMEPAD_MASK_B3; break;
-                case GpioAction::BUTTON_PRESS_B4: gamepad->state.buttons |= GAMEPAD_MASK_B4; break;
-                case GpioAction::BUTTON_PRESS_L1: gamepad->state.buttons |= GAMEPAD_MASK_L1; break;
-                case GpioAction::BUTTON_PRESS_R1: gamepad->state.buttons |= GAMEPAD_MASK_R1; break;
-                case GpioAction::BUTTON_PRESS_L2: gamepad->state.buttons |= GAMEPAD_MASK_L2; break;
-                case GpioAction::BUTTON_PRESS_R2: gamepad->state.buttons |= GAMEPAD_MASK_R2; break;
-                case GpioAction::BUTTON_PRESS_S1: gamepad->state.buttons |= GAMEPAD_MASK_S1; break;
-                case GpioAction::BUTTON_PRESS_S2: gamepad->state.buttons |= GAMEPAD_MASK_S2; break;
-                case GpioAction::BUTTON_PRESS_L3: gamepad->state.buttons |= GAMEPAD_MASK_L3; break;
-                case GpioAction::BUTTON_PRESS_R3: gamepad->state.buttons |= GAMEPAD_MASK_R3; break;
-                case GpioAction::BUTTON_PRESS_A1: gamepad->state.buttons |= GAMEPAD_MASK_A1; break;
-                case GpioAction::BUTTON_PRESS_A2: gamepad->state.buttons |= GAMEPAD_MASK_A2; break;
-                case GpioAction::BUTTON_PRESS_A3: gamepad->state.buttons |= GAMEPAD_MASK_A3; break;
-                case GpioAction::BUTTON_PRESS_A4: gamepad->state.buttons |= GAMEPAD_MASK_A4; break;
-                case GpioAction::BUTTON_PRESS_E1: gamepad->state.buttons |= GAMEPAD_MASK_E1; break;
-                case GpioAction::BUTTON_PRESS_E2: gamepad->state.buttons |= GAMEPAD_MASK_E2; break;
-                case GpioAction::BUTTON_PRESS_E3: gamepad->state.buttons |= GAMEPAD_MASK_E3; break;
-                case GpioAction::BUTTON_PRESS_E4: gamepad->state.buttons |= GAMEPAD_MASK_E4; break;
-                case GpioAction::BUTTON_PRESS_E5: gamepad->state.buttons |= GAMEPAD_MASK_E5; break;
-                case GpioAction::BUTTON_PRESS_E6: gamepad->state.buttons |= GAMEPAD_MASK_E6; break;
-                case GpioAction::BUTTON_PRESS_E7: gamepad->state.buttons |= GAMEPAD_MASK_E7; break;
-                case GpioAction::BUTTON_PRESS_E8: gamepad->state.buttons |= GAMEPAD_MASK_E8; break;
-                case GpioAction::BUTTON_PRESS_E9: gamepad->state.buttons |= GAMEPAD_MASK_E9; break;
-                case GpioAction::BUTTON_PRESS_E10: gamepad->state.buttons |= GAMEPAD_MASK_E10; break;
-                case GpioAction::BUTTON_PRESS_E11: gamepad->state.buttons |= GAMEPAD_MASK_E11; break;
-                case GpioAction::BUTTON_PRESS_E12: gamepad->state.buttons |= GAMEPAD_MASK_E12; break;                
-                case GpioAction::ANALOG_DIRECTION_LS_X_NEG:	gamepad->state.lx = GAMEPAD_JOYSTICK_MIN; break;
-			    case GpioAction::ANALOG_DIRECTION_LS_X_POS:	gamepad->state.lx = GAMEPAD_JOYSTICK_MAX; break;
-			    case GpioAction::ANALOG_DIRECTION_LS_Y_NEG:	gamepad->state.ly = GAMEPAD_JOYSTICK_MIN; break;
-			    case GpioAction::ANALOG_DIRECTION_LS_Y_POS:	gamepad->state.ly = GAMEPAD_JOYSTICK_MAX; break;
-			    case GpioAction::ANALOG_DIRECTION_RS_X_NEG:	gamepad->state.rx = GAMEPAD_JOYSTICK_MIN; break;
-			    case GpioAction::ANALOG_DIRECTION_RS_X_POS:	gamepad->state.rx = GAMEPAD_JOYSTICK_MAX; break;
-                case GpioAction::ANALOG_DIRECTION_RS_Y_NEG:	gamepad->state.ry = GAMEPAD_JOYSTICK_MIN; break;
-                case GpioAction::ANALOG_DIRECTION_RS_Y_POS:	gamepad->state.ry = GAMEPAD_JOYSTICK_MAX; break;
-                case GpioAction::BUTTON_PRESS_FN:	gamepad->state.aux |= AUX_MASK_FUNCTION; break;
-                case GpioAction::MENU_NAVIGATION_UP: EventManager::getInstance().triggerEvent(new GPMenuNavigateEvent(GpioAction::MENU_NAVIGATION_UP)); break;
-                case GpioAction::MENU_NAVIGATION_DOWN: EventManager::getInstance().triggerEvent(new GPMenuNavigateEvent(GpioAction::MENU_NAVIGATION_DOWN)); break;
-                case GpioAction::MENU_NAVIGATION_LEFT: EventManager::getInstance().triggerEvent(new GPMenuNavigateEvent(GpioAction::MENU_NAVIGATION_LEFT)); break;
-                case GpioAction::MENU_NAVIGATION_RIGHT: EventManager::getInstance().triggerEvent(new GPMenuNavigateEvent(GpioAction::MENU_NAVIGATION_RIGHT)); break;
-                case GpioAction::MENU_NAVIGATION_SELECT: EventManager::getInstance().triggerEvent(new GPMenuNavigateEvent(GpioAction::MENU_NAVIGATION_SELECT)); break;
-                case GpioAction::MENU_NAVIGATION_BACK: EventManager::getInstance().triggerEvent(new GPMenuNavigateEvent(GpioAction::MENU_NAVIGATION_BACK)); break;
-                case GpioAction::MENU_NAVIGATION_TOGGLE: EventManager::getInstance().triggerEvent(new GPMenuNavigateEvent(GpioAction::MENU_NAVIGATION_TOGGLE)); break;
-                default: break;
-            }
+    }
+    analogButtons.clearDigital(digitalButtons, digitalDpad);
+
+    for (uint32_t keys = pressed & analogKeys; keys != 0; keys &= keys - 1) {
+        switch (options.triggers[__builtin_ctz(keys)].action) {
+            case GpioAction::ANALOG_DIRECTION_LS_X_NEG: gamepad->state.lx = GAMEPAD_JOYSTICK_MIN; break;
+            case GpioAction::ANALOG_DIRECTION_LS_X_POS: gamepad->state.lx = GAMEPAD_JOYSTICK_MAX; break;
+            case GpioAction::ANALOG_DIRECTION_LS_Y_NEG: gamepad->state.ly = GAMEPAD_JOYSTICK_MIN; break;
+            case GpioAction::ANALOG_DIRECTION_LS_Y_POS: gamepad->state.ly = GAMEPAD_JOYSTICK_MAX; break;
+            case GpioAction::ANALOG_DIRECTION_RS_X_NEG: gamepad->state.rx = GAMEPAD_JOYSTICK_MIN; break;
+            case GpioAction::ANALOG_DIRECTION_RS_X_POS: gamepad->state.rx = GAMEPAD_JOYSTICK_MAX; break;
+            case GpioAction::ANALOG_DIRECTION_RS_Y_NEG: gamepad->state.ry = GAMEPAD_JOYSTICK_MIN; break;
+            case GpioAction::ANALOG_DIRECTION_RS_Y_POS: gamepad->state.ry = GAMEPAD_JOYSTICK_MAX; break;
+            default: break;
         }
     }
+
+    // Menu navigation fires once per press, like the menu hotkeys
+    for (uint32_t keys = newlyPressed & menuKeys; keys != 0; keys &= keys - 1) {
+        GPMenuNavigateEvent event(options.triggers[__builtin_ctz(keys)].action);
+        EventManager::getInstance().triggerEvent(event);
+    }
 }
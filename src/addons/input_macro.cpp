@@ -220,20 +220,25 @@ void InputMacro::runCurrentMacro() {
     // Check if we should still hold this macro input based on duration
     if ((currentMicros - macroStartTime) <= macroInput.duration) {
         uint32_t buttonMask = macroInput.buttonMask;
+        uint8_t dpadMask = 0;
         if (buttonMask & GAMEPAD_MASK_DU) {
-            gamepad->state.dpad |= GAMEPAD_MASK_UP;
+            dpadMask |= GAMEPAD_MASK_UP;
         }
         if (buttonMask & GAMEPAD_MASK_DD) {
-            gamepad->state.dpad |= GAMEPAD_MASK_DOWN;
+            dpadMask |= GAMEPAD_MASK_DOWN;
         }
         if (buttonMask & GAMEPAD_MASK_DL) {
-            gamepad->state.dpad |= GAMEPAD_MASK_LEFT;
+            dpadMask |= GAMEPAD_MASK_LEFT;
         }
         if (buttonMask & GAMEPAD_MASK_DR) {
-            gamepad->state.dpad |= GAMEPAD_MASK_RIGHT;
+            dpadMask |= GAMEPAD_MASK_RIGHT;
         }
+        gamepad->state.dpad |= dpadMask;
         gamepad->state.buttons |= buttonMask;
 
+        // Macro presses are digital, buttons that an HE key also holds go back to full pressure
+        gamepad->auxState.analogButtons.clearDigital(buttonMask, dpadMask);
+
         // Macro LED is on if we're currently running and inputs are doing something (wait-timers turn it off)
         if (boardLedEnabled) {
             gpio_put(BOARD_LED_PIN, (gamepad->state.dpad || gamepad->state.buttons) ? 1 : 0);
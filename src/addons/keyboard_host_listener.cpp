@@ -3,9 +3,11 @@
 #include "storagemanager.h"
 #include "class/hid/hid_host.h"
 #include <algorithm>
+#include <cstring>
 
 #define DEV_ADDR_NONE 0xFF
 #define MOUSE_SCALE_FACTOR (GAMEPAD_JOYSTICK_MID / 127)
+#define MOUSE_GAIN_MAX 0x7FFF0000
 #define GAMEPAD_JOYSTICK_MIN_I32 static_cast<int32_t>(GAMEPAD_JOYSTICK_MIN)
 #define GAMEPAD_JOYSTICK_MAX_I32 static_cast<int32_t>(GAMEPAD_JOYSTICK_MAX)
 
@@ -31,6 +33,8 @@ void KeyboardHostListener::setup() {
   _keyboard_host_mapButtonR3.setMask(GAMEPAD_MASK_R3);
   _keyboard_host_mapButtonA1.setMask(GAMEPAD_MASK_A1);
   _keyboard_host_mapButtonA2.setMask(GAMEPAD_MASK_A2);
+  _keyboard_host_mapButtonA3.setMask(GAMEPAD_MASK_A3);
+  _keyboard_host_mapButtonA4.setMask(GAMEPAD_MASK_A4);
   _keyboard_host_mapDpadUp.setKey(keyboardMapping.keyDpadUp);
   _keyboard_host_mapDpadDown.setKey(keyboardMapping.keyDpadDown);
   _keyboard_host_mapDpadLeft.setKey(keyboardMapping.keyDpadLeft);
@@ -51,13 +55,16 @@ void KeyboardHostListener::setup() {
   _keyboard_host_mapButtonA2.setKey(keyboardMapping.keyButtonA2);
   _keyboard_host_mapButtonA3.setKey(keyboardMapping.keyButtonA3);
   _keyboard_host_mapButtonA4.setKey(keyboardMapping.keyButtonA4);
+  buildKeycodeTables();
 
   mouseLeftMapping = keyboardHostOptions.mouseLeft;
   mouseMiddleMapping = keyboardHostOptions.mouseMiddle;
   mouseRightMapping = keyboardHostOptions.mouseRight;
   mouseSensitivity = keyboardHostOptions.mouseSensitivity;
   mouseMovementMode = keyboardHostOptions.movementMode;
-  mouseSensitivityScale = mouseSensitivity / 10.0f;
+  buildMouseGainTable(keyboardHostOptions.mouseAcceleration);
+  mouseRemainderX = 0;
+  mouseRemainderY = 0;
   mouseResetMS = 16;
   mouseResetNextTimer = 0;
 
@@ -108,11 +115,13 @@ void KeyboardHostListener::process() {
        _keyboard_host_state.ly = joystickMid;
        _keyboard_host_state.rx = joystickMid;
        _keyboard_host_state.ry = joystickMid;
+       mouseRemainderX = 0;
+       mouseRemainderY = 0;
     }
   }
 }
 
-void KeyboardHostListener::mount(uint8_t dev_addr, uint8_t instance, uint8_t const* desc_report, uint16_t desc_len) {
+bool KeyboardHostListener::mount(uint8_t dev_addr, uint8_t instance, uint8_t const* desc_report, uint16_t desc_len) {
     // Interface protocol (hid_interface_protocol_enum_t)
     uint8_t const itf_protocol = tuh_hid_interface_protocol(dev_addr, instance);
 
@@ -121,13 +130,16 @@ void KeyboardHostListener::mount(uint8_t dev_addr, uint8_t instance, uint8_t con
         _keyboard_host_mounted = true;
         _keyboard_dev_addr = dev_addr;
         _keyboard_instance = instance;
+        return true;
     } else if (_mouse_host_mounted == false && itf_protocol == HID_ITF_PROTOCOL_MOUSE) {
         Gamepad *gamepad = Storage::getInstance().GetGamepad();
         gamepad->auxState.sensors.mouse.enabled = true;
         _mouse_host_mounted = true;
         _mouse_dev_addr = dev_addr;
         _mouse_instance = instance;
+        return true;
     }
+    return false;
 }
 
 void KeyboardHostListener::unmount(uint8_t dev_addr) {
@@ -157,19 +169,38 @@ if ( _keyboard_host_mounted == false && _mouse_host_mounted == false )
   }
 }
 
-uint8_t KeyboardHostListener::getKeycodeFromModifier(uint8_t modifier) {
-	switch (modifier) {
-	  case KEYBOARD_MODIFIER_LEFTCTRL   : return HID_KEY_CONTROL_LEFT ;
-	  case KEYBOARD_MODIFIER_LEFTSHIFT  : return HID_KEY_SHIFT_LEFT   ;
-	  case KEYBOARD_MODIFIER_LEFTALT    : return HID_KEY_ALT_LEFT     ;
-	  case KEYBOARD_MODIFIER_LEFTGUI    : return HID_KEY_GUI_LEFT     ;
-	  case KEYBOARD_MODIFIER_RIGHTCTRL  : return HID_KEY_CONTROL_RIGHT;
-	  case KEYBOARD_MODIFIER_RIGHTSHIFT : return HID_KEY_SHIFT_RIGHT  ;
-	  case KEYBOARD_MODIFIER_RIGHTALT   : return HID_KEY_ALT_RIGHT    ;
-	  case KEYBOARD_MODIFIER_RIGHTGUI   : return HID_KEY_GUI_RIGHT    ;
-	}
-
-	return 0;
+void KeyboardHostListener::buildKeycodeTables() {
+  const KeyboardButtonMapping * dpadMappings[] = {
+    &_keyboard_host_mapDpadUp, &_keyboard_host_mapDpadDown, &_keyboard_host_mapDpadLeft, &_keyboard_host_mapDpadRight,
+  };
+  const KeyboardButtonMapping * buttonMappings[] = {
+    &_keyboard_host_mapButtonB1, &_keyboard_host_mapButtonB2, &_keyboard_host_mapButtonB3, &_keyboard_host_mapButtonB4,
+    &_keyboard_host_mapButtonL1, &_keyboard_host_mapButtonR1, &_keyboard_host_mapButtonL2, &_keyboard_host_mapButtonR2,
+    &_keyboard_host_mapButtonS1, &_keyboard_host_mapButtonS2, &_keyboard_host_mapButtonL3, &_keyboard_host_mapButtonR3,
+    &_keyboard_host_mapButtonA1, &_keyboard_host_mapButtonA2, &_keyboard_host_mapButtonA3, &_keyboard_host_mapButtonA4,
+  };
+
+  memset(keycodeButtons, 0, sizeof(keycodeButtons));
+  memset(keycodeDpad, 0, sizeof(keycodeDpad));
+  memset(modifierButtons, 0, sizeof(modifierButtons));
+  memset(modifierDpad, 0, sizeof(modifierDpad));
+
+  // Modifier keys are reported as bits, in the same order as their keycodes HID_KEY_CONTROL_LEFT..HID_KEY_GUI_RIGHT.
+  // Keys above that range only go into the keycode tables
+  for (const KeyboardButtonMapping * mapping : dpadMappings) {
+    if (!mapping->isAssigned()) continue;
+    keycodeDpad[mapping->key] |= mapping->buttonMask;
+    if (mapping->key >= HID_KEY_CONTROL_LEFT && mapping->key <= HID_KEY_GUI_RIGHT) {
+      modifierDpad[mapping->key - HID_KEY_CONTROL_LEFT] |= mapping->buttonMask;
+    }
+  }
+  for (const KeyboardButtonMapping * mapping : buttonMappings) {
+    if (!mapping->isAssigned()) continue;
+    keycodeButtons[mapping->key] |= mapping->buttonMask;
+    if (mapping->key >= HID_KEY_CONTROL_LEFT && mapping->key <= HID_KEY_GUI_RIGHT) {
+      modifierButtons[mapping->key - HID_KEY_CONTROL_LEFT] |= mapping->buttonMask;
+    }
+  }
 }
 
 void KeyboardHostListener::preprocess_report()
@@ -190,52 +221,47 @@ void KeyboardHostListener::process_kbd_report(uint8_t dev_addr, hid_keyboard_rep
 {
   preprocess_report();
 
-  // make this 13 instead of 7 to include modifier bitfields from hid_keyboard_modifier_bm_t
-  for(uint8_t i=0; i<13; i++)
-  {
-    uint8_t keycode = 0;
-    if (i < 6) {
-        // process keycodes normally
-        keycode = report->keycode[i];
-    } else {
-        // keycode modifiers are bitfields, so the old getKeycodeFromModifier switch approach doesn't work
-        // keycode = getKeycodeFromModifier(report->modifier);
-        // new approach masks the modifier bit to determine which keys are pressed
-        keycode = getKeycodeFromModifier(report->modifier & (1 << (i - 6)));
-    }
-    if ( keycode )
-    {
-      _keyboard_host_state.dpad |=
-            ((keycode == _keyboard_host_mapDpadUp.key)    ? _keyboard_host_mapDpadUp.buttonMask : _keyboard_host_state.dpad)
-          | ((keycode == _keyboard_host_mapDpadDown.key)  ? _keyboard_host_mapDpadDown.buttonMask : _keyboard_host_state.dpad)
-          | ((keycode == _keyboard_host_mapDpadLeft.key)  ? _keyboard_host_mapDpadLeft.buttonMask  : _keyboard_host_state.dpad)
-          | ((keycode == _keyboard_host_mapDpadRight.key) ? _keyboard_host_mapDpadRight.buttonMask : _keyboard_host_state.dpad)
-        ;
-
-        _keyboard_host_state.buttons |=
-            ((keycode == _keyboard_host_mapButtonB1.key)  ? _keyboard_host_mapButtonB1.buttonMask  : _keyboard_host_state.buttons)
-          | ((keycode == _keyboard_host_mapButtonB2.key)  ? _keyboard_host_mapButtonB2.buttonMask  : _keyboard_host_state.buttons)
-          | ((keycode == _keyboard_host_mapButtonB3.key)  ? _keyboard_host_mapButtonB3.buttonMask  : _keyboard_host_state.buttons)
-          | ((keycode == _keyboard_host_mapButtonB4.key)  ? _keyboard_host_mapButtonB4.buttonMask  : _keyboard_host_state.buttons)
-          | ((keycode == _keyboard_host_mapButtonL1.key)  ? _keyboard_host_mapButtonL1.buttonMask  : _keyboard_host_state.buttons)
-          | ((keycode == _keyboard_host_mapButtonR1.key)  ? _keyboard_host_mapButtonR1.buttonMask  : _keyboard_host_state.buttons)
-          | ((keycode == _keyboard_host_mapButtonL2.key)  ? _keyboard_host_mapButtonL2.buttonMask  : _keyboard_host_state.buttons)
-          | ((keycode == _keyboard_host_mapButtonR2.key)  ? _keyboard_host_mapButtonR2.buttonMask  : _keyboard_host_state.buttons)
-          | ((keycode == _keyboard_host_mapButtonS1.key)  ? _keyboard_host_mapButtonS1.buttonMask  : _keyboard_host_state.buttons)
-          | ((keycode == _keyboard_host_mapButtonS2.key)  ? _keyboard_host_mapButtonS2.buttonMask  : _keyboard_host_state.buttons)
-          | ((keycode == _keyboard_host_mapButtonL3.key)  ? _keyboard_host_mapButtonL3.buttonMask  : _keyboard_host_state.buttons)
-          | ((keycode == _keyboard_host_mapButtonR3.key)  ? _keyboard_host_mapButtonR3.buttonMask  : _keyboard_host_state.buttons)
-          | ((keycode == _keyboard_host_mapButtonA1.key)  ? _keyboard_host_mapButtonA1.buttonMask  : _keyboard_host_state.buttons)
-          | ((keycode == _keyboard_host_mapButtonA2.key)  ? _keyboard_host_mapButtonA2.buttonMask  : _keyboard_host_state.buttons)
-          | ((keycode == _keyboard_host_mapButtonA3.key)  ? _keyboard_host_mapButtonA3.buttonMask  : _keyboard_host_state.buttons)
-          | ((keycode == _keyboard_host_mapButtonA4.key)  ? _keyboard_host_mapButtonA4.buttonMask  : _keyboard_host_state.buttons)
-        ;
+  uint16_t buttons = 0;
+  uint8_t dpad = 0;
+  for (uint8_t i = 0; i < 6; i++) {
+    const uint8_t keycode = report->keycode[i];
+    buttons |= keycodeButtons[keycode];
+    dpad |= keycodeDpad[keycode];
+  }
+  for (uint8_t modifier = report->modifier, bit = 0; modifier != 0; modifier >>= 1, bit++) {
+    if (modifier & 1) {
+      buttons |= modifierButtons[bit];
+      dpad |= modifierDpad[bit];
     }
   }
+
+  _keyboard_host_state.buttons = buttons;
+  _keyboard_host_state.dpad = dpad;
 }
 
-uint16_t KeyboardHostListener::scaleMouseToJoystick(int8_t mouseVal) {
-  int32_t result = joystickMid + (int32_t)mouseVal * mouseSensitivityScale * MOUSE_SCALE_FACTOR;
+void KeyboardHostListener::buildMouseGainTable(uint8_t acceleration) {
+  // Extra gain at full speed (128 counts) in Q16: none, +50%, +100%, +200%
+  static const int64_t accelerationQ16[] = { 0, 0x8000, 0x10000, 0x20000 };
+  const int64_t accel = accelerationQ16[acceleration <= MOUSE_ACCELERATION_HIGH ? acceleration : MOUSE_ACCELERATION_NONE];
+
+  // Same scale as the old float path (delta * sensitivity / 10 * MOUSE_SCALE_FACTOR), computed once per magnitude
+  for (int32_t delta = 0; delta <= 128; delta++) {
+    int64_t gain = ((int64_t)delta * mouseSensitivity * MOUSE_SCALE_FACTOR << 16) / 10;
+    gain = (gain * (0x10000 + accel * delta / 128)) >> 16;
+    mouseGain[delta] = (int32_t)std::min<int64_t>(gain, MOUSE_GAIN_MAX);
+  }
+}
+
+uint16_t KeyboardHostListener::scaleMouseToJoystick(int8_t mouseVal, int32_t & remainder) {
+  const int32_t gain = mouseGain[mouseVal < 0 ? -mouseVal : mouseVal];
+  // A capped gain is half the stick range or more, which only the rail can represent
+  if (gain == MOUSE_GAIN_MAX) {
+    remainder = 0;
+    return mouseVal < 0 ? GAMEPAD_JOYSTICK_MIN : GAMEPAD_JOYSTICK_MAX;
+  }
+  const int32_t scaled = (mouseVal < 0 ? -gain : gain) + remainder;
+  remainder = scaled & 0xFFFF;
+  int32_t result = joystickMid + (scaled >> 16);
   return std::clamp(result, GAMEPAD_JOYSTICK_MIN_I32, GAMEPAD_JOYSTICK_MAX_I32);
 }
 
@@ -263,11 +289,11 @@ void KeyboardHostListener::process_mouse_report(uint8_t dev_addr, hid_mouse_repo
   mouseResetNextTimer = getMillis() + mouseResetMS;
 
   if (mouseMovementMode == MOUSE_MOVEMENT_LEFT_ANALOG) {
-    _keyboard_host_state.lx = scaleMouseToJoystick(report->x);
-    _keyboard_host_state.ly = scaleMouseToJoystick(report->y);
+    _keyboard_host_state.lx = scaleMouseToJoystick(report->x, mouseRemainderX);
+    _keyboard_host_state.ly = scaleMouseToJoystick(report->y, mouseRemainderY);
   } else if (mouseMovementMode == MOUSE_MOVEMENT_RIGHT_ANALOG) {
-    _keyboard_host_state.rx = scaleMouseToJoystick(report->x);
-    _keyboard_host_state.ry = scaleMouseToJoystick(report->y);
+    _keyboard_host_state.rx = scaleMouseToJoystick(report->x, mouseRemainderX);
+    _keyboard_host_state.ry = scaleMouseToJoystick(report->y, mouseRemainderY);
   }
 
 }
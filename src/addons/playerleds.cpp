@@ -14,6 +14,7 @@
 #include "helper.h"
 #include "storagemanager.h"
 #include "usbdriver.h"
+#include "bootarena.h"
 
 // Move to Proto Enums
 typedef enum
@@ -107,7 +108,7 @@ void PlayerLEDAddon::setup() {
 	switch (ledOptions.pledType)
 	{
 		case PLED_TYPE_PWM:
-			pwmLEDs = new PWMPlayerLEDs();
+			pwmLEDs = BootArena::create<PWMPlayerLEDs>();
 			break;
 		case PLED_TYPE_RGB:
 			// Do not assign pwmLEDs (support later on?)
@@ -1,6 +1,6 @@
 #include "addons/turbo.h"
 
-#include "hardware/adc.h"
+#include "adcservice.h"
 
 #include "storagemanager.h"
 #include "helper.h"
@@ -44,10 +44,9 @@ void TurboInput::setup(){
     uint8_t shotCount = std::clamp<uint8_t>(options.shotCount, TURBO_SHOT_MIN, TURBO_SHOT_MAX);
     if (isValidPin(options.shmupDialPin)) {
         hasShmupDial = true;
-        adc_gpio_init(options.shmupDialPin);
-        adcShmupDial = 26 - options.shmupDialPin;
-        adc_select_input(adcShmupDial);
-        dialValue = adc_read(); // setup initial Dial + Turbo Speed
+        shmupDialPin = options.shmupDialPin;
+        ADCService::addChannel(shmupDialPin);
+        dialValue = ADCService::read(shmupDialPin); // setup initial Dial + Turbo Speed
         shotCount = (dialValue / TURBO_DIAL_INCREMENTS) + TURBO_SHOT_MIN;
     } else {
         dialValue = 0;
@@ -182,8 +181,7 @@ void TurboInput::process()
 
     // Use the dial to modify our turbo shot speed (don't save on dial modify)
     if (hasShmupDial && nextAdcRead < now) {
-        adc_select_input(adcShmupDial);
-        dialValue = adc_read();
+        dialValue = ADCService::read(shmupDialPin);
         uint8_t shotCount = (dialValue / TURBO_DIAL_INCREMENTS) + TURBO_SHOT_MIN;
         if (shotCount != options.shotCount) {
             updateTurboShotCount(shotCount, false);
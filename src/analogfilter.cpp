@@ -0,0 +1,91 @@
+#include "analogfilter.h"
+
+#define ANALOG_FILTER_ALPHA_BITS 16
+#define ANALOG_FILTER_EMA_BITS 24
+#define ANALOG_FILTER_TAU_SCALE 159154943u      // 1e9 / (2 pi), time constant in us of a 1 mHz cutoff
+#define ANALOG_FILTER_SPEED_CUTOFF 1000u        // mHz, smoothing of the one euro speed estimate
+#define ANALOG_FILTER_MAX_CUTOFF 1000000u       // mHz, past this the low-pass passes a 1 ms loop through anyway
+#define ANALOG_FILTER_MAX_DT 0xFFFFu            // us, longer gaps are treated as one slow loop
+
+// Low-pass coefficient of a cutoff for a sample interval, dt / (dt + tau) in Q16
+static inline uint32_t cutoffAlpha(uint32_t cutoff, uint32_t dt) {
+    const uint32_t tau = ANALOG_FILTER_TAU_SCALE / cutoff;
+    return (dt << ANALOG_FILTER_ALPHA_BITS) / (dt + tau);
+}
+
+void AnalogFilter::setup(AnalogFilterMode mode, uint16_t smoothing, uint16_t minCutoff, uint16_t beta) {
+    this->mode = mode;
+    this->emaAlpha = (((uint32_t)smoothing << ANALOG_FILTER_EMA_BITS) + 500) / 1000;
+    this->minCutoff = minCutoff > 0 ? (uint32_t)minCutoff * 100 : 1;
+    this->beta = (uint32_t)beta * 100;
+    this->primed = false;
+}
+
+void AnalogFilter::reset(int32_t value) {
+    state = value << ANALOG_FILTER_STATE_BITS;
+    speed = 0;
+    history[0] = value;
+    history[1] = value;
+    primed = true;
+}
+
+int32_t AnalogFilter::lowPass(int32_t value, uint32_t alpha, uint8_t alphaBits) {
+    state += (int32_t)(((int64_t)((value << ANALOG_FILTER_STATE_BITS) - state) * alpha) >> alphaBits);
+    return (state + (1 << (ANALOG_FILTER_STATE_BITS - 1))) >> ANALOG_FILTER_STATE_BITS;
+}
+
+int32_t AnalogFilter::filter(int32_t value, uint32_t now) {
+    if (!primed) {
+        reset(value);
+        lastTime = now;
+        return value;
+    }
+
+    switch (mode) {
+        case AnalogFilterMode::ANALOG_FILTER_EMA:
+            return lowPass(value, emaAlpha, ANALOG_FILTER_EMA_BITS);
+        case AnalogFilterMode::ANALOG_FILTER_ONE_EURO:
+        {
+            uint32_t dt = now - lastTime;
+            lastTime = now;
+            if (dt == 0) {
+                dt = 1;
+            } else if (dt > ANALOG_FILTER_MAX_DT) {
+                dt = ANALOG_FILTER_MAX_DT;
+            }
+
+            // Speed against the previous output in Q16 full scale per second, smoothed at a fixed 1 Hz
+            const int32_t previous = (state + (1 << (ANALOG_FILTER_STATE_BITS - 1))) >> ANALOG_FILTER_STATE_BITS;
+            int64_t rawSpeed = (((int64_t)(value - previous) * 1000000) >> (ANALOG_FILTER_BITS - 16)) / dt;
+            if (rawSpeed > INT32_MAX / 2) {
+                rawSpeed = INT32_MAX / 2;
+            } else if (rawSpeed < -(INT32_MAX / 2)) {
+                rawSpeed = -(INT32_MAX / 2);
+            }
+            speed += (int32_t)(((rawSpeed - speed) * cutoffAlpha(ANALOG_FILTER_SPEED_CUTOFF, dt)) >> ANALOG_FILTER_ALPHA_BITS);
+
+            // Faster movement raises the cutoff, trading the rest-state smoothing for less lag
+            uint64_t cutoff = minCutoff + (((uint64_t)beta * (uint32_t)(speed < 0 ? -speed : speed)) >> 16);
+            if (cutoff > ANALOG_FILTER_MAX_CUTOFF) {
+                cutoff = ANALOG_FILTER_MAX_CUTOFF;
+            }
+            return lowPass(value, cutoffAlpha((uint32_t)cutoff, dt), ANALOG_FILTER_ALPHA_BITS);
+        }
+        case AnalogFilterMode::ANALOG_FILTER_MEDIAN:
+        {
+            const int32_t a = value;
+            const int32_t b = history[0];
+            const int32_t c = history[1];
+            history[1] = history[0];
+            history[0] = value;
+            if (a > b) {
+                return b > c ? b : (a < c ? a : c);
+            }
+            return a > c ? a : (b < c ? b : c);
+        }
+        case AnalogFilterMode::ANALOG_FILTER_OVERSAMPLE: // averaged by the caller at the source
+        case AnalogFilterMode::ANALOG_FILTER_NONE:
+        default:
+            return value;
+    }
+}
@@ -0,0 +1,90 @@
+#include "bootarena.h"
+
+#if defined(PICO_ON_DEVICE) && PICO_ON_DEVICE
+#include "BoardConfig.h"
+#include "hardware/sync.h"
+
+// Both cores load add-ons during boot
+#define ARENA_LOCK() const uint32_t arenaIrqState = spin_lock_blocking(spin_lock_instance(PICO_SPINLOCK_ID_OS2))
+#define ARENA_UNLOCK() spin_unlock(spin_lock_instance(PICO_SPINLOCK_ID_OS2), arenaIrqState)
+#else
+// Host builds are single threaded
+#define ARENA_LOCK()
+#define ARENA_UNLOCK()
+#endif
+
+// Boards can override this in their BoardConfig.h, use the bootArena values of /api/getMemoryReport to size it
+#ifndef BOOT_ARENA_SIZE
+#define BOOT_ARENA_SIZE (12 * 1024)
+#endif
+
+static const uint32_t NO_ALLOCATION = 0xffffffff;
+
+alignas(8) static uint8_t arena[BOOT_ARENA_SIZE];
+static uint32_t arenaUsed = 0;
+static uint32_t lastAllocation = NO_ALLOCATION; // offset of the most recent allocation
+static uint32_t overflowBytes = 0;
+static uint32_t invalidFrees = 0;
+
+void* BootArena::allocate(size_t size, size_t alignment)
+{
+    void* ptr = nullptr;
+
+    ARENA_LOCK();
+    const uint32_t offset = (arenaUsed + alignment - 1) & ~(alignment - 1);
+    if (offset + size <= BOOT_ARENA_SIZE) {
+        ptr = &arena[offset];
+        lastAllocation = offset;
+        arenaUsed = offset + size;
+    } else {
+        overflowBytes += size;
+    }
+    ARENA_UNLOCK();
+
+    // Too small for this board, the object still works from the heap
+    if (ptr == nullptr) {
+        ptr = ::operator new(size);
+    }
+
+    return ptr;
+}
+
+void BootArena::release(void* ptr)
+{
+    ARENA_LOCK();
+    const uint32_t offset = static_cast<uint8_t*>(ptr) - arena;
+    if (offset == lastAllocation) {
+        arenaUsed = offset;
+        lastAllocation = NO_ALLOCATION;
+    } else {
+        // Arena objects must live for the whole program, getInvalidFrees() reports the ones that didn't
+        invalidFrees++;
+    }
+    ARENA_UNLOCK();
+}
+
+bool BootArena::contains(const void* ptr)
+{
+    const uint8_t* p = static_cast<const uint8_t*>(ptr);
+    return p >= arena && p < arena + BOOT_ARENA_SIZE;
+}
+
+uint32_t BootArena::getSize()
+{
+    return BOOT_ARENA_SIZE;
+}
+
+uint32_t BootArena::getUsed()
+{
+    return arenaUsed;
+}
+
+uint32_t BootArena::getOverflow()
+{
+    return overflowBytes;
+}
+
+uint32_t BootArena::getInvalidFrees()
+{
+    return invalidFrees;
+}
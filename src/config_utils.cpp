@@ -162,6 +162,14 @@
    #define DEFAULT_USB_DESC_VERSION "1.0"
 #endif
 
+#ifndef DEFAULT_USB_POLLING_INTERVAL
+   #define DEFAULT_USB_POLLING_INTERVAL 0
+#endif
+
+#ifndef DEFAULT_USB_TELEMETRY
+   #define DEFAULT_USB_TELEMETRY false
+#endif
+
 #ifndef DEFAULT_USB_ID_OVERRIDE
    #define DEFAULT_USB_ID_OVERRIDE false
 #endif
@@ -320,6 +328,8 @@ void ConfigUtils::initUnsetPropertiesWithDefaults(Config& config)
     INIT_UNSET_PROPERTY(config.gamepadOptions, usbVendorID, DEFAULT_USB_VENDOR_ID);
     INIT_UNSET_PROPERTY(config.gamepadOptions, usbProductID, DEFAULT_USB_PRODUCT_ID);
     INIT_UNSET_PROPERTY(config.gamepadOptions, miniMenuGamepadInput, MINI_MENU_GAMEPAD_INPUT);
+    INIT_UNSET_PROPERTY(config.gamepadOptions, usbPollingInterval, DEFAULT_USB_POLLING_INTERVAL);
+    INIT_UNSET_PROPERTY(config.gamepadOptions, usbTelemetry, DEFAULT_USB_TELEMETRY);
 
     // hotkeyOptions
     HotkeyOptions& hotkeyOptions = config.hotkeyOptions;
@@ -621,6 +631,13 @@ void ConfigUtils::initUnsetPropertiesWithDefaults(Config& config)
     INIT_UNSET_PROPERTY(config.addonOptions.analogOptions, outer_deadzone2, DEFAULT_OUTER_DEADZONE2);
     INIT_UNSET_PROPERTY(config.addonOptions.analogOptions, auto_calibrate2, !!AUTO_CALIBRATE2_ENABLED);
     INIT_UNSET_PROPERTY(config.addonOptions.analogOptions, forced_circularity2, !!FORCED_CIRCULARITY2_ENABLED);
+    // Configs from before the filter choice keep their EMA on/off setting
+    INIT_UNSET_PROPERTY(config.addonOptions.analogOptions, analog_filter, config.addonOptions.analogOptions.analog_smoothing ? ANALOG_FILTER_EMA : ANALOG_FILTER_NONE);
+    INIT_UNSET_PROPERTY(config.addonOptions.analogOptions, analog_filter2, config.addonOptions.analogOptions.analog_smoothing2 ? ANALOG_FILTER_EMA : ANALOG_FILTER_NONE);
+    INIT_UNSET_PROPERTY(config.addonOptions.analogOptions, filter_min_cutoff, ANALOG_FILTER_MIN_CUTOFF);
+    INIT_UNSET_PROPERTY(config.addonOptions.analogOptions, filter_beta, ANALOG_FILTER_BETA);
+    INIT_UNSET_PROPERTY(config.addonOptions.analogOptions, filter_min_cutoff2, ANALOG_FILTER_MIN_CUTOFF2);
+    INIT_UNSET_PROPERTY(config.addonOptions.analogOptions, filter_beta2, ANALOG_FILTER_BETA2);
 
     // addonOptions.turboOptions
     INIT_UNSET_PROPERTY(config.addonOptions.turboOptions, enabled, !!TURBO_ENABLED);
@@ -819,6 +836,9 @@ void ConfigUtils::initUnsetPropertiesWithDefaults(Config& config)
     INIT_UNSET_PROPERTY(config.addonOptions.heTriggerOptions, muxChannels, HETRIGGER_MUX_CHANNELS);
     INIT_UNSET_PROPERTY(config.addonOptions.heTriggerOptions, emaSmoothing, HETRIGGER_SMOOTHING_ENABLED);
     INIT_UNSET_PROPERTY(config.addonOptions.heTriggerOptions, smoothingFactor, HETRIGGER_SMOOTHING_FACTOR);
+    INIT_UNSET_PROPERTY(config.addonOptions.heTriggerOptions, filterMinCutoff, HETRIGGER_FILTER_MIN_CUTOFF);
+    INIT_UNSET_PROPERTY(config.addonOptions.heTriggerOptions, filterBeta, HETRIGGER_FILTER_BETA);
+    INIT_UNSET_PROPERTY(config.addonOptions.heTriggerOptions, muxSettleTime, HETRIGGER_MUX_SETTLE_TIME);
     INIT_UNSET_PROPERTY(config.addonOptions.heTriggerOptions.triggers[0], action, HETRIGGER_HE0_ACTION);
     INIT_UNSET_PROPERTY(config.addonOptions.heTriggerOptions.triggers[0], active, HETRIGGER_HE0_ACTIVE);
     INIT_UNSET_PROPERTY(config.addonOptions.heTriggerOptions.triggers[0], idle, HETRIGGER_HE0_IDLE);
@@ -1075,6 +1095,10 @@ void ConfigUtils::initUnsetPropertiesWithDefaults(Config& config)
     INIT_UNSET_PROPERTY(config.addonOptions.heTriggerOptions.triggers[31], release, HETRIGGER_HE31_RELEASE);
     INIT_UNSET_PROPERTY(config.addonOptions.heTriggerOptions.triggers[31], noise, HETRIGGER_HE31_NOISE);
     INIT_UNSET_PROPERTY(config.addonOptions.heTriggerOptions.triggers[31], rapidTrigger, HETRIGGER_HE31_RAPID);
+    // Configs from before the per-trigger filter choice keep the shared EMA on/off setting
+    for (uint16_t trigger = 0; trigger < HETRIGGER_COUNT; trigger++) {
+        INIT_UNSET_PROPERTY(config.addonOptions.heTriggerOptions.triggers[trigger], filter, config.addonOptions.heTriggerOptions.emaSmoothing ? ANALOG_FILTER_EMA : ANALOG_FILTER_NONE);
+    }
 
     // reminder that this must be set or else nanopb won't retain anything
     config.addonOptions.heTriggerOptions.triggers_count = HETRIGGER_COUNT;
@@ -1105,6 +1129,7 @@ void ConfigUtils::initUnsetPropertiesWithDefaults(Config& config)
     INIT_UNSET_PROPERTY(config.addonOptions.keyboardHostOptions, mouseMiddle, 0);
     INIT_UNSET_PROPERTY(config.addonOptions.keyboardHostOptions, mouseRight, 0);
     INIT_UNSET_PROPERTY(config.addonOptions.keyboardHostOptions, mouseSensitivity, KEYBOARD_HOST_MOUSE_SENSITIVITY);
+    INIT_UNSET_PROPERTY(config.addonOptions.keyboardHostOptions, mouseAcceleration, KEYBOARD_HOST_MOUSE_ACCELERATION);
 
     // addonOptions.focusModeOptions
     INIT_UNSET_PROPERTY(config.addonOptions.focusModeOptions, enabled, !!FOCUS_MODE_ENABLED);
@@ -2073,6 +2098,109 @@ bool ConfigUtils::save(Config& config)
     return true;
 }
 
+// -----------------------------------------------------
+// Protobuf Export / Import
+// -----------------------------------------------------
+
+// Exported configs use the same serialized representation as the FlashPROM storage, preceded by a small header that
+// allows us to reject truncated, corrupted or incompatible uploads before touching the active config:
+//
+// ┌──────┬────────────────────────────────────┐
+// │Header│Protobuf data                       │
+// └──────┴────────────────────────────────────┘
+//
+struct ConfigExportHeader
+{
+    uint32_t magic;
+    uint32_t schemaVersion;
+    uint32_t dataSize;
+    uint32_t dataCrc;
+};
+
+static const uint32_t EXPORT_MAGIC = 0x42503247; // "G2PB"
+
+// Increment whenever a change to config.proto is not backwards compatible (removed or renumbered fields)
+static const uint32_t EXPORT_SCHEMA_VERSION = 1;
+
+bool ConfigUtils::toProtobuf(Config& config, std::string& data)
+{
+    // Set all has_XXX flags to true, see ConfigUtils::save
+    setHasFlags(Config_fields, &config);
+
+    size_t encodedSize = 0;
+    if (!pb_get_encoded_size(&encodedSize, Config_fields, &config) ||
+        encodedSize + sizeof(ConfigFooter) > EEPROM_SIZE_BYTES)
+    {
+        return false;
+    }
+
+    data.resize(sizeof(ConfigExportHeader) + encodedSize);
+    uint8_t* dataPtr = reinterpret_cast<uint8_t*>(&data[0]) + sizeof(ConfigExportHeader);
+
+    pb_ostream_t outputStream = pb_ostream_from_buffer(dataPtr, encodedSize);
+    if (!pb_encode(&outputStream, Config_fields, &config))
+    {
+        data.clear();
+        return false;
+    }
+
+    ConfigExportHeader header;
+    header.magic = EXPORT_MAGIC;
+    header.schemaVersion = EXPORT_SCHEMA_VERSION;
+    header.dataSize = outputStream.bytes_written;
+    header.dataCrc = CRC32::calculate(dataPtr, header.dataSize);
+    memcpy(&data[0], &header, sizeof(ConfigExportHeader));
+
+    return true;
+}
+
+// The payload is fully validated before decoding, on failure config is left in an unspecified state
+bool ConfigUtils::fromProtobuf(Config& config, const uint8_t* data, size_t dataLen)
+{
+    if (dataLen < sizeof(ConfigExportHeader))
+    {
+        return false;
+    }
+
+    ConfigExportHeader header;
+    memcpy(&header, data, sizeof(ConfigExportHeader));
+
+    if (header.magic != EXPORT_MAGIC || header.schemaVersion != EXPORT_SCHEMA_VERSION)
+    {
+        return false;
+    }
+
+    // The header must describe exactly the data we received, and it must fit into FlashPROM on save
+    if (header.dataSize != dataLen - sizeof(ConfigExportHeader) ||
+        header.dataSize + sizeof(ConfigFooter) > EEPROM_SIZE_BYTES)
+    {
+        return false;
+    }
+
+    const uint8_t* dataPtr = data + sizeof(ConfigExportHeader);
+    if (CRC32::calculate(dataPtr, header.dataSize) != header.dataCrc)
+    {
+        return false;
+    }
+
+    config = Config Config_init_zero;
+    pb_istream_t inputStream = pb_istream_from_buffer(dataPtr, header.dataSize);
+    if (!pb_decode(&inputStream, Config_fields, &config))
+    {
+        return false;
+    }
+
+    initUnsetPropertiesWithDefaults(config);
+
+    // same migrations as fromJSON, the uploaded config may come from an older firmware
+    gpioMappingsMigrationCore(config);
+    migrateTurboPinToGpio(config);
+    migrateAuthenticationMethods(config);
+    migrateMacroPinsToGpio(config);
+
+    return true;
+}
+
 // -----------------------------------------------------
 // To JSON
 // -----------------------------------------------------
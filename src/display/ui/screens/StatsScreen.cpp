@@ -3,6 +3,7 @@
 #include "pico/stdlib.h"
 #include "version.h"
 #include "drivermanager.h"
+#include "system.h"
 
 void StatsScreen::init() {
     getRenderer()->clearScreen();
@@ -43,6 +44,13 @@ void StatsScreen::init() {
     arch->setPosition(0, 5); 
     addElement(arch);
 
+    heap = new GPLabel();
+    heap->setRenderer(getRenderer());
+    heap->setText("Heap: " + std::to_string(System::getUsedHeap() / 1024) + "/" + std::to_string(System::getTotalHeap() / 1024) +
+        "K F:" + std::to_string(System::getLargestFreeHeapBlock() / 1024) + "K");
+    heap->setPosition(0, 6);
+    addElement(heap);
+
     exit = new GPLabel();
     exit->setRenderer(getRenderer());
     exit->setText("B2 to Return");
@@ -1,7 +1,9 @@
 #include "drivermanager.h"
+#include "drivers/shared/driverhelper.h"
 
 #include "drivers/net/NetDriver.h"
 #include "drivers/astro/AstroDriver.h"
+#include "drivers/composite/CompositeDriver.h"
 #include "drivers/egret/EgretDriver.h"
 #include "drivers/hid/HIDDriver.h"
 #include "drivers/keyboard/KeyboardDriver.h"
@@ -18,63 +20,77 @@
 #include "drivers/xinput/XInputDriver.h"
 #include "drivers/p5general/P5GeneralDriver.h"
 
+#include "storagemanager.h"
 #include "usbhostmanager.h"
+#include "usbtelemetry.h"
+#include "memorytracker.h"
+#include "bootarena.h"
+
+#include "hardware/structs/systick.h"
+
+// SysTick counts down from 0xffffff at the CPU clock, enough for any single process() call
+#define SYSTICK_MAX_VALUE 0x00ffffff
 
 void DriverManager::setup(InputMode mode) {
+    MemoryTracker::Scope memoryScope(MemoryTracker::TAG_DRIVER);
+
     switch (mode) {
         case INPUT_MODE_CONFIG:
-            driver = new NetDriver();
+            driver = BootArena::create<NetDriver>();
             break;
         case INPUT_MODE_ASTRO:
-            driver = new AstroDriver();
+            driver = BootArena::create<AstroDriver>();
             break;
         case INPUT_MODE_EGRET:
-            driver = new EgretDriver();
+            driver = BootArena::create<EgretDriver>();
             break;
         case INPUT_MODE_KEYBOARD:
-            driver = new KeyboardDriver();
+            driver = BootArena::create<KeyboardDriver>();
             break;
         case INPUT_MODE_GENERIC:
-            driver = new HIDDriver();
+            driver = BootArena::create<HIDDriver>();
+            break;
+        case INPUT_MODE_COMPOSITE:
+            driver = BootArena::create<CompositeDriver>();
             break;
         case INPUT_MODE_MDMINI:
-            driver = new MDMiniDriver();
+            driver = BootArena::create<MDMiniDriver>();
             break;
         case INPUT_MODE_NEOGEO:
-            driver = new NeoGeoDriver();
+            driver = BootArena::create<NeoGeoDriver>();
             break;
         case INPUT_MODE_PSCLASSIC:
-            driver = new PSClassicDriver();
+            driver = BootArena::create<PSClassicDriver>();
             break;
         case INPUT_MODE_PCEMINI:
-            driver = new PCEngineDriver();
+            driver = BootArena::create<PCEngineDriver>();
             break;
         case INPUT_MODE_PS3:
-            driver = new PS3Driver();
+            driver = BootArena::create<PS3Driver>();
             break;
         case INPUT_MODE_PS4:
-            driver = new PS4Driver(PS4_CONTROLLER);
+            driver = BootArena::create<PS4Driver>(PS4_CONTROLLER);
             break;
         case INPUT_MODE_PS5:
-            driver = new PS4Driver(PS4_ARCADESTICK);
+            driver = BootArena::create<PS4Driver>(PS4_ARCADESTICK);
             break;
         case INPUT_MODE_P5GENERAL:
-            driver = new P5GeneralDriver();
+            driver = BootArena::create<P5GeneralDriver>();
             break;
         case INPUT_MODE_SWITCH:
-            driver = new SwitchDriver();
+            driver = BootArena::create<SwitchDriver>();
             break;
         case INPUT_MODE_XBONE:
-            driver = new XBOneDriver();
+            driver = BootArena::create<XBOneDriver>();
             break;
         case INPUT_MODE_XBOXORIGINAL:
-            driver = new XboxOriginalDriver();
+            driver = BootArena::create<XboxOriginalDriver>();
             break;
         case INPUT_MODE_XINPUT:
-            driver = new XInputDriver();
+            driver = BootArena::create<XInputDriver>();
             break;
         case INPUT_MODE_SWITCH_PRO:
-            driver = new SwitchProDriver();
+            driver = BootArena::create<SwitchProDriver>();
             break;
         default:
             return;
@@ -83,4 +99,78 @@ void DriverManager::setup(InputMode mode) {
     // Initialize our chosen driver
     driver->initialize();
     inputMode = mode;
+
+    // Patch the endpoint descriptors before the host enumerates us
+    const GamepadOptions & gamepadOptions = Storage::getInstance().getGamepadOptions();
+    if (gamepadOptions.usbPollingInterval != 0 && driver->supports_polling_interval_override()) {
+        patchPollingInterval(gamepadOptions.usbPollingInterval);
+    }
+    if (gamepadOptions.usbTelemetry && driver->supports_telemetry() && copyConfigurationDescriptor() &&
+        USBTelemetry::appendInterface(configDescriptor, sizeof(configDescriptor))) {
+        // Free-running SysTick on the processor clock, process() passes the cost of every report to telemetry
+        systick_hw->csr = 0;
+        systick_hw->rvr = SYSTICK_MAX_VALUE;
+        systick_hw->cvr = 0;
+        systick_hw->csr = M0PLUS_SYST_CSR_CLKSOURCE_BITS | M0PLUS_SYST_CSR_ENABLE_BITS;
+    }
+
+    // Convert the string descriptors now so enumeration only hands out stored buffers
+    if (mode != INPUT_MODE_CONFIG) {
+        for (uint8_t index = 0; index < USB_STRING_DESCRIPTOR_PRELOAD; index++) {
+            driver->get_descriptor_string_cb(index, 0);
+        }
+    }
+}
+
+bool DriverManager::process(Gamepad * gamepad) {
+    driver->setProcessTime(to_ms_since_boot(get_absolute_time()));
+
+    if (!USBTelemetry::isEnabled()) {
+        return driver->process(gamepad);
+    }
+
+    const uint32_t start = systick_hw->cvr;
+    const bool sent = driver->process(gamepad);
+    const uint32_t cycles = (start - systick_hw->cvr) & SYSTICK_MAX_VALUE;
+    if (sent) {
+        USBTelemetry::reportQueued(gamepad);
+        USBTelemetry::reportBuilt(cycles);
+    }
+    USBTelemetry::process();
+    return sent;
+}
+
+const uint8_t * DriverManager::getConfigurationDescriptor(uint8_t index) {
+    if (configDescriptorPatched) {
+        return configDescriptor;
+    }
+    return driver->get_descriptor_configuration_cb(index);
+}
+
+// Copies the driver's configuration descriptor into our buffer so it can be modified, once
+bool DriverManager::copyConfigurationDescriptor() {
+    if (configDescriptorPatched) {
+        return true;
+    }
+
+    const uint8_t * desc = driver->get_descriptor_configuration_cb(0);
+    if (desc == nullptr) {
+        return false;
+    }
+
+    const uint16_t totalLength = ((const tusb_desc_configuration_t *)desc)->wTotalLength;
+    if (totalLength > sizeof(configDescriptor)) {
+        return false;
+    }
+    memcpy(configDescriptor, desc, totalLength);
+    configDescriptorPatched = true;
+    return true;
+}
+
+// Sets the polling interval in our copy of the configuration descriptor
+void DriverManager::patchPollingInterval(uint8_t interval) {
+    if (!copyConfigurationDescriptor()) {
+        return;
+    }
+    setPollingInterval(configDescriptor, interval);
 }
@@ -26,6 +26,10 @@ void AstroDriver::initialize() {
 }
 
 bool AstroDriver::process(Gamepad * gamepad) {
+	// Nothing changed since the last report we sent
+	if (!stateChanged(gamepad))
+		return false;
+
 	astroReport.lx = 0x7f;
 	astroReport.ly = 0x7f;
 
@@ -60,13 +64,17 @@ bool AstroDriver::process(Gamepad * gamepad) {
 
 	void * report = &astroReport;
 	uint16_t report_size = sizeof(astroReport);
-	if (memcmp(last_report, report, report_size) != 0)
-	{
-		// HID ready + report sent, copy previous report
-		if (tud_hid_ready() && tud_hid_report(0, report, report_size) == true ) {
-			memcpy(last_report, report, report_size);
-			return true;
-		}
+	// The state changed in a way this report does not show
+	if (memcmp(last_report, report, report_size) == 0) {
+		markStateSent(gamepad);
+		return false;
+	}
+
+	// HID ready + report sent, copy previous report
+	if (tud_hid_ready() && tud_hid_report(0, report, report_size) == true ) {
+		memcpy(last_report, report, report_size);
+		markStateSent(gamepad);
+		return true;
 	}
 	return false;
 }
@@ -87,7 +95,7 @@ bool AstroDriver::vendor_control_xfer_cb(uint8_t rhport, uint8_t stage, tusb_con
 
 const uint16_t * AstroDriver::get_descriptor_string_cb(uint8_t index, uint16_t langid) {
 	const char *value = (const char *)astro_string_descriptors[index];
-	return getStringDescriptor(value, index); // getStringDescriptor returns a static array
+	return getStringDescriptor(value, index);
 }
 
 const uint8_t * AstroDriver::get_descriptor_device_cb() {
@@ -0,0 +1,114 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * SPDX-FileCopyrightText: Copyright (c) 2024 OpenStickCommunity (gp2040-ce.info)
+ */
+
+#include "drivers/composite/CompositeDriver.h"
+#include "drivers/composite/CompositeDescriptors.h"
+#include "drivers/shared/driverhelper.h"
+#include "storagemanager.h"
+
+static bool composite_control_xfer_cb(uint8_t rhport, uint8_t stage, tusb_control_request_t const * request)
+{
+	return hidd_control_xfer_cb(rhport, stage, request);
+}
+
+void CompositeDriver::initialize() {
+	interfaces[ITF_NUM_COMPOSITE_GAMEPAD] = &gamepadInterface;
+	interfaces[ITF_NUM_COMPOSITE_KEYBOARD] = &keyboardInterface;
+
+	gamepadInterface.setHIDInstance(ITF_NUM_COMPOSITE_GAMEPAD);
+	keyboardInterface.setHIDInstance(ITF_NUM_COMPOSITE_KEYBOARD);
+	for (uint8_t itf = 0; itf < ITF_NUM_COMPOSITE_TOTAL; itf++) {
+		interfaces[itf]->initialize();
+	}
+
+	// The TinyUSB HID class driver serves every HID interface of the configuration
+	class_driver = {
+	#if CFG_TUSB_DEBUG >= 2
+		.name = "COMPOSITE",
+	#endif
+		.init = hidd_init,
+		.reset = hidd_reset,
+		.open = hidd_open,
+		.control_xfer_cb = composite_control_xfer_cb,
+		.xfer_cb = hidd_xfer_cb,
+		.sof = NULL
+	};
+
+	// Same VID/PID override as the HID mode, applied once
+	memcpy(deviceDescriptor, composite_device_descriptor, sizeof(composite_device_descriptor));
+	GamepadOptions & gamepadOptions = Storage::getInstance().getGamepadOptions();
+	if ( gamepadOptions.usbOverrideID == true ) {
+		memcpy(&deviceDescriptor[8], (uint8_t*)&gamepadOptions.usbVendorID, sizeof(uint16_t)); // Vendor ID
+		memcpy(&deviceDescriptor[10], (uint8_t*)&gamepadOptions.usbProductID, sizeof(uint16_t)); // Product ID
+	}
+}
+
+// Returns whether the gamepad interface sent a report, the one telemetry follows on get_report_endpoint()
+bool CompositeDriver::process(Gamepad * gamepad) {
+	bool sent = false;
+	for (uint8_t itf = 0; itf < ITF_NUM_COMPOSITE_TOTAL; itf++) {
+		interfaces[itf]->setProcessTime(processTime);
+		if (interfaces[itf]->process(gamepad) && itf == ITF_NUM_COMPOSITE_GAMEPAD) {
+			sent = true;
+		}
+	}
+	return sent;
+}
+
+// HID requests come in through get_hid_report/set_hid_report, which know the interface
+uint16_t CompositeDriver::get_report(uint8_t report_id, hid_report_type_t report_type, uint8_t *buffer, uint16_t reqlen) {
+	return get_hid_report(ITF_NUM_COMPOSITE_GAMEPAD, report_id, report_type, buffer, reqlen);
+}
+
+void CompositeDriver::set_report(uint8_t report_id, hid_report_type_t report_type, uint8_t const *buffer, uint16_t bufsize) {
+	set_hid_report(ITF_NUM_COMPOSITE_GAMEPAD, report_id, report_type, buffer, bufsize);
+}
+
+// itf is the HID instance, which matches the interface number
+uint16_t CompositeDriver::get_hid_report(uint8_t itf, uint8_t report_id, hid_report_type_t report_type, uint8_t *buffer, uint16_t reqlen) {
+	if (itf >= ITF_NUM_COMPOSITE_TOTAL) {
+		return 0;
+	}
+	return interfaces[itf]->get_report(report_id, report_type, buffer, reqlen);
+}
+
+void CompositeDriver::set_hid_report(uint8_t itf, uint8_t report_id, hid_report_type_t report_type, uint8_t const *buffer, uint16_t bufsize) {
+	if (itf < ITF_NUM_COMPOSITE_TOTAL) {
+		interfaces[itf]->set_report(report_id, report_type, buffer, bufsize);
+	}
+}
+
+bool CompositeDriver::vendor_control_xfer_cb(uint8_t rhport, uint8_t stage, tusb_control_request_t const *request) {
+	return false;
+}
+
+const uint16_t * CompositeDriver::get_descriptor_string_cb(uint8_t index, uint16_t langid) {
+	const char *value = (const char *)composite_string_descriptors[index];
+	return getStringDescriptor(value, index);
+}
+
+const uint8_t * CompositeDriver::get_descriptor_device_cb() {
+	return deviceDescriptor;
+}
+
+// itf is the HID instance, which matches the interface number
+const uint8_t * CompositeDriver::get_hid_descriptor_report_cb(uint8_t itf) {
+	if (itf >= ITF_NUM_COMPOSITE_TOTAL) {
+		return nullptr;
+	}
+	return interfaces[itf]->get_hid_descriptor_report_cb(0);
+}
+
+const uint8_t * CompositeDriver::get_descriptor_configuration_cb(uint8_t index) {
+	return composite_configuration_descriptor;
+}
+
+const uint8_t * CompositeDriver::get_descriptor_device_qualifier_cb() {
+	return nullptr;
+}
+
+uint16_t CompositeDriver::GetJoystickMidValue() {
+	return gamepadInterface.GetJoystickMidValue();
+}
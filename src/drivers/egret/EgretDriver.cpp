@@ -22,6 +22,10 @@ void EgretDriver::initialize() {
 }
 
 bool EgretDriver::process(Gamepad * gamepad) {
+	// Nothing changed since the last report we sent
+	if (!stateChanged(gamepad))
+		return false;
+
 	switch (gamepad->state.dpad & GAMEPAD_MASK_DPAD)
 	{
 		case GAMEPAD_MASK_UP:                        egretReport.lx = EGRET_JOYSTICK_MID; egretReport.ly = EGRET_JOYSTICK_MIN; break;
@@ -53,13 +57,17 @@ bool EgretDriver::process(Gamepad * gamepad) {
 
 	void * report = &egretReport;
 	uint16_t report_size = sizeof(egretReport);
-	if (memcmp(last_report, report, report_size) != 0)
-	{
-		// HID ready + report sent, copy previous report
-		if (tud_hid_ready() && tud_hid_report(0, report, report_size) == true ) {
-			memcpy(last_report, report, report_size);
-			return true;
-		}
+	// The state changed in a way this report does not show
+	if (memcmp(last_report, report, report_size) == 0) {
+		markStateSent(gamepad);
+		return false;
+	}
+
+	// HID ready + report sent, copy previous report
+	if (tud_hid_ready() && tud_hid_report(0, report, report_size) == true ) {
+		memcpy(last_report, report, report_size);
+		markStateSent(gamepad);
+		return true;
 	}
 	return false;
 }
@@ -80,7 +88,7 @@ bool EgretDriver::vendor_control_xfer_cb(uint8_t rhport, uint8_t stage, tusb_con
 
 const uint16_t * EgretDriver::get_descriptor_string_cb(uint8_t index, uint16_t langid) {
 	const char *value = (const char *)egret_string_descriptors[index];
-	return getStringDescriptor(value, index); // getStringDescriptor returns a static array
+	return getStringDescriptor(value, index);
 }
 
 const uint8_t * EgretDriver::get_descriptor_device_cb() {
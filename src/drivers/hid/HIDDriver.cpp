@@ -32,10 +32,22 @@ void HIDDriver::initialize() {
 		.xfer_cb = hidd_xfer_cb,
 		.sof = NULL
 	};
+
+	// Apply the VID/PID override once, the host reads the device descriptor several times during enumeration
+	memcpy(deviceDescriptor, hid_device_descriptor, sizeof(hid_device_descriptor));
+	GamepadOptions & gamepadOptions = Storage::getInstance().getGamepadOptions();
+	if ( gamepadOptions.usbOverrideID == true ) {
+		memcpy(&deviceDescriptor[8], (uint8_t*)&gamepadOptions.usbVendorID, sizeof(uint16_t)); // Vendor ID
+		memcpy(&deviceDescriptor[10], (uint8_t*)&gamepadOptions.usbProductID, sizeof(uint16_t)); // Product ID
+	}
 }
 
 // Generate HID report from gamepad and send to TUSB Device
 bool HIDDriver::process(Gamepad * gamepad) {
+	// Nothing changed since the last report we sent
+	if (!stateChanged(gamepad))
+		return false;
+
 	switch (gamepad->state.dpad & GAMEPAD_MASK_DPAD)
 	{
 		case GAMEPAD_MASK_UP:                        hidReport.direction = HID_HAT_UP;        break;
@@ -107,13 +119,17 @@ bool HIDDriver::process(Gamepad * gamepad) {
 
 	void * report = &hidReport;
 	uint16_t report_size = sizeof(hidReport);
-	if (memcmp(last_report, report, report_size) != 0)
-	{
-		// HID ready + report sent, copy previous report
-		if (tud_hid_ready() && tud_hid_report(0, report, report_size) == true ) {
-			memcpy(last_report, report, report_size);
-			return true;
-		}
+	// The state changed in a way this report does not show
+	if (memcmp(last_report, report, report_size) == 0) {
+		markStateSent(gamepad);
+		return false;
+	}
+
+	// HID ready + report sent, copy previous report
+	if (tud_hid_n_ready(hidInstance) && tud_hid_n_report(hidInstance, 0, report, report_size) == true ) {
+		memcpy(last_report, report, report_size);
+		markStateSent(gamepad);
+		return true;
 	}
 	
 	return false;
@@ -155,21 +171,11 @@ const uint16_t * HIDDriver::get_descriptor_string_cb(uint8_t index, uint16_t lan
         value = (char *)hid_string_descriptors[index];
     }
 
-	return getStringDescriptor(value, index); // getStringDescriptor returns a static array
+	return getStringDescriptor(value, index);
 }
 
 const uint8_t * HIDDriver::get_descriptor_device_cb() {
-    // Check for override settings
-    GamepadOptions & gamepadOptions = Storage::getInstance().getGamepadOptions();
-    if ( gamepadOptions.usbOverrideID == true ) {
-        static uint8_t modified_device_descriptor[18];
-        memcpy(modified_device_descriptor, hid_device_descriptor, sizeof(hid_device_descriptor));
-        memcpy(&modified_device_descriptor[8], (uint8_t*)&gamepadOptions.usbVendorID, sizeof(uint16_t)); // Vendor ID
-        memcpy(&modified_device_descriptor[10], (uint8_t*)&gamepadOptions.usbProductID, sizeof(uint16_t)); // Product ID
-        return (const uint8_t*)modified_device_descriptor;
-    }
-
-	return hid_device_descriptor;
+	return deviceDescriptor;
 }
 
 const uint8_t * HIDDriver::get_hid_descriptor_report_cb(uint8_t itf) {
@@ -116,9 +116,9 @@ bool KeyboardDriver::process(Gamepad * gamepad) {
 
 	// If we had a keycode but now have a multimedia key OR report is different
 	if (keyboard_report_size != last_report_size || 
-			memcmp(last_report, &keyboardReport, last_report_size) != 0) {
-		if (tud_hid_ready()) {
-			if ( tud_hid_report(keyboardReport.reportId, keyboard_report_payload, keyboard_report_size) ) {
+			memcmp(last_report, keyboard_report_payload, last_report_size) != 0) {
+		if (tud_hid_n_ready(hidInstance)) {
+			if ( tud_hid_n_report(hidInstance, keyboardReport.reportId, keyboard_report_payload, keyboard_report_size) ) {
 				memcpy(last_report, keyboard_report_payload, keyboard_report_size);
 				last_report_size = keyboard_report_size;
 
@@ -174,7 +174,7 @@ bool KeyboardDriver::vendor_control_xfer_cb(uint8_t rhport, uint8_t stage, tusb_
 
 const uint16_t * KeyboardDriver::get_descriptor_string_cb(uint8_t index, uint16_t langid) {
 	const char *value = (const char *)keyboard_string_descriptors[index];
-	return getStringDescriptor(value, index); // getStringDescriptor returns a static array
+	return getStringDescriptor(value, index);
 }
 
 const uint8_t * KeyboardDriver::get_descriptor_device_cb() {
@@ -26,6 +26,10 @@ void MDMiniDriver::initialize() {
 }
 
 bool MDMiniDriver::process(Gamepad * gamepad) {
+	// Nothing changed since the last report we sent
+	if (!stateChanged(gamepad))
+		return false;
+
 	mdminiReport.lx = 0x7f;
 	mdminiReport.ly = 0x7f;
 
@@ -51,13 +55,17 @@ bool MDMiniDriver::process(Gamepad * gamepad) {
 
 	void * report = &mdminiReport;
 	uint16_t report_size = sizeof(mdminiReport);
-	if (memcmp(last_report, report, report_size) != 0)
-	{
-		// HID ready + report sent, copy previous report
-		if (tud_hid_ready() && tud_hid_report(0, report, report_size) == true ) {
-			memcpy(last_report, report, report_size);
-			return true;
-		}
+	// The state changed in a way this report does not show
+	if (memcmp(last_report, report, report_size) == 0) {
+		markStateSent(gamepad);
+		return false;
+	}
+
+	// HID ready + report sent, copy previous report
+	if (tud_hid_ready() && tud_hid_report(0, report, report_size) == true ) {
+		memcpy(last_report, report, report_size);
+		markStateSent(gamepad);
+		return true;
 	}
 
 	return false;
@@ -79,7 +87,7 @@ bool MDMiniDriver::vendor_control_xfer_cb(uint8_t rhport, uint8_t stage, tusb_co
 
 const uint16_t * MDMiniDriver::get_descriptor_string_cb(uint8_t index, uint16_t langid) {
 	const char *value = (const char *)mdmini_string_descriptors[index];
-	return getStringDescriptor(value, index); // getStringDescriptor returns a static array
+	return getStringDescriptor(value, index);
 }
 
 const uint8_t * MDMiniDriver::get_descriptor_device_cb() {
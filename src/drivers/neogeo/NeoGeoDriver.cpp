@@ -39,6 +39,10 @@ void NeoGeoDriver::initialize() {
 }
 
 bool NeoGeoDriver::process(Gamepad * gamepad) {
+	// Nothing changed since the last report we sent
+	if (!stateChanged(gamepad))
+		return false;
+
 	switch (gamepad->state.dpad & GAMEPAD_MASK_DPAD)
 	{
 		case GAMEPAD_MASK_UP:                        neogeoReport.hat = NEOGEO_HAT_UP;        break;
@@ -80,13 +84,17 @@ bool NeoGeoDriver::process(Gamepad * gamepad) {
 
 	void * report = &neogeoReport;
 	uint16_t report_size = sizeof(neogeoReport);
-	if (memcmp(last_report, report, report_size) != 0)
-	{
-		// HID ready + report sent, copy previous report
-		if (tud_hid_ready() && tud_hid_report(0, report, report_size) == true ) {
-			memcpy(last_report, report, report_size);
-			return true;
-		}
+	// The state changed in a way this report does not show
+	if (memcmp(last_report, report, report_size) == 0) {
+		markStateSent(gamepad);
+		return false;
+	}
+
+	// HID ready + report sent, copy previous report
+	if (tud_hid_ready() && tud_hid_report(0, report, report_size) == true ) {
+		memcpy(last_report, report, report_size);
+		markStateSent(gamepad);
+		return true;
 	}
 
 	return false;
@@ -108,7 +116,7 @@ bool NeoGeoDriver::vendor_control_xfer_cb(uint8_t rhport, uint8_t stage, tusb_co
 
 const uint16_t * NeoGeoDriver::get_descriptor_string_cb(uint8_t index, uint16_t langid) {
 	const char *value = (const char *)neogeo_string_descriptors[index];
-	return getStringDescriptor(value, index); // getStringDescriptor returns a static array
+	return getStringDescriptor(value, index);
 }
 
 const uint8_t * NeoGeoDriver::get_descriptor_device_cb() {
@@ -313,7 +313,7 @@ void P5GeneralDriver::set_report(uint8_t report_id, hid_report_type_t report_typ
 const uint16_t * P5GeneralDriver::get_descriptor_string_cb(uint8_t index, uint16_t langid) {
     const char *value = (const char *)p5general_string_descriptors[index];
     P5DRPINTF("P5D:get_descriptor_string_cb Index %d. langid %d, value %x\n", index, langid, (uint32_t)value);
-    return getStringDescriptor(value, index); // getStringDescriptor returns a static array
+    return getStringDescriptor(value, index);
 }
 
 const uint8_t * P5GeneralDriver::get_descriptor_device_cb() {
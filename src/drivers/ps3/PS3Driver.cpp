@@ -224,20 +224,20 @@ bool PS3Driver::process(Gamepad * gamepad) {
             ps3Report.buttonL2Analog = gamepad->state.lt;
             ps3Report.buttonR2Analog = gamepad->state.rt;
         } else {
-            ps3Report.buttonL2Analog = gamepad->pressedL2() ? 0xFF : 0;
-            ps3Report.buttonR2Analog = gamepad->pressedR2() ? 0xFF : 0;
+            ps3Report.buttonL2Analog = gamepad->pressureButton(GAMEPAD_MASK_L2);
+            ps3Report.buttonR2Analog = gamepad->pressureButton(GAMEPAD_MASK_R2);
         }
 
-        ps3Report.buttonNorthAnalog = gamepad->pressedB4() ? 0xFF : 0;
-        ps3Report.buttonEastAnalog  = gamepad->pressedB2() ? 0xFF : 0;
-        ps3Report.buttonSouthAnalog = gamepad->pressedB1() ? 0xFF : 0;
-        ps3Report.buttonWestAnalog  = gamepad->pressedB3() ? 0xFF : 0;
-        ps3Report.buttonL1Analog    = gamepad->pressedL1() ? 0xFF : 0;
-        ps3Report.buttonR1Analog    = gamepad->pressedR1() ? 0xFF : 0;
-        ps3Report.dpadRightAnalog   = gamepad->state.dpad & GAMEPAD_MASK_RIGHT ? 0xFF : 0;
-        ps3Report.dpadLeftAnalog    = gamepad->state.dpad & GAMEPAD_MASK_LEFT ? 0xFF : 0;
-        ps3Report.dpadUpAnalog      = gamepad->state.dpad & GAMEPAD_MASK_UP ? 0xFF : 0;
-        ps3Report.dpadDownAnalog    = gamepad->state.dpad & GAMEPAD_MASK_DOWN ? 0xFF : 0;
+        ps3Report.buttonNorthAnalog = gamepad->pressureButton(GAMEPAD_MASK_B4);
+        ps3Report.buttonEastAnalog  = gamepad->pressureButton(GAMEPAD_MASK_B2);
+        ps3Report.buttonSouthAnalog = gamepad->pressureButton(GAMEPAD_MASK_B1);
+        ps3Report.buttonWestAnalog  = gamepad->pressureButton(GAMEPAD_MASK_B3);
+        ps3Report.buttonL1Analog    = gamepad->pressureButton(GAMEPAD_MASK_L1);
+        ps3Report.buttonR1Analog    = gamepad->pressureButton(GAMEPAD_MASK_R1);
+        ps3Report.dpadRightAnalog   = gamepad->pressureDpad(GAMEPAD_MASK_RIGHT);
+        ps3Report.dpadLeftAnalog    = gamepad->pressureDpad(GAMEPAD_MASK_LEFT);
+        ps3Report.dpadUpAnalog      = gamepad->pressureDpad(GAMEPAD_MASK_UP);
+        ps3Report.dpadDownAnalog    = gamepad->pressureDpad(GAMEPAD_MASK_DOWN);
 
         if (gamepad->auxState.sensors.accelerometer.enabled) {
             ps3Report.accelerometerX = ((gamepad->auxState.sensors.accelerometer.x & 0xFF) << 8) | ((gamepad->auxState.sensors.accelerometer.x & 0xFF00) >> 8);
@@ -381,20 +381,20 @@ bool PS3Driver::process(Gamepad * gamepad) {
                 ps3ReportAlt.gamepad.buttonL2Analog = gamepad->state.lt;
                 ps3ReportAlt.gamepad.buttonR2Analog = gamepad->state.rt;
             } else {
-                ps3ReportAlt.gamepad.buttonL2Analog = gamepad->pressedL2()                    ? PS3_JOYSTICK_MAX : PS3_JOYSTICK_MIN;
-                ps3ReportAlt.gamepad.buttonR2Analog = gamepad->pressedR2()                    ? PS3_JOYSTICK_MAX : PS3_JOYSTICK_MIN;
+                ps3ReportAlt.gamepad.buttonL2Analog = gamepad->pressureButton(GAMEPAD_MASK_L2);
+                ps3ReportAlt.gamepad.buttonR2Analog = gamepad->pressureButton(GAMEPAD_MASK_R2);
             }
 
-            ps3ReportAlt.gamepad.buttonNorthAnalog = ps3ReportAlt.gamepad.buttonNorth         ? PS3_JOYSTICK_MAX : PS3_JOYSTICK_MIN;
-            ps3ReportAlt.gamepad.buttonEastAnalog  = ps3ReportAlt.gamepad.buttonEast          ? PS3_JOYSTICK_MAX : PS3_JOYSTICK_MIN;
-            ps3ReportAlt.gamepad.buttonSouthAnalog = ps3ReportAlt.gamepad.buttonSouth         ? PS3_JOYSTICK_MAX : PS3_JOYSTICK_MIN;
-            ps3ReportAlt.gamepad.buttonWestAnalog  = ps3ReportAlt.gamepad.buttonWest          ? PS3_JOYSTICK_MAX : PS3_JOYSTICK_MIN;
-            ps3ReportAlt.gamepad.buttonL1Analog    = ps3ReportAlt.gamepad.buttonL1            ? PS3_JOYSTICK_MAX : PS3_JOYSTICK_MIN;
-            ps3ReportAlt.gamepad.buttonR1Analog    = ps3ReportAlt.gamepad.buttonR1            ? PS3_JOYSTICK_MAX : PS3_JOYSTICK_MIN;
-            ps3ReportAlt.gamepad.dpadRightAnalog   = gamepad->state.dpad & GAMEPAD_MASK_RIGHT ? PS3_JOYSTICK_MAX : PS3_JOYSTICK_MIN;
-            ps3ReportAlt.gamepad.dpadLeftAnalog    = gamepad->state.dpad & GAMEPAD_MASK_LEFT  ? PS3_JOYSTICK_MAX : PS3_JOYSTICK_MIN;
-            ps3ReportAlt.gamepad.dpadUpAnalog      = gamepad->state.dpad & GAMEPAD_MASK_UP    ? PS3_JOYSTICK_MAX : PS3_JOYSTICK_MIN;
-            ps3ReportAlt.gamepad.dpadDownAnalog    = gamepad->state.dpad & GAMEPAD_MASK_DOWN  ? PS3_JOYSTICK_MAX : PS3_JOYSTICK_MIN;
+            ps3ReportAlt.gamepad.buttonNorthAnalog = gamepad->pressureButton(GAMEPAD_MASK_B4);
+            ps3ReportAlt.gamepad.buttonEastAnalog  = gamepad->pressureButton(GAMEPAD_MASK_B2);
+            ps3ReportAlt.gamepad.buttonSouthAnalog = gamepad->pressureButton(GAMEPAD_MASK_B1);
+            ps3ReportAlt.gamepad.buttonWestAnalog  = gamepad->pressureButton(GAMEPAD_MASK_B3);
+            ps3ReportAlt.gamepad.buttonL1Analog    = gamepad->pressureButton(GAMEPAD_MASK_L1);
+            ps3ReportAlt.gamepad.buttonR1Analog    = gamepad->pressureButton(GAMEPAD_MASK_R1);
+            ps3ReportAlt.gamepad.dpadRightAnalog   = gamepad->pressureDpad(GAMEPAD_MASK_RIGHT);
+            ps3ReportAlt.gamepad.dpadLeftAnalog    = gamepad->pressureDpad(GAMEPAD_MASK_LEFT);
+            ps3ReportAlt.gamepad.dpadUpAnalog      = gamepad->pressureDpad(GAMEPAD_MASK_UP);
+            ps3ReportAlt.gamepad.dpadDownAnalog    = gamepad->pressureDpad(GAMEPAD_MASK_DOWN);
 
             if (gamepad->auxState.sensors.accelerometer.enabled) {
                 ps3ReportAlt.gamepad.accelerometerX = ((gamepad->auxState.sensors.accelerometer.x & 0xFF) << 8) | ((gamepad->auxState.sensors.accelerometer.x & 0xFF00) >> 8);
@@ -642,7 +642,7 @@ bool PS3Driver::vendor_control_xfer_cb(uint8_t rhport, uint8_t stage, tusb_contr
 
 const uint16_t * PS3Driver::get_descriptor_string_cb(uint8_t index, uint16_t langid) {
 	const char *value = (const char *)ps3_string_descriptors[index];
-	return getStringDescriptor(value, index); // getStringDescriptor returns a static array
+	return getStringDescriptor(value, index);
 }
 
 const uint8_t * PS3Driver::get_descriptor_device_cb() {
@@ -13,9 +13,6 @@
 
 #include "enums.pb.h"
 
-// force a report to be sent every X ms
-#define PS4_KEEPALIVE_TIMER 5
-
 // Controller calibration
 static constexpr uint8_t output_0x02[] = {
     0xfe, 0xff, 0x0e, 0x00, 0x04, 0x00, 0xd4, 0x22,
@@ -386,7 +383,7 @@ void PS4Driver::initialize() {
 
     last_report_counter = 0; // PS4 Reports
     last_axis_counter = 0;
-    last_report_timer = to_ms_since_boot(get_absolute_time());
+    keepAliveTimer.reset(to_ms_since_boot(get_absolute_time()));
     cur_nonce_id = 1; // PS4 Auth
     cur_nonce_chunk = 0;
 }
@@ -606,8 +603,8 @@ bool PS4Driver::process(Gamepad * gamepad) {
         ps4Report.leftTrigger = gamepad->state.lt;
         ps4Report.rightTrigger = gamepad->state.rt;
     } else {
-        ps4Report.leftTrigger = gamepad->pressedL2() ? 0xFF : 0;
-        ps4Report.rightTrigger = gamepad->pressedR2() ? 0xFF : 0;
+        ps4Report.leftTrigger = gamepad->pressureButton(GAMEPAD_MASK_L2);
+        ps4Report.rightTrigger = gamepad->pressureButton(GAMEPAD_MASK_R2);
     }
 
     // if the touchpad is pressed (note A2 vs. S1 choice above), emulate one finger of the touchpad
@@ -679,7 +676,6 @@ bool PS4Driver::process(Gamepad * gamepad) {
 
     bool reportSent = false;
 
-    uint32_t now = to_ms_since_boot(get_absolute_time());
     void * report = &ps4Report;
     uint16_t report_size = sizeof(ps4Report);
 
@@ -691,7 +687,7 @@ bool PS4Driver::process(Gamepad * gamepad) {
             reportSent = true;
         }
         // keep track of our last successful report, for keepalive purposes
-        last_report_timer = now;
+        keepAliveTimer.reset(processTime);
     } else {
         // some games apparently can miss reports, or they rely on official behavior of getting frequent
         // updates. we normally only send a report when the value changes; if we increment the counters
@@ -699,11 +695,11 @@ bool PS4Driver::process(Gamepad * gamepad) {
         // TinyUSB and introduce roughly 1ms of latency. but we want to loop often and report on every
         // true update in order to achieve our tight <1ms report timing when we *do* have a different
         // report to send.
-        if ((now - last_report_timer) > PS4_KEEPALIVE_TIMER) {
+        if (keepAliveTimer.expired(processTime)) {
             last_report_counter = (last_report_counter+1) & 0x3F;
             ps4Report.reportCounter = last_report_counter;		// report counter is 6 bits
             if (deviceType == InputModeDeviceType::INPUT_MODE_DEVICE_TYPE_GAMEPAD) {
-                ps4Report.gamepad.axisTiming = now;		 		// axis counter is 16 bits
+                ps4Report.gamepad.axisTiming = processTime;		 		// axis counter is 16 bits
             }
             // the *next* process() will be a forced report (or real user input)
         }
@@ -923,7 +919,7 @@ bool PS4Driver::vendor_control_xfer_cb(uint8_t rhport, uint8_t stage, tusb_contr
 
 const uint16_t * PS4Driver::get_descriptor_string_cb(uint8_t index, uint16_t langid) {
     const char *value = (const char *)ps4_string_descriptors[index];
-    return getStringDescriptor(value, index); // getStringDescriptor returns a static array
+    return getStringDescriptor(value, index);
 }
 
 const uint8_t * PS4Driver::get_descriptor_device_cb() {
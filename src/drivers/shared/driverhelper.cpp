@@ -0,0 +1,70 @@
+#include "drivers/shared/driverhelper.h"
+
+#include "tusb.h"
+
+#include <string.h>
+
+// Highest string index that gets cached, anything above is converted on every request
+#define STRING_DESCRIPTOR_CACHE_COUNT 8
+// UTF-16 units shared by all cached descriptors, enough for the longest set (XInput incl. XSM3)
+#define STRING_DESCRIPTOR_POOL_SIZE 256
+// Max 256 bytes per descriptor, 127 unicode characters
+#define STRING_DESCRIPTOR_MAX_CHARS 127
+
+static uint16_t descriptorStringPool[STRING_DESCRIPTOR_POOL_SIZE];
+static uint16_t descriptorStringPoolUsed = 0;
+static const uint16_t * descriptorStringCache[STRING_DESCRIPTOR_CACHE_COUNT] = { };
+
+static void buildStringDescriptor(uint16_t * buffer, const char * value, size_t charCount)
+{
+	// Fill buffer[1] .. [charCount]
+	for (size_t i = 0; i < charCount; i++)
+		buffer[i + 1] = (uint8_t)value[i];
+
+	// first byte (buffer[0]) is length (including header), second byte is string type
+	buffer[0] = (0x03 << 8) | (2 * (uint8_t)charCount + 2);
+}
+
+const uint16_t * getStringDescriptor(const char * value, uint8_t index)
+{
+	if (index < STRING_DESCRIPTOR_CACHE_COUNT && descriptorStringCache[index] != nullptr)
+		return descriptorStringCache[index];
+
+	size_t charCount;
+	if ( index == 0 ) // language always has a character count of 1
+		charCount = 1;
+	else {
+		charCount = strlen(value);
+		if (charCount > STRING_DESCRIPTOR_MAX_CHARS)
+			charCount = STRING_DESCRIPTOR_MAX_CHARS;
+	}
+
+	if (index < STRING_DESCRIPTOR_CACHE_COUNT && descriptorStringPoolUsed + charCount + 1 <= STRING_DESCRIPTOR_POOL_SIZE) {
+		uint16_t * descriptor = &descriptorStringPool[descriptorStringPoolUsed];
+		buildStringDescriptor(descriptor, value, charCount);
+		descriptorStringPoolUsed += charCount + 1;
+		descriptorStringCache[index] = descriptor;
+		return descriptor;
+	}
+
+	// Out of pool space, fall back to converting on every request
+	static uint16_t descriptorStringBuffer[STRING_DESCRIPTOR_MAX_CHARS + 1];
+	buildStringDescriptor(descriptorStringBuffer, value, charCount);
+	return descriptorStringBuffer;
+}
+
+void setPollingInterval(uint8_t * configDescriptor, uint8_t interval)
+{
+	const tusb_desc_configuration_t * config = (const tusb_desc_configuration_t *)configDescriptor;
+	uint8_t * p = configDescriptor;
+	const uint8_t * end = configDescriptor + config->wTotalLength;
+	while (p < end && tu_desc_len(p) != 0) {
+		if (tu_desc_type(p) == TUSB_DESC_ENDPOINT) {
+			tusb_desc_endpoint_t * endpoint = (tusb_desc_endpoint_t *)p;
+			if (endpoint->bmAttributes.xfer == TUSB_XFER_INTERRUPT) {
+				endpoint->bInterval = interval;
+			}
+		}
+		p += tu_desc_len(p);
+	}
+}
@@ -0,0 +1,383 @@
+#include "drivers/shared/hid_report_plan.h"
+
+// HID 1.11 short items, tag and type bits of the prefix
+#define HID_ITEM_INPUT          0x80
+#define HID_ITEM_COLLECTION     0xA0
+#define HID_ITEM_END_COLLECTION 0xC0
+#define HID_ITEM_USAGE_PAGE     0x04
+#define HID_ITEM_LOGICAL_MIN    0x14
+#define HID_ITEM_LOGICAL_MAX    0x24
+#define HID_ITEM_REPORT_SIZE    0x74
+#define HID_ITEM_REPORT_ID      0x84
+#define HID_ITEM_REPORT_COUNT   0x94
+#define HID_ITEM_PUSH           0xA4
+#define HID_ITEM_POP            0xB4
+#define HID_ITEM_USAGE          0x08
+#define HID_ITEM_USAGE_MIN      0x18
+#define HID_ITEM_USAGE_MAX      0x28
+#define HID_ITEM_LONG           0xFE
+#define HID_ITEM_TYPE_MASK      0x0C
+#define HID_ITEM_TYPE_MAIN      0x00
+
+#define HID_INPUT_CONSTANT      0x01
+#define HID_INPUT_VARIABLE      0x02
+#define HID_COLLECTION_APPLICATION 0x01
+
+#define HID_PAGE_DESKTOP        0x01
+#define HID_PAGE_SIMULATION     0x02
+#define HID_PAGE_BUTTON         0x09
+
+#define HID_USAGE_JOYSTICK      0x04
+#define HID_USAGE_GAMEPAD       0x05
+#define HID_USAGE_MULTI_AXIS    0x08
+#define HID_USAGE_X             0x30
+#define HID_USAGE_Y             0x31
+#define HID_USAGE_Z             0x32
+#define HID_USAGE_RX            0x33
+#define HID_USAGE_RY            0x34
+#define HID_USAGE_RZ            0x35
+#define HID_USAGE_HAT_SWITCH    0x39
+#define HID_USAGE_ACCELERATOR   0xC4
+#define HID_USAGE_BRAKE         0xC5
+
+// Descriptor parser limits, anything beyond is ignored
+#define HID_PARSER_MAX_USAGES       16
+#define HID_PARSER_MAX_REPORT_IDS   8
+#define HID_PARSER_STACK_DEPTH      2
+
+#define HID_DPAD_BUTTON_SHIFT 16 // buttons 17-20 are the d-pad in our HID mode
+
+typedef struct {
+    uint16_t usagePage;
+    int32_t logicalMin;
+    int32_t logicalMax;
+    uint32_t logicalMaxRaw;
+    uint8_t reportSize;
+    uint8_t reportCount;
+    uint8_t reportId;
+} HIDParserGlobals;
+
+typedef struct {
+    uint8_t reportId;
+    uint16_t bits;
+} HIDParserReportOffset;
+
+static const uint8_t hatToDpad[8] = {
+    GAMEPAD_MASK_UP,
+    GAMEPAD_MASK_UP | GAMEPAD_MASK_RIGHT,
+    GAMEPAD_MASK_RIGHT,
+    GAMEPAD_MASK_RIGHT | GAMEPAD_MASK_DOWN,
+    GAMEPAD_MASK_DOWN,
+    GAMEPAD_MASK_DOWN | GAMEPAD_MASK_LEFT,
+    GAMEPAD_MASK_LEFT,
+    GAMEPAD_MASK_LEFT | GAMEPAD_MASK_UP,
+};
+
+static int8_t usageToTarget(uint16_t page, uint16_t usage) {
+    if (page == HID_PAGE_DESKTOP) {
+        switch (usage) {
+            case HID_USAGE_X:          return HID_REPORT_TARGET_LX;
+            case HID_USAGE_Y:          return HID_REPORT_TARGET_LY;
+            case HID_USAGE_Z:          return HID_REPORT_TARGET_RX;
+            case HID_USAGE_RZ:         return HID_REPORT_TARGET_RY;
+            case HID_USAGE_RX:         return HID_REPORT_TARGET_LT;
+            case HID_USAGE_RY:         return HID_REPORT_TARGET_RT;
+            case HID_USAGE_HAT_SWITCH: return HID_REPORT_TARGET_HAT;
+            default:                   return -1;
+        }
+    } else if (page == HID_PAGE_SIMULATION) {
+        switch (usage) {
+            case HID_USAGE_ACCELERATOR: return HID_REPORT_TARGET_RT;
+            case HID_USAGE_BRAKE:       return HID_REPORT_TARGET_LT;
+            default:                    return -1;
+        }
+    }
+    return -1;
+}
+
+// Little endian bit field of up to 32 bits, the caller has checked the report length
+static inline uint32_t extractBits(const uint8_t * data, uint16_t bitOffset, uint8_t bitSize) {
+    const uint8_t * p = data + (bitOffset >> 3);
+    const uint8_t shift = bitOffset & 7;
+    const uint8_t bytes = (shift + bitSize + 7) >> 3;
+    uint64_t raw = 0;
+    for (uint8_t i = 0; i < bytes; i++) {
+        raw |= (uint64_t)p[i] << (i * 8);
+    }
+    raw >>= shift;
+    return (bitSize >= 32) ? (uint32_t)raw : (uint32_t)raw & ((1UL << bitSize) - 1);
+}
+
+bool HIDReportPlan::compile(const uint8_t * desc, uint16_t descLen) {
+    fieldCount = 0;
+    buttonRunCount = 0;
+    reportId = 0;
+    reportBytes = 0;
+    targets = 0;
+    analog = false;
+
+    HIDParserGlobals globals = {};
+    HIDParserGlobals stack[HID_PARSER_STACK_DEPTH];
+    uint8_t stackDepth = 0;
+    uint32_t usages[HID_PARSER_MAX_USAGES];
+    uint8_t usageCount = 0;
+    uint32_t usageMin = 0;
+    uint32_t usageMax = 0;
+    HIDParserReportOffset offsets[HID_PARSER_MAX_REPORT_IDS];
+    uint8_t offsetCount = 0;
+    uint8_t collectionDepth = 0;
+    uint8_t gamepadDepth = 0; // collection depth of the gamepad/joystick application, 0 when outside
+    bool reportChosen = false;
+
+    uint16_t i = 0;
+    while (i < descLen) {
+        const uint8_t prefix = desc[i++];
+        if (prefix == HID_ITEM_LONG) {
+            if (i >= descLen) break;
+            i += 2 + desc[i];
+            continue;
+        }
+
+        const uint8_t size = ((prefix & 0x03) == 0x03) ? 4 : (prefix & 0x03);
+        if (i + size > descLen) break;
+        uint32_t data = 0;
+        for (uint8_t b = 0; b < size; b++) {
+            data |= (uint32_t)desc[i + b] << (b * 8);
+        }
+        int32_t signedData = (int32_t)data;
+        if (size == 1) signedData = (int8_t)data;
+        else if (size == 2) signedData = (int16_t)data;
+        i += size;
+
+        // Short usages are extended with the usage page at the time they are declared
+        const uint32_t usage = (size == 4) ? data : (((uint32_t)globals.usagePage << 16) | (data & 0xFFFF));
+
+        switch (prefix & 0xFC) {
+            case HID_ITEM_USAGE_PAGE:   globals.usagePage = data; break;
+            case HID_ITEM_LOGICAL_MIN:  globals.logicalMin = signedData; break;
+            case HID_ITEM_LOGICAL_MAX:  globals.logicalMax = signedData; globals.logicalMaxRaw = data; break;
+            case HID_ITEM_REPORT_SIZE:  globals.reportSize = data; break;
+            case HID_ITEM_REPORT_ID:    globals.reportId = data; break;
+            case HID_ITEM_REPORT_COUNT: globals.reportCount = data; break;
+            case HID_ITEM_PUSH:
+                if (stackDepth < HID_PARSER_STACK_DEPTH) stack[stackDepth++] = globals;
+                break;
+            case HID_ITEM_POP:
+                if (stackDepth > 0) globals = stack[--stackDepth];
+                break;
+            case HID_ITEM_USAGE:
+                if (usageCount < HID_PARSER_MAX_USAGES) usages[usageCount++] = usage;
+                break;
+            case HID_ITEM_USAGE_MIN:    usageMin = usage; break;
+            case HID_ITEM_USAGE_MAX:    usageMax = usage; break;
+            case HID_ITEM_COLLECTION:
+                collectionDepth++;
+                if (gamepadDepth == 0 && data == HID_COLLECTION_APPLICATION && usageCount > 0 &&
+                        (usages[0] >> 16) == HID_PAGE_DESKTOP &&
+                        ((usages[0] & 0xFFFF) == HID_USAGE_JOYSTICK || (usages[0] & 0xFFFF) == HID_USAGE_GAMEPAD ||
+                         (usages[0] & 0xFFFF) == HID_USAGE_MULTI_AXIS)) {
+                    gamepadDepth = collectionDepth;
+                }
+                break;
+            case HID_ITEM_END_COLLECTION:
+                if (collectionDepth == gamepadDepth) gamepadDepth = 0;
+                if (collectionDepth > 0) collectionDepth--;
+                break;
+            case HID_ITEM_INPUT: {
+                // Every report ID has its own bit layout
+                HIDParserReportOffset * offset = nullptr;
+                for (uint8_t o = 0; o < offsetCount; o++) {
+                    if (offsets[o].reportId == globals.reportId) {
+                        offset = &offsets[o];
+                        break;
+                    }
+                }
+                if (offset == nullptr) {
+                    if (offsetCount == HID_PARSER_MAX_REPORT_IDS) break;
+                    offset = &offsets[offsetCount++];
+                    offset->reportId = globals.reportId;
+                    offset->bits = 0;
+                }
+
+                // The first gamepad input decides which report is decoded
+                if (gamepadDepth != 0 && !(data & HID_INPUT_CONSTANT) && (data & HID_INPUT_VARIABLE) &&
+                        (!reportChosen || globals.reportId == reportId)) {
+                    const uint8_t previousCount = fieldCount + buttonRunCount;
+                    // Logical Maximum is unsigned unless the minimum is negative, e.g. 0x26 0xFF 0x00 vs 0x25 0xFF
+                    const int32_t logicalMax = (globals.logicalMin >= 0 && globals.logicalMax < globals.logicalMin) ?
+                        (int32_t)globals.logicalMaxRaw : globals.logicalMax;
+                    addInput(offset->bits, globals.reportSize, globals.reportCount, usages, usageCount, usageMin, usageMax,
+                             globals.logicalMin, logicalMax);
+                    if (fieldCount + buttonRunCount != previousCount) {
+                        reportChosen = true;
+                        reportId = globals.reportId;
+                    }
+                }
+                offset->bits += (uint16_t)globals.reportSize * globals.reportCount;
+                break;
+            }
+            default:
+                break;
+        }
+
+        // Local items only apply to the next main item
+        if ((prefix & HID_ITEM_TYPE_MASK) == HID_ITEM_TYPE_MAIN) {
+            usageCount = 0;
+            usageMin = 0;
+            usageMax = 0;
+        }
+    }
+
+    uint16_t bytes = 0;
+    for (uint8_t f = 0; f < fieldCount; f++) {
+        const uint16_t end = (fields[f].bitOffset + fields[f].bitSize + 7) >> 3;
+        if (end > bytes) bytes = end;
+    }
+    for (uint8_t r = 0; r < buttonRunCount; r++) {
+        const uint16_t end = (buttonRuns[r].bitOffset + buttonRuns[r].count + 7) >> 3;
+        if (end > bytes) bytes = end;
+    }
+    if (bytes > 0xFF) {
+        reset();
+    }
+    reportBytes = bytes;
+    return isValid();
+}
+
+void HIDReportPlan::addInput(uint16_t bitOffset, uint8_t reportSize, uint8_t reportCount,
+                             const uint32_t * usages, uint8_t usageCount, uint32_t usageMin, uint32_t usageMax,
+                             int32_t logicalMin, int32_t logicalMax) {
+    if (reportSize == 0 || reportSize > 32) return;
+
+    uint8_t itemTargets = 0; // targets assigned by this Input item
+    for (uint8_t j = 0; j < reportCount; j++) {
+        uint32_t usage;
+        if (usageCount > 0) {
+            usage = usages[(j < usageCount) ? j : (usageCount - 1)];
+        } else if (usageMax != 0 && usageMin + j <= usageMax) {
+            usage = usageMin + j;
+        } else {
+            break;
+        }
+
+        const uint16_t page = usage >> 16;
+        const uint16_t id = usage & 0xFFFF;
+        const uint16_t fieldOffset = bitOffset + (uint16_t)j * reportSize;
+
+        if (page == HID_PAGE_BUTTON) {
+            if (reportSize == 1 && id >= 1 && id <= 32) {
+                addButton(fieldOffset, id - 1);
+            }
+            continue;
+        }
+
+        const int8_t target = usageToTarget(page, id);
+        if (target < 0 || logicalMax <= logicalMin) continue;
+        // A usage listed again within the same item moves the target to the later field, e.g. the Astro and MD mini
+        // pads list X four times ahead of Y and only the last X carries the d-pad. Anything else keeps the first field.
+        const bool relisted = (itemTargets & (1 << target)) && j < usageCount;
+        if ((targets & (1 << target)) && !relisted) continue;
+
+        HIDReportField field = {};
+        field.bitOffset = fieldOffset;
+        field.bitSize = reportSize;
+        field.target = target;
+        field.isSigned = logicalMin < 0;
+        field.logicalMin = logicalMin;
+        field.logicalMax = logicalMax;
+        if (target == HID_REPORT_TARGET_HAT) {
+            // 4 position hats skip the diagonals
+            field.scale = (logicalMax - logicalMin == 3) ? 2 : 1;
+        } else {
+            const uint32_t outMax = (target == HID_REPORT_TARGET_LT || target == HID_REPORT_TARGET_RT) ?
+                GAMEPAD_TRIGGER_MAX : GAMEPAD_JOYSTICK_MAX;
+            // Rounded up so the logical maximum reaches outMax, decode() clamps the overshoot
+            const uint32_t range = (uint32_t)(logicalMax - logicalMin);
+            field.scale = (uint32_t)((((uint64_t)outMax << 16) + range - 1) / range);
+            analog = true;
+        }
+        targets |= (1 << target);
+        itemTargets |= (1 << target);
+        addField(field);
+    }
+}
+
+void HIDReportPlan::addField(const HIDReportField & field) {
+    for (uint8_t f = 0; f < fieldCount; f++) {
+        if (fields[f].target == field.target) {
+            fields[f] = field;
+            return;
+        }
+    }
+    if (fieldCount < HID_REPORT_TARGET_COUNT) {
+        fields[fieldCount++] = field;
+    }
+}
+
+void HIDReportPlan::addButton(uint16_t bitOffset, uint8_t button) {
+    // Buttons that follow each other in the report and in numbering are read as one run
+    if (buttonRunCount > 0) {
+        HIDReportButtonRun & last = buttonRuns[buttonRunCount - 1];
+        if (last.bitOffset + last.count == bitOffset && last.firstButton + last.count == button) {
+            last.count++;
+            return;
+        }
+    }
+    if (buttonRunCount < HID_REPORT_PLAN_MAX_BUTTON_RUNS) {
+        buttonRuns[buttonRunCount++] = { bitOffset, 1, button };
+    }
+}
+
+bool HIDReportPlan::decode(const uint8_t * report, uint16_t len, GamepadState & state) const {
+    if (reportId != 0) {
+        if (len == 0 || report[0] != reportId) return false;
+        report++;
+        len--;
+    }
+    if (!isValid() || len < reportBytes) return false;
+
+    uint32_t buttons = 0;
+    for (uint8_t r = 0; r < buttonRunCount; r++) {
+        const HIDReportButtonRun & run = buttonRuns[r];
+        buttons |= extractBits(report, run.bitOffset, run.count) << run.firstButton;
+    }
+
+    uint8_t dpad = 0;
+    for (uint8_t f = 0; f < fieldCount; f++) {
+        const HIDReportField & field = fields[f];
+        const uint32_t raw = extractBits(report, field.bitOffset, field.bitSize);
+
+        int32_t value = (int32_t)raw;
+        if (field.isSigned && field.bitSize < 32 && (raw & (1UL << (field.bitSize - 1)))) {
+            value = (int32_t)(raw | ~((1UL << field.bitSize) - 1));
+        }
+        if (field.target == HID_REPORT_TARGET_HAT) {
+            // Values outside the logical range are the null state
+            if (value >= field.logicalMin && value <= field.logicalMax) {
+                const uint32_t position = (uint32_t)(value - field.logicalMin) * field.scale;
+                if (position < 8) dpad = hatToDpad[position];
+            }
+            continue;
+        }
+
+        if (value < field.logicalMin) value = field.logicalMin;
+        else if (value > field.logicalMax) value = field.logicalMax;
+        uint32_t scaled = (uint32_t)(((uint64_t)(uint32_t)(value - field.logicalMin) * field.scale) >> 16);
+        if (scaled > GAMEPAD_JOYSTICK_MAX) scaled = GAMEPAD_JOYSTICK_MAX;
+        switch (field.target) {
+            case HID_REPORT_TARGET_LX: state.lx = scaled; break;
+            case HID_REPORT_TARGET_LY: state.ly = scaled; break;
+            case HID_REPORT_TARGET_RX: state.rx = scaled; break;
+            case HID_REPORT_TARGET_RY: state.ry = scaled; break;
+            case HID_REPORT_TARGET_LT: state.lt = (scaled > GAMEPAD_TRIGGER_MAX) ? GAMEPAD_TRIGGER_MAX : scaled; break;
+            case HID_REPORT_TARGET_RT: state.rt = (scaled > GAMEPAD_TRIGGER_MAX) ? GAMEPAD_TRIGGER_MAX : scaled; break;
+            default: break;
+        }
+    }
+
+    // HID buttons 1-3 are B3 B1 B2, see HIDDriver
+    buttons = (buttons & ~0x7UL) | ((buttons & 0x1) << 2) | ((buttons >> 1) & 0x3);
+    state.dpad = dpad | ((buttons >> HID_DPAD_BUTTON_SHIFT) & 0xF);
+    state.buttons = buttons & ~(0xFUL << HID_DPAD_BUTTON_SHIFT);
+    return true;
+}
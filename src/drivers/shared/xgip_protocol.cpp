@@ -46,9 +46,7 @@ void XGIPProtocol::reset() {
     numberOfChunksSent = 0;     // How many actual chunks have we sent?
     chunkEnded = false;         // Are we at the end of the chunk?
     isValidPacket = false;      // Is this a valid packet?
-    memset(data, 0, 1024);
-    dataLength = 0;             // Set data length to 0
-    memset(packet, 0, sizeof(packet)); // Set our packet to 0
+    dataLength = 0;             // Set data length to 0 (data and packet are only ever read up to their lengths)
     packetLength = 0;           // Set packet length to 0
 }
 
@@ -78,11 +76,18 @@ bool XGIPProtocol::parse(const uint8_t * buffer, uint16_t len) {
     } else { // Non-ACK
         // Continue parsing chunked data
         if ( newPacket->chunked == true ) {
+            if ( newPacket->length != 0 && newPacket->chunkStart == 1 ) { // START OF CHUNK, drop whatever we had
+                reset();
+            }
             memcpy((void*)&header, buffer, sizeof(GipHeader_t)); // Always copy to header buffer
             if ( header.length == 0 ) { // END OF CHUNK
+                if ( len < 6 ) {
+                    isValidPacket = false;
+                    return false;
+                }
                 uint16_t endChunkSize = (buffer[4] | buffer[5] << 8);
-                // Verify chunk is good
-                if ( totalChunkLength != endChunkSize) {
+                // Verify chunk is good and all of the data it announced arrived
+                if ( totalChunkLength != endChunkSize || actualDataReceived != dataLength ) {
                     isValidPacket = false;
                     return false;
                 }
@@ -90,10 +95,12 @@ bool XGIPProtocol::parse(const uint8_t * buffer, uint16_t len) {
                 isValidPacket = true;
                 return true; // we're good!
             }
-            if ( header.chunkStart == 1 ) { // START OF CHUNK
+            if ( len < 6 ) {
                 reset();
-                memcpy((void*)&header, buffer, sizeof(GipHeader_t));
-
+                isValidPacket = false;
+                return false;
+            }
+            if ( header.chunkStart == 1 ) { // START OF CHUNK
                 // Get total chunk length in uint16
                 if ( header.length > GIP_MAX_CHUNK_SIZE && buffer[4] == 0x00 ) { // if we see 0xBA and buf[4] == 0, single-byte mode
                     totalChunkLength = (uint16_t)buffer[5]; // byte is correct
@@ -118,13 +125,23 @@ bool XGIPProtocol::parse(const uint8_t * buffer, uint16_t len) {
             if ( header.length > GIP_MAX_CHUNK_SIZE ) { // if length is greater than 0x3A (bigger than 64 bytes), we know it is | 0x80 so we can ^ 0x80 and get the real length
                 copyLength ^= 0x80;  // packet length is set to length | 0x80 (0xBA instead of 0x3A)
             }
-            memcpy(&data[actualDataReceived], &buffer[6], copyLength); // 
+            // Drop chunks that claim more than the packet holds or overrun our data buffer
+            if ( copyLength > (len - 6) || (actualDataReceived + copyLength) > sizeof(data) ) {
+                reset();
+                isValidPacket = false;
+                return false;
+            }
+            memcpy(&data[actualDataReceived], &buffer[6], copyLength); // Append straight from the endpoint buffer
             actualDataReceived += copyLength;
             numberOfChunksSent++; // count our chunks for the ACK
             isValidPacket = true;
         } else {
             reset();
             memcpy((void*)&header, buffer, sizeof(GipHeader_t));
+            if ( header.length > (len - 4) ) { // length claims more than we received
+                isValidPacket = false;
+                return false;
+            }
             if ( header.length > 0 ) {
                 memcpy(data, &buffer[4], header.length); // copy incoming data
             }
@@ -160,7 +177,7 @@ void XGIPProtocol::setAttributes(uint8_t cmd, uint8_t seq, uint8_t internal, uin
 }
 
 bool XGIPProtocol::setData(const uint8_t * buffer, uint16_t len) {
-    if ( len > 0x3000) { // arbitrary but this should cover us if something bad happens
+    if ( len > sizeof(data) ) { // payloads are assembled in data, refuse anything larger
         return false;
     }
     memcpy(data, buffer, len);
@@ -170,18 +187,24 @@ bool XGIPProtocol::setData(const uint8_t * buffer, uint16_t len) {
 
 // Generate XGIP Packet for output
 uint8_t * XGIPProtocol::generatePacket() {
+    generatePacket(packet);
+    return packet;
+}
+
+// Generate XGIP Packet straight into out (at least 64 bytes), e.g. a slot of a report queue
+uint16_t XGIPProtocol::generatePacket(uint8_t * out) {
     if ( header.chunked == 0 ) { // Simple data packet does not require chunk logic
         header.length = (uint8_t)dataLength;
-        memcpy(packet, &header, sizeof(GipHeader_t));
-        memcpy((void*)&packet[4], data, dataLength);
+        memcpy(out, &header, sizeof(GipHeader_t));
+        memcpy((void*)&out[4], data, dataLength);
         packetLength = sizeof(GipHeader_t) + dataLength;
     } else { // Are we a chunk?
         if ( numberOfChunksSent > 0 && totalDataSent == dataLength ) { // General Final Chunk Packet (End-Packet)
             header.needsAck = 0;
             header.length = 0;
-            memcpy(packet, &header, sizeof(GipHeader_t));
-            packet[4] = totalChunkLength & 0x00FF;
-            packet[5] = (totalChunkLength & 0xFF00) >> 8;
+            memcpy(out, &header, sizeof(GipHeader_t));
+            out[4] = totalChunkLength & 0x00FF;
+            out[5] = (totalChunkLength & 0xFF00) >> 8;
             packetLength = sizeof(GipHeader_t) + 2;
             chunkEnded = true;
         } else {
@@ -200,7 +223,9 @@ uint8_t * XGIPProtocol::generatePacket() {
                     uint16_t j = 0;
                     do {
                         if ( i < GIP_MAX_CHUNK_SIZE ) {
-                            if ( (j / 0x100) != ((j + i) / 0x100)) { // if we go 0x100 to 0x200, or 0x200 to 0x300, | 0x80
+                            if ( (j < 0x80) && (j + i >= 0x80) ) { // the last chunk can end the first 0x80 bytes too, move up 0x100
+                                j = j + i + 0x100;
+                            } else if ( (j / 0x100) != ((j + i) / 0x100)) { // if we go 0x100 to 0x200, or 0x200 to 0x300, | 0x80
                                 j = j + (i | 0x80);
                             } else {
                                 j = j + i;
@@ -253,8 +278,8 @@ uint8_t * XGIPProtocol::generatePacket() {
             }
 
             // Copy our header and data to the packet
-            memcpy(packet, &header, sizeof(GipHeader_t));
-            memcpy((void*)&packet[6], &data[totalDataSent], dataToSend);
+            memcpy(out, &header, sizeof(GipHeader_t));
+            memcpy((void*)&out[6], &data[totalDataSent], dataToSend);
 
             // Set our packet length
             packetLength = sizeof(GipHeader_t) + 2 + dataToSend;
@@ -270,12 +295,12 @@ uint8_t * XGIPProtocol::generatePacket() {
 
             // Place value in right-byte if our chunk value is < 0x100
             if ( chunkValue < 0x100 ) {
-                packet[4] = 0x00;
-                packet[5] = (uint8_t) chunkValue;
+                out[4] = 0x00;
+                out[5] = (uint8_t) chunkValue;
             // Split appropriately
             } else {
-                packet[4] = chunkValue & 0x00FF;
-                packet[5] = (chunkValue & 0xFF00) >> 8;
+                out[4] = chunkValue & 0x00FF;
+                out[5] = (chunkValue & 0xFF00) >> 8;
             }
 
             // XGIP Hashing: If we're sending over 0x80, + ( data to send + 0x100 )
@@ -292,34 +317,40 @@ uint8_t * XGIPProtocol::generatePacket() {
             numberOfChunksSent++;        // Number of Chunks sent so far
         }
     }
-    return packet;
+    return packetLength;
 }
 
 uint8_t * XGIPProtocol::generateAckPacket() { // Generate output packet
-    packet[0] = 0x01;
-    packet[1] = 0x20;
-    packet[2] = header.sequence;
-    packet[3] = 0x09;
-    packet[4] = 0x00;
-    packet[5] = header.command;
-    packet[6] = 0x20;
+    generateAckPacket(packet);
+    return packet;
+}
+
+// Generate an ack straight into out (at least 13 bytes)
+uint16_t XGIPProtocol::generateAckPacket(uint8_t * out) {
+    out[0] = 0x01;
+    out[1] = 0x20;
+    out[2] = header.sequence;
+    out[3] = 0x09;
+    out[4] = 0x00;
+    out[5] = header.command;
+    out[6] = 0x20;
 
     // we have to keep track of # of chunks because data received for ACK is +2 for size of chunk
     uint16_t dataReceived = actualDataReceived;
-    packet[7] = dataReceived & 0x00FF;
-    packet[8] = (dataReceived & 0xFF00) >> 8;
-    packet[9] = 0x00;
-    packet[10] = 0x00;
+    out[7] = dataReceived & 0x00FF;
+    out[8] = (dataReceived & 0xFF00) >> 8;
+    out[9] = 0x00;
+    out[10] = 0x00;
     if ( header.chunked == true ) { // Are we a chunk?
         uint16_t left = dataLength - dataReceived;
-        packet[11] = left & 0x00FF;
-        packet[12] = (left & 0xFF00) >> 8;
+        out[11] = left & 0x00FF;
+        out[12] = (left & 0xFF00) >> 8;
     } else {
-        packet[11] = 0;
-        packet[12] = 0;
+        out[11] = 0;
+        out[12] = 0;
     }
     packetLength = 13;
-    return packet;
+    return packetLength;
 }
 
 // Get last generated output packet length
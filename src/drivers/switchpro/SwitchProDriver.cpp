@@ -3,9 +3,6 @@
 #include "storagemanager.h"
 #include "pico/rand.h"
 
-// force a report to be sent every X ms
-#define SWITCH_PRO_KEEPALIVE_TIMER 5
-
 void SwitchProDriver::initialize() {
     //stdio_init_all();
 
@@ -70,7 +67,7 @@ void SwitchProDriver::initialize() {
         .padding = {0x00}
     };
 
-    last_report_timer = to_ms_since_boot(get_absolute_time());
+    keepAliveTimer.reset(to_ms_since_boot(get_absolute_time()));
 
     factoryConfig->leftStickCalibration.getRealMin(leftMinX, leftMinY);
     factoryConfig->leftStickCalibration.getCenter(leftCenX, leftCenY);
@@ -93,7 +90,6 @@ void SwitchProDriver::initialize() {
 }
 
 bool SwitchProDriver::process(Gamepad * gamepad) {
-    uint32_t now = to_ms_since_boot(get_absolute_time());
     reportSent = false;
 
     switchReport.inputs.dpadUp =    ((gamepad->state.dpad & GAMEPAD_MASK_UP) == GAMEPAD_MASK_UP);
@@ -145,11 +141,11 @@ bool SwitchProDriver::process(Gamepad * gamepad) {
 		tud_remote_wakeup();
 
     if (isReportQueued) {
-        if ((now - last_report_timer) > SWITCH_PRO_KEEPALIVE_TIMER) {
+        if (keepAliveTimer.expired(processTime)) {
             if (tud_hid_ready() && sendReport(queuedReportID, report, 64) == true ) {
             }
             isReportQueued = false;
-            last_report_timer = now;
+            keepAliveTimer.reset(processTime);
         }
         reportSent = true;
     }
@@ -160,7 +156,7 @@ bool SwitchProDriver::process(Gamepad * gamepad) {
     processedGamepad->auxState.playerID.value = playerID;
 
     if (isReady && !reportSent) {
-        if ((now - last_report_timer) > SWITCH_PRO_KEEPALIVE_TIMER) {
+        if (keepAliveTimer.expired(processTime)) {
             switchReport.timestamp = last_report_counter;
             void * inputReport = &switchReport;
             uint16_t report_size = sizeof(switchReport);
@@ -171,7 +167,7 @@ bool SwitchProDriver::process(Gamepad * gamepad) {
                     reportSent = true;
                 }
 
-                last_report_timer = now;
+                keepAliveTimer.reset(processTime);
             }
         }
     } else {
@@ -183,7 +179,7 @@ bool SwitchProDriver::process(Gamepad * gamepad) {
                 reportSent = true;
             }
 
-            last_report_timer = now;
+            keepAliveTimer.reset(processTime);
         }
     }
 
@@ -533,7 +529,7 @@ bool SwitchProDriver::vendor_control_xfer_cb(uint8_t rhport, uint8_t stage, tusb
 
 const uint16_t * SwitchProDriver::get_descriptor_string_cb(uint8_t index, uint16_t langid) {
 	const char *value = (const char *)switch_pro_string_descriptors[index];
-	return getStringDescriptor(value, index); // getStringDescriptor returns a static array
+	return getStringDescriptor(value, index);
 }
 
 const uint8_t * SwitchProDriver::get_descriptor_device_cb() {
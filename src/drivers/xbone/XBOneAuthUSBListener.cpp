@@ -52,7 +52,7 @@ void XBOneAuthUSBListener::process() {
 
     // Process waiting (always on first frame)
     if ( xboxOneAuthData->xboneState == GPAuthState::wait_auth_console_to_dongle) {
-        queue_host_report(outgoingXGIP.generatePacket(), outgoingXGIP.getPacketLength());
+        queue_host_packet(outgoingXGIP, false);
         if ( outgoingXGIP.getChunked() == false || outgoingXGIP.endOfChunk() == true) {
             xboxOneAuthData->xboneState = GPAuthState::auth_idle_state;
         }
@@ -63,14 +63,16 @@ void XBOneAuthUSBListener::process() {
 
 }
 
-void XBOneAuthUSBListener::xmount(uint8_t dev_addr, uint8_t instance, uint8_t controllerType, uint8_t subtype) {
+bool XBOneAuthUSBListener::xmount(uint8_t dev_addr, uint8_t instance, uint8_t controllerType, uint8_t subtype) {
     if ( controllerType == xinput_type_t::XBOXONE) {
         xbone_dev_addr = dev_addr;
         xbone_instance = instance;
         incomingXGIP.reset();
         outgoingXGIP.reset();
         mounted = true;
+        return true;
     }
+    return false;
 }
 
 void XBOneAuthUSBListener::unmount(uint8_t dev_addr) {
@@ -98,36 +100,36 @@ void XBOneAuthUSBListener::report_received(uint8_t dev_addr, uint8_t instance, u
 
     // Setup an ack before we change anything about the incoming packet
     if ( incomingXGIP.ackRequired() == true ) {
-        queue_host_report((uint8_t*)incomingXGIP.generateAckPacket(), incomingXGIP.getPacketLength());
+        queue_host_packet(incomingXGIP, true);
     }
 
     switch ( incomingXGIP.getCommand() ) {
         case GIP_ANNOUNCE:
             outgoingXGIP.reset();
             outgoingXGIP.setAttributes(GIP_DEVICE_DESCRIPTOR, 1, 1, false, 0);
-            queue_host_report((uint8_t*)outgoingXGIP.generatePacket(), outgoingXGIP.getPacketLength());
+            queue_host_packet(outgoingXGIP, false);
             break;
         case GIP_DEVICE_DESCRIPTOR:
             if ( incomingXGIP.endOfChunk() == true && xboxOneAuthData->dongle_ready != true) {
                 outgoingXGIP.reset();  // Power-on full string
                 outgoingXGIP.setAttributes(GIP_POWER_MODE_DEVICE_CONFIG, 2, 1, false, 0);
                 outgoingXGIP.setData(XBOXONE_POWER_ON, sizeof(XBOXONE_POWER_ON));
-                queue_host_report((uint8_t*)outgoingXGIP.generatePacket(), outgoingXGIP.getPacketLength());
+                queue_host_packet(outgoingXGIP, false);
 
                 outgoingXGIP.reset();  // Power-on with 0x00
                 outgoingXGIP.setAttributes(GIP_POWER_MODE_DEVICE_CONFIG, 3, 1, false, 0);
                 outgoingXGIP.setData(XBOXONE_POWER_ON_SINGLE, sizeof(XBOXONE_POWER_ON_SINGLE));
-                queue_host_report((uint8_t*)outgoingXGIP.generatePacket(), outgoingXGIP.getPacketLength());
+                queue_host_packet(outgoingXGIP, false);
 
                 outgoingXGIP.reset();  // LED On
                 outgoingXGIP.setAttributes(GIP_CMD_LED_ON, 1, 0, false, 0); // not internal function
                 outgoingXGIP.setData(XBOXONE_LED_ON, sizeof(XBOXONE_LED_ON));
-                queue_host_report((uint8_t*)outgoingXGIP.generatePacket(), outgoingXGIP.getPacketLength());
+                queue_host_packet(outgoingXGIP, false);
 
                 outgoingXGIP.reset();  // Rumble Support to enable dongle
                 outgoingXGIP.setAttributes(GIP_CMD_RUMBLE, 1, 0, false, 0); // not internal function
                 outgoingXGIP.setData(XBOXONE_RUMBLE_ON, sizeof(XBOXONE_RUMBLE_ON));
-                queue_host_report((uint8_t*)outgoingXGIP.generatePacket(), outgoingXGIP.getPacketLength());
+                queue_host_packet(outgoingXGIP, false);
 
                 // Dongle is ready!
                 xboxOneAuthData->dongle_ready = true; // dongle is ready
@@ -149,11 +151,11 @@ void XBOneAuthUSBListener::report_received(uint8_t dev_addr, uint8_t instance, u
     };
 }
 
-void XBOneAuthUSBListener::queue_host_report(void* report, uint16_t len) {
-    report_queue_t new_queue;
-    memcpy(new_queue.report, report, len);
-    new_queue.len = len;
-    report_queue.push(new_queue);
+// Generates the next packet of xgip (or its ack) straight into a new queue entry
+void XBOneAuthUSBListener::queue_host_packet(XGIPProtocol & xgip, bool ack) {
+    report_queue.emplace();
+    report_queue_t & new_queue = report_queue.back();
+    new_queue.len = ack ? xgip.generateAckPacket(new_queue.report) : xgip.generatePacket(new_queue.report);
 }
 
 void XBOneAuthUSBListener::process_report_queue() {
@@ -2,11 +2,10 @@
 #include "drivers/shared/driverhelper.h"
 
 #include "drivers/xbone/XBOneAuth.h"
+#include "drivers/xbone/XBOneReportQueue.h"
 #include "peripheralmanager.h"
 #include "storagemanager.h"
 
-#define XBONE_KEEPALIVE_TIMER 15000
-
 #define USB_SETUP_DEVICE_TO_HOST 0x80
 #define USB_SETUP_HOST_TO_DEVICE 0x00
 #define USB_SETUP_TYPE_VENDOR    0x40
@@ -22,10 +21,6 @@
 #define DESC_EXTENDED_PROPERTIES_DESCRIPTOR 0x0005
 #define REQ_GET_XGIP_HEADER 0x90
 
-// Check report queue every 35 milliseconds
-static uint32_t lastReportQueue = 0;
-#define REPORT_QUEUE_INTERVAL 35
-
 typedef enum {
     READY_ANNOUNCE,
     WAIT_DESCRIPTOR_REQUEST,
@@ -92,14 +87,12 @@ static bool xbox_one_powered_on;
 static uint8_t report_led_mode;
 static uint8_t report_led_brightness;
 
-// Report Queue for big report sizes from dongle
-#include <queue>
-typedef struct {
-    uint8_t report[XBONE_ENDPOINT_SIZE];
-    uint16_t len;
-} report_queue_t;
+// XGIP messages that are not input reports, drained from update() and IN endpoint completions
+static XBOneReportQueue reportQueue;
+static_assert(XBONE_QUEUED_PACKET_SIZE == XBONE_ENDPOINT_SIZE, "Queued XGIP packets must fit the endpoint");
 
-static std::queue<report_queue_t> report_queue;
+// Set when queued traffic went out, the next input report is sent even if unchanged
+static bool input_interrupted = false;
 
 #define XGIP_ACK_WAIT_TIMEOUT 2000
 
@@ -117,6 +110,11 @@ typedef struct {
 
 CFG_TUSB_MEM_SECTION static xboned_interface_t _xboned_itf[CFG_TUD_XBONE];
 
+// An OUT packet that arrived while the ack queue was full. The OUT endpoint stays unarmed until update() handles it,
+// so the console holds back its next packet instead of the ack being lost
+static xboned_interface_t * deferred_out_itf = nullptr;
+static uint32_t deferred_out_len = 0;
+
 static XGIPProtocol * outgoingXGIP = nullptr;
 static XGIPProtocol * incomingXGIP = nullptr;
 static XboxOneAuthData * xboxOneAuthData = nullptr;
@@ -152,8 +150,8 @@ static void xbone_reset(uint8_t rhport) {
     timer_wait_for_announce = to_ms_since_boot(get_absolute_time());
     xbox_one_powered_on = false;
     report_led_mode = 0; // 0 = OFF
-    while(!report_queue.empty())
-        report_queue.pop();
+    reportQueue.clear();
+    deferred_out_itf = nullptr;
 
     // close any endpoints that are open
     tu_memclr(&_xboned_itf, sizeof(_xboned_itf));
@@ -212,11 +210,53 @@ static uint16_t xbone_open(uint8_t rhport, tusb_desc_interface_t const *itf_desc
     return drv_len;
 }
 
-static void queue_xbone_report(void *report, uint16_t report_size) {
-    report_queue_t item;
-    memcpy(item.report, report, report_size);
-    item.len = report_size;
-    report_queue.push(item);
+// Generates the next packet of xgip (or its ack) straight into a queue slot, nothing is generated when the queue is full
+static bool queue_xbone_packet(XboxOneQueuePriority priority, XGIPProtocol * xgip) {
+    report_queue_t * item = reportQueue.reserve(priority);
+    if ( item == nullptr ) {
+        return false;
+    }
+    if ( priority == XBONE_QUEUE_ACK ) {
+        item->len = xgip->generateAckPacket(item->report);
+    } else {
+        item->len = xgip->generatePacket(item->report);
+    }
+    reportQueue.commit(priority);
+    return true;
+}
+
+static bool send_xbone_report(uint8_t const *report, uint16_t report_size) {
+    uint8_t itf = 0;
+    xboned_interface_t *p_xbone = _xboned_itf;
+    for (;; itf++, p_xbone++) {
+        if (itf >= TU_ARRAY_SIZE(_xboned_itf)) {
+            return false;
+        }
+        if (p_xbone->ep_in)
+            break;
+    }
+    if ( tud_ready() &&											// Is the device ready?
+        (p_xbone->ep_in != 0) && (!usbd_edpt_busy(TUD_OPT_RHPORT, p_xbone->ep_in))) // Is the IN endpoint available?
+    {
+        // The transfer reads from the buffer until it completes, so send from our own copy
+        memcpy(p_xbone->epin_buf, report, report_size);
+        usbd_edpt_claim(0, p_xbone->ep_in);										// Take control of IN endpoint
+        usbd_edpt_xfer(0, p_xbone->ep_in, p_xbone->epin_buf, report_size); 	// Send report buffer
+        usbd_edpt_release(0, p_xbone->ep_in);										// Release control of IN endpoint
+
+        // we successfully sent the report
+        return true;
+    }
+    return false;
+}
+
+// Sends the next queued report if the endpoint is free, acks first
+static void process_report_queue(uint32_t now) {
+    report_queue_t * item = reportQueue.next(now);
+    if ( item != nullptr && send_xbone_report(item->report, item->len) ) {
+        reportQueue.sent(now);
+        input_interrupted = true;
+    }
 }
 
 // DevCompatIDsOne sends back XGIP10 data when requested by Windows
@@ -241,6 +281,62 @@ bool xbone_vendor_control_xfer_cb(uint8_t rhport, uint8_t stage,
 	return true;
 }
 
+// Handles a packet from the console in the OUT endpoint buffer and re-arms the endpoint. The caller makes sure the ack
+// queue has room
+static bool receive_xbone_packet(uint8_t rhport, xboned_interface_t * p_xbone, uint32_t xferred_bytes) {
+    // Parse incoming packet and verify its valid
+    incomingXGIP->parse(p_xbone->epout_buf, xferred_bytes);
+
+    // Setup an ack before we change anything about the incoming packet, the ack queue was checked for room
+    if ( incomingXGIP->ackRequired() == true ) {
+        queue_xbone_packet(XBONE_QUEUE_ACK, incomingXGIP);
+    }
+
+    uint8_t command = incomingXGIP->getCommand();
+    if ( command == GIP_ACK_RESPONSE ) {
+        waiting_ack = false;
+    } else if ( command == GIP_DEVICE_DESCRIPTOR ) {
+        // setup descriptor packet
+        outgoingXGIP->reset(); // reset if anything was in there
+        outgoingXGIP->setAttributes(GIP_DEVICE_DESCRIPTOR, incomingXGIP->getSequence(), 1, 1, 0);
+        outgoingXGIP->setData(xboxOneDescriptor, sizeof(xboxOneDescriptor));
+        xboneDriverState = XboxOneDriverState::SEND_DESCRIPTOR;
+    } else if ( command == GIP_POWER_MODE_DEVICE_CONFIG ) {
+        // Power Mode On!
+        xbox_one_powered_on = true;
+    } else if ( command == GIP_CMD_LED_ON ) {
+        // Set all player LEDs to on
+        report_led_mode = incomingXGIP->getData()[1]; // 1 - turn LEDs on
+        report_led_brightness = incomingXGIP->getData()[2]; // 2 - brightness (ignored for now)
+
+        // Send our descriptor if descriptor is waiting (Player 2)
+        if ( xboneDriverState == XboxOneDriverState::WAIT_DESCRIPTOR_REQUEST ) {
+            outgoingXGIP->reset(); // reset if anything was in there
+            outgoingXGIP->setAttributes(GIP_DEVICE_DESCRIPTOR, incomingXGIP->getSequence(), 1, 1, 0);
+            outgoingXGIP->setData(xboxOneDescriptor, sizeof(xboxOneDescriptor));
+            xboneDriverState = XboxOneDriverState::SEND_DESCRIPTOR;
+        }
+    } else if ( command == GIP_CMD_RUMBLE ) {
+        // TO-DO
+    } else if ( command == GIP_AUTH || command == GIP_FINAL_AUTH) {
+        if (incomingXGIP->getDataLength() == 2 && memcmp(incomingXGIP->getData(), authReady, sizeof(authReady))==0 ) {
+            xboxOneAuthData->authCompleted = true;
+            xboneDriverState = AUTH_DONE;
+        }
+        if ( (incomingXGIP->getChunked() == true && incomingXGIP->endOfChunk() == true) ||
+                (incomingXGIP->getChunked() == false )) {
+            xboxOneAuthData->consoleBuffer.setBuffer(incomingXGIP->getData(), incomingXGIP->getDataLength(),
+                incomingXGIP->getSequence(), incomingXGIP->getCommand());
+            xboxOneAuthData->xboneState = GPAuthState::send_auth_console_to_dongle;
+            incomingXGIP->reset();
+        }
+    }
+
+    TU_ASSERT(usbd_edpt_xfer(rhport, p_xbone->ep_out, p_xbone->epout_buf,
+                             sizeof(p_xbone->epout_buf)));
+    return true;
+}
+
 bool xbone_xfer_cb(uint8_t rhport, uint8_t ep_addr, xfer_result_t result,
                      uint32_t xferred_bytes) {
     // Do nothing if we couldn't setup our auth listener
@@ -259,58 +355,16 @@ bool xbone_xfer_cb(uint8_t rhport, uint8_t ep_addr, xfer_result_t result,
     }
 
     if (ep_addr == p_xbone->ep_out) {
-        // Parse incoming packet and verify its valid
-        incomingXGIP->parse(p_xbone->epout_buf, xferred_bytes);
-
-        // Setup an ack before we change anything about the incoming packet
-        if ( incomingXGIP->ackRequired() == true ) {
-            queue_xbone_report((uint8_t*)incomingXGIP->generateAckPacket(), incomingXGIP->getPacketLength());
+        // No room for its ack, leave the packet in epout_buf for update()
+        if ( reportQueue.full(XBONE_QUEUE_ACK) ) {
+            deferred_out_itf = p_xbone;
+            deferred_out_len = xferred_bytes;
+            return true;
         }
-
-        uint8_t command = incomingXGIP->getCommand();
-        if ( command == GIP_ACK_RESPONSE ) {
-            waiting_ack = false;
-        } else if ( command == GIP_DEVICE_DESCRIPTOR ) {
-            // setup descriptor packet
-            outgoingXGIP->reset(); // reset if anything was in there
-            outgoingXGIP->setAttributes(GIP_DEVICE_DESCRIPTOR, incomingXGIP->getSequence(), 1, 1, 0);
-            outgoingXGIP->setData(xboxOneDescriptor, sizeof(xboxOneDescriptor));
-            xboneDriverState = XboxOneDriverState::SEND_DESCRIPTOR;
-        } else if ( command == GIP_POWER_MODE_DEVICE_CONFIG ) {
-            // Power Mode On!
-            xbox_one_powered_on = true;
-        } else if ( command == GIP_CMD_LED_ON ) {
-            // Set all player LEDs to on
-            report_led_mode = incomingXGIP->getData()[1]; // 1 - turn LEDs on
-            report_led_brightness = incomingXGIP->getData()[2]; // 2 - brightness (ignored for now)
-
-            // Send our descriptor if descriptor is waiting (Player 2)
-            if ( xboneDriverState == XboxOneDriverState::WAIT_DESCRIPTOR_REQUEST ) {
-                outgoingXGIP->reset(); // reset if anything was in there
-                outgoingXGIP->setAttributes(GIP_DEVICE_DESCRIPTOR, incomingXGIP->getSequence(), 1, 1, 0);
-                outgoingXGIP->setData(xboxOneDescriptor, sizeof(xboxOneDescriptor));
-                xboneDriverState = XboxOneDriverState::SEND_DESCRIPTOR;
-            }
-        } else if ( command == GIP_CMD_RUMBLE ) {
-            // TO-DO
-        } else if ( command == GIP_AUTH || command == GIP_FINAL_AUTH) {
-            if (incomingXGIP->getDataLength() == 2 && memcmp(incomingXGIP->getData(), authReady, sizeof(authReady))==0 ) {
-                xboxOneAuthData->authCompleted = true;
-                xboneDriverState = AUTH_DONE;
-            }
-            if ( (incomingXGIP->getChunked() == true && incomingXGIP->endOfChunk() == true) ||
-                    (incomingXGIP->getChunked() == false )) {
-                xboxOneAuthData->consoleBuffer.setBuffer(incomingXGIP->getData(), incomingXGIP->getDataLength(),
-                    incomingXGIP->getSequence(), incomingXGIP->getCommand());
-                xboxOneAuthData->xboneState = GPAuthState::send_auth_console_to_dongle;
-                incomingXGIP->reset();
-            }
-        }
-
-        TU_ASSERT(usbd_edpt_xfer(rhport, p_xbone->ep_out, p_xbone->epout_buf,
-                                 sizeof(p_xbone->epout_buf)));
+        return receive_xbone_packet(rhport, p_xbone, xferred_bytes);
     } else if (ep_addr == p_xbone->ep_in) {
-        // Nothing needed
+        // Endpoint is free again, send whatever is waiting
+        process_report_queue(to_ms_since_boot(get_absolute_time()));
     }
     return true;
 }
@@ -353,7 +407,7 @@ void XBOneDriver::initialize() {
         .sof = NULL
     };
 
-    keep_alive_timer = to_ms_since_boot(get_absolute_time());
+    keepAliveTimer.reset(to_ms_since_boot(get_absolute_time()));
     keep_alive_sequence = 1; // sequence starts at 1?
     virtual_keycode_sequence = 0;
     xb1_guide_pressed = false;
@@ -413,9 +467,8 @@ bool XBOneDriver::process(Gamepad * gamepad) {
         return true;
     }
 
-    uint32_t now = to_ms_since_boot(get_absolute_time());
-    // Send Keep-Alive every 15 seconds (keep_alive_timer updates if send is successful)
-    if ( (now - keep_alive_timer) > XBONE_KEEPALIVE_TIMER) {
+    // Send Keep-Alive every 15 seconds (keepAliveTimer resets if send is successful)
+    if ( keepAliveTimer.expired(processTime) ) {
         memset(&xboneReport.Header, 0, sizeof(GipHeader_t));
         GIP_HEADER((&xboneReport), GIP_KEEPALIVE, 1, keep_alive_sequence);
         xboneReport.Header.length = 4;
@@ -423,8 +476,8 @@ bool XBOneDriver::process(Gamepad * gamepad) {
         memcpy(&((uint8_t*)&xboneReport)[4], &keepAlive, sizeof(keepAlive));
         xboneReportSize = sizeof(GipHeader_t) + sizeof(keepAlive);
         // If successful, update our keep alive timer/sequence
-        if ( send_xbone_usb((uint8_t*)&xboneReport, xboneReportSize) == true ) {
-            keep_alive_timer = to_ms_since_boot(get_absolute_time());
+        if ( send_xbone_input((uint8_t*)&xboneReport, xboneReportSize) == true ) {
+            keepAliveTimer.reset(processTime);
             keep_alive_sequence++; // will rollover
             if ( keep_alive_sequence == 0 )
                 keep_alive_sequence = 1;
@@ -455,7 +508,7 @@ bool XBOneDriver::process(Gamepad * gamepad) {
             memcpy(&((uint8_t*)&xboneReport)[4], &xb1_guide_off, sizeof(xb1_guide_off));
             xboneReportSize = sizeof(GipHeader_t) + sizeof(xb1_guide_off);
         }
-        if ( send_xbone_usb((uint8_t*)&xboneReport, xboneReportSize) == true ) {
+        if ( send_xbone_input((uint8_t*)&xboneReport, xboneReportSize) == true ) {
             // On success, update our guide pressed state and virtual key code state
             virtual_keycode_sequence = new_sequence;
             xb1_guide_pressed = !xb1_guide_pressed;
@@ -504,7 +557,7 @@ bool XBOneDriver::process(Gamepad * gamepad) {
     }
 
     // We changed inputs since generating our last report, increment last report counter (but don't update until success)
-    if ( memcmp(&last_report[4], &((uint8_t*)&newInputReport)[4], sizeof(XboxOneGamepad_Data_t)-4) != 0 ) {
+    if ( input_interrupted == true || memcmp(&last_report[4], &((uint8_t*)&newInputReport)[4], sizeof(XboxOneGamepad_Data_t)-4) != 0 ) {
         xboneReportSize = sizeof(XboxOneGamepad_Data_t);
         memcpy(&xboneReport, &newInputReport, xboneReportSize);
         xboneReport.Header.sequence = last_report_counter + 1;
@@ -512,8 +565,9 @@ bool XBOneDriver::process(Gamepad * gamepad) {
             xboneReport.Header.sequence = 1;
 
         // Successfully sent report, actually increment last report counter!
-        if ( send_xbone_usb((uint8_t*)&xboneReport, xboneReportSize) == true ) {
-            if ( memcmp(&last_report[4], &((uint8_t*)&xboneReport)[4], xboneReportSize-4) != 0) {
+        if ( send_xbone_input((uint8_t*)&xboneReport, xboneReportSize) == true ) {
+            if ( input_interrupted == true || memcmp(&last_report[4], &((uint8_t*)&xboneReport)[4], xboneReportSize-4) != 0) {
+                input_interrupted = false;
                 last_report_counter++;
                 if (last_report_counter == 0)
                     last_report_counter = 1;
@@ -521,6 +575,8 @@ bool XBOneDriver::process(Gamepad * gamepad) {
                 return true;
             }
         }
+    } else {
+        reportQueue.setInputPending(false); // nothing new to send
     }
     
     return false;
@@ -540,26 +596,14 @@ bool XBOneDriver::getAuthSent() {
 }
 
 bool XBOneDriver::send_xbone_usb(uint8_t const *report, uint16_t report_size) {
-    uint8_t itf = 0;
-    xboned_interface_t *p_xbone = _xboned_itf;
-    for (;; itf++, p_xbone++) {
-        if (itf >= TU_ARRAY_SIZE(_xboned_itf)) {
-            return false;
-        }
-        if (p_xbone->ep_in)
-            break;
-    }
-    if ( tud_ready() &&											// Is the device ready?
-        (p_xbone->ep_in != 0) && (!usbd_edpt_busy(TUD_OPT_RHPORT, p_xbone->ep_in))) // Is the IN endpoint available?
-    {
-        usbd_edpt_claim(0, p_xbone->ep_in);										// Take control of IN endpoint
-        usbd_edpt_xfer(0, p_xbone->ep_in, (uint8_t *)report, report_size); 	// Send report buffer
-        usbd_edpt_release(0, p_xbone->ep_in);										// Release control of IN endpoint
+    return send_xbone_report(report, report_size);
+}
 
-        // we successfully sent the report
-        return true;
-    }
-    return false;
+// Input reports hold off the report queues until they are sent
+bool XBOneDriver::send_xbone_input(uint8_t const *report, uint16_t report_size) {
+    bool sent = send_xbone_report(report, report_size);
+    reportQueue.setInputPending(!sent);
+    return sent;
 }
 
 // tud_hid_get_report_cb
@@ -594,7 +638,7 @@ bool XBOneDriver::vendor_control_xfer_cb(uint8_t rhport, uint8_t stage, tusb_con
 
 const uint16_t * XBOneDriver::get_descriptor_string_cb(uint8_t index, uint16_t langid) {
     const char *value = (const char *)xbone_get_string_descriptor(index);
-    return getStringDescriptor(value, index); // getStringDescriptor returns a static array
+    return getStringDescriptor(value, index);
 }
 
 const uint8_t * XBOneDriver::get_descriptor_device_cb() {
@@ -619,11 +663,18 @@ void XBOneDriver::set_ack_wait() {
 }
 
 void XBOneDriver::update() {
-    uint32_t now = to_ms_since_boot(get_absolute_time());
+    uint32_t now = processTime;
 
-    // Process our report queue
+    // Start draining our report queues if the endpoint is idle, after that they drain on transfer completion
     process_report_queue(now);
 
+    // A packet from the console is waiting for room in the ack queue
+    if ( deferred_out_itf != nullptr && !reportQueue.full(XBONE_QUEUE_ACK) ) {
+        xboned_interface_t * p_xbone = deferred_out_itf;
+        deferred_out_itf = nullptr;
+        receive_xbone_packet(TUD_OPT_RHPORT, p_xbone, deferred_out_len);
+    }
+
     // Do not add logic until our ACK returns
     if ( waiting_ack == true ) {
         if ((now - waiting_ack_timeout) < XGIP_ACK_WAIT_TIMEOUT) {
@@ -633,6 +684,11 @@ void XBOneDriver::update() {
         }
     }
 
+    // Packets are generated chunk by chunk, only generate the next one once it can be queued
+    if ( reportQueue.full(XBONE_QUEUE_CONTROL) ) {
+        return;
+    }
+
     switch(xboneDriverState) {
         case READY_ANNOUNCE:
             // Xbox One announce must wait around 0.5s before sending
@@ -640,12 +696,15 @@ void XBOneDriver::update() {
                 memcpy((void*)&announcePacket[3], &now, 3);
                 outgoingXGIP->setAttributes(GIP_ANNOUNCE, 1, 1, 0, 0);
                 outgoingXGIP->setData(announcePacket, sizeof(announcePacket));
-                queue_xbone_report(outgoingXGIP->generatePacket(), outgoingXGIP->getPacketLength());
-                xboneDriverState = WAIT_DESCRIPTOR_REQUEST;
+                if ( queue_xbone_packet(XBONE_QUEUE_CONTROL, outgoingXGIP) ) {
+                    xboneDriverState = WAIT_DESCRIPTOR_REQUEST;
+                }
             }
             break;
         case SEND_DESCRIPTOR:
-            queue_xbone_report(outgoingXGIP->generatePacket(), outgoingXGIP->getPacketLength());
+            if ( !queue_xbone_packet(XBONE_QUEUE_CONTROL, outgoingXGIP) ) {
+                break;
+            }
             if ( outgoingXGIP->endOfChunk() == true ) {
                 xboneDriverState = SETUP_AUTH;
             }
@@ -669,8 +728,8 @@ void XBOneDriver::update() {
             }
             
             // Process auth dongle to console
-            if ( xboxOneAuthData->xboneState == GPAuthState::wait_auth_dongle_to_console ) {
-                queue_xbone_report(outgoingXGIP->generatePacket(), outgoingXGIP->getPacketLength());
+            if ( xboxOneAuthData->xboneState == GPAuthState::wait_auth_dongle_to_console &&
+                    queue_xbone_packet(XBONE_QUEUE_CONTROL, outgoingXGIP) ) {
                 if ( outgoingXGIP->getChunked() == false || outgoingXGIP->endOfChunk() == true ) {
                     xboxOneAuthData->xboneState = GPAuthState::auth_idle_state;
                 }
@@ -686,19 +745,6 @@ void XBOneDriver::update() {
     };
 }
 
-void XBOneDriver::process_report_queue(uint32_t now) {
-    if ( !report_queue.empty() && (now - lastReportQueue) > REPORT_QUEUE_INTERVAL ) {
-        if ( send_xbone_usb(report_queue.front().report, report_queue.front().len) ) {
-            memcpy(last_report, &report_queue.front().report, report_queue.front().len);
-            report_queue.pop();
-            lastReportQueue = now;
-        } else {
-            // THIS IS REQUIRED FOR TIMING ON PC / CONSOLE
-            sleep_ms(REPORT_QUEUE_INTERVAL); // sleep while we wait, never happens during input only auth
-        }
-    }
-}
-
 uint16_t XBOneDriver::GetJoystickMidValue() {
     return GAMEPAD_JOYSTICK_MID;
 }
@@ -2,6 +2,8 @@
 #include "drivers/xboxog/xid/xid.h"
 #include "drivers/shared/driverhelper.h"
 
+#include <algorithm>
+
 void XboxOriginalDriver::initialize() {
     xboxOriginalReport = {
         .dButtons = 0,
@@ -36,21 +38,21 @@ bool XboxOriginalDriver::process(Gamepad * gamepad) {
 		| (gamepad->pressedR3()    ? XID_RS     : 0)
 	;
 
-    // analog buttons - convert to digital
-    xboxOriginalReport.A     = (gamepad->pressedB1() ? 0xFF : 0);
-    xboxOriginalReport.B     = (gamepad->pressedB2() ? 0xFF : 0);
-    xboxOriginalReport.X     = (gamepad->pressedB3() ? 0xFF : 0);
-    xboxOriginalReport.Y     = (gamepad->pressedB4() ? 0xFF : 0);
-    xboxOriginalReport.BLACK = (gamepad->pressedR1() ? 0xFF : 0);
-    xboxOriginalReport.WHITE = (gamepad->pressedL1() ? 0xFF : 0);
+    // analog buttons - pressure where an analog source drives the button, full scale otherwise
+    xboxOriginalReport.A     = gamepad->pressureButton(GAMEPAD_MASK_B1);
+    xboxOriginalReport.B     = gamepad->pressureButton(GAMEPAD_MASK_B2);
+    xboxOriginalReport.X     = gamepad->pressureButton(GAMEPAD_MASK_B3);
+    xboxOriginalReport.Y     = gamepad->pressureButton(GAMEPAD_MASK_B4);
+    xboxOriginalReport.BLACK = gamepad->pressureButton(GAMEPAD_MASK_R1);
+    xboxOriginalReport.WHITE = gamepad->pressureButton(GAMEPAD_MASK_L1);
 
     // analog triggers
 	if (gamepad->hasAnalogTriggers) {
-		xboxOriginalReport.L = gamepad->pressedL2() ? 0xFF : gamepad->state.lt;
-		xboxOriginalReport.R = gamepad->pressedR2() ? 0xFF : gamepad->state.rt;
+		xboxOriginalReport.L = std::max(gamepad->pressureButton(GAMEPAD_MASK_L2), gamepad->state.lt);
+		xboxOriginalReport.R = std::max(gamepad->pressureButton(GAMEPAD_MASK_R2), gamepad->state.rt);
 	} else {
-		xboxOriginalReport.L = gamepad->pressedL2() ? 0xFF : 0;
-		xboxOriginalReport.R = gamepad->pressedR2() ? 0xFF : 0;
+		xboxOriginalReport.L = gamepad->pressureButton(GAMEPAD_MASK_L2);
+		xboxOriginalReport.R = gamepad->pressureButton(GAMEPAD_MASK_R2);
 	}
 
     // analog sticks
@@ -106,7 +108,7 @@ bool XboxOriginalDriver::vendor_control_xfer_cb(uint8_t rhport, uint8_t stage, t
 
 const uint16_t * XboxOriginalDriver::get_descriptor_string_cb(uint8_t index, uint16_t langid) {
 	const char *value = (const char *)xboxoriginal_string_descriptors[index];
-	return getStringDescriptor(value, index); // getStringDescriptor returns a static array
+	return getStringDescriptor(value, index);
 }
 
 const uint8_t * XboxOriginalDriver::get_descriptor_device_cb() {
@@ -57,7 +57,7 @@ bool XInputAuthUSBListener::xinputh_vendor_report(tusb_dir_t dir, uint8_t reques
     return tuh_control_xfer(&xfer);
 }
 
-void XInputAuthUSBListener::xmount(uint8_t dev_addr, uint8_t instance, uint8_t controllerType, uint8_t subtype) {
+bool XInputAuthUSBListener::xmount(uint8_t dev_addr, uint8_t instance, uint8_t controllerType, uint8_t subtype) {
     if ( controllerType == xinput_type_t::XBOX360) {
         xinput_dev_addr = dev_addr;
         xinput_instance = instance;
@@ -73,7 +73,9 @@ void XInputAuthUSBListener::xmount(uint8_t dev_addr, uint8_t instance, uint8_t c
             auth_dongle_get_serial();
         }
         xinputAuthData->dongle_ready = true;
+        return true;
     }
+    return false;
 }
 
 void XInputAuthUSBListener::unmount(uint8_t dev_addr) {
@@ -7,6 +7,8 @@
 #include "drivers/shared/driverhelper.h"
 #include "storagemanager.h"
 
+#include <algorithm>
+
 #define USB_SETUP_DEVICE_TO_HOST 0x80
 #define USB_SETUP_HOST_TO_DEVICE 0x00
 #define USB_SETUP_TYPE_VENDOR    0x40
@@ -212,6 +214,28 @@ void XInputDriver::initialize() {
         }
     }
 
+    // Descriptors are built once here, the host reads them several times during enumeration
+    memcpy(configDescriptor, &xinput_configuration_descriptor, sizeof(xinput_configuration_descriptor));
+    if (deviceType == InputModeDeviceType::INPUT_MODE_DEVICE_TYPE_WHEEL) {
+        // wheel
+        configDescriptor[22] = XInputSubtype::XINPUT_SUBTYPE_WHEEL;
+    } else if (deviceType == InputModeDeviceType::INPUT_MODE_DEVICE_TYPE_GUITAR) {
+        // guitar
+        configDescriptor[22] = XInputSubtype::XINPUT_SUBTYPE_GUITAR;
+    } else if (deviceType == InputModeDeviceType::INPUT_MODE_DEVICE_TYPE_DRUM) {
+        // drum
+        configDescriptor[22] = XInputSubtype::XINPUT_SUBTYPE_DRUMS;
+    } else {
+        // assume gamepad if not special cased
+        configDescriptor[22] = XInputSubtype::XINPUT_SUBTYPE_GAMEPAD;
+    }
+
+    memcpy(deviceDescriptor, xinput_device_descriptor, sizeof(xinput_device_descriptor));
+    if ( gamepadOptions.usbOverrideID == true ) {
+        memcpy(&deviceDescriptor[8], (uint8_t*)&gamepadOptions.usbVendorID, sizeof(uint16_t)); // Vendor ID
+        memcpy(&deviceDescriptor[10], (uint8_t*)&gamepadOptions.usbProductID, sizeof(uint16_t)); // Product ID
+    }
+
     class_driver = {
     #if CFG_TUSB_DEBUG >= 2
         .name = "XINPUT",
@@ -282,13 +306,13 @@ bool XInputDriver::process(Gamepad * gamepad) {
 
     if (gamepad->hasAnalogTriggers)
     {
-        xinputReport.lt = gamepad->pressedL2() ? 0xFF : gamepad->state.lt;
-        xinputReport.rt = gamepad->pressedR2() ? 0xFF : gamepad->state.rt;
+        xinputReport.lt = std::max(gamepad->pressureButton(GAMEPAD_MASK_L2), gamepad->state.lt);
+        xinputReport.rt = std::max(gamepad->pressureButton(GAMEPAD_MASK_R2), gamepad->state.rt);
     }
     else
     {
-        xinputReport.lt = gamepad->pressedL2() ? 0xFF : 0;
-        xinputReport.rt = gamepad->pressedR2() ? 0xFF : 0;
+        xinputReport.lt = gamepad->pressureButton(GAMEPAD_MASK_L2);
+        xinputReport.rt = gamepad->pressureButton(GAMEPAD_MASK_R2);
     }
 
     // map to Xinput for special buttons
@@ -507,20 +531,11 @@ const uint16_t * XInputDriver::get_descriptor_string_cb(uint8_t index, uint16_t
     } else {
         value = (char *)xinput_get_string_descriptor(index);
     }
-    return getStringDescriptor((const char*)value, index); // getStringDescriptor returns a static array
+    return getStringDescriptor((const char*)value, index);
 }
 
 const uint8_t * XInputDriver::get_descriptor_device_cb() {
-    // Check for override settings
-    GamepadOptions & gamepadOptions = Storage::getInstance().getGamepadOptions();
-    if ( gamepadOptions.usbOverrideID == true ) {
-        static uint8_t modified_device_descriptor[18];
-        memcpy(modified_device_descriptor, xinput_device_descriptor, sizeof(xinput_device_descriptor));
-        memcpy(&modified_device_descriptor[8], (uint8_t*)&gamepadOptions.usbVendorID, sizeof(uint16_t)); // Vendor ID
-        memcpy(&modified_device_descriptor[10], (uint8_t*)&gamepadOptions.usbProductID, sizeof(uint16_t)); // Product ID
-        return (const uint8_t*)modified_device_descriptor;
-    }
-    return xinput_device_descriptor;
+    return deviceDescriptor;
 }
 
 const uint8_t * XInputDriver::get_hid_descriptor_report_cb(uint8_t itf) {
@@ -528,26 +543,6 @@ const uint8_t * XInputDriver::get_hid_descriptor_report_cb(uint8_t itf) {
 }
 
 const uint8_t * XInputDriver::get_descriptor_configuration_cb(uint8_t index) {
-    uint16_t configDescriptorSize = sizeof(xinput_configuration_descriptor);
-    memcpy(configDescriptor, &xinput_configuration_descriptor, configDescriptorSize);
-
-    // check subtype
-    GamepadOptions & gamepadOptions = Storage::getInstance().getGamepadOptions();
-    deviceType = gamepadOptions.inputDeviceType;
-    if (deviceType == InputModeDeviceType::INPUT_MODE_DEVICE_TYPE_WHEEL) {
-        // wheel
-        configDescriptor[22] = XInputSubtype::XINPUT_SUBTYPE_WHEEL;
-    } else if (deviceType == InputModeDeviceType::INPUT_MODE_DEVICE_TYPE_GUITAR) {
-        // guitar
-        configDescriptor[22] = XInputSubtype::XINPUT_SUBTYPE_GUITAR;
-    } else if (deviceType == InputModeDeviceType::INPUT_MODE_DEVICE_TYPE_DRUM) {
-        // drum
-        configDescriptor[22] = XInputSubtype::XINPUT_SUBTYPE_DRUMS;
-    } else {
-        // assume gamepad if not special cased
-        configDescriptor[22] = XInputSubtype::XINPUT_SUBTYPE_GAMEPAD;
-    }
-
     return configDescriptor;
 }
 
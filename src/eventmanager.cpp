@@ -1,12 +1,14 @@
 #include "eventmanager.h"
 #include "storagemanager.h"
 #include "enums.pb.h"
+#include "memorytracker.h"
 
 void EventManager::init() {
     clearEventHandlers();
 }
 
 void EventManager::registerEventHandler(GPEventType eventType, EventFunction handler) {
+    MemoryTracker::Scope memoryScope(MemoryTracker::TAG_EVENTS);
     typename std::vector<EventEntry>::iterator it = std::find_if(eventList.begin(), eventList.end(), [&eventType](const EventEntry& entry) { return entry.first == eventType; });
 
     if (it != eventList.end()) {
@@ -34,17 +36,22 @@ void EventManager::unregisterEventHandler(GPEventType eventType, EventFunction h
 }
 
 void EventManager::triggerEvent(GPEvent* event) {
-    GPEventType eventType = event->eventType();
+    triggerEvent(*event);
+    delete event;
+}
+
+void EventManager::triggerEvent(GPEvent& event) {
+    MemoryTracker::Scope memoryScope(MemoryTracker::TAG_EVENTS);
+    GPEventType eventType = event.eventType();
     for (typename std::vector<EventEntry>::const_iterator it = eventList.begin(); it != eventList.end(); ++it) {
         if (it->first == eventType) {
             // Call all event handlers for the specified event
             const std::vector<EventFunction>& handlers = it->second;
             for (typename std::vector<EventFunction>::const_iterator handler = handlers.begin(); handler != handlers.end(); ++handler) {
-                (*handler)(event);
+                (*handler)(&event);
             }
         }
     }
-    delete event;
 }
 
 void EventManager::clearEventHandlers() {
@@ -15,6 +15,9 @@
 #include "drivermanager.h"
 #include "storagemanager.h"
 #include "system.h"
+#include "bootarena.h"
+
+#include <cstring>
 
 // MUST BE DEFINED for mpgs
 uint32_t getMillis() {
@@ -29,6 +32,57 @@ Gamepad::Gamepad() :
 	options(Storage::getInstance().getGamepadOptions())
 	, hotkeyOptions(Storage::getInstance().getHotkeyOptions())
 {
+	// The mappings live as long as the gamepad, setup() only assigns their pins
+	mapDpadUp       = BootArena::create<GamepadButtonMapping>(GAMEPAD_MASK_UP);
+	mapDpadDown     = BootArena::create<GamepadButtonMapping>(GAMEPAD_MASK_DOWN);
+	mapDpadLeft     = BootArena::create<GamepadButtonMapping>(GAMEPAD_MASK_LEFT);
+	mapDpadRight    = BootArena::create<GamepadButtonMapping>(GAMEPAD_MASK_RIGHT);
+	mapButtonB1     = BootArena::create<GamepadButtonMapping>(GAMEPAD_MASK_B1);
+	mapButtonB2     = BootArena::create<GamepadButtonMapping>(GAMEPAD_MASK_B2);
+	mapButtonB3     = BootArena::create<GamepadButtonMapping>(GAMEPAD_MASK_B3);
+	mapButtonB4     = BootArena::create<GamepadButtonMapping>(GAMEPAD_MASK_B4);
+	mapButtonL1     = BootArena::create<GamepadButtonMapping>(GAMEPAD_MASK_L1);
+	mapButtonR1     = BootArena::create<GamepadButtonMapping>(GAMEPAD_MASK_R1);
+	mapButtonL2     = BootArena::create<GamepadButtonMapping>(GAMEPAD_MASK_L2);
+	mapButtonR2     = BootArena::create<GamepadButtonMapping>(GAMEPAD_MASK_R2);
+	mapButtonS1     = BootArena::create<GamepadButtonMapping>(GAMEPAD_MASK_S1);
+	mapButtonS2     = BootArena::create<GamepadButtonMapping>(GAMEPAD_MASK_S2);
+	mapButtonL3     = BootArena::create<GamepadButtonMapping>(GAMEPAD_MASK_L3);
+	mapButtonR3     = BootArena::create<GamepadButtonMapping>(GAMEPAD_MASK_R3);
+	mapButtonA1     = BootArena::create<GamepadButtonMapping>(GAMEPAD_MASK_A1);
+	mapButtonA2     = BootArena::create<GamepadButtonMapping>(GAMEPAD_MASK_A2);
+	mapButtonA3     = BootArena::create<GamepadButtonMapping>(GAMEPAD_MASK_A3);
+	mapButtonA4     = BootArena::create<GamepadButtonMapping>(GAMEPAD_MASK_A4);
+	mapButtonE1     = BootArena::create<GamepadButtonMapping>(GAMEPAD_MASK_E1);
+	mapButtonE2     = BootArena::create<GamepadButtonMapping>(GAMEPAD_MASK_E2);
+	mapButtonE3     = BootArena::create<GamepadButtonMapping>(GAMEPAD_MASK_E3);
+	mapButtonE4     = BootArena::create<GamepadButtonMapping>(GAMEPAD_MASK_E4);
+	mapButtonE5     = BootArena::create<GamepadButtonMapping>(GAMEPAD_MASK_E5);
+	mapButtonE6     = BootArena::create<GamepadButtonMapping>(GAMEPAD_MASK_E6);
+	mapButtonE7     = BootArena::create<GamepadButtonMapping>(GAMEPAD_MASK_E7);
+	mapButtonE8     = BootArena::create<GamepadButtonMapping>(GAMEPAD_MASK_E8);
+	mapButtonE9     = BootArena::create<GamepadButtonMapping>(GAMEPAD_MASK_E9);
+	mapButtonE10    = BootArena::create<GamepadButtonMapping>(GAMEPAD_MASK_E10);
+	mapButtonE11    = BootArena::create<GamepadButtonMapping>(GAMEPAD_MASK_E11);
+	mapButtonE12    = BootArena::create<GamepadButtonMapping>(GAMEPAD_MASK_E12);
+	mapButtonFn     = BootArena::create<GamepadButtonMapping>(AUX_MASK_FUNCTION);
+	mapButtonDP     = BootArena::create<GamepadButtonMapping>(SUSTAIN_DP_MODE_DP);
+	mapButtonLS     = BootArena::create<GamepadButtonMapping>(SUSTAIN_DP_MODE_LS);
+	mapButtonRS     = BootArena::create<GamepadButtonMapping>(SUSTAIN_DP_MODE_RS);
+	mapDigitalUp    = BootArena::create<GamepadButtonMapping>(GAMEPAD_MASK_UP);
+	mapDigitalDown  = BootArena::create<GamepadButtonMapping>(GAMEPAD_MASK_DOWN);
+	mapDigitalLeft  = BootArena::create<GamepadButtonMapping>(GAMEPAD_MASK_LEFT);
+	mapDigitalRight = BootArena::create<GamepadButtonMapping>(GAMEPAD_MASK_RIGHT);
+	mapAnalogLSXNeg = BootArena::create<GamepadButtonMapping>(ANALOG_DIRECTION_LS_X_NEG);
+	mapAnalogLSXPos = BootArena::create<GamepadButtonMapping>(ANALOG_DIRECTION_LS_X_POS);
+	mapAnalogLSYNeg = BootArena::create<GamepadButtonMapping>(ANALOG_DIRECTION_LS_Y_NEG);
+	mapAnalogLSYPos = BootArena::create<GamepadButtonMapping>(ANALOG_DIRECTION_LS_Y_POS);
+	mapAnalogRSXNeg = BootArena::create<GamepadButtonMapping>(ANALOG_DIRECTION_RS_X_NEG);
+	mapAnalogRSXPos = BootArena::create<GamepadButtonMapping>(ANALOG_DIRECTION_RS_X_POS);
+	mapAnalogRSYNeg = BootArena::create<GamepadButtonMapping>(ANALOG_DIRECTION_RS_Y_NEG);
+	mapAnalogRSYPos = BootArena::create<GamepadButtonMapping>(ANALOG_DIRECTION_RS_Y_POS);
+	map48WayMode    = BootArena::create<GamepadButtonMapping>(SUSTAIN_4_8_WAY_MODE);
+	mapFocusMode    = BootArena::create<GamepadButtonMapping>(SUSTAIN_FOCUS_MODE);
 }
 
 void Gamepad::setup()
@@ -36,57 +90,6 @@ void Gamepad::setup()
 	// Configure pin mapping
 	GpioMappingInfo* pinMappings = Storage::getInstance().getProfilePinMappings();
 
-	mapDpadUp       = new GamepadButtonMapping(GAMEPAD_MASK_UP);
-	mapDpadDown     = new GamepadButtonMapping(GAMEPAD_MASK_DOWN);
-	mapDpadLeft     = new GamepadButtonMapping(GAMEPAD_MASK_LEFT);
-	mapDpadRight    = new GamepadButtonMapping(GAMEPAD_MASK_RIGHT);
-	mapButtonB1     = new GamepadButtonMapping(GAMEPAD_MASK_B1);
-	mapButtonB2     = new GamepadButtonMapping(GAMEPAD_MASK_B2);
-	mapButtonB3     = new GamepadButtonMapping(GAMEPAD_MASK_B3);
-	mapButtonB4     = new GamepadButtonMapping(GAMEPAD_MASK_B4);
-	mapButtonL1     = new GamepadButtonMapping(GAMEPAD_MASK_L1);
-	mapButtonR1     = new GamepadButtonMapping(GAMEPAD_MASK_R1);
-	mapButtonL2     = new GamepadButtonMapping(GAMEPAD_MASK_L2);
-	mapButtonR2     = new GamepadButtonMapping(GAMEPAD_MASK_R2);
-	mapButtonS1     = new GamepadButtonMapping(GAMEPAD_MASK_S1);
-	mapButtonS2     = new GamepadButtonMapping(GAMEPAD_MASK_S2);
-	mapButtonL3     = new GamepadButtonMapping(GAMEPAD_MASK_L3);
-	mapButtonR3     = new GamepadButtonMapping(GAMEPAD_MASK_R3);
-	mapButtonA1     = new GamepadButtonMapping(GAMEPAD_MASK_A1);
-	mapButtonA2     = new GamepadButtonMapping(GAMEPAD_MASK_A2);
-	mapButtonA3     = new GamepadButtonMapping(GAMEPAD_MASK_A3);
-	mapButtonA4     = new GamepadButtonMapping(GAMEPAD_MASK_A4);
-	mapButtonE1     = new GamepadButtonMapping(GAMEPAD_MASK_E1);
-	mapButtonE2     = new GamepadButtonMapping(GAMEPAD_MASK_E2);
-	mapButtonE3     = new GamepadButtonMapping(GAMEPAD_MASK_E3);
-	mapButtonE4     = new GamepadButtonMapping(GAMEPAD_MASK_E4);
-	mapButtonE5     = new GamepadButtonMapping(GAMEPAD_MASK_E5);
-	mapButtonE6     = new GamepadButtonMapping(GAMEPAD_MASK_E6);
-	mapButtonE7     = new GamepadButtonMapping(GAMEPAD_MASK_E7);
-	mapButtonE8     = new GamepadButtonMapping(GAMEPAD_MASK_E8);
-	mapButtonE9     = new GamepadButtonMapping(GAMEPAD_MASK_E9);
-	mapButtonE10    = new GamepadButtonMapping(GAMEPAD_MASK_E10);
-	mapButtonE11    = new GamepadButtonMapping(GAMEPAD_MASK_E11);
-	mapButtonE12    = new GamepadButtonMapping(GAMEPAD_MASK_E12);
-	mapButtonFn     = new GamepadButtonMapping(AUX_MASK_FUNCTION);
-	mapButtonDP     = new GamepadButtonMapping(SUSTAIN_DP_MODE_DP);
-	mapButtonLS     = new GamepadButtonMapping(SUSTAIN_DP_MODE_LS);
-	mapButtonRS     = new GamepadButtonMapping(SUSTAIN_DP_MODE_RS);
-	mapDigitalUp    = new GamepadButtonMapping(GAMEPAD_MASK_UP);
-	mapDigitalDown  = new GamepadButtonMapping(GAMEPAD_MASK_DOWN);
-	mapDigitalLeft  = new GamepadButtonMapping(GAMEPAD_MASK_LEFT);
-	mapDigitalRight = new GamepadButtonMapping(GAMEPAD_MASK_RIGHT);
-	mapAnalogLSXNeg = new GamepadButtonMapping(ANALOG_DIRECTION_LS_X_NEG);
-	mapAnalogLSXPos = new GamepadButtonMapping(ANALOG_DIRECTION_LS_X_POS);
-	mapAnalogLSYNeg = new GamepadButtonMapping(ANALOG_DIRECTION_LS_Y_NEG);
-	mapAnalogLSYPos = new GamepadButtonMapping(ANALOG_DIRECTION_LS_Y_POS);
-	mapAnalogRSXNeg = new GamepadButtonMapping(ANALOG_DIRECTION_RS_X_NEG);
-	mapAnalogRSXPos = new GamepadButtonMapping(ANALOG_DIRECTION_RS_X_POS);
-	mapAnalogRSYNeg = new GamepadButtonMapping(ANALOG_DIRECTION_RS_Y_NEG);
-	mapAnalogRSYPos = new GamepadButtonMapping(ANALOG_DIRECTION_RS_Y_POS);
-	map48WayMode    = new GamepadButtonMapping(SUSTAIN_4_8_WAY_MODE);
-	mapFocusMode    = new GamepadButtonMapping(SUSTAIN_FOCUS_MODE);
-
 	const auto assignCustomMappingToMaps = [&](GpioMappingInfo mapInfo, Pin_t pin) -> void {
 		if (mapDpadUp->buttonMask & mapInfo.customDpadMask)	mapDpadUp->pinMask |= 1 << pin;
 		if (mapDpadDown->buttonMask & mapInfo.customDpadMask)	mapDpadDown->pinMask |= 1 << pin;
@@ -189,61 +192,85 @@ void Gamepad::setup()
 	hotkeys[15] = hotkeyOptions.hotkey16;
 }
 
+void Gamepad::updateStateGeneration()
+{
+	// Only the fields that end up in reports, the EMA filter state changes without affecting them
+	if (state.dpad != generationState.dpad ||
+		state.buttons != generationState.buttons ||
+		state.aux != generationState.aux ||
+		state.lx != generationState.lx ||
+		state.ly != generationState.ly ||
+		state.rx != generationState.rx ||
+		state.ry != generationState.ry ||
+		state.lt != generationState.lt ||
+		state.rt != generationState.rt ||
+		auxState.analogButtons.buttons != generationAnalogButtons.buttons ||
+		auxState.analogButtons.dpad != generationAnalogButtons.dpad ||
+		memcmp(auxState.analogButtons.buttonValues, generationAnalogButtons.buttonValues, sizeof(generationAnalogButtons.buttonValues)) != 0 ||
+		memcmp(auxState.analogButtons.dpadValues, generationAnalogButtons.dpadValues, sizeof(generationAnalogButtons.dpadValues)) != 0)
+	{
+		generationState = state;
+		generationAnalogButtons = auxState.analogButtons;
+		stateGeneration++;
+		stateGenerationTime = readTime;
+	}
+}
+
 /**
- * @brief Undo setup().
+ * @brief Undo setup() by clearing the pins of every mapping.
  */
 void Gamepad::reinit()
 {
-	delete mapDpadUp;
-	delete mapDpadDown;
-	delete mapDpadLeft;
-	delete mapDpadRight;
-	delete mapButtonB1;
-	delete mapButtonB2;
-	delete mapButtonB3;
-	delete mapButtonB4;
-	delete mapButtonL1;
-	delete mapButtonR1;
-	delete mapButtonL2;
-	delete mapButtonR2;
-	delete mapButtonS1;
-	delete mapButtonS2;
-	delete mapButtonL3;
-	delete mapButtonR3;
-	delete mapButtonA1;
-	delete mapButtonA2;
-	delete mapButtonA3;
-	delete mapButtonA4;
-	delete mapButtonE1;
-	delete mapButtonE2;
-	delete mapButtonE3;
-	delete mapButtonE4;
-	delete mapButtonE5;
-	delete mapButtonE6;
-	delete mapButtonE7;
-	delete mapButtonE8;
-	delete mapButtonE9;
-	delete mapButtonE10;
-	delete mapButtonE11;
-	delete mapButtonE12;
-	delete mapButtonFn;
-	delete mapButtonDP;
-	delete mapButtonLS;
-	delete mapButtonRS;
-	delete mapDigitalUp;
-	delete mapDigitalDown;
-	delete mapDigitalLeft;
-	delete mapDigitalRight;
-	delete mapAnalogLSXNeg;
-	delete mapAnalogLSXPos;
-	delete mapAnalogLSYNeg;
-	delete mapAnalogLSYPos;
-	delete mapAnalogRSXNeg;
-	delete mapAnalogRSXPos;
-	delete mapAnalogRSYNeg;
-	delete mapAnalogRSYPos;
-	delete map48WayMode;
-	delete mapFocusMode;
+	mapDpadUp->pinMask = 0;
+	mapDpadDown->pinMask = 0;
+	mapDpadLeft->pinMask = 0;
+	mapDpadRight->pinMask = 0;
+	mapButtonB1->pinMask = 0;
+	mapButtonB2->pinMask = 0;
+	mapButtonB3->pinMask = 0;
+	mapButtonB4->pinMask = 0;
+	mapButtonL1->pinMask = 0;
+	mapButtonR1->pinMask = 0;
+	mapButtonL2->pinMask = 0;
+	mapButtonR2->pinMask = 0;
+	mapButtonS1->pinMask = 0;
+	mapButtonS2->pinMask = 0;
+	mapButtonL3->pinMask = 0;
+	mapButtonR3->pinMask = 0;
+	mapButtonA1->pinMask = 0;
+	mapButtonA2->pinMask = 0;
+	mapButtonA3->pinMask = 0;
+	mapButtonA4->pinMask = 0;
+	mapButtonE1->pinMask = 0;
+	mapButtonE2->pinMask = 0;
+	mapButtonE3->pinMask = 0;
+	mapButtonE4->pinMask = 0;
+	mapButtonE5->pinMask = 0;
+	mapButtonE6->pinMask = 0;
+	mapButtonE7->pinMask = 0;
+	mapButtonE8->pinMask = 0;
+	mapButtonE9->pinMask = 0;
+	mapButtonE10->pinMask = 0;
+	mapButtonE11->pinMask = 0;
+	mapButtonE12->pinMask = 0;
+	mapButtonFn->pinMask = 0;
+	mapButtonDP->pinMask = 0;
+	mapButtonLS->pinMask = 0;
+	mapButtonRS->pinMask = 0;
+	mapDigitalUp->pinMask = 0;
+	mapDigitalDown->pinMask = 0;
+	mapDigitalLeft->pinMask = 0;
+	mapDigitalRight->pinMask = 0;
+	mapAnalogLSXNeg->pinMask = 0;
+	mapAnalogLSXPos->pinMask = 0;
+	mapAnalogLSYNeg->pinMask = 0;
+	mapAnalogLSYPos->pinMask = 0;
+	mapAnalogRSXNeg->pinMask = 0;
+	mapAnalogRSXPos->pinMask = 0;
+	mapAnalogRSYNeg->pinMask = 0;
+	mapAnalogRSYPos->pinMask = 0;
+	map48WayMode->pinMask = 0;
+	mapFocusMode->pinMask = 0;
 
 	// reinitialize pin mappings
 	this->setup();
@@ -320,6 +347,8 @@ void Gamepad::process()
 
 void Gamepad::read()
 {
+	readTime = time_us_32();
+
 	Mask_t values = Storage::getInstance().GetGamepad()->debouncedGpio;
 
 	// Get the midpoint value for the current mode
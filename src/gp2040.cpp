@@ -10,6 +10,9 @@
 #include "addonmanager.h"
 #include "types.h"
 #include "usbhostmanager.h"
+#include "adcservice.h"
+#include "memorytracker.h"
+#include "bootarena.h"
 
 // Inputs for Core0
 #include "addons/analog.h"
@@ -64,8 +67,8 @@ void GP2040::setup() {
 	PeripheralManager::getInstance().initSPI();
 	PeripheralManager::getInstance().initI2C();
 
-	Gamepad * gamepad = new Gamepad();
-	Gamepad * processedGamepad = new Gamepad();
+	Gamepad * gamepad = BootArena::create<Gamepad>();
+	Gamepad * processedGamepad = BootArena::create<Gamepad>();
 	Storage::getInstance().SetGamepad(gamepad);
 	Storage::getInstance().SetProcessedGamepad(processedGamepad);
 
@@ -104,27 +107,27 @@ void GP2040::setup() {
 	adc_init();
 
 	// Setup Add-ons
-	addons.LoadUSBAddon(new KeyboardHostAddon());
-	addons.LoadUSBAddon(new GamepadUSBHostAddon());
-	addons.LoadAddon(new AnalogInput());
-	addons.LoadAddon(new HETriggerAddon());
-	addons.LoadAddon(new BootselButtonAddon());
-	addons.LoadAddon(new DualDirectionalInput());
-	addons.LoadAddon(new FocusModeAddon());
-	addons.LoadAddon(new I2CAnalog1219Input());
-	addons.LoadAddon(new SPIAnalog1256Input());
-	addons.LoadAddon(new WiiExtensionInput());
-	addons.LoadAddon(new SNESpadInput());
-	addons.LoadAddon(new SliderSOCDInput());
-	addons.LoadAddon(new TiltInput());
-	addons.LoadAddon(new RotaryEncoderInput());
-	addons.LoadAddon(new PCF8575Addon());
-	addons.LoadAddon(new TG16padInput());
+	addons.LoadUSBAddon(BootArena::create<KeyboardHostAddon>());
+	addons.LoadUSBAddon(BootArena::create<GamepadUSBHostAddon>());
+	addons.LoadAddon(BootArena::create<AnalogInput>());
+	addons.LoadAddon(BootArena::create<BootselButtonAddon>());
+	addons.LoadAddon(BootArena::create<HETriggerAddon>()); // after the add-ons that only add digital presses
+	addons.LoadAddon(BootArena::create<DualDirectionalInput>());
+	addons.LoadAddon(BootArena::create<FocusModeAddon>());
+	addons.LoadAddon(BootArena::create<I2CAnalog1219Input>());
+	addons.LoadAddon(BootArena::create<SPIAnalog1256Input>());
+	addons.LoadAddon(BootArena::create<WiiExtensionInput>());
+	addons.LoadAddon(BootArena::create<SNESpadInput>());
+	addons.LoadAddon(BootArena::create<SliderSOCDInput>());
+	addons.LoadAddon(BootArena::create<TiltInput>());
+	addons.LoadAddon(BootArena::create<RotaryEncoderInput>());
+	addons.LoadAddon(BootArena::create<PCF8575Addon>());
+	addons.LoadAddon(BootArena::create<TG16padInput>());
 
 	// Input override addons
-	addons.LoadAddon(new ReverseInput());
-	addons.LoadAddon(new TurboInput()); // Turbo overrides button states and should be close to the end
-	addons.LoadAddon(new InputMacro());
+	addons.LoadAddon(BootArena::create<ReverseInput>());
+	addons.LoadAddon(BootArena::create<TurboInput>()); // Turbo overrides button states and should be close to the end
+	addons.LoadAddon(BootArena::create<InputMacro>());
 
 	InputMode inputMode = gamepad->getOptions().inputMode;
 	const BootAction bootAction = getBootAction();
@@ -186,6 +189,9 @@ void GP2040::setup() {
 		case BootAction::SET_INPUT_MODE_SWITCH_PRO:
 			inputMode = INPUT_MODE_SWITCH_PRO;
 			break;
+		case BootAction::SET_INPUT_MODE_COMPOSITE:
+			inputMode = INPUT_MODE_COMPOSITE;
+			break;
 		case BootAction::NONE:
 		default:
 			break;
@@ -291,6 +297,11 @@ void GP2040::run() {
 	// Initialize our USB manager
 	USBHostManager::getInstance().start();
 
+	// Start sampling the ADC pins the add-ons registered (Web-Config reads the ADC directly)
+	if (configMode == false) {
+		ADCService::start();
+	}
+
 	if (configMode == true ) {
 		rndis_init();
 	}
@@ -312,7 +323,10 @@ void GP2040::run() {
 
 		// Config Loop (Web-Config skips Core0 add-ons)
 		if (configMode == true) {
-			inputDriver->process(gamepad);
+			{
+				MemoryTracker::Scope memoryScope(MemoryTracker::TAG_DRIVER);
+				inputDriver->process(gamepad);
+			}
 			rebootHotkeys.process(gamepad, configMode);
 			checkSaveRebootState();
 			continue;
@@ -338,8 +352,15 @@ void GP2040::run() {
 		// Copy Processed Gamepad for Core1 (race condition otherwise)
 		memcpy(&processedGamepad->state, &gamepad->state, sizeof(GamepadState));
 
+		// Let drivers know whether anything changed since their last report
+		gamepad->updateStateGeneration();
+
 		// Process Input Driver
-		bool processed = inputDriver->process(gamepad);
+		bool processed;
+		{
+			MemoryTracker::Scope memoryScope(MemoryTracker::TAG_DRIVER);
+			processed = DriverManager::getInstance().process(gamepad);
+		}
 
 		// TinyUSB Task update
 		tud_task();
@@ -463,6 +484,8 @@ GP2040::BootAction GP2040::getBootAction() {
                                     return BootAction::SET_INPUT_MODE_XBONE;
                                 case INPUT_MODE_SWITCH_PRO:
                                     return BootAction::SET_INPUT_MODE_SWITCH_PRO;
+                                case INPUT_MODE_COMPOSITE:
+                                    return BootAction::SET_INPUT_MODE_COMPOSITE;
                                 default:
                                     return BootAction::NONE;
                             }
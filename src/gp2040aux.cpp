@@ -5,6 +5,8 @@
 #include "drivermanager.h"
 #include "storagemanager.h"
 #include "usbhostmanager.h"
+#include "memorytracker.h"
+#include "bootarena.h"
 
 #include "addons/board_led.h"  // Add-Ons
 #include "addons/buzzerspeaker.h"
@@ -28,6 +30,7 @@ void GP2040Aux::setup() {
 	// Initialize our input driver's auxilliary functions
 	inputDriver = DriverManager::getInstance().getDriver();
 	if ( inputDriver != nullptr ) {
+		MemoryTracker::Scope memoryScope(MemoryTracker::TAG_DRIVER);
 		inputDriver->initializeAux();
 
 		// Check if we have a USB listener
@@ -38,13 +41,13 @@ void GP2040Aux::setup() {
 	}
 
 	// Setup Add-ons
-	addons.LoadAddon(new DisplayAddon());
-	addons.LoadAddon(new NeoPicoLEDAddon());
-	addons.LoadAddon(new PlayerLEDAddon());
-	addons.LoadAddon(new BoardLedAddon());
-	addons.LoadAddon(new BuzzerSpeakerAddon());
-	addons.LoadAddon(new DRV8833RumbleAddon());
-	addons.LoadAddon(new ReactiveLEDAddon());
+	addons.LoadAddon(BootArena::create<DisplayAddon>());
+	addons.LoadAddon(BootArena::create<NeoPicoLEDAddon>());
+	addons.LoadAddon(BootArena::create<PlayerLEDAddon>());
+	addons.LoadAddon(BootArena::create<BoardLedAddon>());
+	addons.LoadAddon(BootArena::create<BuzzerSpeakerAddon>());
+	addons.LoadAddon(BootArena::create<DRV8833RumbleAddon>());
+	addons.LoadAddon(BootArena::create<ReactiveLEDAddon>());
 
 	// Ready to sync Core0 and Core1
 	isReady = true;
@@ -58,6 +61,7 @@ void GP2040Aux::run() {
 
 		// Run auxiliary functions for input driver on Core1
 		if ( inputDriver != nullptr ) {
+			MemoryTracker::Scope memoryScope(MemoryTracker::TAG_DRIVER);
 			inputDriver->processAux();
 		}
 	}
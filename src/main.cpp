@@ -9,6 +9,7 @@
 // GP2040 includes
 #include "gp2040.h"
 #include "gp2040aux.h"
+#include "bootarena.h"
 
 #include <cstdlib>
 
@@ -34,8 +35,8 @@ void core1() {
 
 int main() {
 	// Create GP2040 Main Core (core0), Core1 is dependent on Core0
-	gp2040Core0 = new GP2040();
-	gp2040Core1 = new GP2040Aux();
+	gp2040Core0 = BootArena::create<GP2040>();
+	gp2040Core1 = BootArena::create<GP2040Aux>();
 
 	// Create GP2040 Main Core - Setup Core0
 	gp2040Core0->setup();
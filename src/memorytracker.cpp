@@ -0,0 +1,189 @@
+#include "memorytracker.h"
+#include "bootarena.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#if defined(PICO_ON_DEVICE) && PICO_ON_DEVICE
+#include "hardware/sync.h"
+#include "pico/platform.h"
+
+// Allocations happen on both cores, the hardware spin lock does not need to be initialized before main()
+#define TRACKER_LOCK() const uint32_t trackerIrqState = spin_lock_blocking(spin_lock_instance(PICO_SPINLOCK_ID_OS1))
+#define TRACKER_UNLOCK() spin_unlock(spin_lock_instance(PICO_SPINLOCK_ID_OS1), trackerIrqState)
+#define TRACKER_CORE_NUM() get_core_num()
+#define TRACKER_NUM_CORES NUM_CORES
+#define TRACKER_OUT_OF_MEMORY(size) panic("Out of memory allocating %u bytes", (unsigned)(size))
+#else
+// Host builds are single threaded
+#define TRACKER_LOCK()
+#define TRACKER_UNLOCK()
+#define TRACKER_CORE_NUM() 0
+#define TRACKER_NUM_CORES 1
+#define TRACKER_OUT_OF_MEMORY(size) abort()
+#endif
+
+// Keep the header a multiple of 8 bytes so the returned pointer keeps malloc's alignment
+struct AllocationHeader
+{
+    uint32_t size;
+    uint16_t magic;
+    MemoryTracker::Tag tag;
+    uint8_t reserved;
+};
+
+static_assert(sizeof(AllocationHeader) == 8, "AllocationHeader must preserve 8 byte alignment");
+
+static const uint16_t HEADER_MAGIC = 0x6d54;
+
+// Zero/constant initialized so that allocations made by static constructors are tracked correctly
+static MemoryTracker::TagStats tagStats[MEMORY_TRACKER_MAX_TAGS] = {
+    { "System" },
+    { "Driver" },
+    { "WebConfig" },
+    { "Events" },
+};
+static uint32_t tagCount = MemoryTracker::TAG_BUILTIN_COUNT;
+static volatile MemoryTracker::Tag currentTag[TRACKER_NUM_CORES];
+static uint32_t liveBytes = 0;
+static uint32_t peakBytes = 0;
+
+MemoryTracker::Tag MemoryTracker::registerTag(const char* name)
+{
+    // TAG_UNTAGGED is a valid match ("System"), so a miss needs its own value
+    uint32_t tag = MEMORY_TRACKER_MAX_TAGS;
+
+    TRACKER_LOCK();
+    for (uint32_t i = 0; i < tagCount; i++) {
+        if (strncmp(tagStats[i].name, name, MEMORY_TRACKER_TAG_NAME_LENGTH - 1) == 0) {
+            tag = i;
+            break;
+        }
+    }
+    if (tag == MEMORY_TRACKER_MAX_TAGS && tagCount < MEMORY_TRACKER_MAX_TAGS) {
+        tag = tagCount++;
+        strncpy(tagStats[tag].name, name, MEMORY_TRACKER_TAG_NAME_LENGTH - 1);
+        tagStats[tag].name[MEMORY_TRACKER_TAG_NAME_LENGTH - 1] = '\0';
+    }
+    TRACKER_UNLOCK();
+
+    return tag < MEMORY_TRACKER_MAX_TAGS ? tag : TAG_UNTAGGED;
+}
+
+MemoryTracker::Tag MemoryTracker::setCurrentTag(Tag tag)
+{
+    const uint32_t core = TRACKER_CORE_NUM();
+    const Tag previous = currentTag[core];
+    currentTag[core] = tag;
+    return previous;
+}
+
+uint32_t MemoryTracker::getTagCount()
+{
+    return tagCount;
+}
+
+bool MemoryTracker::getTagStats(Tag tag, TagStats& stats)
+{
+    if (tag >= tagCount) {
+        return false;
+    }
+
+    TRACKER_LOCK();
+    stats = tagStats[tag];
+    TRACKER_UNLOCK();
+    return true;
+}
+
+uint32_t MemoryTracker::getLiveBytes()
+{
+    return liveBytes;
+}
+
+uint32_t MemoryTracker::getPeakBytes()
+{
+    return peakBytes;
+}
+
+void* MemoryTracker::allocate(size_t size)
+{
+    AllocationHeader* header = static_cast<AllocationHeader*>(malloc(sizeof(AllocationHeader) + size));
+    if (header == nullptr) {
+        return nullptr;
+    }
+
+    header->size = size;
+    header->magic = HEADER_MAGIC;
+    header->tag = currentTag[TRACKER_CORE_NUM()];
+    header->reserved = 0;
+
+    TRACKER_LOCK();
+    TagStats& stats = tagStats[header->tag];
+    stats.liveBytes += size;
+    stats.liveCount++;
+    stats.allocCount++;
+    if (stats.liveBytes > stats.peakBytes) {
+        stats.peakBytes = stats.liveBytes;
+    }
+    liveBytes += size;
+    if (liveBytes > peakBytes) {
+        peakBytes = liveBytes;
+    }
+    TRACKER_UNLOCK();
+
+    return header + 1;
+}
+
+void MemoryTracker::release(void* ptr)
+{
+    if (ptr == nullptr) {
+        return;
+    }
+
+    // Objects created with BootArena::create() are not tracked and have no header
+    if (BootArena::contains(ptr)) {
+        BootArena::release(ptr);
+        return;
+    }
+
+    AllocationHeader* header = static_cast<AllocationHeader*>(ptr) - 1;
+
+    // Anything else would be memory that did not come from allocate(), which should never be passed to delete
+    if (header->magic == HEADER_MAGIC && header->tag < MEMORY_TRACKER_MAX_TAGS) {
+        TRACKER_LOCK();
+        TagStats& stats = tagStats[header->tag];
+        stats.liveBytes -= header->size;
+        stats.liveCount--;
+        liveBytes -= header->size;
+        TRACKER_UNLOCK();
+
+        // Make sure a double free is not accounted twice
+        header->magic = 0;
+    }
+
+    free(header);
+}
+
+// Exceptions are disabled, a throwing new that cannot return memory has no way to report it to the caller
+static void* allocateOrPanic(size_t size)
+{
+    void* ptr = MemoryTracker::allocate(size);
+    if (ptr == nullptr) {
+        TRACKER_OUT_OF_MEMORY(size);
+    }
+    return ptr;
+}
+
+// Route all C++ heap allocations through the tracker, CMakeLists.txt sets PICO_CXX_DISABLE_ALLOCATION_OVERRIDES so the
+// SDK does not define these as well
+void* operator new(size_t size) { return allocateOrPanic(size); }
+void* operator new[](size_t size) { return allocateOrPanic(size); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return MemoryTracker::allocate(size); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return MemoryTracker::allocate(size); }
+void operator delete(void* ptr) noexcept { MemoryTracker::release(ptr); }
+void operator delete[](void* ptr) noexcept { MemoryTracker::release(ptr); }
+void operator delete(void* ptr, size_t) noexcept { MemoryTracker::release(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { MemoryTracker::release(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { MemoryTracker::release(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { MemoryTracker::release(ptr); }
@@ -0,0 +1,81 @@
+#include "rapidtrigger.h"
+
+void RapidTrigger::clear() {
+    keys = 0;
+    rapid = 0;
+    pressed = 0;
+}
+
+void RapidTrigger::setKey(uint8_t key, uint16_t actuation, uint16_t release, uint16_t resetDistance, bool rapid) {
+    if (key >= RAPID_TRIGGER_KEYS) {
+        return;
+    }
+    const uint32_t bit = 1u << key;
+    this->actuation[key] = actuation;
+    // A release point deeper than actuation would let a key go while it is still held past it
+    this->release[key] = release < actuation ? release : actuation;
+    this->resetDistance[key] = resetDistance;
+    keys |= bit;
+    if (rapid) {
+        this->rapid |= bit;
+    } else {
+        this->rapid &= ~bit;
+    }
+    pressed &= ~bit;
+}
+
+void RapidTrigger::reset(uint8_t key, uint16_t travel) {
+    if (key >= RAPID_TRIGGER_KEYS) {
+        return;
+    }
+    extreme[key] = travel;
+    pressed &= ~(1u << key);
+}
+
+uint32_t RapidTrigger::update(const uint16_t * travel) {
+    uint32_t next = 0;
+
+    // Plain keys only compare against actuation
+    for (uint32_t remaining = keys & ~rapid; remaining != 0; remaining &= remaining - 1) {
+        const uint32_t key = __builtin_ctz(remaining);
+        next |= (uint32_t)(travel[key] > actuation[key]) << key;
+    }
+
+    // Rapid trigger keys follow the direction of travel
+    for (uint32_t remaining = keys & rapid; remaining != 0; remaining &= remaining - 1) {
+        const uint32_t key = __builtin_ctz(remaining);
+        const uint32_t bit = 1u << key;
+        const int32_t value = travel[key];
+
+        const int32_t moved = value - extreme[key];
+        const bool pressing = moved > resetDistance[key];
+        const bool releasing = -moved > resetDistance[key];
+        if (pressing || releasing) {
+            extreme[key] = value;
+        }
+        if (pressed & bit) {
+            next |= (releasing && value <= release[key]) ? 0 : bit;
+        } else {
+            next |= (pressing && value >= actuation[key]) ? bit : 0;
+        }
+    }
+    pressed = next;
+    return next;
+}
+
+void RapidTrigger::setPressureRange(uint8_t key, uint16_t idle, uint16_t pressed) {
+    if (key >= RAPID_TRIGGER_KEYS) {
+        return;
+    }
+    pressureIdle[key] = idle;
+    pressureScale[key] = pressed > idle ? (255u << 16) / (pressed - idle) : 0;
+}
+
+uint8_t RapidTrigger::getPressure(uint8_t key, uint16_t travel) const {
+    if (key >= RAPID_TRIGGER_KEYS || pressureScale[key] == 0) {
+        return 0xFF;
+    }
+    const uint32_t depth = travel > pressureIdle[key] ? travel - pressureIdle[key] : 0;
+    const uint32_t pressure = ((uint64_t)depth * pressureScale[key] + (1u << 15)) >> 16;
+    return pressure > 0xFF ? 0xFF : (pressure < 1 ? 1 : pressure);
+}
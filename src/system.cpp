@@ -8,6 +8,7 @@
 #include <pico/multicore.h>
 
 #include <malloc.h>
+#include <unistd.h>
 
 extern char __flash_binary_start;
 extern char __flash_binary_end;
@@ -58,6 +59,17 @@ uint32_t System::getUsedHeap() {
     return mallinfo().uordblks;
 }
 
+uint32_t System::getLargestFreeHeapBlock() {
+    // Memory that has not been claimed by sbrk yet plus the free chunk at the top of the arena
+    const uint32_t unclaimed = &__StackLimit - static_cast<char*>(sbrk(0));
+    return unclaimed + mallinfo().keepcost;
+}
+
+uint32_t System::getFragmentedHeap() {
+    const struct mallinfo info = mallinfo();
+    return info.fordblks - info.keepcost;
+}
+
 void System::reboot(BootMode bootMode) {
     // Halt all running USB instances
     USBHostManager::getInstance().shutdown();
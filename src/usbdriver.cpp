@@ -8,10 +8,60 @@
 
 #include "tusb.h"
 #include "drivermanager.h"
+#include "usbtelemetry.h"
+
+#include "hardware/structs/usb.h"
+#include "pico/time.h"
 
 static bool usb_mounted;
 static bool usb_suspended;
 
+// Host poll rate measurement: completed IN transfers are counted against the frame number of the
+// host's SOF packets, so the rate follows the host's clock rather than ours
+#define POLL_RATE_WINDOW_FRAMES 1000
+#define USB_FRAME_NUMBER_MASK 0x7ff
+
+static const usbd_class_driver_t * active_class_driver;
+static uint8_t report_endpoint;
+static usbd_class_driver_t app_class_drivers[2];
+static uint32_t poll_count;
+static uint32_t poll_window_frames;
+static uint16_t poll_last_frame;
+static uint32_t poll_last_ms;
+static uint32_t poll_rate;
+
+static bool measured_xfer_cb(uint8_t rhport, uint8_t ep_addr, xfer_result_t result, uint32_t xferred_bytes) {
+	if (tu_edpt_dir(ep_addr) == TUSB_DIR_IN && result == XFER_RESULT_SUCCESS &&
+		(report_endpoint == 0 || ep_addr == report_endpoint)) {
+		const uint16_t frame = usb_hw->sof_rd & USB_FRAME_NUMBER_MASK;
+		const uint32_t now = to_ms_since_boot(get_absolute_time());
+
+		// The frame number wraps every 2048 frames, start over after long gaps
+		if ((now - poll_last_ms) > POLL_RATE_WINDOW_FRAMES) {
+			poll_count = 0;
+			poll_window_frames = 0;
+			poll_rate = 0;
+		} else {
+			poll_count++;
+			poll_window_frames += (frame - poll_last_frame) & USB_FRAME_NUMBER_MASK;
+		}
+		poll_last_frame = frame;
+		poll_last_ms = now;
+
+		if (poll_window_frames >= POLL_RATE_WINDOW_FRAMES) {
+			poll_rate = (poll_count * 1000) / poll_window_frames;
+			poll_count = 0;
+			poll_window_frames = 0;
+		}
+		USBTelemetry::reportCompleted();
+	}
+	return active_class_driver->xfer_cb(rhport, ep_addr, result, xferred_bytes);
+}
+
+uint32_t get_usb_poll_rate(void) {
+	return poll_rate;
+}
+
 bool get_usb_mounted(void) {
 	return usb_mounted;
 }
@@ -21,18 +71,31 @@ bool get_usb_suspended(void) {
 }
 
 const usbd_class_driver_t *usbd_app_driver_get_cb(uint8_t *driver_count) {
-	*driver_count = 1;
-	return DriverManager::getInstance().getDriver()->get_class_driver();
+	uint8_t count = 0;
+
+	// The telemetry interface goes first, vendor class drivers like XInput claim any vendor interface
+	if (USBTelemetry::isEnabled()) {
+		app_class_drivers[count++] = *USBTelemetry::getClassDriver();
+	}
+
+	// Wrap the driver's transfer callback to measure the poll rate
+	active_class_driver = DriverManager::getInstance().getDriver()->get_class_driver();
+	report_endpoint = DriverManager::getInstance().getDriver()->get_report_endpoint();
+	app_class_drivers[count] = *active_class_driver;
+	app_class_drivers[count++].xfer_cb = measured_xfer_cb;
+
+	*driver_count = count;
+	return app_class_drivers;
 }
 
 uint16_t tud_hid_get_report_cb(uint8_t itf, uint8_t report_id, hid_report_type_t report_type, uint8_t *buffer, uint16_t reqlen) {
-	return DriverManager::getInstance().getDriver()->get_report(report_id, report_type, buffer, reqlen);
+	return DriverManager::getInstance().getDriver()->get_hid_report(itf, report_id, report_type, buffer, reqlen);
 }
 
 // Invoked when received SET_REPORT control request or
 // received data on OUT endpoint ( Report ID = 0, Type = 0 )
 void tud_hid_set_report_cb(uint8_t itf, uint8_t report_id, hid_report_type_t report_type, uint8_t const *buffer, uint16_t bufsize) {
-	DriverManager::getInstance().getDriver()->set_report(report_id, report_type, buffer, bufsize);
+	DriverManager::getInstance().getDriver()->set_hid_report(itf, report_id, report_type, buffer, bufsize);
 }
 
 // Invoked when device is mounted
@@ -92,7 +155,7 @@ uint8_t const *tud_hid_descriptor_report_cb(uint8_t itf) {
 // Application return pointer to descriptor
 // Descriptor contents must exist long enough for transfer to complete
 uint8_t const *tud_descriptor_configuration_cb(uint8_t index) {
-	return DriverManager::getInstance().getDriver()->get_descriptor_configuration_cb(index);
+	return DriverManager::getInstance().getConfigurationDescriptor(index);
 }
 
 uint8_t const* tud_descriptor_device_qualifier_cb() {
@@ -11,6 +11,11 @@
 
 #include "drivers/shared/xinput_host.h"
 
+#include "pico/time.h"
+
+#include <algorithm>
+#include <cstring>
+
 void USBHostManager::start() {
     // This will happen after Gamepad has initialized
     if (PeripheralManager::getInstance().isUSBEnabled(0) && listeners.size() > 0) {
@@ -32,81 +37,208 @@ void USBHostManager::shutdown() {
 }
 
 void USBHostManager::pushListener(USBListener * usbListener) { // If anything needs to update in the gpconfig driver
+    if ( listeners.size() >= USB_HOST_LISTENER_MAX ) return;
     listeners.push_back(usbListener);
 }
 
-// Host manager should call tuh_task as fast as possible
+// Host manager should call tuh_task as fast as possible, listener work is limited to the time budget
 void USBHostManager::process() {
-    if ( tuh_ready ){
-        tuh_task();
+    if ( !tuh_ready ) return;
+
+    const uint32_t start = time_us_32();
+    tuh_task();
+
+    // One event per device per pass, starting after the device that went first last time.
+    // Always hand over at least one event so the queues drain even when tuh_task() used up the budget
+    bool dispatched = true;
+    while ( dispatched ) {
+        dispatched = false;
+        for (uint8_t i = 0; i < USB_HOST_DEVICE_MAX; i++) {
+            USBHostDevice * device = &devices[(nextDevice + i) % USB_HOST_DEVICE_MAX];
+            if ( device->listeners != 0 && dispatchEvent(device) ) {
+                dispatched = true;
+                if ( (time_us_32() - start) >= USB_HOST_PROCESS_BUDGET_US ) {
+                    nextDevice = (nextDevice + i + 1) % USB_HOST_DEVICE_MAX;
+                    dispatched = false;
+                    break;
+                }
+            }
+        }
+    }
+
+    const uint32_t elapsed = time_us_32() - start;
+    if ( elapsed > maxProcessUs ) {
+        maxProcessUs = elapsed;
     }
 }
 
-void USBHostManager::hid_mount_cb(uint8_t dev_addr, uint8_t instance, uint8_t const* desc_report, uint16_t desc_len) {
-    if ( listeners.size() == 0 ) return;
-    for( std::vector<USBListener*>::iterator it = listeners.begin(); it != listeners.end(); it++ ){
-        (*it)->mount(dev_addr, instance, desc_report, desc_len);
+void USBHostManager::queueEvent(USBHostEventType type, uint8_t dev_addr, uint8_t instance, uint8_t const* report, uint16_t len, uint8_t report_id, uint8_t report_type) {
+    const bool xinput = (type == USB_HOST_EVENT_XINPUT_REPORT_RECEIVED || type == USB_HOST_EVENT_XINPUT_REPORT_SENT);
+    USBHostDevice * device = findDevice(dev_addr, instance, xinput);
+    if ( device == nullptr ) {
+        // Nobody claimed this interface on mount
+        unclaimedEvents++;
+        return;
     }
+
+    USBHostEvent * event = device->events.reserve();
+    if ( event == nullptr ) {
+        // Keep the order and never drop an event, the oldest one of this device goes out now
+        device->queueOverflows++;
+        dispatchEvent(device);
+        event = device->events.reserve();
+    }
+
+    event->type = type;
+    event->dev_addr = dev_addr;
+    event->instance = instance;
+    event->report_id = report_id;
+    event->report_type = report_type;
+    event->len = len;
+    if ( report != nullptr ) {
+        // TinyUSB reuses its endpoint buffers as soon as the callback returns
+        event->len = std::min<uint16_t>(len, USB_HOST_EVENT_REPORT_SIZE);
+        memcpy(event->report, report, event->len);
+    }
+    device->events.commit();
 }
 
-void USBHostManager::hid_umount_cb(uint8_t dev_addr, uint8_t instance) {
-    if ( listeners.size() == 0 ) return;
-    for( std::vector<USBListener*>::iterator it = listeners.begin(); it != listeners.end(); it++ ){
-        (*it)->unmount(dev_addr);
+void USBHostManager::flushEvents() {
+    for (uint8_t i = 0; i < USB_HOST_DEVICE_MAX; i++) {
+        while ( devices[i].listeners != 0 && dispatchEvent(&devices[i]) ) {}
     }
 }
 
-void USBHostManager::hid_report_received_cb(uint8_t dev_addr, uint8_t instance, uint8_t const* report, uint16_t len) {
-    if ( listeners.size() == 0 ) return;
-    for( std::vector<USBListener*>::iterator it = listeners.begin(); it != listeners.end(); it++ ){
-        (*it)->report_received(dev_addr, instance, report, len);
+uint32_t USBHostManager::getQueueOverflows() {
+    uint32_t overflows = 0;
+    for (uint8_t i = 0; i < USB_HOST_DEVICE_MAX; i++) {
+        overflows += devices[i].queueOverflows;
     }
+    return overflows;
 }
 
-void USBHostManager::hid_set_report_complete_cb(uint8_t dev_addr, uint8_t instance, uint8_t report_id, uint8_t report_type, uint16_t len) {
-    if ( listeners.size() == 0 ) return;
-    for( std::vector<USBListener*>::iterator it = listeners.begin(); it != listeners.end(); it++ ){
-        (*it)->set_report_complete(dev_addr, instance, report_id, report_type, len);
+uint8_t USBHostManager::getDeviceCount() {
+    uint8_t count = 0;
+    for (uint8_t i = 0; i < USB_HOST_DEVICE_MAX; i++) {
+        if ( devices[i].listeners != 0 ) count++;
     }
+    return count;
 }
 
-void USBHostManager::hid_get_report_complete_cb(uint8_t dev_addr, uint8_t instance, uint8_t report_id, uint8_t report_type, uint16_t len) {
-    if ( listeners.size() == 0 ) return;
-    for( std::vector<USBListener*>::iterator it = listeners.begin(); it != listeners.end(); it++ ){
-        (*it)->get_report_complete(dev_addr, instance, report_id, report_type, len);
+USBHostDevice * USBHostManager::findDevice(uint8_t dev_addr, uint8_t instance, bool xinput) {
+    for (uint8_t i = 0; i < USB_HOST_DEVICE_MAX; i++) {
+        USBHostDevice * device = &devices[i];
+        if ( device->listeners != 0 && device->dev_addr == dev_addr && device->instance == instance && device->xinput == xinput ) {
+            return device;
+        }
     }
+    return nullptr;
 }
 
-void USBHostManager::xinput_mount_cb(uint8_t dev_addr, uint8_t instance, uint8_t controllerType, uint8_t subtype) {
-    if ( listeners.size() == 0 ) return;
-    for( std::vector<USBListener*>::iterator it = listeners.begin(); it != listeners.end(); it++ ){
-        (*it)->xmount(dev_addr, instance, controllerType, subtype);
+void USBHostManager::registerDevice(uint8_t dev_addr, uint8_t instance, bool xinput, uint32_t claims) {
+    if ( claims == 0 ) return;
+
+    USBHostDevice * device = findDevice(dev_addr, instance, xinput);
+    if ( device == nullptr ) {
+        for (uint8_t i = 0; i < USB_HOST_DEVICE_MAX; i++) {
+            if ( devices[i].listeners == 0 ) {
+                device = &devices[i];
+                break;
+            }
+        }
+        // Registry full, the listeners keep their mount but get no reports from this interface
+        if ( device == nullptr ) return;
+        device->events.clear();
     }
+
+    device->dev_addr = dev_addr;
+    device->instance = instance;
+    device->xinput = xinput;
+    device->listeners = claims;
 }
 
-void USBHostManager::xinput_umount_cb(uint8_t dev_addr) {
-    if ( listeners.size() == 0 ) return;
-    for( std::vector<USBListener*>::iterator it = listeners.begin(); it != listeners.end(); it++ ){
-        (*it)->unmount(dev_addr);
+void USBHostManager::releaseDevice(USBHostDevice * device) {
+    device->listeners = 0;
+    device->events.clear();
+}
+
+bool USBHostManager::dispatchEvent(USBHostDevice * device) {
+    USBHostEvent * front = device->events.front();
+    if ( front == nullptr ) return false;
+
+    // Take the event off the queue first, a listener may start a transfer whose callback queues on this device
+    USBHostEvent event = *front;
+    device->events.pop();
+
+    for (uint8_t i = 0; i < listeners.size(); i++) {
+        if ( (device->listeners & (1u << i)) == 0 ) continue;
+
+        USBListener * listener = listeners[i];
+        switch (event.type) {
+            case USB_HOST_EVENT_HID_REPORT_RECEIVED:
+            case USB_HOST_EVENT_XINPUT_REPORT_RECEIVED:
+                listener->report_received(event.dev_addr, event.instance, event.report, event.len);
+                break;
+            case USB_HOST_EVENT_HID_SET_REPORT_COMPLETE:
+                listener->set_report_complete(event.dev_addr, event.instance, event.report_id, event.report_type, event.len);
+                break;
+            case USB_HOST_EVENT_HID_GET_REPORT_COMPLETE:
+                listener->get_report_complete(event.dev_addr, event.instance, event.report_id, event.report_type, event.len);
+                break;
+            case USB_HOST_EVENT_XINPUT_REPORT_SENT:
+                listener->report_sent(event.dev_addr, event.instance, event.report, event.len);
+                break;
+        }
+    }
+    return true;
+}
+
+void USBHostManager::hid_mount_cb(uint8_t dev_addr, uint8_t instance, uint8_t const* desc_report, uint16_t desc_len) {
+    uint32_t claims = 0;
+    for (uint8_t i = 0; i < listeners.size(); i++) {
+        if ( listeners[i]->mount(dev_addr, instance, desc_report, desc_len) ) {
+            claims |= (1u << i);
+        }
     }
+    registerDevice(dev_addr, instance, false, claims);
 }
 
-void USBHostManager::xinput_report_received_cb(uint8_t dev_addr, uint8_t instance, uint8_t const* report, uint16_t len) {
-    if ( listeners.size() == 0 ) return;
-    for( std::vector<USBListener*>::iterator it = listeners.begin(); it != listeners.end(); it++ ){
-        (*it)->report_received(dev_addr, instance, report, len);
+void USBHostManager::hid_umount_cb(uint8_t dev_addr, uint8_t instance) {
+    USBHostDevice * device = findDevice(dev_addr, instance, false);
+    if ( device == nullptr ) return;
+    for (uint8_t i = 0; i < listeners.size(); i++) {
+        if ( device->listeners & (1u << i) ) {
+            listeners[i]->unmount(dev_addr);
+        }
+    }
+    releaseDevice(device);
+}
+
+void USBHostManager::xinput_mount_cb(uint8_t dev_addr, uint8_t instance, uint8_t controllerType, uint8_t subtype) {
+    uint32_t claims = 0;
+    for (uint8_t i = 0; i < listeners.size(); i++) {
+        if ( listeners[i]->xmount(dev_addr, instance, controllerType, subtype) ) {
+            claims |= (1u << i);
+        }
     }
+    registerDevice(dev_addr, instance, true, claims);
 }
 
-void USBHostManager::xinput_report_sent_cb(uint8_t dev_addr, uint8_t instance, uint8_t const* report, uint16_t len) {
-    if ( listeners.size() == 0 ) return;
-    for( std::vector<USBListener*>::iterator it = listeners.begin(); it != listeners.end(); it++ ){
-        (*it)->report_sent(dev_addr, instance, report, len);
+void USBHostManager::xinput_umount_cb(uint8_t dev_addr, uint8_t instance) {
+    USBHostDevice * device = findDevice(dev_addr, instance, true);
+    if ( device == nullptr ) return;
+    for (uint8_t i = 0; i < listeners.size(); i++) {
+        if ( device->listeners & (1u << i) ) {
+            listeners[i]->unmount(dev_addr);
+        }
     }
+    releaseDevice(device);
 }
 
 void tuh_hid_mount_cb(uint8_t dev_addr, uint8_t instance, uint8_t const* desc_report, uint16_t desc_len)
 {
+    // The report descriptor is only valid during this callback, mounts are rare enough to hand over directly
+    USBHostManager::getInstance().flushEvents();
     USBHostManager::getInstance().hid_mount_cb(dev_addr, instance, desc_report, desc_len);
     if ( !tuh_hid_receive_report(dev_addr, instance) ) {
         // Error: cannot request report
@@ -134,13 +266,14 @@ void tuh_umount_cb(uint8_t dev_addr) {
 /// Invoked when device is unmounted (bus reset/unplugged)
 void tuh_hid_umount_cb(uint8_t daddr, uint8_t instance)
 {
+    USBHostManager::getInstance().flushEvents();
     USBHostManager::getInstance().hid_umount_cb(daddr, instance);
 }
 
 // Invoked when received report from device via interrupt endpoint
 void tuh_hid_report_received_cb(uint8_t dev_addr, uint8_t instance, uint8_t const* report, uint16_t len)
 {
-    USBHostManager::getInstance().hid_report_received_cb(dev_addr, instance, report, len);
+    USBHostManager::getInstance().queueEvent(USB_HOST_EVENT_HID_REPORT_RECEIVED, dev_addr, instance, report, len);
 
     if ( !tuh_hid_receive_report(dev_addr, instance) ) {
         //Error: cannot request report
@@ -150,35 +283,37 @@ void tuh_hid_report_received_cb(uint8_t dev_addr, uint8_t instance, uint8_t cons
 // On IN/OUT/FEATURE set report callback
 void tuh_hid_set_report_complete_cb(uint8_t dev_addr, uint8_t instance, uint8_t report_id, uint8_t report_type, uint16_t len) {
     if ( len != 0 )
-        USBHostManager::getInstance().hid_set_report_complete_cb(dev_addr, instance, report_id, report_type, len);
+        USBHostManager::getInstance().queueEvent(USB_HOST_EVENT_HID_SET_REPORT_COMPLETE, dev_addr, instance, nullptr, len, report_id, report_type);
 }
 
 
 // GET REPORT FEATURE
 void tuh_hid_get_report_complete_cb(uint8_t dev_addr, uint8_t instance, uint8_t report_id, uint8_t report_type, uint16_t len) {
     if ( len != 0 )
-        USBHostManager::getInstance().hid_get_report_complete_cb(dev_addr, instance, report_id, report_type, len);
+        USBHostManager::getInstance().queueEvent(USB_HOST_EVENT_HID_GET_REPORT_COMPLETE, dev_addr, instance, nullptr, len, report_id, report_type);
 }
 
 // USB Host: X-Input
 // Add X-Input Driver
 void tuh_xinput_mount_cb(uint8_t dev_addr, uint8_t instance, uint8_t controllerType, uint8_t subtype) {
+    USBHostManager::getInstance().flushEvents();
     USBHostManager::getInstance().xinput_mount_cb(dev_addr, instance, controllerType, subtype);
 }
 
 void tuh_xinput_umount_cb(uint8_t dev_addr, uint8_t instance) {
     // send to xinput_unmount_cb in usb host manager
-    USBHostManager::getInstance().xinput_umount_cb(dev_addr);
+    USBHostManager::getInstance().flushEvents();
+    USBHostManager::getInstance().xinput_umount_cb(dev_addr, instance);
 }
 
 void tuh_xinput_report_received_cb(uint8_t dev_addr, uint8_t instance, uint8_t const *report, uint16_t len) {
     // report received from xinput device
-    USBHostManager::getInstance().xinput_report_received_cb(dev_addr, instance, report, len);
+    USBHostManager::getInstance().queueEvent(USB_HOST_EVENT_XINPUT_REPORT_RECEIVED, dev_addr, instance, report, len);
 }
 
 void tuh_xinput_report_sent_cb(uint8_t dev_addr, uint8_t instance, uint8_t const *report, uint16_t len) {
     // report sent to xinput device
-    USBHostManager::getInstance().xinput_report_sent_cb(dev_addr, instance, report, len);
+    USBHostManager::getInstance().queueEvent(USB_HOST_EVENT_XINPUT_REPORT_SENT, dev_addr, instance, report, len);
 }
 
 usbh_class_driver_t driver_host[] = {
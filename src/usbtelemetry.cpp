@@ -0,0 +1,232 @@
+#include "usbtelemetry.h"
+
+#include "gamepad.h"
+#include "usbdriver.h"
+#include "drivers/shared/spsc_ring.h"
+
+#include "pico/time.h"
+#include "hardware/clocks.h"
+
+#include <string.h>
+
+#define TELEMETRY_PACKET_SIZE 64
+#define TELEMETRY_RING_SIZE 64
+#define TELEMETRY_MAX_ENDPOINTS 16 // RP2040 USB controller
+
+// Records are produced from TinyUSB callbacks and consumed from the driver loop, both on core 0
+static SPSCRing<USBTelemetryRecord, TELEMETRY_RING_SIZE> records;
+static USBTelemetryRecord pending;
+static bool pendingValid = false;
+static uint16_t sequence = 0;
+static uint32_t dropped = 0;
+static uint32_t inputScanUs = 0;
+static uint32_t inputScanMaxUs = 0;
+static uint64_t reportBuildCycles = 0;
+static uint32_t reportBuildCount = 0;
+static uint32_t reportBuildMaxCycles = 0;
+
+static bool enabled = false;
+static uint8_t endpointIn = 0;
+static bool endpointBusy = false;
+CFG_TUSB_MEM_ALIGN static uint8_t packet[TELEMETRY_PACKET_SIZE];
+
+static void telemetry_init(void) {
+    endpointIn = 0;
+    endpointBusy = false;
+}
+
+static void telemetry_reset(uint8_t rhport) {
+    (void)rhport;
+    telemetry_init();
+    pendingValid = false;
+}
+
+static uint16_t telemetry_open(uint8_t rhport, tusb_desc_interface_t const * itf_descriptor, uint16_t max_length) {
+    TU_VERIFY(itf_descriptor->bInterfaceClass == TUSB_CLASS_VENDOR_SPECIFIC &&
+              itf_descriptor->bInterfaceSubClass == USB_TELEMETRY_SUBCLASS &&
+              itf_descriptor->bInterfaceProtocol == USB_TELEMETRY_PROTOCOL, 0);
+    TU_VERIFY(max_length >= USB_TELEMETRY_DESC_LEN, 0);
+
+    tusb_desc_endpoint_t const * endpoint = (tusb_desc_endpoint_t const *)tu_desc_next(itf_descriptor);
+    TU_ASSERT(usbd_edpt_open(rhport, endpoint), 0);
+    endpointIn = endpoint->bEndpointAddress;
+    return USB_TELEMETRY_DESC_LEN;
+}
+
+static uint32_t cyclesToNs(uint64_t cycles) {
+    return (uint32_t)((cycles * 1000000000ull) / clock_get_hz(clk_sys));
+}
+
+static bool telemetry_control_xfer_cb(uint8_t rhport, uint8_t stage, tusb_control_request_t const * request) {
+    if (request->bmRequestType_bit.type != TUSB_REQ_TYPE_VENDOR ||
+        request->bmRequestType_bit.direction != TUSB_DIR_IN ||
+        request->bRequest != USB_TELEMETRY_REQUEST_STATUS) {
+        return false;
+    }
+    if (stage != CONTROL_STAGE_SETUP) {
+        return true;
+    }
+
+    // Control transfers read from the buffer until they complete
+    static USBTelemetryStatus status;
+    status.dropped = dropped;
+    status.inputScanUs = inputScanUs;
+    status.inputScanMaxUs = inputScanMaxUs;
+    status.pollRate = get_usb_poll_rate();
+    status.reportBuildNs = reportBuildCount ? cyclesToNs(reportBuildCycles / reportBuildCount) : 0;
+    status.reportBuildMaxNs = cyclesToNs(reportBuildMaxCycles);
+    return tud_control_xfer(rhport, request, &status, sizeof(status));
+}
+
+static bool telemetry_xfer_cb(uint8_t rhport, uint8_t ep_addr, xfer_result_t result, uint32_t xferred_bytes) {
+    (void)rhport;
+    (void)result;
+    (void)xferred_bytes;
+    if (ep_addr == endpointIn) {
+        endpointBusy = false;
+    }
+    return true;
+}
+
+static const usbd_class_driver_t telemetryClassDriver = {
+#if CFG_TUSB_DEBUG >= 2
+    .name = "TELEMETRY",
+#endif
+    .init = telemetry_init,
+    .reset = telemetry_reset,
+    .open = telemetry_open,
+    .control_xfer_cb = telemetry_control_xfer_cb,
+    .xfer_cb = telemetry_xfer_cb,
+    .sof = NULL
+};
+
+bool USBTelemetry::appendInterface(uint8_t * desc, uint16_t maxLength)
+{
+    tusb_desc_configuration_t * config = (tusb_desc_configuration_t *)desc;
+    const uint16_t totalLength = config->wTotalLength;
+    if (totalLength + USB_TELEMETRY_DESC_LEN > maxLength) {
+        return false;
+    }
+
+    // Take the endpoint after the highest one the driver uses
+    uint8_t endpointNumber = 0;
+    const uint8_t * p = desc;
+    const uint8_t * end = desc + totalLength;
+    while (p < end && tu_desc_len(p) != 0) {
+        if (tu_desc_type(p) == TUSB_DESC_ENDPOINT) {
+            const uint8_t number = tu_edpt_number(((const tusb_desc_endpoint_t *)p)->bEndpointAddress);
+            if (number > endpointNumber) {
+                endpointNumber = number;
+            }
+        }
+        p += tu_desc_len(p);
+    }
+    endpointNumber++;
+    if (endpointNumber >= TELEMETRY_MAX_ENDPOINTS) {
+        return false;
+    }
+
+    const uint8_t interfaceDescriptor[USB_TELEMETRY_DESC_LEN] = {
+        // Interface: one bulk IN endpoint, no string
+        sizeof(tusb_desc_interface_t), TUSB_DESC_INTERFACE, config->bNumInterfaces, 0, 1,
+        TUSB_CLASS_VENDOR_SPECIFIC, USB_TELEMETRY_SUBCLASS, USB_TELEMETRY_PROTOCOL, 0,
+        // Endpoint In
+        sizeof(tusb_desc_endpoint_t), TUSB_DESC_ENDPOINT, (uint8_t)(TUSB_DIR_IN_MASK | endpointNumber),
+        TUSB_XFER_BULK, U16_TO_U8S_LE(TELEMETRY_PACKET_SIZE), 0
+    };
+    memcpy(&desc[totalLength], interfaceDescriptor, sizeof(interfaceDescriptor));
+
+    config->wTotalLength = totalLength + USB_TELEMETRY_DESC_LEN;
+    config->bNumInterfaces++;
+    enabled = true;
+    return true;
+}
+
+bool USBTelemetry::isEnabled()
+{
+    return enabled;
+}
+
+const usbd_class_driver_t * USBTelemetry::getClassDriver()
+{
+    return &telemetryClassDriver;
+}
+
+void USBTelemetry::reportQueued(const Gamepad * gamepad)
+{
+    if (!enabled) {
+        return;
+    }
+    // One report in flight at a time, the record of one that never completed is lost
+    if (pendingValid) {
+        dropped++;
+    }
+    pending.edgeUs = gamepad->getStateGenerationTime();
+    pending.queuedUs = time_us_32();
+    pending.sequence = sequence++;
+    pending.generation = (uint16_t)gamepad->getStateGeneration();
+    pendingValid = true;
+}
+
+void USBTelemetry::reportBuilt(uint32_t cycles)
+{
+    reportBuildCycles += cycles;
+    reportBuildCount++;
+    if (cycles > reportBuildMaxCycles) {
+        reportBuildMaxCycles = cycles;
+    }
+}
+
+void USBTelemetry::reportCompleted()
+{
+    if (!pendingValid) {
+        return;
+    }
+    pendingValid = false;
+
+    USBTelemetryRecord * record = records.reserve();
+    if (record == nullptr) {
+        dropped++;
+        return;
+    }
+    *record = pending;
+    record->completeUs = time_us_32();
+    records.commit();
+}
+
+void USBTelemetry::process()
+{
+    if (!enabled || endpointIn == 0 || endpointBusy || records.empty() || !tud_ready() ||
+        !usbd_edpt_claim(0, endpointIn)) {
+        return;
+    }
+
+    // Records stay in the ring until the transfer is started, a failed attempt sends them next time
+    uint16_t length = 0;
+    size_t count = 0;
+    USBTelemetryRecord * record;
+    while (length + sizeof(USBTelemetryRecord) <= TELEMETRY_PACKET_SIZE && (record = records.peek(count)) != nullptr) {
+        memcpy(&packet[length], record, sizeof(USBTelemetryRecord));
+        length += sizeof(USBTelemetryRecord);
+        count++;
+    }
+
+    endpointBusy = usbd_edpt_xfer(0, endpointIn, packet, length);
+    if (endpointBusy) {
+        records.pop(count);
+    }
+    usbd_edpt_release(0, endpointIn);
+}
+
+uint32_t USBTelemetry::getDropped()
+{
+    return dropped;
+}
+
+void USBTelemetry::inputScanned(uint32_t us)
+{
+    inputScanUs = us;
+    if (us > inputScanMaxUs) {
+        inputScanMaxUs = us;
+    }
+}
@@ -5,11 +5,14 @@
 
 #include "drivermanager.h"
 #include "storagemanager.h"
+#include "usbhostmanager.h"
 #include "eventmanager.h"
 #include "layoutmanager.h"
 #include "peripheralmanager.h"
 #include "animationstorage.h"
 #include "system.h"
+#include "memorytracker.h"
+#include "bootarena.h"
 #include "config_utils.h"
 #include "types.h"
 #include "version.h"
@@ -222,13 +225,15 @@ enum class HttpStatusCode
 
 struct DataAndStatusCode
 {
-    DataAndStatusCode(string&& data, HttpStatusCode statusCode) :
+    DataAndStatusCode(string&& data, HttpStatusCode statusCode, const char* contentType = "application/json") :
         data(std::move(data)),
-        statusCode(statusCode)
+        statusCode(statusCode),
+        contentType(contentType)
     {}
 
     string data;
     HttpStatusCode statusCode;
+    const char* contentType;
 };
 
 // **** WEB SERVER Overrides and Special Functionality ****
@@ -250,7 +255,11 @@ int set_file_data(fs_file* file, const DataAndStatusCode& dataAndStatusCode)
     returnData->append("\r\n");
     returnData->append(
         "Server: GP2040-CE " GP2040VERSION "\r\n"
-        "Content-Type: application/json\r\n"
+        "Content-Type: "
+    );
+    returnData->append(dataAndStatusCode.contentType);
+    returnData->append(
+        "\r\n"
         "Access-Control-Allow-Origin: *\r\n"
         "Content-Length: "
     );
@@ -696,6 +705,8 @@ std::string setGamepadOptions()
     readDoc(gamepadOptions.usbOverrideID, doc, "usbOverrideID");
     readDoc(gamepadOptions.usbVendorID, doc, "usbVendorID");
     readDoc(gamepadOptions.usbProductID, doc, "usbProductID");
+    readDoc(gamepadOptions.usbPollingInterval, doc, "usbPollingInterval");
+    readDoc(gamepadOptions.usbTelemetry, doc, "usbTelemetry");
 
 
     HotkeyOptions& hotkeyOptions = Storage::getInstance().getHotkeyOptions();
@@ -764,6 +775,8 @@ std::string getGamepadOptions()
     char usbProductStr[5];
     snprintf(usbProductStr, 5, "%04X", gamepadOptions.usbProductID);
     writeDoc(doc, "usbProductID", usbProductStr);
+    writeDoc(doc, "usbPollingInterval", gamepadOptions.usbPollingInterval);
+    writeDoc(doc, "usbTelemetry", gamepadOptions.usbTelemetry);
     writeDoc(doc, "fnButtonPin", -1);
     GpioMappingInfo* gpioMappings = Storage::getInstance().getGpioMappings().pins;
     for (unsigned int pin = 0; pin < NUM_BANK0_GPIOS; pin++) {
@@ -1468,7 +1481,6 @@ std::string setExpansionPins()
 static uint32_t calibrationMuxChannels = 0;
 static Pin_t calibrationSelectPins[4];
 static Pin_t calibrationADCPins[4];
-static bool calibrationSmoothing = false;
 static uint32_t calibrationSmoothingFactor = 0;
 static float ema_smoothing;
 static uint32_t smoothingRead = 0;
@@ -1488,7 +1500,6 @@ std::string setHETriggerOptions()
     calibrationADCPins[2] = doc["muxADCPin2"];
     calibrationADCPins[3] = doc["muxADCPin3"];
 
-    calibrationSmoothing = doc["heTriggerSmoothing"];
     calibrationSmoothingFactor = doc["heTriggerSmoothingFactor"];
     ema_smoothing = (float)calibrationSmoothingFactor / 100.f; // 99 = max smoothing factor
 
@@ -1577,17 +1588,13 @@ std::string getHETriggerVoltage()
     }
     adc_select_input(adcSelectPin-26);
     // Web-Config triggers getHECalibration every 50ms, game controller triggers <1ms
-    if ( calibrationSmoothing ) {
-        uint16_t read;
-        for(int i = 0; i < 50; i++) {
-            read = adc_read();
-            read = emaCalculation(read, smoothingRead);
-            smoothingRead = read;
-        }
-        doc["voltage"] = read;
-    } else {
-        doc["voltage"] = adc_read();
+    uint16_t read;
+    for(int i = 0; i < 50; i++) {
+        read = adc_read();
+        read = emaCalculation(read, smoothingRead);
+        smoothingRead = read;
     }
+    doc["voltage"] = read;
     return serialize_json(doc);
 }
 
@@ -1609,6 +1616,7 @@ std::string getHETriggerCalibrations()
         trigger["release"] = heTriggers[i].release;
         trigger["noise"] = heTriggers[i].noise;
         trigger["rapidTrigger"] = heTriggers[i].rapidTrigger;
+        trigger["filter"] = heTriggers[i].filter;
     }
 
     return serialize_json(doc);
@@ -1629,6 +1637,7 @@ std::string setHETriggerCalibrations()
         heTriggers[i].release = doc["triggers"][i]["release"];
         heTriggers[i].noise = doc["triggers"][i]["noise"];
         heTriggers[i].rapidTrigger = doc["triggers"][i]["rapidTrigger"];
+        heTriggers[i].filter = doc["triggers"][i]["filter"];
     }
     
     Storage::getInstance().getAddonOptions().heTriggerOptions.triggers_count = 32;
@@ -1706,6 +1715,12 @@ std::string setAddonOptions()
     docToValue(analogOptions.smoothing_factor2, doc, "smoothing_factor2");
     docToValue(analogOptions.analog_error, doc, "analog_error");
     docToValue(analogOptions.analog_error2, doc, "analog_error2");
+    docToValue(analogOptions.analog_filter, doc, "analog_filter");
+    docToValue(analogOptions.analog_filter2, doc, "analog_filter2");
+    docToValue(analogOptions.filter_min_cutoff, doc, "filter_min_cutoff");
+    docToValue(analogOptions.filter_min_cutoff2, doc, "filter_min_cutoff2");
+    docToValue(analogOptions.filter_beta, doc, "filter_beta");
+    docToValue(analogOptions.filter_beta2, doc, "filter_beta2");
     docToValue(analogOptions.enabled, doc, "AnalogInputEnabled");
 
     BootselButtonOptions& bootselButtonOptions = Storage::getInstance().getAddonOptions().bootselButtonOptions;
@@ -1820,6 +1835,7 @@ std::string setAddonOptions()
     docToValue(keyboardHostOptions.mouseRight, doc, "keyboardHostMouseRight");
     docToValue(keyboardHostOptions.mouseSensitivity, doc, "keyboardHostMouseSensitivity");
     docToValue(keyboardHostOptions.movementMode, doc, "keyboardHostMouseMovement");
+    docToValue(keyboardHostOptions.mouseAcceleration, doc, "keyboardHostMouseAcceleration");
 
     GamepadUSBHostOptions& gamepadUSBHostOptions = Storage::getInstance().getAddonOptions().gamepadUSBHostOptions;
     docToValue(gamepadUSBHostOptions.enabled, doc, "GamepadUSBHostAddonEnabled");
@@ -1886,8 +1902,10 @@ std::string setAddonOptions()
     docToPin(heTriggerOptions.muxADCPin1, doc, "muxADCPin1");
     docToPin(heTriggerOptions.muxADCPin2, doc, "muxADCPin2");
     docToPin(heTriggerOptions.muxADCPin3, doc, "muxADCPin3");
-    docToValue(heTriggerOptions.emaSmoothing, doc, "heTriggerSmoothing");
     docToValue(heTriggerOptions.smoothingFactor, doc, "heTriggerSmoothingFactor");
+    docToValue(heTriggerOptions.filterMinCutoff, doc, "heTriggerFilterMinCutoff");
+    docToValue(heTriggerOptions.filterBeta, doc, "heTriggerFilterBeta");
+    docToValue(heTriggerOptions.muxSettleTime, doc, "muxSettleTime");
 
     EventManager::getInstance().triggerEvent(new GPStorageSaveEvent(true));
 
@@ -2164,6 +2182,12 @@ std::string getAddonOptions()
     writeDoc(doc, "smoothing_factor2", analogOptions.smoothing_factor2);
     writeDoc(doc, "analog_error", analogOptions.analog_error);
     writeDoc(doc, "analog_error2", analogOptions.analog_error2);
+    writeDoc(doc, "analog_filter", analogOptions.analog_filter);
+    writeDoc(doc, "analog_filter2", analogOptions.analog_filter2);
+    writeDoc(doc, "filter_min_cutoff", analogOptions.filter_min_cutoff);
+    writeDoc(doc, "filter_min_cutoff2", analogOptions.filter_min_cutoff2);
+    writeDoc(doc, "filter_beta", analogOptions.filter_beta);
+    writeDoc(doc, "filter_beta2", analogOptions.filter_beta2);
     writeDoc(doc, "AnalogInputEnabled", analogOptions.enabled);
 
     const BootselButtonOptions& bootselButtonOptions = Storage::getInstance().getAddonOptions().bootselButtonOptions;
@@ -2272,6 +2296,7 @@ std::string getAddonOptions()
     writeDoc(doc, "keyboardHostMouseRight", keyboardHostOptions.mouseRight);
     writeDoc(doc, "keyboardHostMouseSensitivity", keyboardHostOptions.mouseSensitivity);
     writeDoc(doc, "keyboardHostMouseMovement", keyboardHostOptions.movementMode);
+    writeDoc(doc, "keyboardHostMouseAcceleration", keyboardHostOptions.mouseAcceleration);
 
     const GamepadUSBHostOptions& gamepadUSBHostOptions = Storage::getInstance().getAddonOptions().gamepadUSBHostOptions;
     writeDoc(doc, "GamepadUSBHostAddonEnabled", gamepadUSBHostOptions.enabled);
@@ -2344,8 +2369,10 @@ std::string getAddonOptions()
     writeDoc(doc, "muxADCPin1", cleanPin(heTriggerOptions.muxADCPin1));
     writeDoc(doc, "muxADCPin2", cleanPin(heTriggerOptions.muxADCPin2));
     writeDoc(doc, "muxADCPin3", cleanPin(heTriggerOptions.muxADCPin3));
-    writeDoc(doc, "heTriggerSmoothing", heTriggerOptions.emaSmoothing);
     writeDoc(doc, "heTriggerSmoothingFactor", heTriggerOptions.smoothingFactor);
+    writeDoc(doc, "heTriggerFilterMinCutoff", heTriggerOptions.filterMinCutoff);
+    writeDoc(doc, "heTriggerFilterBeta", heTriggerOptions.filterBeta);
+    writeDoc(doc, "muxSettleTime", heTriggerOptions.muxSettleTime);
 
     return serialize_json(doc);
 }
@@ -2442,7 +2469,8 @@ std::string getFirmwareVersion()
 
 std::string getMemoryReport()
 {
-    const size_t capacity = JSON_OBJECT_SIZE(10);
+    const size_t capacity = JSON_OBJECT_SIZE(16) + JSON_ARRAY_SIZE(MEMORY_TRACKER_MAX_TAGS) +
+        MEMORY_TRACKER_MAX_TAGS * (JSON_OBJECT_SIZE(5) + MEMORY_TRACKER_TAG_NAME_LENGTH);
     DynamicJsonDocument doc(capacity);
     writeDoc(doc, "totalFlash", System::getTotalFlash());
     writeDoc(doc, "usedFlash", System::getUsedFlash());
@@ -2450,6 +2478,39 @@ std::string getMemoryReport()
     writeDoc(doc, "staticAllocs", System::getStaticAllocs());
     writeDoc(doc, "totalHeap", System::getTotalHeap());
     writeDoc(doc, "usedHeap", System::getUsedHeap());
+    writeDoc(doc, "largestFreeBlock", System::getLargestFreeHeapBlock());
+    writeDoc(doc, "fragmentedHeap", System::getFragmentedHeap());
+    writeDoc(doc, "trackedHeap", MemoryTracker::getLiveBytes());
+    writeDoc(doc, "peakTrackedHeap", MemoryTracker::getPeakBytes());
+    writeDoc(doc, "bootArenaSize", BootArena::getSize());
+    writeDoc(doc, "bootArenaUsed", BootArena::getUsed());
+    writeDoc(doc, "bootArenaOverflow", BootArena::getOverflow());
+    writeDoc(doc, "bootArenaInvalidFrees", BootArena::getInvalidFrees());
+
+    // Per subsystem attribution of operator new allocations
+    JsonArray allocations = doc.createNestedArray("allocations");
+    MemoryTracker::TagStats stats;
+    for (uint32_t tag = 0; tag < MemoryTracker::getTagCount(); tag++) {
+        if (MemoryTracker::getTagStats(tag, stats)) {
+            JsonObject allocation = allocations.createNestedObject();
+            allocation["name"] = stats.name; // char[] is copied into the document
+            allocation["liveBytes"] = stats.liveBytes;
+            allocation["peakBytes"] = stats.peakBytes;
+            allocation["liveCount"] = stats.liveCount;
+            allocation["allocCount"] = stats.allocCount;
+        }
+    }
+    return serialize_json(doc);
+}
+
+std::string getUSBHostStats()
+{
+    USBHostManager & usbHost = USBHostManager::getInstance();
+    DynamicJsonDocument doc(JSON_OBJECT_SIZE(4));
+    writeDoc(doc, "devices", usbHost.getDeviceCount());
+    writeDoc(doc, "maxProcessUs", usbHost.getMaxProcessUs());
+    writeDoc(doc, "queueOverflows", usbHost.getQueueOverflows());
+    writeDoc(doc, "unclaimedEvents", usbHost.getUnclaimedEvents());
     return serialize_json(doc);
 }
 
@@ -2548,6 +2609,43 @@ DataAndStatusCode setConfig()
     }
 }
 
+// Raw nanopb encoded config for bulk provisioning, see ConfigUtils::toProtobuf for the format
+DataAndStatusCode getConfigProtobuf()
+{
+    std::string data;
+    if (ConfigUtils::toProtobuf(Storage::getInstance().getConfig(), data))
+    {
+        return DataAndStatusCode(std::move(data), HttpStatusCode::_200, "application/x-protobuf");
+    }
+    else
+    {
+        return DataAndStatusCode("{ \"error\": \"internal error while encoding config\" }", HttpStatusCode::_500);
+    }
+}
+
+DataAndStatusCode setConfigProtobuf()
+{
+    // Store config struct on the heap to avoid stack overflow
+    std::unique_ptr<Config> config(new Config);
+    if (ConfigUtils::fromProtobuf(*config.get(), reinterpret_cast<const uint8_t*>(http_post_payload), http_post_payload_len))
+    {
+        Storage::getInstance().getConfig() = *config.get();
+        config.reset();
+        if (Storage::getInstance().save(true))
+        {
+            return DataAndStatusCode("{ \"success\": true }", HttpStatusCode::_200);
+        }
+        else
+        {
+            return DataAndStatusCode("{ \"error\": \"internal error while saving config\" }", HttpStatusCode::_500);
+        }
+    }
+    else
+    {
+        return DataAndStatusCode("{ \"error\": \"invalid protobuf config\" }", HttpStatusCode::_400);
+    }
+}
+
 // This should be a storage feature
 std::string resetSettings()
 {
@@ -2721,6 +2819,7 @@ static const std::pair<const char*, HandlerFuncPtr> handlerFuncs[] =
     { "/api/getSplashImage", getSplashImage },
     { "/api/getFirmwareVersion", getFirmwareVersion },
     { "/api/getMemoryReport", getMemoryReport },
+    { "/api/getUSBHostStats", getUSBHostStats },
     { "/api/getHeldPins", getHeldPins },
     { "/api/abortGetHeldPins", abortGetHeldPins },
     { "/api/getUsedPins", getUsedPins },
@@ -2736,10 +2835,14 @@ typedef DataAndStatusCode (*HandlerFuncStatusCodePtr)();
 static const std::pair<const char*, HandlerFuncStatusCodePtr> handlerFuncsWithStatusCode[] =
 {
     { "/api/setConfig", setConfig },
+    { "/api/getConfigProtobuf", getConfigProtobuf },
+    { "/api/setConfigProtobuf", setConfigProtobuf },
 };
 
 int fs_open_custom(struct fs_file *file, const char *name)
 {
+    MemoryTracker::Scope memoryScope(MemoryTracker::TAG_WEBCONFIG);
+
     for (const auto& handlerFunc : handlerFuncs)
     {
         if (strcmp(handlerFunc.first, name) == 0)
@@ -0,0 +1,367 @@
+#include "adcservice.h"
+#include "hardware/adc.h"
+#include "hardware/dma.h"
+
+#include <cstdio>
+#include <algorithm>
+#include <cstdlib>
+#include <deque>
+#include <vector>
+
+#include "test.h"
+
+// ADCService against an emulated RP2040 ADC and DMA channel. Every tick the ADC converts the selected input, pushes
+// the result into its 4 deep FIFO and moves on to the next input of the round-robin mask; the DMA channel takes FIFO
+// entries with a random lag and writes them through its address ring. Each sample carries its input in the top bits
+// and its conversion index in the rest, so a read tells which input and which conversion it came from.
+//   adcservice_test <input mask>
+
+#define ADC_FIFO_DEPTH 4
+
+static uint32_t randomState = 0x12345678;
+
+static uint32_t randomNext()
+{
+    randomState ^= randomState << 13;
+    randomState ^= randomState >> 17;
+    randomState ^= randomState << 5;
+    return randomState;
+}
+
+static uint16_t sampleOf(uint8_t input, uint32_t conversion) {
+    return (input << 10) | (conversion & 0x3FF);
+}
+
+struct Transfer {
+    uint16_t value;
+    uint32_t tick;
+};
+
+static adc_hw_t adcRegisters = { ADC_CS_READY_BITS, 0, 0, 0 };
+adc_hw_t * const adc_hw = &adcRegisters;
+
+static struct {
+    uint32_t ticks = 0;
+    uint32_t conversions = 0;
+    uint8_t ainsel = 0;
+    uint8_t roundRobin = 0;
+    bool startMany = false;
+    bool finishing = false; // the conversion in flight when adc_run(false) was called
+    bool fifoEnabled = false;
+    bool dreqEnabled = false;
+    bool fifoOverflow = false;
+    std::deque<Transfer> fifo;
+
+    dma_channel_hw_t channel = {};
+    uint32_t ringBits = 0;
+    uint32_t dreq = 0;
+    uintptr_t ringBase = 0;
+    bool dmaActive = false;
+    bool ringMoved = false;
+    uint32_t configures = 0;
+    uint32_t transfers = 0;
+    std::vector<Transfer> history[ADC_SERVICE_INPUTS];
+} hw;
+
+static void convert() {
+    const Transfer sample = { sampleOf(hw.ainsel, hw.conversions++), hw.ticks };
+    adc_hw->result = sample.value;
+    if (hw.fifoEnabled) {
+        if (hw.fifo.size() == ADC_FIFO_DEPTH) {
+            hw.fifoOverflow = true;
+        } else {
+            hw.fifo.push_back(sample);
+        }
+    }
+    if (hw.roundRobin != 0) {
+        do {
+            hw.ainsel = (hw.ainsel + 1) % ADC_SERVICE_INPUTS;
+        } while (!(hw.roundRobin & (1 << hw.ainsel)));
+    }
+}
+
+static void transfer() {
+    const Transfer sample = hw.fifo.front();
+    hw.fifo.pop_front();
+    CHECK(hw.channel.read_addr == (uintptr_t)&adc_hw->fifo);
+    const uintptr_t mask = (1u << hw.ringBits) - 1;
+    *(uint16_t *)(hw.channel.write_addr) = sample.value;
+    hw.channel.write_addr = (hw.channel.write_addr & ~mask) | ((hw.channel.write_addr + sizeof(uint16_t)) & mask);
+    hw.channel.transfer_count--;
+    hw.dmaActive = hw.channel.transfer_count > 0;
+    hw.transfers++;
+    hw.history[sample.value >> 10].push_back(sample);
+}
+
+// One conversion time, the DMA channel lags the ADC by up to three FIFO entries
+static void step() {
+    hw.ticks++;
+    if (hw.startMany || hw.finishing) {
+        convert();
+        hw.finishing = false;
+    }
+    adc_hw->cs = (hw.startMany || hw.finishing) ? 0 : ADC_CS_READY_BITS;
+    if (hw.dmaActive && hw.dreqEnabled && hw.dreq == DREQ_ADC) {
+        const size_t take = hw.fifo.size() >= ADC_FIFO_DEPTH - 1 ? hw.fifo.size() : randomNext() % (hw.fifo.size() + 1);
+        for (size_t i = 0; i < take; i++) {
+            transfer();
+        }
+    }
+}
+
+static void run(uint32_t ticks) {
+    for (uint32_t i = 0; i < ticks; i++) {
+        step();
+    }
+}
+
+// Skips whole periods of the round and the ring, so every ring position keeps its input and the samples in the ring
+// still match the history, only the counters move on
+static void fastForward(uint32_t count, uint32_t transfers) {
+    const uint32_t period = count * ADC_SERVICE_RING_SIZE;
+    transfers -= transfers % period;
+    hw.channel.transfer_count -= transfers;
+    hw.transfers += transfers;
+    hw.conversions += transfers;
+    hw.ticks += transfers;
+    for (std::vector<Transfer> & history : hw.history) {
+        for (Transfer & sample : history) {
+            sample.tick += transfers;
+        }
+    }
+}
+
+extern "C" {
+void tight_loop_contents(void) { step(); }
+
+void adc_init(void) {}
+void adc_gpio_init(uint gpio) {}
+void adc_select_input(uint input) { hw.ainsel = input; }
+uint adc_get_selected_input(void) { return hw.ainsel; }
+void adc_set_round_robin(uint input_mask) { hw.roundRobin = input_mask; }
+void adc_run(bool run) {
+    if (!run && hw.startMany) {
+        hw.finishing = true;
+    }
+    hw.startMany = run;
+    adc_hw->cs = (hw.startMany || hw.finishing) ? 0 : ADC_CS_READY_BITS;
+}
+uint16_t adc_read(void) {
+    // A blocking conversion while the ADC is free-running would take a sample out of the round
+    CHECK(!hw.startMany && !hw.finishing);
+    hw.ticks++;
+    convert();
+    return adc_hw->result;
+}
+void adc_fifo_setup(bool en, bool dreq_en, uint16_t dreq_thresh, bool err_in_fifo, bool byte_shift) {
+    hw.fifoEnabled = en;
+    hw.dreqEnabled = dreq_en;
+    CHECK(!en || (dreq_thresh == 1 && !err_in_fifo && !byte_shift));
+}
+uint8_t adc_fifo_get_level(void) { return hw.fifo.size(); }
+void adc_fifo_drain(void) { hw.fifo.clear(); }
+
+int dma_claim_unused_channel(bool required) { return 3; }
+dma_channel_hw_t * dma_channel_hw_addr(uint channel) {
+    CHECK(channel == 3);
+    return &hw.channel;
+}
+dma_channel_config dma_channel_get_default_config(uint channel) { return dma_channel_config { 0 }; }
+void channel_config_set_transfer_data_size(dma_channel_config * c, enum dma_channel_transfer_size size) { CHECK(size == DMA_SIZE_16); }
+void channel_config_set_read_increment(dma_channel_config * c, bool incr) { CHECK(!incr); }
+void channel_config_set_write_increment(dma_channel_config * c, bool incr) { CHECK(incr); }
+void channel_config_set_ring(dma_channel_config * c, bool write, uint size_bits) {
+    CHECK(write);
+    hw.ringBits = size_bits;
+}
+void channel_config_set_dreq(dma_channel_config * c, uint dreq) { hw.dreq = dreq; }
+void dma_channel_configure(uint channel, const dma_channel_config * config, volatile void * write_addr,
+                           const volatile void * read_addr, uint transfer_count, bool trigger) {
+    CHECK(!hw.dmaActive);
+    hw.channel.write_addr = (uintptr_t)write_addr;
+    hw.channel.read_addr = (uintptr_t)read_addr;
+    hw.channel.transfer_count = transfer_count;
+    hw.dmaActive = trigger;
+    hw.configures++;
+
+    // The ring has to stay in one aligned block of its size, restarts included
+    const uintptr_t ringBase = hw.channel.write_addr & ~(uintptr_t)((1u << hw.ringBits) - 1);
+    if (hw.ringBase != 0 && hw.ringBase != ringBase) {
+        hw.ringMoved = true;
+    }
+    hw.ringBase = ringBase;
+}
+void dma_channel_abort(uint channel) { hw.dmaActive = false; }
+}
+
+static uint32_t inputMask = 0;
+static uint8_t inputs[ADC_SERVICE_INPUTS];
+static uint8_t inputCount = 0;
+static uint32_t launchTick = 0;
+static uint32_t worstAge = 0;
+static uint32_t lastSampleCount = 0;
+
+// What read() has to return: the average of the newest samples of the input that reached the ring
+static uint16_t expected(uint8_t input, uint32_t samples) {
+    const std::vector<Transfer> & history = hw.history[input];
+    if (history.empty()) {
+        return 0;
+    }
+    const uint32_t n = std::min<uint32_t>(std::min<uint32_t>(std::max<uint32_t>(samples, 1), ADC_SERVICE_MAX_SAMPLES), history.size());
+    uint32_t sum = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        sum += history[history.size() - 1 - i].value;
+    }
+    return sum / n;
+}
+
+static void checkRead(uint8_t input, uint32_t samples, bool paused) {
+    const uint16_t value = ADCService::read(ADC_SERVICE_FIRST_PIN + input, samples);
+    CHECK_EQ(value, expected(input, samples));
+    if (samples == 1) {
+        CHECK_EQ(value >> 10, input);
+    }
+
+    // Once a round has gone by since the last (re)start, the newest sample of every input is at most a round old
+    // plus what the DMA channel still has to take from the FIFO
+    if (!paused && !hw.history[input].empty() && hw.ticks - launchTick >= inputCount + ADC_FIFO_DEPTH) {
+        const uint32_t age = hw.ticks - hw.history[input].back().tick;
+        worstAge = std::max(worstAge, age);
+        CHECK(age <= inputCount + ADC_FIFO_DEPTH - 1);
+    }
+
+    const uint32_t sampleCount = ADCService::getSampleCount();
+    CHECK_EQ(sampleCount, hw.transfers);
+    CHECK(sampleCount >= lastSampleCount);
+    lastSampleCount = sampleCount;
+}
+
+static uint8_t randomInput() {
+    return inputs[randomNext() % inputCount];
+}
+
+void testBeforeStart() {
+    // Not running yet, reads are blocking conversions of the pin asked for
+    CHECK(!ADCService::isRunning());
+    for (uint8_t input = 0; input < ADC_SERVICE_INPUTS; input++) {
+        const uint32_t conversion = hw.conversions;
+        CHECK_EQ(ADCService::read(ADC_SERVICE_FIRST_PIN + input, 1), sampleOf(input, conversion));
+    }
+    CHECK_EQ(ADCService::getSampleCount(), 0u);
+    CHECK_EQ(hw.transfers, 0u);
+}
+
+void testStart() {
+    ADCService::start();
+    launchTick = hw.ticks;
+    CHECK(ADCService::isRunning());
+    CHECK(hw.startMany);
+    CHECK_EQ(hw.roundRobin, inputMask);
+    // start() waits for a sample of every input
+    for (uint8_t i = 0; i < inputCount; i++) {
+        CHECK(!hw.history[inputs[i]].empty());
+    }
+    CHECK(!ADCService::addChannel(ADC_SERVICE_FIRST_PIN));
+}
+
+// Free-running reads of random inputs and sample counts, with pauses, reads while paused and blocking reads of
+// registered and unregistered pins in between
+void testInterleaved() {
+    for (uint32_t i = 0; i < 200000; i++) {
+        run(randomNext() % 16);
+        const uint32_t action = randomNext() % 100;
+        if (action < 85) {
+            checkRead(randomInput(), randomNext() % 3 == 0 ? 1 : randomNext() % (ADC_SERVICE_MAX_SAMPLES + 4), false);
+        } else if (action < 93) {
+            const uint8_t input = randomNext() % ADC_SERVICE_INPUTS;
+            const uint32_t samples = 1 + randomNext() % 4;
+            const uint16_t value = ADCService::readBlocking(ADC_SERVICE_FIRST_PIN + input, samples);
+            launchTick = hw.ticks;
+            CHECK(ADCService::isRunning());
+            if (samples == 1) {
+                CHECK_EQ(value, sampleOf(input, hw.conversions - 1));
+                // The blocking conversion did not reach the ring
+                CHECK(hw.history[input].empty() || hw.history[input].back().value != value);
+            } else {
+                CHECK_EQ(value >> 10, input);
+            }
+        } else {
+            ADCService::pause();
+            CHECK(!ADCService::isRunning());
+            CHECK(!hw.startMany && !hw.dmaActive);
+            CHECK_EQ(hw.fifo.size(), 0u);
+            const uint32_t transfers = hw.transfers;
+            const uint32_t reads = randomNext() % 4;
+            for (uint32_t r = 0; r < reads; r++) {
+                run(randomNext() % 8);
+                checkRead(randomInput(), 1 + randomNext() % ADC_SERVICE_MAX_SAMPLES, true);
+                // Blocking conversions behind an external mux, none of them reaches the ring
+                ADCService::readBlocking(ADC_SERVICE_FIRST_PIN + randomInput(), 2);
+                CHECK(!ADCService::isRunning());
+            }
+            CHECK_EQ(hw.transfers, transfers);
+            ADCService::resume();
+            launchTick = hw.ticks;
+            CHECK(ADCService::isRunning());
+        }
+        if (testFailures > 0) {
+            printf("failed at step %u\n", i);
+            return;
+        }
+    }
+    CHECK(!hw.fifoOverflow);
+    CHECK(!hw.ringMoved);
+}
+
+// Close to the restart threshold the next read re-arms the DMA channel and folds the sample index; reads on both
+// sides of it still come from the right input and the sample count goes on counting
+void testRestart() {
+    const uint32_t configures = hw.configures;
+    const uint32_t sampleCount = ADCService::getSampleCount();
+    fastForward(inputCount, 0x80000000u - (sampleCount % 0x80000000u) + 4 * inputCount * ADC_SERVICE_RING_SIZE);
+    CHECK(ADCService::getSampleCount() > sampleCount);
+    lastSampleCount = ADCService::getSampleCount();
+
+    for (uint32_t i = 0; i < 20000; i++) {
+        run(randomNext() % 16);
+        const uint32_t before = hw.configures;
+        checkRead(randomInput(), 1 + randomNext() % ADC_SERVICE_MAX_SAMPLES, false);
+        if (hw.configures != before) {
+            launchTick = hw.ticks;
+        }
+        if (i % 1000 == 999) {
+            ADCService::pause();
+            ADCService::resume();
+            launchTick = hw.ticks;
+        }
+    }
+    CHECK(hw.configures > configures);
+    CHECK(!hw.fifoOverflow);
+    CHECK(!hw.ringMoved);
+    printf("restarted after %u samples, count %u\n", sampleCount, ADCService::getSampleCount());
+}
+
+int main(int argc, char ** argv) {
+    inputMask = argc > 1 ? strtoul(argv[1], nullptr, 0) : 0xF;
+    CHECK(!ADCService::addChannel(ADC_SERVICE_FIRST_PIN - 1));
+    CHECK(!ADCService::addChannel(ADC_SERVICE_FIRST_PIN + ADC_SERVICE_INPUTS));
+    for (uint8_t input = 0; input < ADC_SERVICE_INPUTS; input++) {
+        if (inputMask & (1 << input)) {
+            CHECK(ADCService::addChannel(ADC_SERVICE_FIRST_PIN + input));
+            inputs[inputCount++] = input;
+        }
+    }
+    if (inputCount == 0) {
+        printf("no ADC inputs in mask 0x%x\n", inputMask);
+        return 1;
+    }
+
+    testBeforeStart();
+    testStart();
+    testInterleaved();
+    testRestart();
+
+    printf("inputs 0x%x: %u samples, newest sample at most %u conversions old\n", inputMask, hw.transfers, worstAge);
+
+    return TEST_RESULT();
+}
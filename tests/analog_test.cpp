@@ -0,0 +1,322 @@
+#include "addons/analog.h"
+#include "adcservice.h"
+#include "drivermanager.h"
+#include "storagemanager.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+
+#include "test.h"
+
+// The fixed point stick pipeline of AnalogInput against the float pipeline it replaced, over every pair of 12-bit
+// ADC readings for a set of deadzone, error, circularity, calibration and joystick range settings
+
+#define ADC_MAX 4095
+#define STICK_X_PIN 26
+#define STICK_Y_PIN 27
+
+static uint16_t adcValues[ADC_SERVICE_INPUTS];
+
+namespace ADCService {
+    bool addChannel(Pin_t pin) { return true; }
+    void start() {}
+    bool isRunning() { return true; }
+    uint16_t read(Pin_t pin) { return adcValues[pin - ADC_SERVICE_FIRST_PIN]; }
+    uint16_t read(Pin_t pin, uint32_t samples) { return adcValues[pin - ADC_SERVICE_FIRST_PIN]; }
+    uint16_t readBlocking(Pin_t pin) { return adcValues[pin - ADC_SERVICE_FIRST_PIN]; }
+    uint16_t readBlocking(Pin_t pin, uint32_t samples) { return adcValues[pin - ADC_SERVICE_FIRST_PIN]; }
+    void pause() {}
+    void resume() {}
+    uint32_t getSampleCount() { return 0; }
+}
+
+uint64_t getMicro() { return 0; }
+
+Gamepad::Gamepad() :
+    options(Storage::getInstance().gamepadOptions)
+    , hotkeyOptions(Storage::getInstance().hotkeyOptions)
+{
+}
+
+// Only the joystick range of the active driver matters to the analog add-on
+class RangeDriver : public GPDriver {
+public:
+    explicit RangeDriver(uint16_t mid) : mid(mid) {}
+    virtual void initialize() {}
+    virtual void initializeAux() {}
+    virtual bool process(Gamepad * gamepad) { return false; }
+    virtual void processAux() {}
+    virtual uint16_t get_report(uint8_t report_id, hid_report_type_t report_type, uint8_t *buffer, uint16_t reqlen) { return 0; }
+    virtual void set_report(uint8_t report_id, hid_report_type_t report_type, uint8_t const *buffer, uint16_t bufsize) {}
+    virtual bool vendor_control_xfer_cb(uint8_t rhport, uint8_t stage, tusb_control_request_t const *request) { return false; }
+    virtual const uint16_t * get_descriptor_string_cb(uint8_t index, uint16_t langid) { return nullptr; }
+    virtual const uint8_t * get_descriptor_device_cb() { return nullptr; }
+    virtual const uint8_t * get_hid_descriptor_report_cb(uint8_t itf) { return nullptr; }
+    virtual const uint8_t * get_descriptor_configuration_cb(uint8_t index) { return nullptr; }
+    virtual const uint8_t * get_descriptor_device_qualifier_cb() { return nullptr; }
+    virtual uint16_t GetJoystickMidValue() { return mid; }
+    virtual USBListener * get_usb_auth_listener() { return nullptr; }
+private:
+    uint16_t mid;
+};
+
+static RangeDriver xinputRange(0x8000);
+static RangeDriver hidRange(0x7FFF);
+
+// The test selects the driver range through the input mode, config mode has no driver
+void DriverManager::setup(InputMode mode) {
+    inputMode = mode;
+    if (mode == INPUT_MODE_XINPUT) {
+        driver = &xinputRange;
+    } else if (mode == INPUT_MODE_GENERIC) {
+        driver = &hidRange;
+    } else {
+        driver = nullptr;
+    }
+}
+
+// AnalogInput before fixed point, for one stick without smoothing
+struct FloatStick {
+    float x_value, y_value;
+    float x_magnitude, y_magnitude, xy_magnitude;
+    uint16_t x_center, y_center;
+    float error_rate, in_deadzone, out_deadzone;
+    bool auto_calibration, forced_circularity;
+    InvertMode analog_invert;
+
+    uint16_t map(uint16_t x, uint16_t in_min, uint16_t in_max, uint16_t out_min, uint16_t out_max) {
+        return (x - in_min) * (out_max - out_min) / (in_max - in_min) + out_min;
+    }
+
+    float readPin(uint16_t adc_value, uint16_t center) {
+        if (auto_calibration || center != 0) {
+            if (adc_value > center) {
+                adc_value = map(adc_value, center, ADC_MAX, ADC_MAX / 2, ADC_MAX);
+            } else if (adc_value == center) {
+                adc_value = ADC_MAX / 2;
+            } else {
+                adc_value = map(adc_value, 0, center, 0, ADC_MAX / 2);
+            }
+        }
+        return ((float)adc_value) / ADC_MAX;
+    }
+
+    void process(uint16_t adcX, uint16_t adcY, uint32_t joystickMax, uint16_t & outX, uint16_t & outY) {
+        x_value = readPin(adcX, x_center);
+        if (analog_invert == InvertMode::INVERT_X || analog_invert == InvertMode::INVERT_XY) {
+            x_value = 1.0f - x_value;
+        }
+        y_value = readPin(adcY, y_center);
+        if (analog_invert == InvertMode::INVERT_Y || analog_invert == InvertMode::INVERT_XY) {
+            y_value = 1.0f - y_value;
+        }
+        x_magnitude = x_value - 0.5f;
+        y_magnitude = y_value - 0.5f;
+        xy_magnitude = error_rate * std::sqrt((x_magnitude * x_magnitude) + (y_magnitude * y_magnitude));
+        if (xy_magnitude < in_deadzone) {
+            x_value = 0.5f;
+            y_value = 0.5f;
+        } else {
+            float scaling_factor = (xy_magnitude - in_deadzone) / (out_deadzone - in_deadzone);
+            if (forced_circularity == true) {
+                scaling_factor = std::fmin(scaling_factor, 0.5f);
+            }
+            x_value = ((x_magnitude / xy_magnitude) * scaling_factor) + 0.5f;
+            y_value = ((y_magnitude / xy_magnitude) * scaling_factor) + 0.5f;
+            x_value = std::clamp(x_value, 0.0f, 1.0f);
+            y_value = std::clamp(y_value, 0.0f, 1.0f);
+        }
+        outX = (uint16_t)std::min((uint32_t)(joystickMax * std::min(x_value, 1.0f)), (uint32_t)0xFFFF);
+        outY = (uint16_t)std::min((uint32_t)(joystickMax * std::min(y_value, 1.0f)), (uint32_t)0xFFFF);
+    }
+};
+
+struct SweepSettings {
+    const char * name;
+    uint32_t innerDeadzone;
+    uint32_t outerDeadzone;
+    uint32_t errorRate;
+    bool forcedCircularity;
+    bool autoCalibrate;
+    uint16_t centerX;           // manual calibration, or the resting reading for auto calibration
+    uint16_t centerY;
+    InvertMode invert;
+    InputMode mode;
+};
+
+static const SweepSettings sweeps[] = {
+    { "defaults", 5, 95, 1000, false, false, 0, 0, INVERT_NONE, INPUT_MODE_CONFIG },
+    { "no deadzone, circular", 0, 100, 1000, true, false, 0, 0, INVERT_NONE, INPUT_MODE_CONFIG },
+    { "auto calibrated, error 950", 10, 90, 950, true, true, 2000, 2100, INVERT_NONE, INPUT_MODE_XINPUT },
+    { "manual calibration, error 1050", 20, 70, 1050, false, false, 1800, 2300, INVERT_XY, INPUT_MODE_XINPUT },
+    { "0x7FFF mid, inverted X", 15, 85, 1000, true, false, 0, 0, INVERT_X, INPUT_MODE_GENERIC },
+};
+
+static void setupStick(const SweepSettings & settings, AnalogInput & analog, FloatStick & reference)
+{
+    AnalogOptions & options = Storage::getInstance().getAddonOptions().analogOptions;
+    options = {};
+    options.enabled = true;
+    options.analogAdc1PinX = STICK_X_PIN;
+    options.analogAdc1PinY = STICK_Y_PIN;
+    options.analogAdc1Mode = DPAD_MODE_LEFT_ANALOG;
+    options.analogAdc1Invert = settings.invert;
+    options.analogAdc2PinX = -1;
+    options.analogAdc2PinY = -1;
+    options.analog_filter = ANALOG_FILTER_NONE;
+    options.inner_deadzone = settings.innerDeadzone;
+    options.outer_deadzone = settings.outerDeadzone;
+    options.analog_error = settings.errorRate;
+    options.forced_circularity = settings.forcedCircularity;
+    options.auto_calibrate = settings.autoCalibrate;
+    if (!settings.autoCalibrate) {
+        options.joystick_center_x = settings.centerX;
+        options.joystick_center_y = settings.centerY;
+    }
+    adcValues[STICK_X_PIN - ADC_SERVICE_FIRST_PIN] = settings.centerX;
+    adcValues[STICK_Y_PIN - ADC_SERVICE_FIRST_PIN] = settings.centerY;
+    DriverManager::getInstance().setup(settings.mode);
+    analog.setup();
+
+    reference = {};
+    reference.x_center = settings.centerX;
+    reference.y_center = settings.centerY;
+    reference.error_rate = settings.errorRate / 1000.0f;
+    reference.in_deadzone = settings.innerDeadzone / 100.0f;
+    reference.out_deadzone = settings.outerDeadzone / 100.0f;
+    reference.auto_calibration = settings.autoCalibrate;
+    reference.forced_circularity = settings.forcedCircularity;
+    reference.analog_invert = settings.invert;
+}
+
+static void testSweep(const SweepSettings & settings)
+{
+    Gamepad gamepad;
+    Storage::getInstance().gamepad = &gamepad;
+    AnalogInput analog;
+    FloatStick reference;
+    setupStick(settings, analog, reference);
+    GPDriver * driver = DriverManager::getInstance().getDriver();
+    const uint32_t joystickMax = driver != nullptr ? driver->GetJoystickMidValue() * 2 : GAMEPAD_JOYSTICK_MAX;
+
+    uint32_t worst = 0;
+    uint32_t deadzoneEdge = 0;
+    uint32_t mismatches = 0;
+    for (uint32_t x = 0; x <= ADC_MAX; x++) {
+        for (uint32_t y = 0; y <= ADC_MAX; y++) {
+            adcValues[STICK_X_PIN - ADC_SERVICE_FIRST_PIN] = x;
+            adcValues[STICK_Y_PIN - ADC_SERVICE_FIRST_PIN] = y;
+            analog.process();
+            uint16_t expectedX, expectedY;
+            reference.process(x, y, joystickMax, expectedX, expectedY);
+
+            const uint32_t error = std::max(std::abs(gamepad.state.lx - expectedX), std::abs(gamepad.state.ly - expectedY));
+            if (error <= 1) {
+                continue;
+            }
+            // Readings that sit on the inner deadzone edge may land on either side of it, and the float pipeline
+            // has no answer for a stick exactly at center with no deadzone
+            if (std::fabs(reference.xy_magnitude - reference.in_deadzone) < 1e-5f || reference.xy_magnitude == 0.0f) {
+                deadzoneEdge++;
+                continue;
+            }
+            if (mismatches < 5) {
+                printf("%s: adc %u,%u gives %u,%u, float %u,%u\n", settings.name, x, y, gamepad.state.lx, gamepad.state.ly, expectedX, expectedY);
+            }
+            mismatches++;
+            worst = std::max(worst, error);
+        }
+    }
+    printf("%s: %u readings off by more than 1, %u on the deadzone edge\n", settings.name, mismatches, deadzoneEdge);
+    CHECK_EQ(mismatches, 0);
+    CHECK(deadzoneEdge < 64);
+    Storage::getInstance().gamepad = nullptr;
+}
+
+// Full deflection reaches the ends of the range and center stays center
+static void testEnds()
+{
+    Gamepad gamepad;
+    Storage::getInstance().gamepad = &gamepad;
+    AnalogInput analog;
+    FloatStick reference;
+    setupStick(sweeps[1], analog, reference);
+
+    adcValues[STICK_X_PIN - ADC_SERVICE_FIRST_PIN] = ADC_MAX / 2;
+    adcValues[STICK_Y_PIN - ADC_SERVICE_FIRST_PIN] = ADC_MAX / 2;
+    analog.process();
+    CHECK(std::abs(gamepad.state.lx - GAMEPAD_JOYSTICK_MID) <= 8);
+    CHECK(std::abs(gamepad.state.ly - GAMEPAD_JOYSTICK_MID) <= 8);
+
+    adcValues[STICK_X_PIN - ADC_SERVICE_FIRST_PIN] = ADC_MAX;
+    analog.process();
+    CHECK_EQ(gamepad.state.lx, GAMEPAD_JOYSTICK_MAX);
+    adcValues[STICK_X_PIN - ADC_SERVICE_FIRST_PIN] = 0;
+    analog.process();
+    CHECK_EQ(gamepad.state.lx, GAMEPAD_JOYSTICK_MIN);
+
+    // 0x8000 mid clamps the top of the range to 0xFFFF, X is inverted
+    setupStick(sweeps[3], analog, reference);
+    adcValues[STICK_X_PIN - ADC_SERVICE_FIRST_PIN] = 0;
+    adcValues[STICK_Y_PIN - ADC_SERVICE_FIRST_PIN] = 2300;
+    analog.process();
+    CHECK_EQ(gamepad.state.lx, 0xFFFF);
+    Storage::getInstance().gamepad = nullptr;
+}
+
+// Host cost of a process() call with both sticks on the same inputs, against the float pipeline run for both. The
+// host has an FPU and a hardware square root, so floats are cheap here and this is no measure of the M0+, where every
+// float operation of the old pipeline is a soft-float call
+static void benchmarkProcess()
+{
+    Gamepad gamepad;
+    Storage::getInstance().gamepad = &gamepad;
+    AnalogInput analog;
+    FloatStick reference;
+    setupStick(sweeps[2], analog, reference);
+    AnalogOptions & options = Storage::getInstance().getAddonOptions().analogOptions;
+    options.analogAdc2PinX = STICK_X_PIN;
+    options.analogAdc2PinY = STICK_Y_PIN;
+    options.analogAdc2Mode = DPAD_MODE_RIGHT_ANALOG;
+    options.inner_deadzone2 = options.inner_deadzone;
+    options.outer_deadzone2 = options.outer_deadzone;
+    options.analog_error2 = options.analog_error;
+    analog.setup();
+
+    const uint32_t samples = 1 << 22;
+    uint32_t sink = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < samples; i++) {
+        adcValues[STICK_X_PIN - ADC_SERVICE_FIRST_PIN] = (i * 7) & ADC_MAX;
+        adcValues[STICK_Y_PIN - ADC_SERVICE_FIRST_PIN] = (i * 13) & ADC_MAX;
+        analog.process();
+        sink += gamepad.state.lx + gamepad.state.rx;
+    }
+    const double fixedNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / samples;
+
+    start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < samples; i++) {
+        uint16_t x, y;
+        for (uint8_t stick = 0; stick < ADC_COUNT; stick++) {
+            reference.process((i * 7) & ADC_MAX, (i * 13) & ADC_MAX, 0x10000, x, y);
+            sink += x;
+        }
+    }
+    const double floatNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / samples;
+
+    printf("two sticks: fixed point %.1f ns, float %.1f ns on the host (%u)\n", fixedNs, floatNs, sink & 1);
+    Storage::getInstance().gamepad = nullptr;
+}
+
+int main()
+{
+    for (const SweepSettings & settings : sweeps) {
+        testSweep(settings);
+    }
+    testEnds();
+    benchmarkProcess();
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,268 @@
+#include "analogfilter.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+#include "test.h"
+
+// Replays ADC traces through every mode of AnalogFilter and reports jitter against added latency. There are no
+// recorded stick or trigger traces, so the traces are synthetic: white ADC noise, single sample spikes, steps and
+// flicks, sampled by a free-running ADC every few microseconds and read by a 500 us main loop. A recorded trace can be
+// replayed instead with analogfilter_test <file>, one "microseconds reading" pair per line.
+
+#define ADC_MAX 4095
+#define LOOP_US 500
+#define ADC_ROUND_US 8          // four ADC inputs at 2 us per conversion
+#define NOISE_LSB 12.0          // ADC noise, standard deviation in 12-bit counts
+#define OUTPUT_MAX 65535        // jitter and errors are reported in 16-bit joystick LSB
+
+struct FilterSetting {
+    const char * name;
+    AnalogFilterMode mode;
+    uint16_t smoothing;
+    uint16_t minCutoff;
+    uint16_t beta;
+};
+
+static const FilterSetting settings[] = {
+    { "none", ANALOG_FILTER_NONE, 0, 0, 0 },
+    { "oversample", ANALOG_FILTER_OVERSAMPLE, 0, 0, 0 },
+    { "median", ANALOG_FILTER_MEDIAN, 0, 0, 0 },
+    { "EMA, factor 50", ANALOG_FILTER_EMA, 50, 0, 0 },
+    { "EMA, factor 5", ANALOG_FILTER_EMA, 5, 0, 0 },
+    { "one euro, 1 Hz, beta 10", ANALOG_FILTER_ONE_EURO, 0, 10, 100 },
+};
+
+#define SETTING_NONE 0
+#define SETTING_OVERSAMPLE 1
+#define SETTING_MEDIAN 2
+#define SETTING_EMA 3
+#define SETTING_ONE_EURO 5
+#define SETTING_COUNT (sizeof(settings) / sizeof(settings[0]))
+
+static uint32_t randomState = 0x2545F491;
+
+static double randomUniform()
+{
+    randomState ^= randomState << 13;
+    randomState ^= randomState >> 17;
+    randomState ^= randomState << 5;
+    return (randomState + 0.5) / 4294967296.0;
+}
+
+static double randomGaussian()
+{
+    return std::sqrt(-2.0 * std::log(randomUniform())) * std::cos(2.0 * M_PI * randomUniform());
+}
+
+// Stick position in full scale at a time, plus the trace's spikes
+typedef double (*Position)(uint32_t us);
+
+struct Trace {
+    Position position;
+    uint32_t spikeEvery;        // loops between single-sample spikes, 0 for none
+    int32_t spikeSize;          // ADC counts
+};
+
+// ADC reading of a trace at a time, spikes hit the sample the loop reads last
+static uint16_t adcSample(const Trace & trace, uint32_t us, bool spike)
+{
+    double reading = trace.position(us) * ADC_MAX + NOISE_LSB * randomGaussian();
+    if (spike) {
+        reading += trace.spikeSize;
+    }
+    return reading < 0 ? 0 : (reading > ADC_MAX ? ADC_MAX : (uint16_t)std::lround(reading));
+}
+
+// What a loop gets from ADCService::read(): the newest sample, or the average of the newest ones
+static uint16_t loopReading(const Trace & trace, uint32_t us, uint8_t oversample, bool spike)
+{
+    uint32_t sum = 0;
+    for (uint8_t sample = 0; sample < oversample; sample++) {
+        sum += adcSample(trace, us - sample * ADC_ROUND_US, spike && sample == 0);
+    }
+    return (sum + oversample / 2) / oversample;
+}
+
+// Output of a loop as joystick LSB, the way AnalogInput scales the filtered value
+static double toOutput(int32_t filtered)
+{
+    return (double)filtered * OUTPUT_MAX / (1 << ANALOG_FILTER_BITS);
+}
+
+static int32_t toFilterInput(uint16_t reading)
+{
+    return ((uint32_t)reading << ANALOG_FILTER_BITS) / ADC_MAX;
+}
+
+// Replays a trace for a number of loops, out[] gets the filtered output of every loop
+static void replay(const FilterSetting & setting, const Trace & trace, uint32_t loops, double * out)
+{
+    AnalogFilter filter;
+    filter.setup(setting.mode, setting.smoothing, setting.minCutoff, setting.beta);
+    for (uint32_t loop = 0; loop < loops; loop++) {
+        const uint32_t us = 100000 + loop * LOOP_US;
+        const bool spike = trace.spikeEvery != 0 && loop % trace.spikeEvery == trace.spikeEvery / 2;
+        out[loop] = toOutput(filter.filter(toFilterInput(loopReading(trace, us, filter.getOversample(), spike)), us));
+    }
+}
+
+static double rest(uint32_t us) { return 0.5; }
+static uint32_t stepAt = 0;
+static double step(uint32_t us) { return us < stepAt ? 0.5 : 0.9; }
+// A flick: full deflection and back within 40 ms
+static double flick(uint32_t us) {
+    if (us < stepAt) {
+        return 0.5;
+    }
+    const double t = (us - stepAt) / 40000.0;
+    return t >= 1.0 ? 0.5 : 0.5 + 0.5 * std::sin(M_PI * t);
+}
+
+#define REST_LOOPS 20000        // 10 s
+#define STEP_LOOPS 4000
+#define SETTLE_LOOPS 2000       // filters settle at rest before a step
+
+struct Result {
+    double jitter;              // RMS around the true position at rest
+    double spikePeak;           // largest deviation from the true position with spikes
+    double stepDelay;           // ms until 90% of a step
+    double flickPeak;           // peak of a full flick, 1.0 is the whole way
+};
+
+static Result measure(const FilterSetting & setting)
+{
+    static double out[REST_LOOPS];
+    Result result;
+
+    const Trace restTrace = { rest, 0, 0 };
+    replay(setting, restTrace, REST_LOOPS, out);
+    double sum = 0;
+    for (uint32_t loop = SETTLE_LOOPS; loop < REST_LOOPS; loop++) {
+        const double error = out[loop] - 0.5 * OUTPUT_MAX;
+        sum += error * error;
+    }
+    result.jitter = std::sqrt(sum / (REST_LOOPS - SETTLE_LOOPS));
+
+    const Trace spikeTrace = { rest, 200, 1000 };
+    replay(setting, spikeTrace, REST_LOOPS, out);
+    result.spikePeak = 0;
+    for (uint32_t loop = SETTLE_LOOPS; loop < REST_LOOPS; loop++) {
+        result.spikePeak = std::fmax(result.spikePeak, std::fabs(out[loop] - 0.5 * OUTPUT_MAX));
+    }
+
+    stepAt = 100000 + SETTLE_LOOPS * LOOP_US;
+    const Trace stepTrace = { step, 0, 0 };
+    replay(setting, stepTrace, STEP_LOOPS, out);
+    result.stepDelay = -1;
+    for (uint32_t loop = SETTLE_LOOPS; loop < STEP_LOOPS; loop++) {
+        if (out[loop] >= (0.5 + 0.4 * 0.9) * OUTPUT_MAX) {
+            result.stepDelay = (loop - SETTLE_LOOPS) * LOOP_US / 1000.0;
+            break;
+        }
+    }
+
+    const Trace flickTrace = { flick, 0, 0 };
+    replay(setting, flickTrace, STEP_LOOPS, out);
+    result.flickPeak = 0;
+    for (uint32_t loop = SETTLE_LOOPS; loop < STEP_LOOPS; loop++) {
+        result.flickPeak = std::fmax(result.flickPeak, (out[loop] - 0.5 * OUTPUT_MAX) / (0.5 * OUTPUT_MAX));
+    }
+    return result;
+}
+
+static void testFilterBank()
+{
+    Result results[SETTING_COUNT];
+    printf("%-24s %10s %10s %12s %10s\n", "filter", "jitter", "spike", "step delay", "flick");
+    for (uint32_t i = 0; i < SETTING_COUNT; i++) {
+        results[i] = measure(settings[i]);
+        printf("%-24s %6.1f LSB %6.0f LSB %9.1f ms %9.0f%%\n", settings[i].name, results[i].jitter, results[i].spikePeak,
+            results[i].stepDelay, results[i].flickPeak * 100);
+    }
+
+    const Result & none = results[SETTING_NONE];
+    // 12 ADC counts of noise are 192 joystick LSB, unfiltered that is what a loop sees
+    CHECK(none.jitter > 150 && none.jitter < 250);
+    CHECK_EQ(none.stepDelay, 0);
+    CHECK(none.spikePeak > 900 * 16);
+
+    // Averaging 16 samples quarters the noise at the cost of a few ADC rounds
+    const Result & oversample = results[SETTING_OVERSAMPLE];
+    CHECK(oversample.jitter < none.jitter / 3.5);
+    CHECK(oversample.stepDelay <= LOOP_US / 1000.0);
+
+    // The median drops single sample spikes entirely and adds one loop of delay on a step
+    const Result & median = results[SETTING_MEDIAN];
+    CHECK(median.jitter < none.jitter);
+    CHECK(median.spikePeak < 6 * none.jitter);
+    CHECK(median.stepDelay <= LOOP_US / 1000.0);
+
+    // EMA: 90% of a step after ln(10) / a loops
+    const Result & ema = results[SETTING_EMA];
+    const double emaDelay = std::log(10.0) / 0.05 * LOOP_US / 1000.0;
+    CHECK(std::fabs(ema.stepDelay - emaDelay) < 0.1 * emaDelay);
+    CHECK(ema.jitter < none.jitter / 4);
+
+    // One euro: smoothing like a slow EMA at rest, but flicks come through almost whole
+    const Result & oneEuro = results[SETTING_ONE_EURO];
+    CHECK(oneEuro.jitter < none.jitter / 4);
+    CHECK(oneEuro.stepDelay < ema.stepDelay);
+    CHECK(oneEuro.flickPeak > ema.flickPeak);
+    CHECK(oneEuro.flickPeak > 0.9);
+}
+
+// A replay of a recorded trace: jitter is measured against a centered moving average, latency is not known without the
+// true position
+static int replayFile(const char * path)
+{
+    FILE * file = fopen(path, "r");
+    if (file == nullptr) {
+        printf("cannot open %s\n", path);
+        return 1;
+    }
+    static uint32_t times[1 << 20];
+    static uint16_t readings[1 << 20];
+    static double out[1 << 20];
+    uint32_t count = 0;
+    unsigned int time, reading;
+    while (count < (1 << 20) && fscanf(file, "%u %u", &time, &reading) == 2) {
+        times[count] = time;
+        readings[count] = reading > ADC_MAX ? ADC_MAX : reading;
+        count++;
+    }
+    fclose(file);
+
+    const uint32_t window = 64;
+    for (const FilterSetting & setting : settings) {
+        AnalogFilter filter;
+        filter.setup(setting.mode, setting.smoothing, setting.minCutoff, setting.beta);
+        for (uint32_t i = 0; i < count; i++) {
+            out[i] = toOutput(filter.filter(toFilterInput(readings[i]), times[i]));
+        }
+        double sum = 0;
+        uint32_t samples = 0;
+        for (uint32_t i = window; i + window < count; i++) {
+            double mean = 0;
+            for (uint32_t j = i - window; j <= i + window; j++) {
+                mean += out[j];
+            }
+            mean /= 2 * window + 1;
+            sum += (out[i] - mean) * (out[i] - mean);
+            samples++;
+        }
+        printf("%-24s %6.1f LSB\n", setting.name, samples > 0 ? std::sqrt(sum / samples) : 0.0);
+    }
+    return 0;
+}
+
+int main(int argc, char * argv[])
+{
+    if (argc > 1) {
+        return replayFile(argv[1]);
+    }
+    testFilterBank();
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,335 @@
+#include "drivers/composite/CompositeDriver.h"
+#include "drivers/composite/CompositeDescriptors.h"
+#include "drivermanager.h"
+#include "eventmanager.h"
+#include "storagemanager.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include "test.h"
+
+// The composite device as the host sees it: the combined configuration descriptor checked field by field against
+// the interfaces the driver serves, then the real driver run against one emulated interrupt IN endpoint per
+// interface. The host polls each endpoint at the bInterval of its descriptor and the test measures, per
+// interface, the time from a state change the loop read to the host receiving a report that carries it.
+
+#define KEY_B1 HID_KEY_A
+#define MAX_INTERFACES 4
+
+// Emulated endpoints, indexed by HID instance
+static struct {
+    bool pending;           // report armed, waiting for the host to poll
+    bool stalled;           // the host stopped polling this endpoint
+    uint8_t reportId;
+    uint8_t report[64];
+    uint16_t length;
+} endpoints[MAX_INTERFACES];
+
+extern "C" {
+bool tud_suspended(void) { return false; }
+bool tud_remote_wakeup(void) { return true; }
+bool tud_hid_ready(void) { return false; }
+bool tud_hid_report(uint8_t report_id, void const * report, uint16_t len) { return false; }
+bool tud_hid_n_ready(uint8_t instance) { return instance < MAX_INTERFACES && !endpoints[instance].pending; }
+bool tud_hid_n_report(uint8_t instance, uint8_t report_id, void const * report, uint16_t len) {
+    if (!tud_hid_n_ready(instance) || len > sizeof(endpoints[instance].report)) {
+        return false;
+    }
+    endpoints[instance].pending = true;
+    endpoints[instance].reportId = report_id;
+    endpoints[instance].length = len;
+    memcpy(endpoints[instance].report, report, len);
+    return true;
+}
+void hidd_init(void) {}
+void hidd_reset(uint8_t rhport) {}
+uint16_t hidd_open(uint8_t rhport, tusb_desc_interface_t const * desc_itf, uint16_t max_len) { return 0; }
+bool hidd_control_xfer_cb(uint8_t rhport, uint8_t stage, tusb_control_request_t const * request) { return false; }
+bool hidd_xfer_cb(uint8_t rhport, uint8_t ep_addr, xfer_result_t result, uint32_t xferred_bytes) { return false; }
+}
+
+void EventManager::registerEventHandler(GPEventType eventType, EventFunction handler) {}
+
+Gamepad::Gamepad() :
+    options(Storage::getInstance().gamepadOptions)
+    , hotkeyOptions(Storage::getInstance().hotkeyOptions)
+{
+}
+
+// The drivers only build a report when the state generation moved
+void Gamepad::updateStateGeneration() { stateGeneration++; }
+
+static uint32_t randomState = 0x12345678;
+
+static uint32_t randomNext() {
+    randomState ^= randomState << 13;
+    randomState ^= randomState >> 17;
+    randomState ^= randomState << 5;
+    return randomState;
+}
+
+// What the configuration descriptor says about each interface
+typedef struct {
+    uint8_t number;
+    uint8_t protocol;
+    uint16_t reportDescriptorLength;
+    uint8_t endpoint;
+    uint8_t interval;   // frames, 1 ms at full speed
+} InterfaceInfo;
+
+static int interfaceCount = 0;
+static InterfaceInfo interfaceInfo[MAX_INTERFACES];
+
+static void testDescriptor(CompositeDriver & driver) {
+    const tusb_desc_device_t * device = (const tusb_desc_device_t *)driver.get_descriptor_device_cb();
+    CHECK_EQ(device->bLength, sizeof(tusb_desc_device_t));
+    CHECK_EQ(device->bNumConfigurations, 1);
+
+    const uint8_t * desc = driver.get_descriptor_configuration_cb(0);
+    const tusb_desc_configuration_t * config = (const tusb_desc_configuration_t *)desc;
+    CHECK_EQ(config->bDescriptorType, TUSB_DESC_CONFIGURATION);
+    CHECK_EQ(config->wTotalLength, sizeof(composite_configuration_descriptor));
+    CHECK(config->wTotalLength <= DRIVER_CONFIG_DESCRIPTOR_MAX_SIZE);
+
+    // Every descriptor is an interface, its HID descriptor and its IN endpoint, and they add up to wTotalLength
+    InterfaceInfo * current = nullptr;
+    uint16_t offset = config->bLength;
+    while (offset < config->wTotalLength) {
+        const uint8_t len = desc[offset];
+        CHECK(len >= 2);
+        if (len < 2) {
+            return;
+        }
+        switch (desc[offset + 1]) {
+            case TUSB_DESC_INTERFACE: {
+                const tusb_desc_interface_t * itf = (const tusb_desc_interface_t *)&desc[offset];
+                CHECK(interfaceCount < MAX_INTERFACES);
+                if (interfaceCount >= MAX_INTERFACES) {
+                    return;
+                }
+                CHECK_EQ(itf->bInterfaceClass, TUSB_CLASS_HID);
+                CHECK_EQ(itf->bAlternateSetting, 0);
+                CHECK_EQ(itf->bNumEndpoints, 1);
+                current = &interfaceInfo[interfaceCount++];
+                *current = {};
+                current->number = itf->bInterfaceNumber;
+                current->protocol = itf->bInterfaceProtocol;
+                break;
+            }
+            case HID_DESC_TYPE_HID:
+                CHECK(current != nullptr);
+                CHECK_EQ(desc[offset + 6], HID_DESC_TYPE_REPORT);
+                if (current != nullptr) {
+                    current->reportDescriptorLength = desc[offset + 7] | (desc[offset + 8] << 8);
+                }
+                break;
+            case TUSB_DESC_ENDPOINT: {
+                const tusb_desc_endpoint_t * endpoint = (const tusb_desc_endpoint_t *)&desc[offset];
+                CHECK(current != nullptr);
+                CHECK_EQ(endpoint->bmAttributes.xfer, TUSB_XFER_INTERRUPT);
+                CHECK(endpoint->wMaxPacketSize <= CFG_TUD_HID_EP_BUFSIZE);
+                if (current != nullptr) {
+                    current->endpoint = endpoint->bEndpointAddress;
+                    current->interval = endpoint->bInterval;
+                }
+                break;
+            }
+            default:
+                printf("unexpected descriptor type 0x%02x at %u\n", desc[offset + 1], offset);
+                CHECK(false);
+                break;
+        }
+        offset += len;
+    }
+    CHECK_EQ(offset, config->wTotalLength);
+    CHECK_EQ(config->bNumInterfaces, interfaceCount);
+    CHECK_EQ(interfaceCount, ITF_NUM_COMPOSITE_TOTAL);
+
+    // Interface numbers run 0..N-1 in order, they double as the HID instance of the interface
+    for (int i = 0; i < interfaceCount; i++) {
+        CHECK_EQ(interfaceInfo[i].number, i);
+        CHECK(interfaceInfo[i].endpoint & 0x80);
+        CHECK((interfaceInfo[i].endpoint & 0x7F) != 0);
+        CHECK(interfaceInfo[i].interval > 0);
+        for (int j = 0; j < i; j++) {
+            CHECK(interfaceInfo[i].endpoint != interfaceInfo[j].endpoint);
+        }
+    }
+
+    // The report descriptor each interface announces is the one it hands out, at the announced length. The
+    // descriptors are static arrays in the headers, so compare their bytes rather than their addresses.
+    static const struct {
+        const uint8_t * desc;
+        uint16_t length;
+        uint8_t protocol;
+    } reportDescriptors[ITF_NUM_COMPOSITE_TOTAL] = {
+        { hid_report_descriptor, sizeof(hid_report_descriptor), HID_ITF_PROTOCOL_NONE },
+        { keyboard_report_descriptor, sizeof(keyboard_report_descriptor), HID_ITF_PROTOCOL_KEYBOARD },
+    };
+    for (int i = 0; i < interfaceCount && i < ITF_NUM_COMPOSITE_TOTAL; i++) {
+        CHECK(memcmp(driver.get_hid_descriptor_report_cb(i), reportDescriptors[i].desc, reportDescriptors[i].length) == 0);
+        CHECK_EQ(interfaceInfo[i].reportDescriptorLength, reportDescriptors[i].length);
+        CHECK_EQ(interfaceInfo[i].protocol, reportDescriptors[i].protocol);
+    }
+    CHECK(driver.get_hid_descriptor_report_cb(ITF_NUM_COMPOSITE_TOTAL) == nullptr);
+
+    // Telemetry follows the gamepad endpoint
+    CHECK_EQ(driver.get_report_endpoint(), interfaceInfo[ITF_NUM_COMPOSITE_GAMEPAD].endpoint);
+
+    for (int i = 0; i < interfaceCount; i++) {
+        printf("interface %u: protocol %u, report descriptor %u bytes, endpoint 0x%02x every %u ms\n",
+            interfaceInfo[i].number, interfaceInfo[i].protocol, interfaceInfo[i].reportDescriptorLength,
+            interfaceInfo[i].endpoint, interfaceInfo[i].interval);
+    }
+}
+
+// Whether the report the host received has B1 down
+static bool reportPressed(uint8_t itf) {
+    if (itf == ITF_NUM_COMPOSITE_GAMEPAD) {
+        const HIDReport * report = (const HIDReport *)endpoints[itf].report;
+        return (report->buttons & GAMEPAD_MASK_B2) != 0; // B1 is the second HID button
+    }
+    return endpoints[itf].reportId == KEYBOARD_KEY_REPORT_ID && (endpoints[itf].report[KEY_B1 / 8] & (1 << (KEY_B1 % 8)));
+}
+
+#define PASSES 200000
+#define LOOP_MIN_US 250
+#define LOOP_JITTER_US 100
+
+typedef struct {
+    std::vector<uint32_t> latencies;    // µs from the pass that read a change to the poll that delivered it
+    uint32_t reports;                   // reports the host received
+    uint32_t superseded;                // changes replaced by the next one before a report carried them
+} InterfaceStats;
+
+// Toggles B1 every 1..40 loop passes and lets the host poll each endpoint every bInterval ms, each at its own
+// phase within the frame. Stalled endpoints are never polled, as when the host does not read that interface.
+static void simulate(Gamepad & gamepad, const bool * stalled, InterfaceStats * stats) {
+    CompositeDriver driver;
+    driver.initialize();
+    randomState = 0x12345678;
+    gamepad.state.buttons = 0;
+    gamepad.updateStateGeneration();
+    memset(endpoints, 0, sizeof(endpoints));
+    for (int i = 0; i < interfaceCount; i++) {
+        endpoints[i].stalled = stalled[i];
+        stats[i] = {};
+    }
+
+    uint32_t nextPoll[MAX_INTERFACES];
+    bool delivered[MAX_INTERFACES];         // the host has the current state on this interface
+    bool lastPressed[MAX_INTERFACES] = {};
+    for (int i = 0; i < interfaceCount; i++) {
+        nextPoll[i] = 137 + i * 311;
+        delivered[i] = true;
+    }
+
+    bool pressed = false;
+    uint32_t changeTime = 0;
+    uint32_t nextChange = 1;
+    uint32_t now = 0;
+    for (uint32_t pass = 0; pass < PASSES; pass++) {
+        if (--nextChange == 0) {
+            for (int i = 0; i < interfaceCount; i++) {
+                if (!delivered[i]) {
+                    stats[i].superseded++;
+                }
+                delivered[i] = false;
+            }
+            pressed = !pressed;
+            gamepad.state.buttons = pressed ? GAMEPAD_MASK_B1 : 0;
+            gamepad.updateStateGeneration();
+            changeTime = now;
+            nextChange = 1 + randomNext() % 40;
+        }
+        driver.setProcessTime(now / 1000);
+        driver.process(&gamepad);
+
+        const uint32_t passEnd = now + LOOP_MIN_US + randomNext() % (LOOP_JITTER_US + 1);
+        for (int i = 0; i < interfaceCount; i++) {
+            while (nextPoll[i] < passEnd) {
+                if (endpoints[i].pending && !endpoints[i].stalled) {
+                    endpoints[i].pending = false;
+                    stats[i].reports++;
+                    const bool reportState = reportPressed(i);
+                    // A report the endpoint held from before the change does not count
+                    if (!delivered[i] && reportState == pressed && reportState != lastPressed[i]) {
+                        stats[i].latencies.push_back(nextPoll[i] - changeTime);
+                        delivered[i] = true;
+                    }
+                    lastPressed[i] = reportState;
+                }
+                nextPoll[i] += interfaceInfo[i].interval * 1000;
+            }
+        }
+        now = passEnd;
+    }
+}
+
+static void printStats(const char * name, uint8_t itf, InterfaceStats & stats) {
+    std::vector<uint32_t> & latencies = stats.latencies;
+    if (latencies.empty()) {
+        printf("%-18s itf %u: %u reports, no change delivered\n", name, itf, stats.reports);
+        return;
+    }
+    std::sort(latencies.begin(), latencies.end());
+    uint64_t sum = 0;
+    for (uint32_t latency : latencies) {
+        sum += latency;
+    }
+    printf("%-18s itf %u: %u reports, %zu changes, latency mean %llu us, p99 %u us, max %u us, %u superseded\n",
+        name, itf, stats.reports, latencies.size(), (unsigned long long)(sum / latencies.size()),
+        latencies[latencies.size() * 99 / 100], latencies.back(), stats.superseded);
+}
+
+static void testLatency(Gamepad & gamepad) {
+    const bool none[MAX_INTERFACES] = {};
+    InterfaceStats baseline[MAX_INTERFACES];
+    simulate(gamepad, none, baseline);
+    for (int i = 0; i < interfaceCount; i++) {
+        printStats("both polled", i, baseline[i]);
+        CHECK(!baseline[i].latencies.empty());
+        // One report per change at most, an interface re-sending an unchanged report keeps its endpoint busy
+        CHECK(baseline[i].reports <= baseline[i].latencies.size() + baseline[i].superseded + 1);
+        // A report is armed on the pass that read the change, or on the pass after the poll that freed a busy
+        // endpoint, and goes out on the next poll
+        const uint32_t frame = interfaceInfo[i].interval * 1000;
+        const uint32_t bound = 2 * frame + LOOP_MIN_US + LOOP_JITTER_US;
+        CHECK(baseline[i].latencies.back() <= bound);
+    }
+
+    // The host not reading one interface leaves the others exactly as they were
+    for (int stalledItf = 0; stalledItf < interfaceCount; stalledItf++) {
+        bool stalled[MAX_INTERFACES] = {};
+        stalled[stalledItf] = true;
+        InterfaceStats stats[MAX_INTERFACES];
+        simulate(gamepad, stalled, stats);
+        for (int i = 0; i < interfaceCount; i++) {
+            printStats(stalledItf == ITF_NUM_COMPOSITE_GAMEPAD ? "gamepad stalled" : "keyboard stalled", i, stats[i]);
+            if (i == stalledItf) {
+                CHECK_EQ(stats[i].reports, 0);
+            } else {
+                CHECK(stats[i].latencies == baseline[i].latencies);
+                CHECK_EQ(stats[i].reports, baseline[i].reports);
+            }
+        }
+    }
+}
+
+int main() {
+    Gamepad gamepad;
+    Storage::getInstance().gamepad = &gamepad;
+    Storage::getInstance().keyboardMapping.keyButtonB1 = KEY_B1;
+
+    CompositeDriver driver;
+    driver.initialize();
+
+    testDescriptor(driver);
+    if (testFailures == 0) {
+        testLatency(gamepad);
+    }
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,255 @@
+#include "rapidtrigger.h"
+#include "storagemanager.h"
+#include "drivers/ps3/PS3Driver.h"
+#include "drivers/xboxog/XboxOriginalDriver.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#include "test.h"
+
+// The HE trigger travel of a key is mapped to a pressure and published in the gamepad aux state, the PS3 and
+// original Xbox drivers then build their reports from it. The USB side only records the last report sent.
+
+static uint8_t sentReport[64];
+static uint16_t sentReportSize = 0;
+
+extern "C" {
+bool tud_suspended(void) { return false; }
+bool tud_remote_wakeup(void) { return true; }
+bool tud_hid_ready(void) { return true; }
+bool tud_hid_report(uint8_t report_id, void const * report, uint16_t len) {
+    memcpy(sentReport, report, len);
+    sentReportSize = len;
+    return true;
+}
+void hidd_init(void) {}
+void hidd_reset(uint8_t rhport) {}
+uint16_t hidd_open(uint8_t rhport, tusb_desc_interface_t const * desc_itf, uint16_t max_len) { return 0; }
+bool hidd_control_xfer_cb(uint8_t rhport, uint8_t stage, tusb_control_request_t const * request) { return false; }
+bool hidd_xfer_cb(uint8_t rhport, uint8_t ep_addr, xfer_result_t result, uint32_t xferred_bytes) { return false; }
+
+static usbd_class_driver_t xidDriver = {};
+const usbd_class_driver_t * xid_get_driver(void) { return &xidDriver; }
+int8_t xid_get_index_by_type(uint8_t type_index, xid_type_t type) { return 0; }
+bool xid_send_report(uint8_t index, void * report, uint16_t len) { return tud_hid_report(0, report, len); }
+bool xid_get_report(uint8_t index, void * report, uint16_t len) { return false; }
+}
+
+uint32_t get_rand_32(void) { return 0; }
+const uint16_t * getStringDescriptor(const char * value, uint8_t index) { return nullptr; }
+
+Gamepad::Gamepad() :
+    options(Storage::getInstance().gamepadOptions)
+    , hotkeyOptions(Storage::getInstance().hotkeyOptions)
+{
+}
+
+// Keys as the HE trigger add-on sets them up: travel in ADC counts, actuation at 500, calibrated idle 100 and full
+// press 3500
+enum {
+    KEY_SOUTH,
+    KEY_SOUTH_SECOND,
+    KEY_L2,
+    KEY_UP,
+    KEY_R1,
+    KEY_UNCALIBRATED,
+};
+
+static RapidTrigger keys;
+static uint16_t travel[RAPID_TRIGGER_KEYS];
+
+static void setupKeys()
+{
+    keys.clear();
+    for (uint8_t key = KEY_SOUTH; key <= KEY_R1; key++) {
+        keys.setKey(key, 500, 500, 50, false);
+        keys.setPressureRange(key, 100, 3500);
+    }
+    keys.setKey(KEY_UNCALIBRATED, 500, 500, 50, false);
+    keys.setPressureRange(KEY_UNCALIBRATED, 100, 100);
+}
+
+// Same steps as HETriggerAddon::applyKeys for the keys used here
+static void applyKeys(Gamepad & gamepad, uint32_t pressed)
+{
+    static const uint32_t keyButtons[] = { GAMEPAD_MASK_B1, GAMEPAD_MASK_B1, GAMEPAD_MASK_L2, 0, GAMEPAD_MASK_R1, GAMEPAD_MASK_B4 };
+    static const uint8_t keyDpad[] = { 0, 0, 0, GAMEPAD_MASK_UP, 0, 0 };
+
+    const uint32_t digitalButtons = gamepad.state.buttons;
+    const uint8_t digitalDpad = gamepad.state.dpad;
+    GamepadAuxAnalogButtons & analogButtons = gamepad.auxState.analogButtons;
+    analogButtons.clear();
+    for (uint32_t remaining = pressed; remaining != 0; remaining &= remaining - 1) {
+        const uint8_t key = __builtin_ctz(remaining);
+        gamepad.state.buttons |= keyButtons[key];
+        gamepad.state.dpad |= keyDpad[key];
+        if (keyButtons[key] != 0) {
+            analogButtons.setButton(keyButtons[key], keys.getPressure(key, travel[key]));
+        } else if (keyDpad[key] != 0) {
+            analogButtons.setDpad(keyDpad[key], keys.getPressure(key, travel[key]));
+        }
+    }
+    analogButtons.clearDigital(digitalButtons, digitalDpad);
+}
+
+static void testPressureMapping()
+{
+    setupKeys();
+    CHECK_EQ(keys.getPressure(KEY_SOUTH, 100), 1);      // pressed at idle still reads as pressed
+    CHECK_EQ(keys.getPressure(KEY_SOUTH, 0), 1);
+    CHECK_EQ(keys.getPressure(KEY_SOUTH, 1800), 127);
+    CHECK_EQ(keys.getPressure(KEY_SOUTH, 3500), 255);
+    CHECK_EQ(keys.getPressure(KEY_SOUTH, 4095), 255);
+    CHECK_EQ(keys.getPressure(KEY_UNCALIBRATED, 1800), 255);
+    CHECK_EQ(keys.getPressure(RAPID_TRIGGER_KEYS, 1800), 255);
+
+    // Linear over the calibrated range, within one step of the exact value
+    for (uint16_t value = 100; value <= 3500; value++) {
+        const int expected = std::max(((value - 100) * 255 + 1700) / 3400, 1);
+        const int pressure = keys.getPressure(KEY_SOUTH, value);
+        if (std::abs(pressure - expected) > 1) {
+            CHECK_EQ(pressure, expected);
+            break;
+        }
+    }
+}
+
+static void testPublish()
+{
+    setupKeys();
+    Gamepad gamepad;
+    gamepad.state.buttons = GAMEPAD_MASK_R1;    // held by a GPIO button
+    travel[KEY_SOUTH] = 1000;
+    travel[KEY_SOUTH_SECOND] = 2900;
+    travel[KEY_L2] = 1800;
+    travel[KEY_UP] = 700;
+    travel[KEY_R1] = 1000;
+    travel[KEY_UNCALIBRATED] = 0;
+    applyKeys(gamepad, keys.update(travel));
+
+    const GamepadAuxAnalogButtons & analogButtons = gamepad.auxState.analogButtons;
+    CHECK_EQ(gamepad.state.buttons, GAMEPAD_MASK_B1 | GAMEPAD_MASK_L2 | GAMEPAD_MASK_R1);
+    CHECK_EQ(gamepad.state.dpad, GAMEPAD_MASK_UP);
+    CHECK_EQ(analogButtons.buttons, GAMEPAD_MASK_B1 | GAMEPAD_MASK_L2);
+    CHECK_EQ(analogButtons.dpad, GAMEPAD_MASK_UP);
+    CHECK_EQ(analogButtons.buttonValues[__builtin_ctz(GAMEPAD_MASK_B1)], 210);  // deepest of the two keys
+    CHECK_EQ(analogButtons.buttonValues[__builtin_ctz(GAMEPAD_MASK_L2)], 127);
+    CHECK_EQ(analogButtons.dpadValues[__builtin_ctz(GAMEPAD_MASK_UP)], 45);
+    CHECK_EQ(gamepad.pressureButton(GAMEPAD_MASK_R1), 0xFF);
+    CHECK_EQ(gamepad.pressureButton(GAMEPAD_MASK_B4), 0);
+
+    // A button released later in the loop (turbo, SOCD) reports 0 whatever was published
+    gamepad.state.buttons &= ~GAMEPAD_MASK_B1;
+    CHECK_EQ(gamepad.pressureButton(GAMEPAD_MASK_B1), 0);
+}
+
+static void testPS3Report()
+{
+    setupKeys();
+    Gamepad gamepad;
+    Storage::getInstance().gamepad = &gamepad;
+    PS3Driver driver;
+    driver.initialize();
+
+    gamepad.state.buttons = GAMEPAD_MASK_R1;
+    gamepad.state.dpad = GAMEPAD_MASK_LEFT;
+    travel[KEY_SOUTH] = 2900;
+    travel[KEY_SOUTH_SECOND] = 0;
+    travel[KEY_L2] = 1800;
+    travel[KEY_UP] = 3500;
+    travel[KEY_R1] = 1000;
+    applyKeys(gamepad, keys.update(travel));
+    CHECK(driver.process(&gamepad));
+
+    CHECK_EQ(sentReportSize, sizeof(PS3Report));
+    PS3Report report;
+    memcpy(&report, sentReport, sizeof(report));
+    CHECK(report.buttonSouth);
+    CHECK(report.buttonL2);
+    CHECK(report.dpadUp);
+    CHECK_EQ(report.buttonSouthAnalog, 210);
+    CHECK_EQ(report.buttonL2Analog, 127);
+    CHECK_EQ(report.dpadUpAnalog, 255);
+    CHECK_EQ(report.buttonR1Analog, 0xFF);
+    CHECK_EQ(report.dpadLeftAnalog, 0xFF);
+    CHECK_EQ(report.buttonNorthAnalog, 0);
+    CHECK_EQ(report.buttonR2Analog, 0);
+    CHECK_EQ(report.dpadDownAnalog, 0);
+
+    // A pressure change alone sends a new report
+    travel[KEY_SOUTH] = 1000;
+    gamepad.state.buttons = GAMEPAD_MASK_R1;
+    gamepad.state.dpad = GAMEPAD_MASK_LEFT;
+    applyKeys(gamepad, keys.update(travel));
+    CHECK(driver.process(&gamepad));
+    memcpy(&report, sentReport, sizeof(report));
+    CHECK_EQ(report.buttonSouthAnalog, 67);
+    CHECK_EQ(report.buttonL2Analog, 127);
+    CHECK_EQ(report.dpadUpAnalog, 255);
+    CHECK_EQ(report.buttonR1Analog, 0xFF);
+
+    // Released buttons go back to 0
+    travel[KEY_SOUTH] = 0;
+    gamepad.state.buttons = 0;
+    gamepad.state.dpad = 0;
+    applyKeys(gamepad, keys.update(travel));
+    CHECK(driver.process(&gamepad));
+    memcpy(&report, sentReport, sizeof(report));
+    CHECK(!report.buttonSouth);
+    CHECK_EQ(report.buttonSouthAnalog, 0);
+    CHECK_EQ(report.buttonR1Analog, 67);
+    CHECK_EQ(report.dpadLeftAnalog, 0);
+
+    Storage::getInstance().gamepad = nullptr;
+}
+
+static void testXboxOriginalReport()
+{
+    setupKeys();
+    Gamepad gamepad;
+    XboxOriginalDriver driver;
+    driver.initialize();
+
+    travel[KEY_SOUTH] = 1800;
+    travel[KEY_SOUTH_SECOND] = 0;
+    travel[KEY_L2] = 2900;
+    travel[KEY_UP] = 0;
+    travel[KEY_R1] = 0;
+    applyKeys(gamepad, keys.update(travel));
+    CHECK(driver.process(&gamepad));
+
+    CHECK_EQ(sentReportSize, sizeof(XboxOriginalReport));
+    XboxOriginalReport report;
+    memcpy(&report, sentReport, sizeof(report));
+    CHECK_EQ(report.A, 127);
+    CHECK_EQ(report.L, 210);
+    CHECK_EQ(report.B, 0);
+    CHECK_EQ(report.R, 0);
+    CHECK_EQ(report.BLACK, 0);
+
+    // With analog triggers the deeper of the HE key and the trigger reading wins
+    gamepad.hasAnalogTriggers = true;
+    gamepad.state.lt = 0xF0;
+    gamepad.state.rt = 0x40;
+    CHECK(driver.process(&gamepad));
+    memcpy(&report, sentReport, sizeof(report));
+    CHECK_EQ(report.L, 0xF0);
+    CHECK_EQ(report.R, 0x40);
+
+    gamepad.state.lt = 0x20;
+    CHECK(driver.process(&gamepad));
+    memcpy(&report, sentReport, sizeof(report));
+    CHECK_EQ(report.L, 210);
+}
+
+int main()
+{
+    testPressureMapping();
+    testPublish();
+    testPS3Report();
+    testXboxOriginalReport();
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,280 @@
+#include "addons/he_trigger.h"
+#include "adcservice.h"
+#include "eventmanager.h"
+#include "storagemanager.h"
+#include "usbtelemetry.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "test.h"
+
+// HETriggerAddon scanning analog muxes against an RC model of the mux output. Each mux output node charges through
+// the source resistance into the ADC input capacitance, so after a select switch it moves from the old channel's
+// voltage towards the new one with time constant R * C. A conversion samples the node as it starts and takes 2 us.
+// Neighbouring channels alternate between idle and fully pressed, the worst case for crosstalk.
+
+#define ADC_MAX 4095
+#define CONVERSION_US 2.0
+#define INPUT_CAPACITANCE 50e-12
+#define LOOP_GAP_US 100.0       // rest of the main loop between two scans
+#define IDLE_READING 300
+#define PRESSED_READING 3500
+
+static const Pin_t selectPins[4] = { 2, 3, 4, 5 };
+static const Pin_t muxPins[4] = { 26, 27, 28, 29 };
+
+static double nowUs = 0;
+
+struct MuxNode {
+    double from;    // node voltage in ADC counts at the last switch
+    double to;      // voltage of the selected channel
+    double since;
+};
+
+static struct {
+    double tau = 0;             // us
+    uint8_t channels = 8;
+    uint8_t select = 0;
+    MuxNode nodes[4];
+    double worstError = 0;
+    uint32_t conversions = 0;
+    std::vector<uint16_t> converted; // mux * 16 + channel of every conversion
+} model;
+
+static uint16_t sourceReading(uint8_t mux, uint8_t channel) {
+    return ((mux + channel) % 2) ? PRESSED_READING : IDLE_READING;
+}
+
+static double nodeReading(uint8_t mux) {
+    const MuxNode & node = model.nodes[mux];
+    return node.to + (node.from - node.to) * std::exp(-(nowUs - node.since) / model.tau);
+}
+
+static void switchTo(uint8_t select) {
+    select %= model.channels;
+    if (select == model.select) {
+        return;
+    }
+    for (uint8_t mux = 0; mux < 4; mux++) {
+        model.nodes[mux] = { nodeReading(mux), (double)sourceReading(mux, select), nowUs };
+    }
+    model.select = select;
+}
+
+extern "C" {
+uint32_t time_us_32(void) { return (uint32_t)nowUs; }
+void busy_wait_us_32(uint32_t delay_us) { nowUs += delay_us; }
+void tight_loop_contents(void) { nowUs += 0.05; }
+void gpio_init(unsigned int gpio) {}
+void gpio_set_dir(unsigned int gpio, bool out) {}
+void gpio_put(unsigned int gpio, bool value) {
+    for (uint8_t i = 0; i < 4; i++) {
+        if (selectPins[i] == (Pin_t)gpio) {
+            switchTo(value ? (model.select | (1 << i)) : (model.select & ~(1 << i)));
+        }
+    }
+}
+void adc_gpio_init(uint gpio) {}
+}
+
+uint64_t getMicro() { return (uint64_t)nowUs; }
+
+static uint32_t pauses = 0;
+static uint32_t scanReported = 0;
+
+namespace ADCService {
+    bool addChannel(Pin_t pin) { return true; }
+    void start() {}
+    bool isRunning() { return pauses == 0; }
+    uint16_t read(Pin_t pin) { return readBlocking(pin); }
+    uint16_t read(Pin_t pin, uint32_t samples) { return readBlocking(pin, samples); }
+    uint16_t readBlocking(Pin_t pin) { return readBlocking(pin, 1); }
+    uint16_t readBlocking(Pin_t pin, uint32_t samples) {
+        const uint8_t mux = pin - ADC_SERVICE_FIRST_PIN;
+        uint32_t sum = 0;
+        for (uint32_t i = 0; i < samples; i++) {
+            const double reading = nodeReading(mux);
+            model.worstError = std::max(model.worstError, std::fabs(reading - sourceReading(mux, model.select)));
+            model.converted.push_back(mux * 16 + model.select);
+            model.conversions++;
+            sum += (uint16_t)std::lround(reading);
+            nowUs += CONVERSION_US;
+        }
+        return sum / samples;
+    }
+    void pause() { pauses++; }
+    void resume() { pauses--; }
+    uint32_t getSampleCount() { return 0; }
+}
+
+void USBTelemetry::inputScanned(uint32_t us) { scanReported = us; }
+
+void EventManager::triggerEvent(GPEvent & event) {}
+
+Gamepad::Gamepad() :
+    options(Storage::getInstance().gamepadOptions)
+    , hotkeyOptions(Storage::getInstance().hotkeyOptions)
+{
+}
+
+static const struct {
+    GpioAction action;
+    uint32_t mask;
+} buttonActions[] = {
+    { GpioAction::BUTTON_PRESS_B1, GAMEPAD_MASK_B1 }, { GpioAction::BUTTON_PRESS_B2, GAMEPAD_MASK_B2 },
+    { GpioAction::BUTTON_PRESS_B3, GAMEPAD_MASK_B3 }, { GpioAction::BUTTON_PRESS_B4, GAMEPAD_MASK_B4 },
+    { GpioAction::BUTTON_PRESS_L1, GAMEPAD_MASK_L1 }, { GpioAction::BUTTON_PRESS_R1, GAMEPAD_MASK_R1 },
+    { GpioAction::BUTTON_PRESS_L2, GAMEPAD_MASK_L2 }, { GpioAction::BUTTON_PRESS_R2, GAMEPAD_MASK_R2 },
+    { GpioAction::BUTTON_PRESS_S1, GAMEPAD_MASK_S1 }, { GpioAction::BUTTON_PRESS_S2, GAMEPAD_MASK_S2 },
+    { GpioAction::BUTTON_PRESS_L3, GAMEPAD_MASK_L3 }, { GpioAction::BUTTON_PRESS_R3, GAMEPAD_MASK_R3 },
+    { GpioAction::BUTTON_PRESS_A1, GAMEPAD_MASK_A1 }, { GpioAction::BUTTON_PRESS_A2, GAMEPAD_MASK_A2 },
+    { GpioAction::BUTTON_PRESS_E1, GAMEPAD_MASK_E1 }, { GpioAction::BUTTON_PRESS_E2, GAMEPAD_MASK_E2 },
+    { GpioAction::BUTTON_PRESS_E3, GAMEPAD_MASK_E3 }, { GpioAction::BUTTON_PRESS_E4, GAMEPAD_MASK_E4 },
+};
+#define BUTTON_ACTIONS (sizeof(buttonActions) / sizeof(buttonActions[0]))
+
+struct ScanResult {
+    double worstError;
+    uint32_t scanPeriod;
+    uint32_t perTriggerPeriod; // the same triggers switched, settled and converted one at a time
+    uint32_t wrongScans;        // scans that pressed other buttons than the sources
+};
+
+// Sets up the add-on for muxChannels x muxCount triggers, active on the select channels in channelMask, and runs a
+// number of scans. Every scan has to convert each active trigger once on its own channel, the buttons pressed are
+// compared with those of the triggers whose source is pressed.
+static ScanResult runScans(uint8_t muxChannels, uint8_t muxCount, double sourceOhms, uint32_t settleUs, uint16_t channelMask)
+{
+    static Gamepad gamepad;
+    Storage::getInstance().gamepad = &gamepad;
+    HETriggerOptions & options = Storage::getInstance().getAddonOptions().heTriggerOptions;
+    options = HETriggerOptions();
+    options.enabled = true;
+    options.muxChannels = muxChannels;
+    options.selectPin0 = selectPins[0];
+    options.selectPin1 = selectPins[1];
+    options.selectPin2 = selectPins[2];
+    options.selectPin3 = selectPins[3];
+    options.muxADCPin0 = muxCount > 0 ? muxPins[0] : -1;
+    options.muxADCPin1 = muxCount > 1 ? muxPins[1] : -1;
+    options.muxADCPin2 = muxCount > 2 ? muxPins[2] : -1;
+    options.muxADCPin3 = muxCount > 3 ? muxPins[3] : -1;
+    options.muxSettleTime = settleUs;
+    options.triggers_count = 32;
+
+    uint32_t expectedButtons = 0;
+    uint32_t activeTriggers = 0;
+    std::vector<uint16_t> expectedScan;
+    for (uint8_t channel = 0; channel < muxChannels; channel++) {
+        for (uint8_t mux = 0; mux < muxCount; mux++) {
+            const uint8_t he = mux * muxChannels + channel;
+            HETriggerInfo & trigger = options.triggers[he];
+            trigger.action = GpioAction::NONE;
+            if (he >= 32 || !(channelMask & (1 << channel))) {
+                continue;
+            }
+            trigger.action = buttonActions[he % BUTTON_ACTIONS].action;
+            trigger.idle = 150;
+            trigger.active = 2000;
+            trigger.release = 2000;
+            trigger.pressed = 3500;
+            trigger.noise = 30;
+            trigger.filter = AnalogFilterMode::ANALOG_FILTER_NONE;
+            if (sourceReading(mux, channel) == PRESSED_READING) {
+                expectedButtons |= buttonActions[he % BUTTON_ACTIONS].mask;
+            }
+            expectedScan.push_back(mux * 16 + channel);
+            activeTriggers++;
+        }
+    }
+    for (uint8_t he = muxChannels * muxCount; he < 32; he++) {
+        options.triggers[he].action = GpioAction::NONE;
+    }
+
+    model.tau = sourceOhms * INPUT_CAPACITANCE * 1e6;
+    model.channels = muxChannels;
+    model.select = 0;
+    for (uint8_t mux = 0; mux < 4; mux++) {
+        model.nodes[mux] = { (double)sourceReading(mux, 0), (double)sourceReading(mux, 0), nowUs };
+    }
+
+    HETriggerAddon addon;
+    CHECK(addon.available());
+    addon.setup();
+    CHECK_EQ(addon.getScanPeriod(), 0u);
+
+    ScanResult result = { 0, 0, (uint32_t)std::ceil(activeTriggers * (settleUs + CONVERSION_US)), 0 };
+    model.worstError = 0;
+    for (uint32_t scan = 0; scan < 50; scan++) {
+        nowUs += LOOP_GAP_US;
+        model.converted.clear();
+        gamepad.state.buttons = 0;
+        gamepad.state.dpad = 0;
+        addon.preprocess();
+        CHECK_EQ(pauses, 0u);
+
+        // Every active trigger once, by channel, muxes in order
+        CHECK(model.converted == expectedScan);
+        if (gamepad.state.buttons != expectedButtons) {
+            result.wrongScans++;
+        }
+        CHECK_EQ(scanReported, addon.getScanPeriod());
+        result.scanPeriod = std::max(result.scanPeriod, addon.getScanPeriod());
+        if (testFailures > 0) {
+            break;
+        }
+    }
+    result.worstError = model.worstError;
+    return result;
+}
+
+static void testScan(uint8_t muxChannels, uint8_t muxCount, double sourceOhms)
+{
+    const uint32_t settleUs = HETRIGGER_MUX_SETTLE_TIME;
+    const ScanResult result = runScans(muxChannels, muxCount, sourceOhms, settleUs, 0xFFFF);
+
+    // Settled to well within an LSB, every step after the first waits at most one timer tick more than needed
+    CHECK(result.worstError < 1.0);
+    CHECK_EQ(result.wrongScans, 0u);
+    const uint32_t steps = muxChannels;
+    const uint32_t bound = (steps - 1) * (settleUs + 1) + steps * muxCount * CONVERSION_US + 1;
+    CHECK(result.scanPeriod <= bound);
+    CHECK(result.scanPeriod < result.perTriggerPeriod);
+    printf("%2u channels x %u muxes, %5.0f ohm: worst error %.3f LSB, scan %u us (per trigger %u us)\n",
+        muxChannels, muxCount, sourceOhms, result.worstError, result.scanPeriod, result.perTriggerPeriod);
+}
+
+// Without settling the mux output still carries the previous channel, the model has to show it
+static void testNoSettling()
+{
+    const ScanResult result = runScans(16, 2, 10000, 0, 0xFFFF);
+    CHECK(result.worstError > 1000.0);
+    CHECK(result.wrongScans > 0);
+    printf("16 channels x 2 muxes, no settle time: worst error %.0f LSB, %u of 50 scans pressed wrong buttons\n",
+        result.worstError, result.wrongScans);
+}
+
+// Select channels without a trigger on any mux are skipped, the scan only switches between the others
+static void testSparseChannels()
+{
+    const ScanResult result = runScans(8, 3, 10000, HETRIGGER_MUX_SETTLE_TIME, 0x89);
+    CHECK(result.worstError < 1.0);
+    CHECK_EQ(result.wrongScans, 0u);
+    CHECK(result.scanPeriod <= 2 * (HETRIGGER_MUX_SETTLE_TIME + 1) + 3 * 3 * CONVERSION_US + 1);
+    printf(" 3 of 8 channels x 3 muxes: scan %u us\n", result.scanPeriod);
+}
+
+int main()
+{
+    testScan(16, 2, 1000);
+    testScan(16, 2, 10000);
+    testScan(8, 3, 10000);
+    testScan(4, 4, 10000);
+    testNoSettling();
+    testSparseChannels();
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,164 @@
+#include "drivers/shared/hid_report_plan.h"
+#include "tusb.h"
+#include "drivers/hid/HIDDescriptors.h"
+#include "drivers/switch/SwitchDescriptors.h"
+#include "drivers/switchpro/SwitchProDescriptors.h"
+#include "drivers/ps3/PS3Descriptors.h"
+#include "drivers/ps4/PS4Descriptors.h"
+#include "drivers/psclassic/PSClassicDescriptors.h"
+#include "drivers/astro/AstroDescriptors.h"
+#include "drivers/neogeo/NeoGeoDescriptors.h"
+#include "drivers/p5general/P5GeneralDescriptors.h"
+#include "drivers/keyboard/KeyboardDescriptors.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+#include "test.h"
+
+// Mutated report descriptors through HIDReportPlan::compile() and random reports through decode() under the
+// address and undefined behaviour sanitizers. The seeds are the report descriptors in the tree; descriptors dumped
+// from real devices can be added on the command line, one per file as hex bytes:
+//   hidreportplan_fuzz descriptor.txt
+
+typedef std::vector<uint8_t> Bytes;
+
+static uint32_t randomState = 0x12345678;
+
+static uint32_t randomNext()
+{
+    randomState ^= randomState << 13;
+    randomState ^= randomState >> 17;
+    randomState ^= randomState << 5;
+    return randomState;
+}
+
+static bool loadDescriptor(const char * path, std::vector<Bytes> & seeds) {
+    FILE * file = fopen(path, "r");
+    if (file == nullptr) {
+        printf("cannot open %s\n", path);
+        return false;
+    }
+    Bytes desc;
+    unsigned int byte;
+    while (fscanf(file, "%x", &byte) == 1) {
+        desc.push_back((uint8_t)byte);
+    }
+    fclose(file);
+    seeds.push_back(desc);
+    return true;
+}
+
+static void mutate(Bytes & desc) {
+    switch (randomNext() % 6) {
+        case 0: // flip a bit
+            if (!desc.empty()) {
+                desc[randomNext() % desc.size()] ^= 1 << (randomNext() % 8);
+            }
+            break;
+        case 1: // random byte
+            if (!desc.empty()) {
+                desc[randomNext() % desc.size()] = randomNext();
+            }
+            break;
+        case 2: // truncate
+            desc.resize(randomNext() % (desc.size() + 1));
+            break;
+        case 3: // drop an item's worth of bytes
+            if (!desc.empty()) {
+                const size_t at = randomNext() % desc.size();
+                desc.erase(desc.begin() + at, desc.begin() + std::min(desc.size(), at + 1 + randomNext() % 3));
+            }
+            break;
+        case 4: // duplicate a stretch, e.g. nested collections or repeated inputs
+            if (!desc.empty() && desc.size() < 1024) {
+                const size_t at = randomNext() % desc.size();
+                const size_t len = std::min<size_t>(desc.size() - at, 1 + randomNext() % 16);
+                Bytes stretch(desc.begin() + at, desc.begin() + at + len);
+                desc.insert(desc.begin() + randomNext() % desc.size(), stretch.begin(), stretch.end());
+            }
+            break;
+        default: // oversized report size or count
+            if (!desc.empty()) {
+                const uint8_t items[] = { 0x75, 0x95, 0x26, 0x16 };
+                const size_t at = randomNext() % desc.size();
+                desc.insert(desc.begin() + at, { items[randomNext() % 4], (uint8_t)randomNext() });
+            }
+            break;
+    }
+}
+
+int main(int argc, char ** argv) {
+    std::vector<Bytes> seeds = {
+        Bytes(hid_report_descriptor, hid_report_descriptor + sizeof(hid_report_descriptor)),
+        Bytes(switch_report_descriptor, switch_report_descriptor + sizeof(switch_report_descriptor)),
+        Bytes(switch_pro_report_descriptor, switch_pro_report_descriptor + sizeof(switch_pro_report_descriptor)),
+        Bytes(ps3_report_descriptor, ps3_report_descriptor + sizeof(ps3_report_descriptor)),
+        Bytes(ps4_report_descriptor, ps4_report_descriptor + sizeof(ps4_report_descriptor)),
+        Bytes(psclassic_report_descriptor, psclassic_report_descriptor + sizeof(psclassic_report_descriptor)),
+        Bytes(astro_report_descriptor, astro_report_descriptor + sizeof(astro_report_descriptor)),
+        Bytes(neogeo_report_descriptor, neogeo_report_descriptor + sizeof(neogeo_report_descriptor)),
+        Bytes(p5general_report_descriptor, p5general_report_descriptor + sizeof(p5general_report_descriptor)),
+        Bytes(keyboard_report_descriptor, keyboard_report_descriptor + sizeof(keyboard_report_descriptor)),
+    };
+    for (int i = 1; i < argc; i++) {
+        if (!loadDescriptor(argv[i], seeds)) {
+            return 1;
+        }
+    }
+
+    uint32_t compiled = 0;
+    uint32_t decoded = 0;
+    for (uint32_t run = 0; run < 100000; run++) {
+        Bytes desc = seeds[randomNext() % seeds.size()];
+        const uint32_t mutations = randomNext() % 4;
+        for (uint32_t m = 0; m < mutations; m++) {
+            mutate(desc);
+        }
+
+        // Exactly sized heap copies, so a read past the end is caught
+        uint8_t * descCopy = new uint8_t[desc.size()];
+        std::copy(desc.begin(), desc.end(), descCopy);
+        HIDReportPlan plan;
+        if (plan.compile(descCopy, desc.size())) {
+            compiled++;
+        }
+        delete[] descCopy;
+
+        // Reports of every length an interrupt endpoint delivers, the first byte often the plan's report ID
+        for (uint32_t r = 0; r < 16; r++) {
+            const uint16_t len = randomNext() % 65;
+            uint8_t * report = new uint8_t[len];
+            for (uint16_t b = 0; b < len; b++) {
+                report[b] = randomNext();
+            }
+            if (len > 0 && randomNext() % 2) {
+                report[0] = plan.getReportId();
+            }
+            GamepadState state;
+            if (plan.decode(report, len, state)) {
+                decoded++;
+                CHECK(state.lt <= GAMEPAD_TRIGGER_MAX);
+                CHECK(state.rt <= GAMEPAD_TRIGGER_MAX);
+                CHECK(state.dpad <= 0xF);
+            }
+            delete[] report;
+        }
+
+        if (testFailures > 0) {
+            printf("failed on descriptor:");
+            for (uint8_t byte : desc) {
+                printf(" %02x", byte);
+            }
+            printf("\n");
+            return TEST_RESULT();
+        }
+    }
+
+    printf("%u of 100000 descriptors compiled, %u reports decoded\n", compiled, decoded);
+    CHECK(compiled > 10000);
+    CHECK(decoded > 10000);
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,456 @@
+#include "drivers/shared/hid_report_plan.h"
+#include "addons/gamepad_usb_host_listener.h"
+#include "storagemanager.h"
+#include "class/hid/hid_host.h"
+#include "drivers/shared/xinput_host.h"
+#include "drivers/hid/HIDDriver.h"
+#include "drivers/hid/HIDDescriptors.h"
+#include "drivers/switch/SwitchDriver.h"
+#include "drivers/switch/SwitchDescriptors.h"
+#include "drivers/switchpro/SwitchProDescriptors.h"
+#include "drivers/ps3/PS3Descriptors.h"
+#include "drivers/ps4/PS4Descriptors.h"
+#include "drivers/psclassic/PSClassicDriver.h"
+#include "drivers/psclassic/PSClassicDescriptors.h"
+#include "drivers/astro/AstroDriver.h"
+#include "drivers/astro/AstroDescriptors.h"
+#include "drivers/egret/EgretDriver.h"
+#include "drivers/egret/EgretDescriptors.h"
+#include "drivers/mdmini/MDMiniDriver.h"
+#include "drivers/mdmini/MDMiniDescriptors.h"
+#include "drivers/neogeo/NeoGeoDriver.h"
+#include "drivers/neogeo/NeoGeoDescriptors.h"
+#include "drivers/pcengine/PCEngineDriver.h"
+#include "drivers/pcengine/PCEngineDescriptors.h"
+#include "drivers/p5general/P5GeneralDescriptors.h"
+#include "drivers/keyboard/KeyboardDescriptors.h"
+
+#include <chrono>
+#include <cstring>
+
+#include "test.h"
+
+// HIDReportPlan against the report descriptors in the tree: what compile() keeps of each one, and the reports our
+// own device drivers send decoded back into the state they were built from. The USB side only records the last
+// report sent, the host side is a generic pad with a few HID interfaces.
+
+#define GENERIC_PAD_PID 0x1234
+
+static uint8_t sentReport[64];
+static uint16_t sentReportSize = 0;
+
+extern "C" {
+bool tud_suspended(void) { return false; }
+bool tud_remote_wakeup(void) { return true; }
+bool tud_hid_ready(void) { return true; }
+bool tud_hid_report(uint8_t report_id, void const * report, uint16_t len) {
+    memcpy(sentReport, report, len);
+    sentReportSize = len;
+    return true;
+}
+bool tud_hid_n_ready(uint8_t instance) { return true; }
+bool tud_hid_n_report(uint8_t instance, uint8_t report_id, void const * report, uint16_t len) {
+    return tud_hid_report(report_id, report, len);
+}
+void hidd_init(void) {}
+void hidd_reset(uint8_t rhport) {}
+uint16_t hidd_open(uint8_t rhport, tusb_desc_interface_t const * desc_itf, uint16_t max_len) { return 0; }
+bool hidd_control_xfer_cb(uint8_t rhport, uint8_t stage, tusb_control_request_t const * request) { return false; }
+bool hidd_xfer_cb(uint8_t rhport, uint8_t ep_addr, xfer_result_t result, uint32_t xferred_bytes) { return false; }
+
+bool tuh_vid_pid_get(uint8_t daddr, uint16_t * vid, uint16_t * pid) {
+    *vid = 0xF00D;
+    *pid = GENERIC_PAD_PID;
+    return true;
+}
+uint8_t tuh_hid_interface_protocol(uint8_t dev_addr, uint8_t instance) { return HID_ITF_PROTOCOL_NONE; }
+uint8_t tuh_hid_parse_report_descriptor(tuh_hid_report_info_t * reports_info_arr, uint8_t arr_count,
+                                        uint8_t const * desc_report, uint16_t desc_len) { return 0; }
+bool tuh_hid_send_report(uint8_t dev_addr, uint8_t instance, uint8_t report_id, const void * report, uint16_t len) { return true; }
+bool tuh_hid_get_report(uint8_t dev_addr, uint8_t instance, uint8_t report_id, uint8_t report_type, void * report, uint16_t len) { return true; }
+bool tuh_hid_set_report(uint8_t dev_addr, uint8_t instance, uint8_t report_id, uint8_t report_type, void * report, uint16_t len) { return true; }
+bool tuh_xinput_receive_report(uint8_t dev_addr, uint8_t instance) { return true; }
+bool tuh_xinput_send_report(uint8_t dev_addr, uint8_t instance, uint8_t const * report, uint16_t len) { return true; }
+void tuh_xinput_wait_for_tx(uint8_t dev_addr, uint8_t instance) {}
+}
+
+uint32_t getMillis() { return 0; }
+
+const uint16_t * getStringDescriptor(const char * value, uint8_t index) { return nullptr; }
+
+Gamepad::Gamepad() :
+    options(Storage::getInstance().gamepadOptions)
+    , hotkeyOptions(Storage::getInstance().hotkeyOptions)
+{
+}
+
+// The drivers only build a report when the state generation moved
+void Gamepad::updateStateGeneration() { stateGeneration++; }
+
+#define DESCRIPTOR(desc) #desc, desc, sizeof(desc)
+
+typedef struct {
+    const char * name;
+    const uint8_t * desc;
+    uint16_t len;
+    bool valid;
+    uint8_t reportId;
+    uint8_t fieldCount;
+    uint8_t buttonRunCount;
+    bool analog;
+} CorpusEntry;
+
+// What compile() keeps of every report descriptor in the tree. A change here changes how a real pad of that kind
+// is read when it is plugged into the host port.
+static const CorpusEntry corpus[] = {
+    { DESCRIPTOR(hid_report_descriptor),        true,  0,    5, 1, true },
+    { DESCRIPTOR(switch_report_descriptor),     true,  0,    5, 1, true },
+    { DESCRIPTOR(switch_pro_report_descriptor), true,  0x30, 5, 2, true },
+    { DESCRIPTOR(ps3_report_descriptor),        true,  1,    4, 1, true },
+    { DESCRIPTOR(ps3_alt_report_descriptor),    true,  0,    5, 1, true },
+    { DESCRIPTOR(ps4_report_descriptor),        true,  1,    7, 1, true },
+    { DESCRIPTOR(psclassic_report_descriptor),  true,  0,    2, 1, true },
+    { DESCRIPTOR(astro_report_descriptor),      true,  0,    2, 1, true },
+    { DESCRIPTOR(egret_report_descriptor),      true,  0,    2, 1, true },
+    { DESCRIPTOR(mdmini_report_descriptor),     true,  0,    2, 1, true },
+    { DESCRIPTOR(neogeo_report_descriptor),     true,  0,    7, 1, true },
+    { DESCRIPTOR(pcengine_report_descriptor),   true,  0,    5, 1, true },
+    { DESCRIPTOR(p5general_report_descriptor),  true,  1,    7, 1, true },
+    // Keyboards belong to the keyboard host add-on
+    { DESCRIPTOR(keyboard_report_descriptor),   false, 0,    0, 0, false },
+};
+
+static void testCorpus()
+{
+    for (const CorpusEntry & entry : corpus) {
+        HIDReportPlan plan;
+        const bool valid = plan.compile(entry.desc, entry.len);
+        if (valid != entry.valid || plan.getReportId() != entry.reportId || plan.getFieldCount() != entry.fieldCount ||
+                plan.getButtonRunCount() != entry.buttonRunCount || plan.hasAnalog() != entry.analog) {
+            printf("%s: valid %d report ID %u fields %u button runs %u analog %d\n", entry.name, valid,
+                   plan.getReportId(), plan.getFieldCount(), plan.getButtonRunCount(), plan.hasAnalog());
+            testFailures++;
+        }
+
+        // Every truncation of a descriptor compiles without reading past the end
+        for (uint16_t len = 0; len < entry.len; len++) {
+            plan.compile(entry.desc, len);
+        }
+    }
+}
+
+typedef struct {
+    const char * name;
+    GPDriver * driver;
+    const uint8_t * desc;
+    uint16_t len;
+    bool hat;           // the d-pad is a hat switch, otherwise it is the X and Y axes
+    bool sameButtons;   // HID button numbers follow our own HID mode, so the masks come back unchanged
+    uint16_t center;    // decoded neutral stick
+} DriverEntry;
+
+static bool sendState(Gamepad & gamepad, GPDriver * driver, uint32_t buttons, uint8_t dpad)
+{
+    gamepad.state = GamepadState();
+    gamepad.state.buttons = buttons;
+    gamepad.state.dpad = dpad;
+    gamepad.updateStateGeneration();
+    sentReportSize = 0;
+    driver->process(&gamepad);
+    return sentReportSize != 0;
+}
+
+static const uint8_t directions[] = {
+    GAMEPAD_MASK_UP,
+    GAMEPAD_MASK_UP | GAMEPAD_MASK_RIGHT,
+    GAMEPAD_MASK_RIGHT,
+    GAMEPAD_MASK_RIGHT | GAMEPAD_MASK_DOWN,
+    GAMEPAD_MASK_DOWN,
+    GAMEPAD_MASK_DOWN | GAMEPAD_MASK_LEFT,
+    GAMEPAD_MASK_LEFT,
+    GAMEPAD_MASK_LEFT | GAMEPAD_MASK_UP,
+};
+
+// Reports built by our device drivers, decoded with the plan of the descriptor they are sent under
+static void testDriverRoundTrip()
+{
+    Gamepad gamepad;
+    Storage::getInstance().gamepad = &gamepad;
+
+    HIDDriver hid;
+    SwitchDriver switchDriver;
+    PSClassicDriver psClassic;
+    AstroDriver astro;
+    EgretDriver egret;
+    MDMiniDriver mdMini;
+    NeoGeoDriver neoGeo;
+    PCEngineDriver pcEngine;
+    const DriverEntry drivers[] = {
+        { "hid",       &hid,          hid_report_descriptor,       sizeof(hid_report_descriptor),       true,  true,  0x7F7F },
+        { "switch",    &switchDriver, switch_report_descriptor,    sizeof(switch_report_descriptor),    true,  true,  0x7F7F },
+        { "psclassic", &psClassic,    psclassic_report_descriptor, sizeof(psclassic_report_descriptor), false, false, 0x7FFF },
+        { "astro",     &astro,        astro_report_descriptor,     sizeof(astro_report_descriptor),     false, false, 0x7F7F },
+        { "egret",     &egret,        egret_report_descriptor,     sizeof(egret_report_descriptor),     false, false, 0x7F7F },
+        { "mdmini",    &mdMini,       mdmini_report_descriptor,    sizeof(mdmini_report_descriptor),    false, false, 0x7F7F },
+        { "neogeo",    &neoGeo,       neogeo_report_descriptor,    sizeof(neogeo_report_descriptor),    true,  false, 0x8080 },
+        { "pcengine",  &pcEngine,     pcengine_report_descriptor,  sizeof(pcengine_report_descriptor),  true,  false, 0x8080 },
+    };
+
+    for (const DriverEntry & entry : drivers) {
+        entry.driver->initialize();
+        HIDReportPlan plan;
+        CHECK(plan.compile(entry.desc, entry.len));
+
+        GamepadState decoded;
+        CHECK(sendState(gamepad, entry.driver, 0, 0));
+        CHECK(plan.decode(sentReport, sentReportSize, decoded));
+        if (decoded.buttons != 0 || decoded.dpad != 0 || decoded.lx != entry.center || decoded.ly != entry.center) {
+            printf("%s: neutral decodes to buttons %05x d-pad %x lx %04x ly %04x\n", entry.name, decoded.buttons,
+                   decoded.dpad, decoded.lx, decoded.ly);
+            testFailures++;
+        }
+
+        // Each button the driver reports comes back as one button of its own
+        uint32_t seen = 0;
+        for (uint8_t bit = 0; bit < 14; bit++) {
+            if (!sendState(gamepad, entry.driver, 1U << bit, 0)) {
+                continue; // the pad has no such button, the report did not change
+            }
+            CHECK(plan.decode(sentReport, sentReportSize, decoded));
+            if (entry.sameButtons) {
+                CHECK_EQ(decoded.buttons, 1U << bit);
+            } else if (decoded.buttons != 0) {
+                CHECK((decoded.buttons & (decoded.buttons - 1)) == 0);
+                CHECK((seen & decoded.buttons) == 0);
+                seen |= decoded.buttons;
+            }
+            CHECK_EQ(decoded.dpad, 0);
+        }
+
+        for (uint8_t direction : directions) {
+            sendState(gamepad, entry.driver, 0, direction);
+            CHECK(plan.decode(sentReport, sentReportSize, decoded));
+            if (entry.hat) {
+                CHECK_EQ(decoded.dpad, direction);
+            } else {
+                CHECK_EQ(decoded.dpad, 0);
+                const uint16_t x = (direction & GAMEPAD_MASK_LEFT) ? GAMEPAD_JOYSTICK_MIN :
+                    (direction & GAMEPAD_MASK_RIGHT) ? GAMEPAD_JOYSTICK_MAX : entry.center;
+                const uint16_t y = (direction & GAMEPAD_MASK_UP) ? GAMEPAD_JOYSTICK_MIN :
+                    (direction & GAMEPAD_MASK_DOWN) ? GAMEPAD_JOYSTICK_MAX : entry.center;
+                if (decoded.lx != x || decoded.ly != y) {
+                    printf("%s: d-pad %x decodes to lx %04x ly %04x\n", entry.name, direction, decoded.lx, decoded.ly);
+                    testFailures++;
+                }
+            }
+        }
+    }
+
+    // Our HID mode sends 8 bit sticks, they come back spread over the full range
+    hid.initialize();
+    HIDReportPlan plan;
+    CHECK(plan.compile(hid_report_descriptor, sizeof(hid_report_descriptor)));
+    for (uint32_t value = 0; value <= GAMEPAD_JOYSTICK_MAX; value += 0x3F) {
+        gamepad.state = GamepadState();
+        gamepad.state.lx = value;
+        gamepad.state.ry = GAMEPAD_JOYSTICK_MAX - value;
+        gamepad.updateStateGeneration();
+        hid.process(&gamepad);
+        GamepadState decoded;
+        CHECK(plan.decode(sentReport, sentReportSize, decoded));
+        CHECK_EQ(decoded.lx, (value >> 8) * 0x101);
+        CHECK_EQ(decoded.ry, ((GAMEPAD_JOYSTICK_MAX - value) >> 8) * 0x101);
+    }
+}
+
+// A DualShock 4 input report, the layout dedicated DS4 handling reads, through the generic plan
+static void testDS4()
+{
+    HIDReportPlan plan;
+    CHECK(plan.compile(ps4_report_descriptor, sizeof(ps4_report_descriptor)));
+
+    PS4Report report = {};
+    report.reportID = 1;
+    report.leftStickX = 0x00;
+    report.leftStickY = 0xFF;
+    report.rightStickX = 0x80;
+    report.rightStickY = 0x40;
+    report.dpad = PS4_HAT_DOWNLEFT;
+    report.buttonWest = 1;
+    report.buttonR2 = 1;
+    report.buttonHome = 1;
+    report.reportCounter = 0x3F;
+    report.leftTrigger = 0xFF;
+    report.rightTrigger = 0x10;
+
+    GamepadState decoded;
+    CHECK(plan.decode((const uint8_t *)&report, sizeof(report), decoded));
+    CHECK_EQ(decoded.buttons, GAMEPAD_MASK_B3 | GAMEPAD_MASK_R2 | GAMEPAD_MASK_A1);
+    CHECK_EQ(decoded.dpad, GAMEPAD_MASK_DOWN | GAMEPAD_MASK_LEFT);
+    CHECK_EQ(decoded.lx, 0x0000);
+    CHECK_EQ(decoded.ly, 0xFFFF);
+    CHECK_EQ(decoded.rx, 0x8080);
+    CHECK_EQ(decoded.ry, 0x4040);
+    CHECK_EQ(decoded.lt, 0xFF);
+    CHECK_EQ(decoded.rt, 0x10);
+
+    report = {};
+    report.reportID = 1;
+    report.dpad = PS4_HAT_NOTHING;
+    report.buttonSouth = 1;
+    report.buttonEast = 1;
+    report.buttonNorth = 1;
+    report.buttonSelect = 1;
+    report.buttonTouchpad = 1;
+    CHECK(plan.decode((const uint8_t *)&report, sizeof(report), decoded));
+    CHECK_EQ(decoded.buttons, GAMEPAD_MASK_B1 | GAMEPAD_MASK_B2 | GAMEPAD_MASK_B4 | GAMEPAD_MASK_S1 | GAMEPAD_MASK_A2);
+    CHECK_EQ(decoded.dpad, 0);
+
+    // Other report IDs and short reports leave the state alone
+    report.reportID = 5;
+    CHECK(!plan.decode((const uint8_t *)&report, sizeof(report), decoded));
+    report.reportID = 1;
+    CHECK(!plan.decode((const uint8_t *)&report, 9, decoded));
+}
+
+// Descriptor features none of the in-tree descriptors use
+static void testHandBuilt()
+{
+    HIDReportPlan plan;
+    GamepadState decoded;
+
+    // Signed 16 bit sticks and a 4 position hat
+    static const uint8_t signedSticks[] = {
+        0x05, 0x01, 0x09, 0x04, 0xA1, 0x01,
+        0x16, 0x00, 0x80, 0x26, 0xFF, 0x7F, 0x75, 0x10, 0x95, 0x02, 0x09, 0x30, 0x09, 0x31, 0x81, 0x02,
+        0x15, 0x00, 0x25, 0x03, 0x75, 0x04, 0x95, 0x01, 0x09, 0x39, 0x81, 0x42,
+        0x75, 0x04, 0x95, 0x01, 0x81, 0x01,
+        0xC0,
+    };
+    CHECK(plan.compile(signedSticks, sizeof(signedSticks)));
+    const uint8_t sticks[] = { 0x00, 0x80, 0xFF, 0x7F, 0x03 };
+    CHECK(plan.decode(sticks, sizeof(sticks), decoded));
+    CHECK_EQ(decoded.lx, GAMEPAD_JOYSTICK_MIN);
+    CHECK_EQ(decoded.ly, GAMEPAD_JOYSTICK_MAX);
+    CHECK_EQ(decoded.dpad, GAMEPAD_MASK_LEFT);
+    const uint8_t centred[] = { 0x00, 0x00, 0x00, 0x00, 0x0F };
+    CHECK(plan.decode(centred, sizeof(centred), decoded));
+    CHECK(decoded.lx >= 0x7FFF && decoded.lx <= 0x8000);
+    CHECK_EQ(decoded.dpad, 0);
+
+    // Wheel pedals on the simulation page, behind a second report ID
+    static const uint8_t wheel[] = {
+        0x05, 0x01, 0x09, 0x04, 0xA1, 0x01,
+        0x85, 0x02, 0x05, 0x02, 0x15, 0x00, 0x26, 0xFF, 0x03, 0x75, 0x10, 0x95, 0x02,
+        0x09, 0xC4, 0x09, 0xC5, 0x81, 0x02,
+        0xC0,
+    };
+    CHECK(plan.compile(wheel, sizeof(wheel)));
+    CHECK_EQ(plan.getReportId(), 2);
+    const uint8_t pedals[] = { 0x02, 0xFF, 0x03, 0x00, 0x02 };
+    CHECK(plan.decode(pedals, sizeof(pedals), decoded));
+    CHECK_EQ(decoded.rt, GAMEPAD_TRIGGER_MAX);
+    CHECK_EQ(decoded.lt, 0x7F);
+
+    // A repeated usage in one item moves the target to the later field, a usage repeated by a later item does not
+    static const uint8_t repeated[] = {
+        0x05, 0x01, 0x09, 0x05, 0xA1, 0x01,
+        0x15, 0x00, 0x26, 0xFF, 0x00, 0x75, 0x08, 0x95, 0x03, 0x09, 0x30, 0x09, 0x30, 0x09, 0x31, 0x81, 0x02,
+        0x95, 0x01, 0x09, 0x31, 0x81, 0x02,
+        0xC0,
+    };
+    CHECK(plan.compile(repeated, sizeof(repeated)));
+    CHECK_EQ(plan.getFieldCount(), 2);
+    const uint8_t axes[] = { 0x00, 0xFF, 0x00, 0xFF };
+    CHECK(plan.decode(axes, sizeof(axes), decoded));
+    CHECK_EQ(decoded.lx, GAMEPAD_JOYSTICK_MAX);
+    CHECK_EQ(decoded.ly, GAMEPAD_JOYSTICK_MIN);
+
+    // Buttons listed out of order, one run each
+    static const uint8_t scattered[] = {
+        0x05, 0x01, 0x09, 0x05, 0xA1, 0x01,
+        0x05, 0x09, 0x15, 0x00, 0x25, 0x01, 0x75, 0x01, 0x95, 0x04,
+        0x09, 0x04, 0x09, 0x03, 0x09, 0x02, 0x09, 0x01, 0x81, 0x02,
+        0x95, 0x04, 0x81, 0x01,
+        0xC0,
+    };
+    CHECK(plan.compile(scattered, sizeof(scattered)));
+    CHECK_EQ(plan.getButtonRunCount(), 4);
+    const uint8_t buttons[] = { 0x09 };
+    CHECK(plan.decode(buttons, sizeof(buttons), decoded));
+    CHECK_EQ(decoded.buttons, GAMEPAD_MASK_B4 | GAMEPAD_MASK_B3);
+    CHECK(!plan.hasAnalog());
+}
+
+// A generic pad is decoded with the plan of the interface it was claimed for
+static void testListenerMount()
+{
+    Gamepad gamepad;
+    Storage::getInstance().gamepad = &gamepad;
+    GamepadUSBHostListener listener;
+    listener.setup();
+
+    // No gamepad report, nothing to claim
+    CHECK(!listener.mount(1, 0, keyboard_report_descriptor, sizeof(keyboard_report_descriptor)));
+
+    CHECK(listener.mount(1, 1, hid_report_descriptor, sizeof(hid_report_descriptor)));
+    // A second gamepad interface of the same pad does not replace the layout of the first
+    CHECK(!listener.mount(1, 2, ps4_report_descriptor, sizeof(ps4_report_descriptor)));
+    CHECK(!listener.mount(2, 0, hid_report_descriptor, sizeof(hid_report_descriptor)));
+
+    HIDDriver hid;
+    hid.initialize();
+    sendState(gamepad, &hid, GAMEPAD_MASK_B2 | GAMEPAD_MASK_R1, GAMEPAD_MASK_LEFT);
+    listener.report_received(1, 1, sentReport, sentReportSize);
+    gamepad.state = GamepadState();
+    listener.process();
+    CHECK_EQ(gamepad.state.buttons, GAMEPAD_MASK_B2 | GAMEPAD_MASK_R1);
+    CHECK_EQ(gamepad.state.dpad, GAMEPAD_MASK_LEFT);
+
+    // Unplugged, the next pad is claimed for its own layout
+    listener.unmount(1);
+    CHECK(listener.mount(3, 0, ps4_report_descriptor, sizeof(ps4_report_descriptor)));
+    PS4Report report = {};
+    report.reportID = 1;
+    report.dpad = PS4_HAT_UP;
+    report.buttonNorth = 1;
+    listener.report_received(3, 0, (const uint8_t *)&report, sizeof(report));
+    gamepad.state = GamepadState();
+    listener.process();
+    CHECK_EQ(gamepad.state.buttons, GAMEPAD_MASK_B4);
+    CHECK_EQ(gamepad.state.dpad, GAMEPAD_MASK_UP);
+}
+
+static void benchmarkDecode()
+{
+    HIDReportPlan plan;
+    plan.compile(ps4_report_descriptor, sizeof(ps4_report_descriptor));
+    PS4Report report = {};
+    report.reportID = 1;
+    report.dpad = PS4_HAT_UP;
+
+    const uint32_t iterations = 2000000;
+    GamepadState state;
+    uint32_t sink = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < iterations; i++) {
+        report.leftStickX = i;
+        report.buttonSouth = i >> 3;
+        plan.decode((const uint8_t *)&report, sizeof(report), state);
+        sink += state.lx + state.buttons;
+    }
+    const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+    printf("DS4 report decode: %.1f ns (%u)\n", (double)elapsed.count() / iterations, sink);
+}
+
+int main()
+{
+    testCorpus();
+    testDriverRoundTrip();
+    testDS4();
+    testHandBuilt();
+    testListenerMount();
+    benchmarkDecode();
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,101 @@
+#include "drivers/shared/keepalive_timer.h"
+
+#include "test.h"
+
+// The keepalive cadence of the PS4, Xbox One and Switch Pro drivers: process() sends an input report when the state
+// changed and a keepalive once the timer expired, and every report that goes out resets the timer
+
+static const uint32_t INTERVAL = 100;
+
+struct Driver {
+    KeepAliveTimer timer {INTERVAL};
+    uint32_t keepAlives = 0;
+    uint32_t lastKeepAlive = 0;
+
+    void process(uint32_t now, bool changed) {
+        if (changed) {
+            timer.reset(now);
+        } else if (timer.expired(now)) {
+            keepAlives++;
+            lastKeepAlive = now;
+            timer.reset(now);
+        }
+    }
+};
+
+static void testExpiry()
+{
+    KeepAliveTimer timer(INTERVAL);
+    timer.reset(1000);
+    CHECK(!timer.expired(1000));
+    CHECK(!timer.expired(1000 + INTERVAL - 1));
+    CHECK(!timer.expired(1000 + INTERVAL));
+    CHECK(timer.expired(1000 + INTERVAL + 1));
+    CHECK(timer.expired(1000 + 10 * INTERVAL));
+}
+
+static void testCadence()
+{
+    Driver driver;
+    driver.timer.reset(0);
+    for (uint32_t now = 1; now <= 10 * (INTERVAL + 1); now++) {
+        driver.process(now, false);
+    }
+    // Idle input: one keepalive every interval plus the millisecond it takes to expire
+    CHECK_EQ(driver.keepAlives, 10);
+    CHECK_EQ(driver.lastKeepAlive, 10 * (INTERVAL + 1));
+}
+
+static void testResetOnReport()
+{
+    Driver driver;
+    driver.timer.reset(0);
+
+    // Input changing more often than the interval never needs a keepalive
+    for (uint32_t now = 1; now <= 20 * INTERVAL; now++) {
+        driver.process(now, now % (INTERVAL / 2) == 0);
+    }
+    CHECK_EQ(driver.keepAlives, 0);
+
+    // The first keepalive counts from the last input report
+    const uint32_t lastReport = 20 * INTERVAL;
+    for (uint32_t now = lastReport + 1; now <= lastReport + INTERVAL + 1; now++) {
+        driver.process(now, false);
+    }
+    CHECK_EQ(driver.keepAlives, 1);
+    CHECK_EQ(driver.lastKeepAlive, lastReport + INTERVAL + 1);
+}
+
+static void testWrap()
+{
+    // Deadline past the wrap of the 32-bit millisecond counter
+    KeepAliveTimer timer(INTERVAL);
+    const uint32_t start = UINT32_MAX - INTERVAL / 2;
+    timer.reset(start);
+    CHECK(!timer.expired(start));
+    CHECK(!timer.expired(UINT32_MAX));
+    CHECK(!timer.expired(0));
+    CHECK(!timer.expired(start + INTERVAL));
+    CHECK(timer.expired(start + INTERVAL + 1));
+
+    // Same cadence across the wrap as anywhere else
+    Driver driver;
+    driver.timer.reset(start);
+    uint32_t now = start;
+    for (uint32_t step = 0; step < 5 * (INTERVAL + 1); step++) {
+        now++;
+        driver.process(now, false);
+    }
+    CHECK_EQ(driver.keepAlives, 5);
+    CHECK_EQ(driver.lastKeepAlive, (uint32_t)(start + 5 * (INTERVAL + 1)));
+}
+
+int main()
+{
+    testExpiry();
+    testCadence();
+    testResetOnReport();
+    testWrap();
+
+    return TEST_RESULT();
+}
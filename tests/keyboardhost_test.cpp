@@ -0,0 +1,436 @@
+#include "addons/keyboard_host_listener.h"
+#include "drivermanager.h"
+#include "storagemanager.h"
+#include "class/hid/hid_host.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+#include "test.h"
+
+// KeyboardHostListener fed through its USB listener interface: the keycode tables against the per-mapping
+// comparisons they replaced, and the Q16 mouse to stick transform against the float formula it replaced
+
+#define MOUSE_SCALE_FACTOR (GAMEPAD_JOYSTICK_MID / 127)
+#define KEYBOARD_DEV_ADDR 1
+#define MOUSE_DEV_ADDR 2
+
+static uint32_t millis = 0;
+
+uint32_t getMillis() { return millis; }
+
+extern "C" uint8_t tuh_hid_interface_protocol(uint8_t dev_addr, uint8_t instance) {
+    return dev_addr == KEYBOARD_DEV_ADDR ? HID_ITF_PROTOCOL_KEYBOARD : HID_ITF_PROTOCOL_MOUSE;
+}
+
+Gamepad::Gamepad() :
+    options(Storage::getInstance().gamepadOptions)
+    , hotkeyOptions(Storage::getInstance().hotkeyOptions)
+{
+}
+
+// Only the joystick range of the active driver matters to the listener
+class RangeDriver : public GPDriver {
+public:
+    explicit RangeDriver(uint16_t mid) : mid(mid) {}
+    virtual void initialize() {}
+    virtual void initializeAux() {}
+    virtual bool process(Gamepad * gamepad) { return false; }
+    virtual void processAux() {}
+    virtual uint16_t get_report(uint8_t report_id, hid_report_type_t report_type, uint8_t *buffer, uint16_t reqlen) { return 0; }
+    virtual void set_report(uint8_t report_id, hid_report_type_t report_type, uint8_t const *buffer, uint16_t bufsize) {}
+    virtual bool vendor_control_xfer_cb(uint8_t rhport, uint8_t stage, tusb_control_request_t const *request) { return false; }
+    virtual const uint16_t * get_descriptor_string_cb(uint8_t index, uint16_t langid) { return nullptr; }
+    virtual const uint8_t * get_descriptor_device_cb() { return nullptr; }
+    virtual const uint8_t * get_hid_descriptor_report_cb(uint8_t itf) { return nullptr; }
+    virtual const uint8_t * get_descriptor_configuration_cb(uint8_t index) { return nullptr; }
+    virtual const uint8_t * get_descriptor_device_qualifier_cb() { return nullptr; }
+    virtual uint16_t GetJoystickMidValue() { return mid; }
+    virtual USBListener * get_usb_auth_listener() { return nullptr; }
+private:
+    uint16_t mid;
+};
+
+static RangeDriver hidRange(0x8000);
+
+// HID centres on 0x8000, config mode has no driver and the listener falls back to GAMEPAD_JOYSTICK_MID (0x7FFF)
+void DriverManager::setup(InputMode mode) {
+    inputMode = mode;
+    driver = mode == INPUT_MODE_GENERIC ? &hidRange : nullptr;
+}
+
+static Gamepad gamepad;
+
+static uint32_t randomState = 0x12345678;
+
+static uint32_t randomNext()
+{
+    randomState ^= randomState << 13;
+    randomState ^= randomState >> 17;
+    randomState ^= randomState << 5;
+    return randomState;
+}
+
+#define KEY_MAPPINGS 20
+#define DPAD_MAPPINGS 4
+
+// Mapping order of the tables: the four d-pad directions, then the buttons
+static const uint16_t MAPPING_MASKS[KEY_MAPPINGS] = {
+    GAMEPAD_MASK_UP, GAMEPAD_MASK_DOWN, GAMEPAD_MASK_LEFT, GAMEPAD_MASK_RIGHT,
+    GAMEPAD_MASK_B1, GAMEPAD_MASK_B2, GAMEPAD_MASK_B3, GAMEPAD_MASK_B4,
+    GAMEPAD_MASK_L1, GAMEPAD_MASK_R1, GAMEPAD_MASK_L2, GAMEPAD_MASK_R2,
+    GAMEPAD_MASK_S1, GAMEPAD_MASK_S2, GAMEPAD_MASK_L3, GAMEPAD_MASK_R3,
+    GAMEPAD_MASK_A1, GAMEPAD_MASK_A2, GAMEPAD_MASK_A3, GAMEPAD_MASK_A4,
+};
+
+static uint32_t KeyboardMapping::* const MAPPING_KEYS[KEY_MAPPINGS] = {
+    &KeyboardMapping::keyDpadUp, &KeyboardMapping::keyDpadDown, &KeyboardMapping::keyDpadLeft, &KeyboardMapping::keyDpadRight,
+    &KeyboardMapping::keyButtonB1, &KeyboardMapping::keyButtonB2, &KeyboardMapping::keyButtonB3, &KeyboardMapping::keyButtonB4,
+    &KeyboardMapping::keyButtonL1, &KeyboardMapping::keyButtonR1, &KeyboardMapping::keyButtonL2, &KeyboardMapping::keyButtonR2,
+    &KeyboardMapping::keyButtonS1, &KeyboardMapping::keyButtonS2, &KeyboardMapping::keyButtonL3, &KeyboardMapping::keyButtonR3,
+    &KeyboardMapping::keyButtonA1, &KeyboardMapping::keyButtonA2, &KeyboardMapping::keyButtonA3, &KeyboardMapping::keyButtonA4,
+};
+
+// process_kbd_report before the tables. The old loop stopped at i < 13 and never looked at the right GUI bit, the
+// reference covers all eight modifier bits so the comparison is about the mapping logic
+struct LegacyKeyboard {
+    KeyboardButtonMapping mappings[KEY_MAPPINGS];
+
+    void setup(const KeyboardMapping & keyboardMapping) {
+        for (uint8_t i = 0; i < KEY_MAPPINGS; i++) {
+            mappings[i].setMask(MAPPING_MASKS[i]);
+            mappings[i].setKey(keyboardMapping.*MAPPING_KEYS[i]);
+        }
+    }
+
+    static uint8_t getKeycodeFromModifier(uint8_t modifier) {
+        switch (modifier) {
+            case KEYBOARD_MODIFIER_LEFTCTRL   : return HID_KEY_CONTROL_LEFT ;
+            case KEYBOARD_MODIFIER_LEFTSHIFT  : return HID_KEY_SHIFT_LEFT   ;
+            case KEYBOARD_MODIFIER_LEFTALT    : return HID_KEY_ALT_LEFT     ;
+            case KEYBOARD_MODIFIER_LEFTGUI    : return HID_KEY_GUI_LEFT     ;
+            case KEYBOARD_MODIFIER_RIGHTCTRL  : return HID_KEY_CONTROL_RIGHT;
+            case KEYBOARD_MODIFIER_RIGHTSHIFT : return HID_KEY_SHIFT_RIGHT  ;
+            case KEYBOARD_MODIFIER_RIGHTALT   : return HID_KEY_ALT_RIGHT    ;
+            case KEYBOARD_MODIFIER_RIGHTGUI   : return HID_KEY_GUI_RIGHT    ;
+        }
+        return 0;
+    }
+
+    void process(hid_keyboard_report_t const * report, uint16_t & buttons, uint8_t & dpad) const {
+        buttons = 0;
+        dpad = 0;
+        for (uint8_t i = 0; i < 14; i++) {
+            uint8_t keycode = (i < 6) ? report->keycode[i] : getKeycodeFromModifier(report->modifier & (1 << (i - 6)));
+            if (keycode) {
+                for (uint8_t m = 0; m < DPAD_MAPPINGS; m++) {
+                    dpad |= (keycode == mappings[m].key) ? mappings[m].buttonMask : dpad;
+                }
+                for (uint8_t m = DPAD_MAPPINGS; m < KEY_MAPPINGS; m++) {
+                    buttons |= (keycode == mappings[m].key) ? mappings[m].buttonMask : buttons;
+                }
+            }
+        }
+    }
+};
+
+// Random mappings that often share keys and use modifiers, some left unassigned or out of range
+static void randomKeyboardMapping(KeyboardMapping & keyboardMapping) {
+    static const uint8_t commonKeys[] = { 0x04, 0x16, 0x1A, 0x2C, HID_KEY_CONTROL_LEFT, HID_KEY_SHIFT_LEFT, HID_KEY_ALT_RIGHT, HID_KEY_GUI_RIGHT };
+    for (uint8_t i = 0; i < KEY_MAPPINGS; i++) {
+        const uint32_t choice = randomNext() % 8;
+        if (choice == 0) {
+            keyboardMapping.*MAPPING_KEYS[i] = 0;
+        } else if (choice < 4) {
+            keyboardMapping.*MAPPING_KEYS[i] = commonKeys[randomNext() % sizeof(commonKeys)];
+        } else if (choice < 7) {
+            keyboardMapping.*MAPPING_KEYS[i] = randomNext() % (HID_KEY_GUI_RIGHT + 1);
+        } else {
+            keyboardMapping.*MAPPING_KEYS[i] = randomNext() % 0x200;
+        }
+    }
+}
+
+static void setupKeyboard(KeyboardHostListener & listener, LegacyKeyboard & legacy) {
+    KeyboardHostOptions & options = Storage::getInstance().addonOptions.keyboardHostOptions;
+    randomKeyboardMapping(options.mapping);
+    listener.setup();
+    listener.mount(KEYBOARD_DEV_ADDR, 0, nullptr, 0);
+    legacy.setup(options.mapping);
+}
+
+static void pressKeys(KeyboardHostListener & listener, const hid_keyboard_report_t & report) {
+    listener.report_received(KEYBOARD_DEV_ADDR, 0, (const uint8_t *)&report, sizeof(report));
+    gamepad.state = GamepadState();
+    listener.process();
+}
+
+// Every keycode on its own, every modifier combination and random six-key reports give the same buttons and d-pad
+// as the old comparisons. Keycodes past HID_KEY_GUI_RIGHT are reserved and map to nothing: the old chain matched
+// 0xFF against every unassigned mapping, whose key is 0xFF
+static void testKeyboardEquivalence() {
+    DriverManager::getInstance().setup(INPUT_MODE_CONFIG);
+    KeyboardHostListener listener;
+    LegacyKeyboard legacy;
+    uint32_t reports = 0;
+    uint32_t mismatches = 0;
+    for (uint32_t run = 0; run < 2000; run++) {
+        setupKeyboard(listener, legacy);
+        auto compare = [&](const hid_keyboard_report_t & report) {
+            uint16_t buttons;
+            uint8_t dpad;
+            legacy.process(&report, buttons, dpad);
+            pressKeys(listener, report);
+            reports++;
+            if (gamepad.state.buttons != buttons || gamepad.state.dpad != dpad) {
+                mismatches++;
+            }
+        };
+
+        hid_keyboard_report_t report = {};
+        for (uint32_t keycode = 0; keycode <= HID_KEY_GUI_RIGHT; keycode++) {
+            report.keycode[randomNext() % 6] = keycode;
+            compare(report);
+            report = {};
+        }
+        for (uint32_t modifier = 0; modifier <= 0xFF; modifier++) {
+            report.modifier = modifier;
+            compare(report);
+        }
+        for (uint32_t i = 0; i < 500; i++) {
+            report.modifier = randomNext() % 4 == 0 ? randomNext() : 0;
+            for (uint8_t k = 0; k < 6; k++) {
+                report.keycode[k] = randomNext() % 2 == 0 ? randomNext() % (HID_KEY_GUI_RIGHT + 1) : 0;
+            }
+            compare(report);
+        }
+
+        report = {};
+        for (uint32_t keycode = HID_KEY_GUI_RIGHT + 1; keycode <= 0xFF; keycode++) {
+            report.keycode[0] = keycode;
+            pressKeys(listener, report);
+            CHECK_EQ(gamepad.state.buttons, 0);
+            CHECK_EQ(gamepad.state.dpad, 0);
+        }
+    }
+    CHECK(reports > 1000000);
+    CHECK_EQ(mismatches, 0);
+}
+
+// Every mapping reaches its button, A3 and A4 included, and right GUI works as a modifier
+static void testKeyboardMappings() {
+    DriverManager::getInstance().setup(INPUT_MODE_CONFIG);
+    KeyboardHostListener listener;
+    KeyboardHostOptions & options = Storage::getInstance().addonOptions.keyboardHostOptions;
+    for (uint8_t i = 0; i < KEY_MAPPINGS; i++) {
+        options.mapping.*MAPPING_KEYS[i] = 0x04 + i;
+    }
+    options.mapping.keyButtonA4 = HID_KEY_GUI_RIGHT;
+    listener.setup();
+    listener.mount(KEYBOARD_DEV_ADDR, 0, nullptr, 0);
+
+    hid_keyboard_report_t report = {};
+    for (uint8_t i = 0; i < KEY_MAPPINGS - 1; i++) {
+        report.keycode[5] = 0x04 + i;
+        pressKeys(listener, report);
+        if (i < DPAD_MAPPINGS) {
+            CHECK_EQ(gamepad.state.dpad, MAPPING_MASKS[i]);
+            CHECK_EQ(gamepad.state.buttons, 0);
+        } else {
+            CHECK_EQ(gamepad.state.dpad, 0);
+            CHECK_EQ(gamepad.state.buttons, MAPPING_MASKS[i]);
+        }
+    }
+    report = {};
+    report.modifier = KEYBOARD_MODIFIER_RIGHTGUI;
+    pressKeys(listener, report);
+    CHECK_EQ(gamepad.state.buttons, GAMEPAD_MASK_A4);
+}
+
+// Cost of one keyboard report, the listener including its dispatch against the old comparisons alone
+static void benchmarkKeyboard() {
+    DriverManager::getInstance().setup(INPUT_MODE_CONFIG);
+    KeyboardHostListener listener;
+    LegacyKeyboard legacy;
+    setupKeyboard(listener, legacy);
+
+    static const uint32_t REPORTS = 4096;
+    static hid_keyboard_report_t reports[REPORTS];
+    for (hid_keyboard_report_t & report : reports) {
+        report.modifier = randomNext() % 4 == 0 ? randomNext() : 0;
+        for (uint8_t k = 0; k < 6; k++) {
+            report.keycode[k] = randomNext() % 2 == 0 ? randomNext() % (HID_KEY_GUI_RIGHT + 1) : 0;
+        }
+    }
+
+    uint32_t sink = 0;
+    const uint32_t passes = 64;
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t pass = 0; pass < passes; pass++) {
+        for (const hid_keyboard_report_t & report : reports) {
+            listener.report_received(KEYBOARD_DEV_ADDR, 0, (const uint8_t *)&report, sizeof(report));
+            listener.process();
+            sink += gamepad.state.buttons;
+        }
+    }
+    const double tableNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / (passes * REPORTS);
+
+    start = std::chrono::steady_clock::now();
+    for (uint32_t pass = 0; pass < passes; pass++) {
+        for (const hid_keyboard_report_t & report : reports) {
+            uint16_t buttons;
+            uint8_t dpad;
+            legacy.process(&report, buttons, dpad);
+            sink += buttons + dpad;
+        }
+    }
+    const double legacyNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / (passes * REPORTS);
+
+    printf("keyboard report: tables %.1f ns, comparisons %.1f ns (%u)\n", tableNs, legacyNs, sink & 1);
+}
+
+static void setupListener(KeyboardHostListener & listener, uint32_t sensitivity, MouseAcceleration acceleration) {
+    KeyboardHostOptions & options = Storage::getInstance().addonOptions.keyboardHostOptions;
+    options.mouseSensitivity = sensitivity;
+    options.mouseAcceleration = acceleration;
+    options.movementMode = MOUSE_MOVEMENT_LEFT_ANALOG;
+    listener.setup();
+    listener.mount(MOUSE_DEV_ADDR, 0, nullptr, 0);
+}
+
+static void moveMouse(KeyboardHostListener & listener, int8_t x, int8_t y) {
+    hid_mouse_report_t report = {};
+    report.x = x;
+    report.y = y;
+    listener.report_received(MOUSE_DEV_ADDR, 0, (const uint8_t *)&report, sizeof(report));
+    gamepad.state = GamepadState();
+    listener.process();
+}
+
+// The float formula before fixed point, one report with nothing carried over
+static int32_t floatMouseToJoystick(int8_t mouseVal, uint32_t sensitivity, uint16_t joystickMid) {
+    const float mouseSensitivityScale = sensitivity / 10.0f;
+    int32_t result = joystickMid + (int32_t)mouseVal * mouseSensitivityScale * MOUSE_SCALE_FACTOR;
+    return std::clamp(result, (int32_t)GAMEPAD_JOYSTICK_MIN, (int32_t)GAMEPAD_JOYSTICK_MAX);
+}
+
+// Without acceleration a single report lands within one count of the float formula, for every sensitivity the
+// web config allows and every delta
+static void testMatchesFloat(InputMode mode) {
+    DriverManager::getInstance().setup(mode);
+    const uint16_t joystickMid = mode == INPUT_MODE_GENERIC ? 0x8000 : GAMEPAD_JOYSTICK_MID;
+    KeyboardHostListener listener;
+    int32_t maxError = 0;
+    for (uint32_t sensitivity = 1; sensitivity <= 100; sensitivity++) {
+        for (int32_t delta = -128; delta <= 127; delta++) {
+            // A fresh setup per report so no remainder is carried
+            setupListener(listener, sensitivity, MOUSE_ACCELERATION_NONE);
+            moveMouse(listener, (int8_t)delta, (int8_t)-delta);
+            const int32_t expectedX = floatMouseToJoystick((int8_t)delta, sensitivity, joystickMid);
+            const int32_t expectedY = floatMouseToJoystick((int8_t)-delta, sensitivity, joystickMid);
+            maxError = std::max(maxError, std::abs((int32_t)gamepad.state.lx - expectedX));
+            maxError = std::max(maxError, std::abs((int32_t)gamepad.state.ly - expectedY));
+        }
+    }
+    printf("single report, mid 0x%04x: max error against float %d\n", joystickMid, maxError);
+    CHECK(maxError <= 1);
+}
+
+// Slow movement adds up: over many reports of the same small delta the stick moves by the exact scaled total give
+// or take a count, where truncating every report on its own loses the fraction each time
+static void testAccumulation() {
+    DriverManager::getInstance().setup(INPUT_MODE_CONFIG);
+    KeyboardHostListener listener;
+    const int32_t reports = 1000;
+    for (uint32_t sensitivity : { 1u, 3u, 7u, 10u, 25u }) {
+        for (int8_t delta : { 1, -1, 2, -3 }) {
+            setupListener(listener, sensitivity, MOUSE_ACCELERATION_NONE);
+            int64_t total = 0;
+            int64_t truncatedTotal = 0;
+            for (int32_t i = 0; i < reports; i++) {
+                moveMouse(listener, delta, 0);
+                total += (int32_t)gamepad.state.lx - GAMEPAD_JOYSTICK_MID;
+                truncatedTotal += floatMouseToJoystick(delta, sensitivity, GAMEPAD_JOYSTICK_MID) - GAMEPAD_JOYSTICK_MID;
+            }
+            const double exact = (double)reports * delta * (sensitivity / 10.0) * MOUSE_SCALE_FACTOR;
+            CHECK(std::fabs(total - exact) <= 1.0);
+            CHECK(std::fabs(total - exact) <= std::fabs(truncatedTotal - exact));
+        }
+    }
+}
+
+// The carried fraction is dropped with the stick once the mouse stops reporting
+static void testRemainderReset() {
+    DriverManager::getInstance().setup(INPUT_MODE_CONFIG);
+    KeyboardHostListener listener;
+    setupListener(listener, 1, MOUSE_ACCELERATION_NONE);
+    millis = 100;
+    moveMouse(listener, 1, 1);
+    CHECK_EQ(gamepad.state.lx, GAMEPAD_JOYSTICK_MID + 25);
+    millis = 200;
+    listener.process();
+    gamepad.state = GamepadState();
+    listener.process();
+    CHECK_EQ(gamepad.state.lx, GAMEPAD_JOYSTICK_MID);
+    // 0.8 of a count was carried before the reset, a second report starts from zero again
+    moveMouse(listener, 1, 1);
+    CHECK_EQ(gamepad.state.lx, GAMEPAD_JOYSTICK_MID + 25);
+    millis = 0;
+}
+
+// Acceleration leaves the slowest movement alone, grows with speed, and at full speed adds 50%, 100% or 200%
+static void testAcceleration() {
+    DriverManager::getInstance().setup(INPUT_MODE_CONFIG);
+    KeyboardHostListener listener;
+    const uint32_t sensitivity = 2;
+    const double fullSpeedGain[] = { 1.0, 1.5, 2.0, 3.0 };
+    for (int acceleration = MOUSE_ACCELERATION_NONE; acceleration <= MOUSE_ACCELERATION_HIGH; acceleration++) {
+        int32_t previous = 0;
+        for (int32_t delta = 0; delta <= 127; delta++) {
+            setupListener(listener, sensitivity, (MouseAcceleration)acceleration);
+            moveMouse(listener, (int8_t)delta, (int8_t)-delta);
+            const int32_t offset = (int32_t)gamepad.state.lx - GAMEPAD_JOYSTICK_MID;
+            CHECK(offset >= previous);
+            // Symmetric, up to the floor of a negative offset
+            CHECK(std::abs(GAMEPAD_JOYSTICK_MID - (int32_t)gamepad.state.ly - offset) <= 1);
+            previous = offset;
+        }
+        const double linear = 127 * (sensitivity / 10.0) * MOUSE_SCALE_FACTOR;
+        const double expected = linear * (1.0 + (fullSpeedGain[acceleration] - 1.0) * 127 / 128);
+        CHECK(std::fabs(previous - expected) <= 1.0);
+
+        setupListener(listener, sensitivity, (MouseAcceleration)acceleration);
+        moveMouse(listener, 1, 0);
+        const double slowest = (sensitivity / 10.0 * MOUSE_SCALE_FACTOR) * (1.0 + (fullSpeedGain[acceleration] - 1.0) / 128);
+        CHECK_EQ((int32_t)gamepad.state.lx - GAMEPAD_JOYSTICK_MID, (int32_t)slowest);
+    }
+}
+
+// High sensitivity saturates at the ends of the stick range instead of wrapping
+static void testClamp() {
+    DriverManager::getInstance().setup(INPUT_MODE_CONFIG);
+    KeyboardHostListener listener;
+    setupListener(listener, 100, MOUSE_ACCELERATION_HIGH);
+    moveMouse(listener, 127, -128);
+    CHECK_EQ(gamepad.state.lx, GAMEPAD_JOYSTICK_MAX);
+    CHECK_EQ(gamepad.state.ly, GAMEPAD_JOYSTICK_MIN);
+}
+
+int main() {
+    Storage::getInstance().gamepad = &gamepad;
+
+    testKeyboardEquivalence();
+    testKeyboardMappings();
+    benchmarkKeyboard();
+    testMatchesFloat(INPUT_MODE_CONFIG);
+    testMatchesFloat(INPUT_MODE_GENERIC);
+    testAccumulation();
+    testRemainderReset();
+    testAcceleration();
+    testClamp();
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,220 @@
+#include "memorytracker.h"
+#include "bootarena.h"
+
+#include <cstdint>
+#include <new>
+
+#include "test.h"
+
+static MemoryTracker::TagStats stats(MemoryTracker::Tag tag)
+{
+    MemoryTracker::TagStats result = {};
+    CHECK(MemoryTracker::getTagStats(tag, result));
+    return result;
+}
+
+static void testRegisterTag()
+{
+    const MemoryTracker::Tag tag = MemoryTracker::registerTag("Test");
+    CHECK(tag >= MemoryTracker::TAG_BUILTIN_COUNT);
+    CHECK_EQ(MemoryTracker::registerTag("Test"), tag);
+    CHECK(MemoryTracker::registerTag("Other") != tag);
+    CHECK_EQ(MemoryTracker::registerTag("Driver"), MemoryTracker::TAG_DRIVER);
+
+    // The untagged tag is found by name like any other
+    const uint32_t count = MemoryTracker::getTagCount();
+    CHECK_EQ(MemoryTracker::registerTag("System"), MemoryTracker::TAG_UNTAGGED);
+    CHECK_EQ(MemoryTracker::getTagCount(), count);
+
+    MemoryTracker::TagStats unknown;
+    CHECK(!MemoryTracker::getTagStats(MemoryTracker::getTagCount(), unknown));
+}
+
+static void testScopeAccounting()
+{
+    const MemoryTracker::Tag tag = MemoryTracker::registerTag("Scoped");
+    const uint32_t liveBefore = MemoryTracker::getLiveBytes();
+
+    uint8_t* single;
+    uint32_t* array;
+    {
+        MemoryTracker::Scope scope(tag);
+        single = new uint8_t(1);
+        array = new uint32_t[10];
+    }
+    uint8_t* untagged = new uint8_t(2);
+
+    MemoryTracker::TagStats s = stats(tag);
+    CHECK_EQ(s.liveBytes, 1 + 10 * sizeof(uint32_t));
+    CHECK_EQ(s.peakBytes, s.liveBytes);
+    CHECK_EQ(s.liveCount, 2);
+    CHECK_EQ(s.allocCount, 2);
+    CHECK_EQ(MemoryTracker::getLiveBytes() - liveBefore, s.liveBytes + 1);
+    CHECK(MemoryTracker::getPeakBytes() >= MemoryTracker::getLiveBytes());
+
+    delete[] array;
+    s = stats(tag);
+    CHECK_EQ(s.liveBytes, 1);
+    CHECK_EQ(s.peakBytes, 1 + 10 * sizeof(uint32_t));
+    CHECK_EQ(s.liveCount, 1);
+    CHECK_EQ(s.allocCount, 2);
+
+    delete single;
+    delete untagged;
+    s = stats(tag);
+    CHECK_EQ(s.liveBytes, 0);
+    CHECK_EQ(s.liveCount, 0);
+    CHECK_EQ(MemoryTracker::getLiveBytes(), liveBefore);
+}
+
+static void testFreeCreditedToAllocatingTag()
+{
+    const MemoryTracker::Tag producer = MemoryTracker::registerTag("Producer");
+    const MemoryTracker::Tag consumer = MemoryTracker::registerTag("Consumer");
+
+    uint64_t* value;
+    {
+        MemoryTracker::Scope scope(producer);
+        value = new uint64_t(3);
+    }
+    {
+        MemoryTracker::Scope scope(consumer);
+        delete value;
+    }
+
+    CHECK_EQ(stats(producer).liveBytes, 0);
+    CHECK_EQ(stats(producer).liveCount, 0);
+    CHECK_EQ(stats(producer).allocCount, 1);
+    CHECK_EQ(stats(consumer).liveBytes, 0);
+    CHECK_EQ(stats(consumer).allocCount, 0);
+}
+
+static void testNestedScopes()
+{
+    const MemoryTracker::Tag outer = MemoryTracker::registerTag("Outer");
+    const MemoryTracker::Tag inner = MemoryTracker::registerTag("Inner");
+
+    uint16_t* a;
+    uint16_t* b;
+    uint16_t* c;
+    {
+        MemoryTracker::Scope outerScope(outer);
+        a = new uint16_t(0);
+        {
+            MemoryTracker::Scope innerScope(inner);
+            b = new uint16_t(0);
+        }
+        c = new uint16_t(0);
+    }
+
+    CHECK_EQ(stats(outer).liveCount, 2);
+    CHECK_EQ(stats(inner).liveCount, 1);
+
+    delete a;
+    delete b;
+    delete c;
+}
+
+static void testNothrow()
+{
+    const MemoryTracker::Tag tag = MemoryTracker::registerTag("Nothrow");
+    MemoryTracker::Scope scope(tag);
+
+    uint8_t* single = new (std::nothrow) uint8_t(0);
+    uint8_t* array = new (std::nothrow) uint8_t[7];
+    CHECK(single != nullptr);
+    CHECK(array != nullptr);
+    CHECK_EQ(stats(tag).liveBytes, 8);
+
+    delete single;
+    delete[] array;
+    CHECK_EQ(stats(tag).liveBytes, 0);
+}
+
+static void testAllocationAlignment()
+{
+    void* ptr = MemoryTracker::allocate(24);
+    CHECK(ptr != nullptr);
+    CHECK_EQ(reinterpret_cast<uintptr_t>(ptr) % 8, 0);
+    MemoryTracker::release(ptr);
+    MemoryTracker::release(nullptr);
+}
+
+struct ArenaObject
+{
+    uint32_t value[4];
+};
+
+static void testBootArenaNotTracked()
+{
+    const MemoryTracker::Tag tag = MemoryTracker::registerTag("Arena");
+    MemoryTracker::Scope scope(tag);
+
+    const uint32_t arenaBefore = BootArena::getUsed();
+    ArenaObject* object = BootArena::create<ArenaObject>();
+    CHECK(BootArena::contains(object));
+    CHECK_EQ(BootArena::getUsed() - arenaBefore, sizeof(ArenaObject));
+    CHECK_EQ(stats(tag).allocCount, 0);
+
+    // Discarding the most recent arena object gives its memory back
+    delete object;
+    CHECK_EQ(BootArena::getUsed(), arenaBefore);
+    CHECK_EQ(BootArena::getInvalidFrees(), 0);
+    CHECK_EQ(stats(tag).allocCount, 0);
+}
+
+static void testBootArenaNeverFreed()
+{
+    ArenaObject* first = BootArena::create<ArenaObject>();
+    ArenaObject* second = BootArena::create<ArenaObject>();
+    first->value[0] = 1;
+    second->value[0] = 2;
+    const uint32_t usedBefore = BootArena::getUsed();
+    const uint32_t invalidBefore = BootArena::getInvalidFrees();
+
+    // Only the most recent allocation can be given back, any other free is counted and its memory kept
+    delete first;
+    CHECK_EQ(BootArena::getInvalidFrees(), invalidBefore + 1);
+    CHECK_EQ(BootArena::getUsed(), usedBefore);
+    CHECK_EQ(second->value[0], 2);
+
+    ArenaObject* third = BootArena::create<ArenaObject>();
+    CHECK(third != first);
+    CHECK_EQ(BootArena::getUsed(), usedBefore + sizeof(ArenaObject));
+
+    // The object allocated before the newest one can't be rolled back either
+    delete second;
+    CHECK_EQ(BootArena::getInvalidFrees(), invalidBefore + 2);
+    CHECK_EQ(BootArena::getUsed(), usedBefore + sizeof(ArenaObject));
+
+    delete third;
+    CHECK_EQ(BootArena::getUsed(), usedBefore);
+    CHECK_EQ(BootArena::getInvalidFrees(), invalidBefore + 2);
+}
+
+static void testTagsExhausted()
+{
+    char name[] = "Fill00";
+    for (uint32_t i = MemoryTracker::getTagCount(); i < MEMORY_TRACKER_MAX_TAGS; i++) {
+        name[4] = '0' + i / 10;
+        name[5] = '0' + i % 10;
+        CHECK(MemoryTracker::registerTag(name) != MemoryTracker::TAG_UNTAGGED);
+    }
+    CHECK_EQ(MemoryTracker::getTagCount(), MEMORY_TRACKER_MAX_TAGS);
+    CHECK_EQ(MemoryTracker::registerTag("OneTooMany"), MemoryTracker::TAG_UNTAGGED);
+}
+
+int main()
+{
+    testRegisterTag();
+    testScopeAccounting();
+    testFreeCreditedToAllocatingTag();
+    testNestedScopes();
+    testNothrow();
+    testAllocationAlignment();
+    testBootArenaNotTracked();
+    testBootArenaNeverFreed();
+    testTagsExhausted();
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,161 @@
+#include "drivers/shared/driverhelper.h"
+#include "drivermanager.h"
+#include "tusb.h"
+
+#include <cstdio>
+#include <cstring>
+
+#include "drivers/astro/AstroDescriptors.h"
+#include "drivers/composite/CompositeDescriptors.h"
+#include "drivers/egret/EgretDescriptors.h"
+#include "drivers/hid/HIDDescriptors.h"
+#include "drivers/keyboard/KeyboardDescriptors.h"
+#include "drivers/mdmini/MDMiniDescriptors.h"
+#include "drivers/neogeo/NeoGeoDescriptors.h"
+#include "drivers/p5general/P5GeneralDescriptors.h"
+#include "drivers/pcengine/PCEngineDescriptors.h"
+#include "drivers/ps3/PS3Descriptors.h"
+#include "drivers/ps4/PS4Descriptors.h"
+#include "drivers/psclassic/PSClassicDescriptors.h"
+#include "drivers/switch/SwitchDescriptors.h"
+#include "drivers/switchpro/SwitchProDescriptors.h"
+#include "drivers/xbone/XBOneDescriptors.h"
+#include "drivers/xboxog/XboxOriginalDescriptors.h"
+#include "drivers/xinput/XInputDescriptors.h"
+
+#include "test.h"
+
+// The polling interval override DriverManager applies at setup, over the configuration descriptor of every driver.
+// Only bInterval of interrupt endpoints may change, everything else and the bytes past wTotalLength stay as they were.
+
+#define UNTOUCHED 0xA5
+
+static const struct {
+    const char * name;
+    const uint8_t * desc;
+    bool overridable;   // the driver's supports_polling_interval_override()
+} drivers[] = {
+    { "astro", astro_configuration_descriptor, false },
+    { "composite", composite_configuration_descriptor, true },
+    { "egret", egret_configuration_descriptor, false },
+    { "hid", hid_configuration_descriptor, true },
+    { "keyboard", keyboard_configuration_descriptor, false },
+    { "mdmini", mdmini_configuration_descriptor, false },
+    { "neogeo", neogeo_configuration_descriptor, false },
+    { "p5general", p5general_configuration_descriptor, false },
+    { "pcengine", pcengine_configuration_descriptor, false },
+    { "ps3", ps3_configuration_descriptor, false },
+    { "ps3_alt", ps3_alt_configuration_descriptor, false },
+    { "ps4", ps4_configuration_descriptor, true },
+    { "psclassic", psclassic_configuration_descriptor, false },
+    { "switch", switch_configuration_descriptor, true },
+    { "switchpro", switch_pro_configuration_descriptor, false },
+    { "xbone", xbone_configuration_descriptor, false },
+    { "xboxog", xboxoriginal_configuration_descriptor, false },
+    { "xinput", xinput_configuration_descriptor, true },
+};
+
+static uint16_t totalLength(const uint8_t * desc) {
+    return ((const tusb_desc_configuration_t *)desc)->wTotalLength;
+}
+
+// Offsets of the bInterval fields of interrupt endpoints, the descriptors have to add up to wTotalLength exactly
+static int interruptIntervals(const uint8_t * desc, uint16_t * offsets, int maxOffsets) {
+    const uint16_t length = totalLength(desc);
+    int count = 0;
+    uint16_t offset = 0;
+    while (offset < length) {
+        const uint8_t len = desc[offset];
+        CHECK(len >= 2);
+        if (len < 2) {
+            return -1;
+        }
+        if (desc[offset + 1] == TUSB_DESC_ENDPOINT) {
+            const tusb_desc_endpoint_t * endpoint = (const tusb_desc_endpoint_t *)&desc[offset];
+            if (endpoint->bmAttributes.xfer == TUSB_XFER_INTERRUPT && count < maxOffsets) {
+                offsets[count++] = offset + offsetof(tusb_desc_endpoint_t, bInterval);
+            }
+        }
+        offset += len;
+    }
+    CHECK_EQ(offset, length);
+    return count;
+}
+
+static bool isOffset(uint16_t offset, const uint16_t * offsets, int count) {
+    for (int i = 0; i < count; i++) {
+        if (offsets[i] == offset) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void testDriver(const char * name, const uint8_t * desc, bool overridable) {
+    const uint16_t length = totalLength(desc);
+    CHECK(length <= DRIVER_CONFIG_DESCRIPTOR_MAX_SIZE);
+    if (length > DRIVER_CONFIG_DESCRIPTOR_MAX_SIZE) {
+        printf("%s: %u bytes do not fit\n", name, length);
+        return;
+    }
+
+    uint16_t offsets[16];
+    const int count = interruptIntervals(desc, offsets, 16);
+    // The drivers that offer the override report on an interrupt endpoint
+    CHECK(!overridable || count > 0);
+
+    static const uint8_t intervals[] = { 1, 2, 4, 8, 10, 255 };
+    for (uint8_t interval : intervals) {
+        uint8_t patched[DRIVER_CONFIG_DESCRIPTOR_MAX_SIZE];
+        memset(patched, UNTOUCHED, sizeof(patched));
+        memcpy(patched, desc, length);
+        setPollingInterval(patched, interval);
+
+        for (uint16_t offset = 0; offset < sizeof(patched); offset++) {
+            const uint8_t expected = offset >= length ? UNTOUCHED : isOffset(offset, offsets, count) ? interval : desc[offset];
+            if (patched[offset] != expected) {
+                printf("%s, interval %u: byte %u is 0x%02x, expected 0x%02x\n", name, interval, offset, patched[offset], expected);
+                CHECK_EQ(patched[offset], expected);
+                break;
+            }
+        }
+
+        // Patching again changes nothing
+        uint8_t again[DRIVER_CONFIG_DESCRIPTOR_MAX_SIZE];
+        memcpy(again, patched, sizeof(again));
+        setPollingInterval(again, interval);
+        CHECK(memcmp(again, patched, sizeof(again)) == 0);
+    }
+    printf("%-10s %3u bytes, %d interrupt endpoint(s)%s\n", name, length, count, overridable ? ", override" : "");
+}
+
+// A descriptor cut short or with a zero length entry stops the walk instead of running past the buffer
+static void testMalformed() {
+    uint8_t desc[DRIVER_CONFIG_DESCRIPTOR_MAX_SIZE];
+    const uint16_t length = totalLength(hid_configuration_descriptor);
+    memset(desc, UNTOUCHED, sizeof(desc));
+    memcpy(desc, hid_configuration_descriptor, length);
+
+    // wTotalLength ends inside the first endpoint, which is left alone
+    uint16_t offsets[4];
+    const int count = interruptIntervals(hid_configuration_descriptor, offsets, 4);
+    CHECK(count > 0);
+    ((tusb_desc_configuration_t *)desc)->wTotalLength = offsets[0] - 2;
+    setPollingInterval(desc, 1);
+    CHECK_EQ(desc[offsets[0]], hid_configuration_descriptor[offsets[0]]);
+
+    // A zero length entry ends it too
+    memcpy(desc, hid_configuration_descriptor, length);
+    desc[desc[0]] = 0;
+    setPollingInterval(desc, 1);
+    CHECK_EQ(desc[offsets[0]], hid_configuration_descriptor[offsets[0]]);
+}
+
+int main() {
+    for (const auto & driver : drivers) {
+        testDriver(driver.name, driver.desc, driver.overridable);
+    }
+    testMalformed();
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,310 @@
+#include "rapidtrigger.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+
+#include "test.h"
+
+// RapidTrigger against the per-key logic HETriggerAddon::updateTrigger used before, synthetic key strokes over all
+// 32 keys, and the cost of a 32-key update()
+
+#define ADC_MAX 4095
+
+static uint32_t randomState = 0x12345678;
+
+static uint32_t randomNext()
+{
+    randomState ^= randomState << 13;
+    randomState ^= randomState >> 17;
+    randomState ^= randomState << 5;
+    return randomState;
+}
+
+static int32_t randomRange(int32_t low, int32_t high)
+{
+    return low + (int32_t)(randomNext() % (uint32_t)(high - low + 1));
+}
+
+static uint16_t clampTravel(int32_t value)
+{
+    return value < 0 ? 0 : (value > ADC_MAX ? ADC_MAX : value);
+}
+
+struct KeyConfig {
+    uint16_t actuation;
+    uint16_t release;
+    uint16_t resetDistance;
+    bool rapid;
+};
+
+// HETriggerAddon::updateTrigger before the engine, with travel already flipped for polarized sensors
+struct LegacyKey {
+    KeyConfig config;
+    uint16_t lastIncrement;
+    bool triggerActive;
+
+    void reset(uint16_t value) {
+        lastIncrement = value;
+        triggerActive = false;
+    }
+
+    bool update(uint16_t value) {
+        const uint16_t activationThreshold = config.actuation;
+        const uint16_t releaseThreshold = config.rapid ? config.release : config.actuation;
+        if (!config.rapid) {
+            // no rapid trigger
+            triggerActive = value > activationThreshold;
+        } else {
+            // chad rapid trigger
+            bool pressing = (value > lastIncrement) && (value - lastIncrement) > config.resetDistance;
+            bool releasing = (lastIncrement > value) && (lastIncrement - value) > config.resetDistance;
+            if (pressing || releasing) {
+                lastIncrement = value;
+            }
+
+            if ( !triggerActive && pressing && value >= activationThreshold) {
+                triggerActive = true;
+            } else if (triggerActive && releasing && value <= releaseThreshold) {
+                triggerActive = false;
+            }
+        }
+        return triggerActive;
+    }
+};
+
+static KeyConfig randomConfig()
+{
+    KeyConfig config;
+    config.actuation = randomRange(100, ADC_MAX - 100);
+    config.release = randomRange(0, config.actuation);   // the web config keeps release at or above actuation travel
+    config.resetDistance = randomRange(0, 400);
+    config.rapid = randomNext() & 1;
+    return config;
+}
+
+// Random walks with jumps on all 32 keys, every key set up fresh for each run
+static void testLegacyEquivalence()
+{
+    RapidTrigger engine;
+    LegacyKey legacy[RAPID_TRIGGER_KEYS];
+    uint16_t travel[RAPID_TRIGGER_KEYS];
+    uint32_t mismatches = 0;
+
+    for (uint32_t run = 0; run < 2000; run++) {
+        // Some runs leave keys unconfigured, like triggers without an action
+        const uint32_t configured = (run % 4 == 0) ? randomNext() : 0xFFFFFFFF;
+        engine.clear();
+        for (uint8_t key = 0; key < RAPID_TRIGGER_KEYS; key++) {
+            travel[key] = randomRange(0, ADC_MAX);
+            if (configured & (1u << key)) {
+                legacy[key].config = randomConfig();
+                legacy[key].reset(travel[key]);
+                engine.setKey(key, legacy[key].config.actuation, legacy[key].config.release, legacy[key].config.resetDistance, legacy[key].config.rapid);
+                engine.reset(key, travel[key]);
+            }
+        }
+        CHECK_EQ(engine.getKeys(), configured);
+
+        for (uint32_t step = 0; step < 500; step++) {
+            uint32_t expected = 0;
+            for (uint8_t key = 0; key < RAPID_TRIGGER_KEYS; key++) {
+                const int32_t move = (randomNext() % 16 == 0) ? randomRange(-ADC_MAX, ADC_MAX) : randomRange(-150, 150);
+                travel[key] = clampTravel(travel[key] + move);
+                if ((configured & (1u << key)) && legacy[key].update(travel[key])) {
+                    expected |= 1u << key;
+                }
+            }
+            const uint32_t pressed = engine.update(travel);
+            if (pressed != expected) {
+                mismatches++;
+            }
+            CHECK_EQ(engine.getPressed(), pressed);
+        }
+    }
+    CHECK_EQ(mismatches, 0);
+}
+
+// Full strokes of rapid trigger keys: smooth travel curves sampled 2 to 60 times per stroke, with noise peak to peak
+// below the reset distance. The strokes reach past the release and actuation points by the reset distance plus twice
+// the noise, so every stroke down has to press exactly once and every stroke up has to release exactly once.
+static void testStrokes()
+{
+    RapidTrigger engine;
+    KeyConfig config[RAPID_TRIGGER_KEYS];
+    uint16_t low[RAPID_TRIGGER_KEYS];
+    uint16_t high[RAPID_TRIGGER_KEYS];
+    uint16_t noise[RAPID_TRIGGER_KEYS];
+    uint16_t travel[RAPID_TRIGGER_KEYS];
+    uint32_t strokes = 0;
+    uint32_t missed = 0;
+    uint32_t extra = 0;
+
+    for (uint32_t run = 0; run < 200; run++) {
+        engine.clear();
+        for (uint8_t key = 0; key < RAPID_TRIGGER_KEYS; key++) {
+            config[key].resetDistance = randomRange(10, 300);
+            noise[key] = randomRange(0, config[key].resetDistance / 2 - 1);
+            const uint16_t margin = config[key].resetDistance + 2 * noise[key];
+            config[key].release = randomRange(margin, ADC_MAX - margin);
+            config[key].actuation = randomRange(config[key].release, ADC_MAX - margin);
+            config[key].rapid = true;
+            low[key] = config[key].release - margin;
+            high[key] = config[key].actuation + margin;
+            engine.setKey(key, config[key].actuation, config[key].release, config[key].resetDistance, true);
+            travel[key] = low[key];
+            engine.reset(key, travel[key]);
+        }
+
+        // Every key runs its own strokes, one sample of every key per update() like a scan
+        uint8_t samples[RAPID_TRIGGER_KEYS];
+        uint8_t sample[RAPID_TRIGGER_KEYS] = {};
+        bool down[RAPID_TRIGGER_KEYS];
+        uint8_t changes[RAPID_TRIGGER_KEYS] = {};
+        for (uint8_t key = 0; key < RAPID_TRIGGER_KEYS; key++) {
+            samples[key] = randomRange(2, 60);
+            down[key] = true;
+        }
+
+        uint32_t lastPressed = 0;
+        for (uint32_t step = 0; step < 2000; step++) {
+            for (uint8_t key = 0; key < RAPID_TRIGGER_KEYS; key++) {
+                sample[key]++;
+                const float t = (float)sample[key] / samples[key];
+                const float curve = t * t * (3.0f - 2.0f * t);
+                const float position = down[key] ? curve : 1.0f - curve;
+                int32_t value = low[key] + (int32_t)lroundf(position * (high[key] - low[key]));
+                // Both ends of the stroke are sampled clean so a stroke always reaches them
+                if (sample[key] < samples[key]) {
+                    value += randomRange(-noise[key], noise[key]);
+                }
+                travel[key] = clampTravel(value);
+            }
+
+            const uint32_t pressed = engine.update(travel);
+            const uint32_t changed = pressed ^ lastPressed;
+            lastPressed = pressed;
+            for (uint8_t key = 0; key < RAPID_TRIGGER_KEYS; key++) {
+                if (changed & (1u << key)) {
+                    changes[key]++;
+                }
+                if (sample[key] == samples[key]) {
+                    // End of a stroke: exactly one change in the direction of the stroke
+                    const bool held = pressed & (1u << key);
+                    strokes++;
+                    if (changes[key] == 0 || held != down[key]) {
+                        missed++;
+                    } else if (changes[key] > 1) {
+                        extra++;
+                    }
+                    changes[key] = 0;
+                    sample[key] = 0;
+                    samples[key] = randomRange(2, 60);
+                    down[key] = !down[key];
+                }
+            }
+        }
+    }
+    CHECK(strokes > 30000);
+    CHECK_EQ(missed, 0);
+    CHECK_EQ(extra, 0);
+}
+
+// A press needs the key at or past actuation and a release at or above the release point, however the key moves
+static void testThresholds()
+{
+    RapidTrigger engine;
+    uint16_t travel[RAPID_TRIGGER_KEYS] = {};
+    for (uint8_t key = 0; key < RAPID_TRIGGER_KEYS; key++) {
+        engine.setKey(key, 2000, 1500, 50, true);
+        engine.reset(key, 0);
+    }
+    uint32_t lastPressed = 0;
+    for (uint32_t step = 0; step < 200000; step++) {
+        for (uint8_t key = 0; key < RAPID_TRIGGER_KEYS; key++) {
+            travel[key] = clampTravel(travel[key] + randomRange(-300, 300));
+        }
+        const uint32_t pressed = engine.update(travel);
+        for (uint8_t key = 0; key < RAPID_TRIGGER_KEYS; key++) {
+            const uint32_t bit = 1u << key;
+            if ((pressed & bit) && !(lastPressed & bit) && travel[key] < 2000) {
+                CHECK(travel[key] >= 2000);
+            }
+            if (!(pressed & bit) && (lastPressed & bit) && travel[key] > 1500) {
+                CHECK(travel[key] <= 1500);
+            }
+        }
+        lastPressed = pressed;
+    }
+
+    // A release point set deeper than actuation is clamped to it
+    engine.clear();
+    engine.setKey(0, 1000, 3000, 50, true);
+    engine.reset(0, 0);
+    travel[0] = 2000;
+    CHECK_EQ(engine.update(travel), 1);
+    travel[0] = 1100;
+    CHECK_EQ(engine.update(travel), 1);
+    travel[0] = 1000;
+    CHECK_EQ(engine.update(travel), 0);
+
+    // Keys past the last one are ignored
+    engine.setKey(RAPID_TRIGGER_KEYS, 0, 0, 0, false);
+    CHECK_EQ(engine.getKeys(), 1);
+}
+
+// Cost of one scan's update() with all 32 keys configured, half of them rapid trigger
+static void benchmarkUpdate()
+{
+    static const uint32_t SCANS = 4096;
+    static uint16_t travel[SCANS][RAPID_TRIGGER_KEYS];
+    RapidTrigger engine;
+    LegacyKey legacy[RAPID_TRIGGER_KEYS];
+    for (uint8_t key = 0; key < RAPID_TRIGGER_KEYS; key++) {
+        legacy[key].config = { 2000, 1500, 50, (key & 1) != 0 };
+        legacy[key].reset(0);
+        engine.setKey(key, 2000, 1500, 50, (key & 1) != 0);
+        engine.reset(key, 0);
+        uint16_t value = 0;
+        for (uint32_t scan = 0; scan < SCANS; scan++) {
+            value = clampTravel(value + randomRange(-200, 200));
+            travel[scan][key] = value;
+        }
+    }
+
+    uint32_t sink = 0;
+    const uint32_t passes = 64;
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t pass = 0; pass < passes; pass++) {
+        for (uint32_t scan = 0; scan < SCANS; scan++) {
+            sink += engine.update(travel[scan]);
+        }
+    }
+    const double engineNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / (passes * SCANS);
+
+    start = std::chrono::steady_clock::now();
+    for (uint32_t pass = 0; pass < passes; pass++) {
+        for (uint32_t scan = 0; scan < SCANS; scan++) {
+            uint32_t pressed = 0;
+            for (uint8_t key = 0; key < RAPID_TRIGGER_KEYS; key++) {
+                if (legacy[key].update(travel[scan][key])) {
+                    pressed |= 1u << key;
+                }
+            }
+            sink += pressed;
+        }
+    }
+    const double legacyNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / (passes * SCANS);
+
+    printf("32-key update: %.1f ns, per-key loop: %.1f ns (%u)\n", engineNs, legacyNs, sink & 1);
+}
+
+int main()
+{
+    testLegacyEquivalence();
+    testStrokes();
+    testThresholds();
+    benchmarkUpdate();
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,456 @@
+#include "storagemanager.h"
+#include "eventmanager.h"
+#include "drivers/astro/AstroDriver.h"
+#include "drivers/egret/EgretDriver.h"
+#include "drivers/hid/HIDDriver.h"
+#include "drivers/keyboard/KeyboardDriver.h"
+#include "drivers/mdmini/MDMiniDriver.h"
+#include "drivers/neogeo/NeoGeoDriver.h"
+#include "drivers/p5general/P5GeneralDriver.h"
+#include "drivers/pcengine/PCEngineDriver.h"
+#include "drivers/ps3/PS3Driver.h"
+#include "drivers/ps4/PS4Driver.h"
+#include "drivers/psclassic/PSClassicDriver.h"
+#include "drivers/switch/SwitchDriver.h"
+#include "drivers/switchpro/SwitchProDriver.h"
+#include "drivers/xbone/XBOneDriver.h"
+#include "drivers/xbone/XBOneAuth.h"
+#include "drivers/xboxog/XboxOriginalDriver.h"
+#include "drivers/xinput/XInputDriver.h"
+
+#include <chrono>
+#include <cstring>
+#include <vector>
+
+#include "test.h"
+
+// Report builder benchmark: every GPDriver::process() in the tree replays the same input sequences, one process()
+// call per 1 ms frame, against an emulated host that picks up every IN transfer at the next frame.
+//
+// For each driver and sequence it prints the reports sent in one pass, the time of the calls that sent one (ns/report)
+// and of the ones that did not (ns/skip), and the bytes the driver compared with memcmp per call. The drivers are built
+// without the memcmp builtin and linked with --wrap=memcmp so every comparison they make is counted.
+//
+// The reports of the first pass are hashed per driver and checked against the values below, so a change to any
+// driver's report construction that alters a single byte fails the test. When a change to a report is intended,
+// update the value from the output. Timing never fails the test, it is there to compare builds.
+
+#define FRAME_US 1000
+#define TIMING_PASSES 20
+
+// Reports sent during the first pass and their FNV-1a hash, the endpoint and report ID are part of it
+static const struct {
+    const char * name;
+    uint32_t reports;
+    uint32_t hash;
+} conformance[] = {
+    { "astro",      763, 0x7bfb52b3 },
+    { "egret",      797, 0xbb3d12c5 },
+    { "hid",       5876, 0x30ec4939 },
+    { "keyboard",   692, 0x2052c5be },
+    { "mdmini",     763, 0x7bfb52b3 },
+    { "neogeo",     877, 0xe4da9499 },
+    { "p5general", 7961, 0x014e77b5 },
+    { "pcengine",   633, 0x82e24679 },
+    { "ps3",       5876, 0xd0b218e8 },
+    { "ps4",       6508, 0x51d5a75d },
+    { "psclassic",  843, 0xbb9cbc03 },
+    { "switch",    5876, 0x09a560a3 },
+    { "switchpro", 2001, 0xbcebed11 },
+    { "xbone",     5893, 0x27ad2486 },
+    { "xboxog",    5842, 0x6fffa857 },
+    { "xinput",    5876, 0xb25334bf },
+};
+
+// Emulated USB device side
+static uint32_t nowUs = 0;
+static GPDriver * activeDriver = nullptr;
+static bool hidBusy[CFG_TUD_HID] = {};
+static bool endpointBusy[2][16] = {};    // [direction][number], OUT endpoints stay armed until the host writes
+static uint16_t endpointLength[16] = {};
+static uint32_t reportsSent = 0;
+static uint32_t reportHash = 2166136261u;
+static bool inProcess = false;
+static uint64_t bytesCompared = 0;
+
+static void hashBytes(const void * data, uint16_t len) {
+    const uint8_t * bytes = (const uint8_t *)data;
+    for (uint16_t i = 0; i < len; i++) {
+        reportHash = (reportHash ^ bytes[i]) * 16777619u;
+    }
+}
+
+static void captureReport(uint8_t endpoint, uint8_t reportId, const void * report, uint16_t len) {
+    const uint8_t header[2] = { endpoint, reportId };
+    hashBytes(header, sizeof(header));
+    hashBytes(report, len);
+    reportsSent++;
+}
+
+extern "C" {
+int __real_memcmp(const void * a, const void * b, size_t len);
+int __wrap_memcmp(const void * a, const void * b, size_t len) {
+    if (inProcess) {
+        bytesCompared += len;
+    }
+    return __real_memcmp(a, b, len);
+}
+
+uint32_t time_us_32(void) { return nowUs; }
+absolute_time_t get_absolute_time(void) { return nowUs; }
+uint32_t to_ms_since_boot(absolute_time_t t) { return (uint32_t)(t / 1000); }
+uint64_t to_us_since_boot(absolute_time_t t) { return t; }
+
+bool tud_ready(void) { return true; }
+bool tud_suspended(void) { return false; }
+bool tud_remote_wakeup(void) { return true; }
+bool tud_control_xfer(uint8_t rhport, tusb_control_request_t const * request, void * buffer, uint16_t len) { return true; }
+bool tud_hid_n_ready(uint8_t instance) { return instance < CFG_TUD_HID && !hidBusy[instance]; }
+bool tud_hid_n_report(uint8_t instance, uint8_t report_id, void const * report, uint16_t len) {
+    if (!tud_hid_n_ready(instance)) {
+        return false;
+    }
+    hidBusy[instance] = true;
+    captureReport(0x81 + instance, report_id, report, len);
+    return true;
+}
+bool tud_hid_ready(void) { return tud_hid_n_ready(0); }
+bool tud_hid_report(uint8_t report_id, void const * report, uint16_t len) { return tud_hid_n_report(0, report_id, report, len); }
+void hidd_init(void) {}
+void hidd_reset(uint8_t rhport) {}
+uint16_t hidd_open(uint8_t rhport, tusb_desc_interface_t const * desc_itf, uint16_t max_len) { return 0; }
+bool hidd_control_xfer_cb(uint8_t rhport, uint8_t stage, tusb_control_request_t const * request) { return false; }
+bool hidd_xfer_cb(uint8_t rhport, uint8_t ep_addr, xfer_result_t result, uint32_t xferred_bytes) { return false; }
+
+bool usbd_edpt_claim(uint8_t rhport, uint8_t ep_addr) { return true; }
+bool usbd_edpt_release(uint8_t rhport, uint8_t ep_addr) { return true; }
+bool usbd_edpt_busy(uint8_t rhport, uint8_t ep_addr) { return endpointBusy[tu_edpt_dir(ep_addr)][tu_edpt_number(ep_addr)]; }
+bool usbd_edpt_xfer(uint8_t rhport, uint8_t ep_addr, uint8_t * buffer, uint16_t total_bytes) {
+    if (usbd_edpt_busy(rhport, ep_addr)) {
+        return false;
+    }
+    endpointBusy[tu_edpt_dir(ep_addr)][tu_edpt_number(ep_addr)] = true;
+    if (tu_edpt_dir(ep_addr) == TUSB_DIR_IN) {
+        endpointLength[tu_edpt_number(ep_addr)] = total_bytes;
+        captureReport(ep_addr, 0, buffer, total_bytes);
+    }
+    return true;
+}
+bool usbd_open_edpt_pair(uint8_t rhport, uint8_t const * p_desc, uint8_t ep_count, uint8_t xfer_type, uint8_t * ep_out, uint8_t * ep_in) {
+    for (uint8_t i = 0; i < ep_count; i++, p_desc = tu_desc_next(p_desc)) {
+        const tusb_desc_endpoint_t * endpoint = (const tusb_desc_endpoint_t *)p_desc;
+        if (tu_edpt_dir(endpoint->bEndpointAddress) == TUSB_DIR_IN) {
+            *ep_in = endpoint->bEndpointAddress;
+        } else {
+            *ep_out = endpoint->bEndpointAddress;
+        }
+    }
+    return true;
+}
+
+static usbd_class_driver_t xidDriver = {};
+const usbd_class_driver_t * xid_get_driver(void) { return &xidDriver; }
+int8_t xid_get_index_by_type(uint8_t type_index, xid_type_t type) { return 0; }
+bool xid_send_report(uint8_t index, void * report, uint16_t len) { return tud_hid_report(0, report, len); }
+bool xid_get_report(uint8_t index, void * report, uint16_t len) { return false; }
+}
+
+uint32_t get_rand_32(void) { return 0x5EED5EED; }
+
+void EventManager::registerEventHandler(GPEventType eventType, EventFunction handler) {}
+
+// No dongles: the console side of authentication completes at once, the P5General dongle signs by echoing the report
+void PS4Auth::initialize() {}
+bool PS4Auth::available() { return false; }
+void PS4Auth::process() {}
+void PS4Auth::resetAuth() {}
+void XInputAuth::initialize() {}
+bool XInputAuth::available() { return false; }
+void XInputAuth::process() {}
+void XBOneAuth::initialize() { xboxOneAuthData.authCompleted = true; }
+bool XBOneAuth::available() { return true; }
+void XBOneAuth::process() {}
+void P5GeneralAuth::initialize() { p5GeneralAuthData.dongle_ready = true; }
+bool P5GeneralAuth::available() { return true; }
+void P5GeneralAuth::process() {
+    if (p5GeneralAuthData.hash_pending) {
+        memcpy(p5GeneralAuthData.hash_finish_buffer, p5GeneralAuthData.hash_pending_buffer, sizeof(p5GeneralAuthData.hash_finish_buffer));
+        p5GeneralAuthData.hash_pending = false;
+        p5GeneralAuthData.hash_ready = true;
+    }
+}
+
+Gamepad::Gamepad() :
+    options(Storage::getInstance().gamepadOptions)
+    , hotkeyOptions(Storage::getInstance().hotkeyOptions)
+{
+}
+
+// Same as the firmware, so the drivers that skip unchanged states see the same generations
+void Gamepad::updateStateGeneration()
+{
+    if (state.dpad != generationState.dpad ||
+        state.buttons != generationState.buttons ||
+        state.aux != generationState.aux ||
+        state.lx != generationState.lx ||
+        state.ly != generationState.ly ||
+        state.rx != generationState.rx ||
+        state.ry != generationState.ry ||
+        state.lt != generationState.lt ||
+        state.rt != generationState.rt)
+    {
+        generationState = state;
+        stateGeneration++;
+        stateGenerationTime = readTime;
+    }
+}
+
+static uint32_t randomState = 0x12345678;
+
+static uint32_t randomNext() {
+    randomState ^= randomState << 13;
+    randomState ^= randomState >> 17;
+    randomState ^= randomState << 5;
+    return randomState;
+}
+
+typedef struct {
+    const char * name;
+    std::vector<GamepadState> frames;
+} Sequence;
+
+// Nothing pressed, the loop runs with an unchanged state
+static Sequence idleSequence() {
+    Sequence sequence = { "idle", {} };
+    sequence.frames.assign(2000, GamepadState());
+    return sequence;
+}
+
+// Fightstick play: motion inputs on the dpad and button presses held for 1..16 frames
+static Sequence buttonSequence() {
+    static const uint8_t motions[][3] = {
+        { GAMEPAD_MASK_DOWN, GAMEPAD_MASK_DOWN | GAMEPAD_MASK_RIGHT, GAMEPAD_MASK_RIGHT },
+        { GAMEPAD_MASK_DOWN, GAMEPAD_MASK_DOWN | GAMEPAD_MASK_LEFT, GAMEPAD_MASK_LEFT },
+        { GAMEPAD_MASK_RIGHT, GAMEPAD_MASK_DOWN, GAMEPAD_MASK_DOWN | GAMEPAD_MASK_RIGHT },
+    };
+    static const uint32_t buttons[] = {
+        GAMEPAD_MASK_B1, GAMEPAD_MASK_B2, GAMEPAD_MASK_B3, GAMEPAD_MASK_B4,
+        GAMEPAD_MASK_L1, GAMEPAD_MASK_R1, GAMEPAD_MASK_L2, GAMEPAD_MASK_R2,
+        GAMEPAD_MASK_S2, GAMEPAD_MASK_A1,
+    };
+    Sequence sequence = { "buttons", {} };
+    randomState = 0x12345678;
+    GamepadState state;
+    while (sequence.frames.size() < 5000) {
+        const uint32_t action = randomNext();
+        if (action % 4 == 0) {
+            for (uint8_t dpad : motions[(action >> 8) % 3]) {
+                state.dpad = dpad;
+                for (uint32_t hold = 1 + (randomNext() % 3); hold > 0; hold--) {
+                    sequence.frames.push_back(state);
+                }
+            }
+            state.dpad = 0;
+        }
+        state.buttons ^= buttons[(action >> 16) % (sizeof(buttons) / sizeof(buttons[0]))];
+        for (uint32_t hold = 1 + (randomNext() % 16); hold > 0; hold--) {
+            sequence.frames.push_back(state);
+        }
+    }
+    return sequence;
+}
+
+// Analog play: both sticks turning and the triggers ramping, a new state every frame
+static Sequence analogSequence() {
+    Sequence sequence = { "analog", {} };
+    GamepadState state;
+    for (uint32_t frame = 0; frame < 5000; frame++) {
+        const uint32_t phase = (frame * 97) & 0xFFFF;
+        state.lx = (uint16_t)phase;
+        state.ly = (uint16_t)(GAMEPAD_JOYSTICK_MAX - phase);
+        state.rx = (uint16_t)((phase * 3) & 0xFFFF);
+        state.ry = (uint16_t)((phase * 5) & 0xFFFF);
+        state.lt = (uint8_t)(frame & 0xFF);
+        state.rt = (uint8_t)(0xFF - (frame & 0xFF));
+        state.buttons = (frame / 250) & 1 ? GAMEPAD_MASK_L3 : 0;
+        sequence.frames.push_back(state);
+    }
+    return sequence;
+}
+
+typedef struct {
+    uint32_t calls;
+    uint32_t firstPassReports;
+    uint32_t reports;
+    uint32_t reportCalls;   // process() calls that sent a report
+    uint64_t reportNs;
+    uint64_t skipNs;        // the others
+    uint64_t bytesCompared;
+} SequenceStats;
+
+// The host picks up whatever was sent during the previous frame
+static void completeTransfers() {
+    memset(hidBusy, 0, sizeof(hidBusy));
+    for (uint8_t number = 1; number < 16; number++) {
+        if (endpointBusy[TUSB_DIR_IN][number]) {
+            endpointBusy[TUSB_DIR_IN][number] = false;
+            const usbd_class_driver_t * classDriver = activeDriver->get_class_driver();
+            if (classDriver->xfer_cb != nullptr) {
+                classDriver->xfer_cb(0, TUSB_DIR_IN_MASK | number, XFER_RESULT_SUCCESS, endpointLength[number]);
+            }
+        }
+    }
+}
+
+static void runSequence(GPDriver * driver, Gamepad & gamepad, const Sequence & sequence, SequenceStats & stats) {
+    for (const GamepadState & state : sequence.frames) {
+        nowUs += FRAME_US;
+        completeTransfers();
+        gamepad.state = state;
+        gamepad.updateStateGeneration();
+        driver->setProcessTime(nowUs / 1000);
+
+        const uint32_t before = reportsSent;
+        bytesCompared = 0;
+        inProcess = true;
+        const auto start = std::chrono::steady_clock::now();
+        driver->process(&gamepad);
+        const auto end = std::chrono::steady_clock::now();
+        inProcess = false;
+        const uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+
+        stats.calls++;
+        stats.bytesCompared += bytesCompared;
+        if (reportsSent != before) {
+            stats.reports += reportsSent - before;
+            stats.reportCalls++;
+            stats.reportNs += ns;
+        } else {
+            stats.skipNs += ns;
+        }
+
+        // The auth side runs on the other core in the firmware, it is not part of the report cost
+        driver->processAux();
+    }
+}
+
+// What the device stack does at enumeration: open every interface of the configuration with the driver
+static void enumerate(GPDriver * driver) {
+    const uint8_t * desc = driver->get_descriptor_configuration_cb(0);
+    const uint16_t length = ((const tusb_desc_configuration_t *)desc)->wTotalLength;
+    const usbd_class_driver_t * classDriver = driver->get_class_driver();
+    if (classDriver->init != nullptr) {
+        classDriver->init();
+    }
+    for (uint16_t offset = desc[0]; offset < length && desc[offset] != 0; offset += desc[offset]) {
+        const tusb_desc_interface_t * itf = (const tusb_desc_interface_t *)&desc[offset];
+        if (itf->bDescriptorType == TUSB_DESC_INTERFACE && itf->bAlternateSetting == 0 && classDriver->open != nullptr) {
+            classDriver->open(0, itf, length - offset);
+        }
+    }
+}
+
+// The Switch Pro driver only sends input reports after the console's configuration requests
+static void switchProHandshake(GPDriver * driver) {
+    const uint8_t disableTimeout[] = { SwitchReportID::REPORT_CONFIGURATION, SwitchOutputSubtypes::DISABLE_USB_TIMEOUT };
+    driver->set_report(0, HID_REPORT_TYPE_OUTPUT, disableTimeout, sizeof(disableTimeout));
+}
+
+static const struct {
+    const char * name;
+    GPDriver * (*create)();
+    void (*handshake)(GPDriver * driver);
+} drivers[] = {
+    { "astro",     []() -> GPDriver * { return new AstroDriver(); }, nullptr },
+    { "egret",     []() -> GPDriver * { return new EgretDriver(); }, nullptr },
+    { "hid",       []() -> GPDriver * { return new HIDDriver(); }, nullptr },
+    { "keyboard",  []() -> GPDriver * { return new KeyboardDriver(); }, nullptr },
+    { "mdmini",    []() -> GPDriver * { return new MDMiniDriver(); }, nullptr },
+    { "neogeo",    []() -> GPDriver * { return new NeoGeoDriver(); }, nullptr },
+    { "p5general", []() -> GPDriver * { return new P5GeneralDriver(); }, nullptr },
+    { "pcengine",  []() -> GPDriver * { return new PCEngineDriver(); }, nullptr },
+    { "ps3",       []() -> GPDriver * { return new PS3Driver(); }, nullptr },
+    { "ps4",       []() -> GPDriver * { return new PS4Driver(PS4_CONTROLLER); }, nullptr },
+    { "psclassic", []() -> GPDriver * { return new PSClassicDriver(); }, nullptr },
+    { "switch",    []() -> GPDriver * { return new SwitchDriver(); }, nullptr },
+    { "switchpro", []() -> GPDriver * { return new SwitchProDriver(); }, switchProHandshake },
+    { "xbone",     []() -> GPDriver * { return new XBOneDriver(); }, nullptr },
+    { "xboxog",    []() -> GPDriver * { return new XboxOriginalDriver(); }, nullptr },
+    { "xinput",    []() -> GPDriver * { return new XInputDriver(); }, nullptr },
+};
+
+static_assert(sizeof(drivers) / sizeof(drivers[0]) == sizeof(conformance) / sizeof(conformance[0]), "One conformance entry per driver");
+
+int main() {
+    Gamepad gamepad;
+    Storage::getInstance().gamepad = &gamepad;
+    KeyboardMapping & keyboardMapping = Storage::getInstance().keyboardMapping;
+    keyboardMapping.keyDpadUp = HID_KEY_A + 0;
+    keyboardMapping.keyDpadDown = HID_KEY_A + 1;
+    keyboardMapping.keyDpadLeft = HID_KEY_A + 2;
+    keyboardMapping.keyDpadRight = HID_KEY_A + 3;
+    keyboardMapping.keyButtonB1 = HID_KEY_A + 4;
+    keyboardMapping.keyButtonB2 = HID_KEY_A + 5;
+    keyboardMapping.keyButtonB3 = HID_KEY_A + 6;
+    keyboardMapping.keyButtonB4 = HID_KEY_A + 7;
+
+    const Sequence sequences[] = { idleSequence(), buttonSequence(), analogSequence() };
+    const size_t sequenceCount = sizeof(sequences) / sizeof(sequences[0]);
+
+    printf("%-10s %-8s %8s %10s %8s %10s\n", "driver", "sequence", "reports", "ns/report", "ns/skip", "cmp B/call");
+    for (size_t index = 0; index < sizeof(drivers) / sizeof(drivers[0]); index++) {
+        memset(hidBusy, 0, sizeof(hidBusy));
+        memset(endpointBusy, 0, sizeof(endpointBusy));
+        nowUs = 0;
+        gamepad.state = GamepadState();
+        gamepad.updateStateGeneration();
+
+        GPDriver * driver = drivers[index].create();
+        activeDriver = driver;
+        driver->initialize();
+        driver->initializeAux();
+        enumerate(driver);
+        if (drivers[index].handshake != nullptr) {
+            drivers[index].handshake(driver);
+        }
+
+        // First pass: the reports, byte for byte
+        SequenceStats stats[sequenceCount] = {};
+        reportsSent = 0;
+        reportHash = 2166136261u;
+        for (size_t s = 0; s < sequenceCount; s++) {
+            runSequence(driver, gamepad, sequences[s], stats[s]);
+        }
+        const uint32_t firstPassReports = reportsSent;
+        const uint32_t firstPassHash = reportHash;
+        for (size_t s = 0; s < sequenceCount; s++) {
+            stats[s].firstPassReports = stats[s].reports;
+        }
+
+        // More passes for the timing
+        for (uint32_t pass = 0; pass < TIMING_PASSES; pass++) {
+            for (size_t s = 0; s < sequenceCount; s++) {
+                runSequence(driver, gamepad, sequences[s], stats[s]);
+            }
+        }
+
+        for (size_t s = 0; s < sequenceCount; s++) {
+            const SequenceStats & stat = stats[s];
+            const uint32_t skipCalls = stat.calls - stat.reportCalls;
+            printf("%-10s %-8s %8u %10llu %8llu %10.1f\n", drivers[index].name, sequences[s].name,
+                stat.firstPassReports,
+                (unsigned long long)(stat.reportCalls ? stat.reportNs / stat.reportCalls : 0),
+                (unsigned long long)(skipCalls ? stat.skipNs / skipCalls : 0),
+                (double)stat.bytesCompared / stat.calls);
+        }
+
+        CHECK(strcmp(conformance[index].name, drivers[index].name) == 0);
+        if (firstPassReports != conformance[index].reports || firstPassHash != conformance[index].hash) {
+            printf("%s: %u reports, hash 0x%08x, expected %u reports, hash 0x%08x\n", drivers[index].name,
+                firstPassReports, firstPassHash, conformance[index].reports, conformance[index].hash);
+            testFailures++;
+        }
+    }
+
+    return TEST_RESULT();
+}
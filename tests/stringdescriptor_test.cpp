@@ -0,0 +1,153 @@
+#include "drivers/shared/driverhelper.h"
+
+#include <cstdio>
+#include <cstring>
+
+#include "drivers/astro/AstroDescriptors.h"
+#include "drivers/composite/CompositeDescriptors.h"
+#include "drivers/egret/EgretDescriptors.h"
+#include "drivers/hid/HIDDescriptors.h"
+#include "drivers/keyboard/KeyboardDescriptors.h"
+#include "drivers/mdmini/MDMiniDescriptors.h"
+#include "drivers/neogeo/NeoGeoDescriptors.h"
+#include "drivers/p5general/P5GeneralDescriptors.h"
+#include "drivers/pcengine/PCEngineDescriptors.h"
+#include "drivers/ps3/PS3Descriptors.h"
+#include "drivers/ps4/PS4Descriptors.h"
+#include "drivers/psclassic/PSClassicDescriptors.h"
+#include "drivers/switch/SwitchDescriptors.h"
+#include "drivers/switchpro/SwitchProDescriptors.h"
+#include "drivers/xbone/XBOneDescriptors.h"
+#include "drivers/xboxog/XboxOriginalDescriptors.h"
+#include "drivers/xinput/XInputDescriptors.h"
+
+#include "test.h"
+
+// The pooled string descriptors against the conversion the drivers did on every request before. The pool is only
+// filled once per boot, so every string table runs in its own process: stringdescriptor_test <table>
+
+// driverhelper.h before the pool, char is unsigned on the RP2040 so the characters are read as unsigned char
+static uint16_t * legacyStringDescriptor(const char * value, uint8_t index)
+{
+	static uint16_t descriptorStringBuffer[128]; // Max 256 bytes, 127 unicode characters
+	size_t charCount;
+	if ( index == 0 ) // language always has a character count of 1
+		charCount = 1;
+	else {
+		charCount = strlen(value);
+		if (charCount > 127)
+			charCount = 127;
+	}
+	// Fill descriptionStringBuffer[1] .. [32]
+	for (uint8_t i = 0; i < charCount; i++)
+		descriptorStringBuffer[i + 1] = (unsigned char)value[i];
+
+	// first byte (descriptionStringBuffer[0]) is length (including header), second byte is string type
+	descriptorStringBuffer[0] = (0x03 << 8) | (2 * (uint8_t)charCount + 2);
+
+	// Cast temp buffer to final result
+	return descriptorStringBuffer;
+}
+
+static const uint8_t * xinputStrings[] = {
+	xinput_get_string_descriptor(0),
+	xinput_get_string_descriptor(1),
+	xinput_get_string_descriptor(2),
+	xinput_get_string_descriptor(3),
+	xinput_get_string_descriptor(4),
+};
+
+// Driver settings with the longest strings the web config accepts, and one past the 127 character limit
+static char overrideLong[200];
+static const uint8_t * overrideStrings[] = {
+	hid_string_language,
+	(const uint8_t *)"GP2040-CE Manufacturer Override",
+	(const uint8_t *)"",
+	(const uint8_t *)overrideLong,
+};
+
+#define STRING_TABLE(name, strings) { name, strings, sizeof(strings) / sizeof(strings[0]) }
+
+static const struct {
+	const char * name;
+	const uint8_t * const * strings;
+	uint8_t count;
+} stringTables[] = {
+	STRING_TABLE("astro", astro_string_descriptors),
+	STRING_TABLE("composite", composite_string_descriptors),
+	STRING_TABLE("egret", egret_string_descriptors),
+	STRING_TABLE("hid", hid_string_descriptors),
+	STRING_TABLE("keyboard", keyboard_string_descriptors),
+	STRING_TABLE("mdmini", mdmini_string_descriptors),
+	STRING_TABLE("neogeo", neogeo_string_descriptors),
+	STRING_TABLE("p5general", p5general_string_descriptors),
+	STRING_TABLE("pcengine", pcengine_string_descriptors),
+	STRING_TABLE("ps3", ps3_string_descriptors),
+	STRING_TABLE("ps4", ps4_string_descriptors),
+	STRING_TABLE("psclassic", psclassic_string_descriptors),
+	STRING_TABLE("switch", switch_string_descriptors),
+	STRING_TABLE("switchpro", switch_pro_string_descriptors),
+	STRING_TABLE("xbone", xbone_string_descriptors),
+	STRING_TABLE("xboxog", xboxoriginal_string_descriptors),
+	STRING_TABLE("xinput", xinputStrings),
+	STRING_TABLE("override", overrideStrings),
+};
+
+static bool sameDescriptor(const uint16_t * descriptor, const uint16_t * expected)
+{
+	return descriptor != nullptr && descriptor[0] == expected[0] && memcmp(descriptor, expected, expected[0] & 0xFF) == 0;
+}
+
+static void testStringTable(const uint8_t * const * strings, uint8_t count)
+{
+	static uint16_t expected[16][128];
+	const uint16_t * first[16];
+
+	// Enumeration order: the preloaded indices, then whatever the host asks for
+	for (uint8_t index = 0; index < count; index++) {
+		memcpy(expected[index], legacyStringDescriptor((const char *)strings[index], index), sizeof(expected[index]));
+		first[index] = getStringDescriptor((const char *)strings[index], index);
+		CHECK(sameDescriptor(first[index], expected[index]));
+	}
+
+	// Repeated requests in any order return the stored descriptor unchanged
+	for (uint8_t round = 0; round < 3; round++) {
+		for (uint8_t i = 0; i < count; i++) {
+			const uint8_t index = (i * 3 + round) % count;
+			const uint16_t * descriptor = getStringDescriptor((const char *)strings[index], index);
+			CHECK(descriptor == first[index]);
+			CHECK(sameDescriptor(descriptor, expected[index]));
+		}
+	}
+	for (uint8_t index = 0; index < count; index++) {
+		CHECK(sameDescriptor(first[index], expected[index]));
+	}
+}
+
+// Indices past the cached ones are converted on every request, into the same buffer as before the pool
+static void testUncachedIndex()
+{
+	const uint8_t index = 0xEE;
+	const char * serial = "serial past the cached indices";
+	CHECK(sameDescriptor(getStringDescriptor(serial, index), legacyStringDescriptor(serial, index)));
+	CHECK(sameDescriptor(getStringDescriptor(overrideLong, index), legacyStringDescriptor(overrideLong, index)));
+}
+
+int main(int argc, char * argv[])
+{
+	memset(overrideLong, 'W', sizeof(overrideLong) - 1);
+	if (argc < 2) {
+		printf("usage: %s <string table>\n", argv[0]);
+		return 1;
+	}
+
+	for (const auto & table : stringTables) {
+		if (strcmp(table.name, argv[1]) == 0) {
+			testStringTable(table.strings, table.count);
+			testUncachedIndex();
+			return TEST_RESULT();
+		}
+	}
+	printf("unknown string table %s\n", argv[1]);
+	return 1;
+}
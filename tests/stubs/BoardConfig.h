@@ -0,0 +1,6 @@
+#ifndef BOARDCONFIG_H_
+#define BOARDCONFIG_H_
+
+// Host builds use the defaults of every option
+
+#endif
@@ -0,0 +1,98 @@
+#ifndef CLASS_HID_HID_H_
+#define CLASS_HID_HID_H_
+
+#include "tusb.h"
+
+#ifndef CFG_TUD_HID_EP_BUFSIZE
+#define CFG_TUD_HID_EP_BUFSIZE 64
+#endif
+
+enum {
+    HID_SUBCLASS_NONE = 0,
+    HID_SUBCLASS_BOOT = 1,
+};
+
+enum {
+    HID_ITF_PROTOCOL_NONE = 0,
+    HID_ITF_PROTOCOL_KEYBOARD = 1,
+    HID_ITF_PROTOCOL_MOUSE = 2,
+};
+
+enum {
+    HID_DESC_TYPE_HID = 0x21,
+    HID_DESC_TYPE_REPORT = 0x22,
+};
+
+#define HID_KEY_NONE 0x00
+#define HID_KEY_A 0x04
+#define HID_KEY_CONTROL_LEFT 0xE0
+#define HID_KEY_SHIFT_LEFT 0xE1
+#define HID_KEY_ALT_LEFT 0xE2
+#define HID_KEY_GUI_LEFT 0xE3
+#define HID_KEY_CONTROL_RIGHT 0xE4
+#define HID_KEY_SHIFT_RIGHT 0xE5
+#define HID_KEY_ALT_RIGHT 0xE6
+#define HID_KEY_GUI_RIGHT 0xE7
+
+typedef enum {
+    KEYBOARD_MODIFIER_LEFTCTRL = 1u << 0,
+    KEYBOARD_MODIFIER_LEFTSHIFT = 1u << 1,
+    KEYBOARD_MODIFIER_LEFTALT = 1u << 2,
+    KEYBOARD_MODIFIER_LEFTGUI = 1u << 3,
+    KEYBOARD_MODIFIER_RIGHTCTRL = 1u << 4,
+    KEYBOARD_MODIFIER_RIGHTSHIFT = 1u << 5,
+    KEYBOARD_MODIFIER_RIGHTALT = 1u << 6,
+    KEYBOARD_MODIFIER_RIGHTGUI = 1u << 7,
+} hid_keyboard_modifier_bm_t;
+
+typedef struct TU_ATTR_PACKED {
+    uint8_t modifier;
+    uint8_t reserved;
+    uint8_t keycode[6];
+} hid_keyboard_report_t;
+
+typedef enum {
+    MOUSE_BUTTON_LEFT = 1u << 0,
+    MOUSE_BUTTON_RIGHT = 1u << 1,
+    MOUSE_BUTTON_MIDDLE = 1u << 2,
+    MOUSE_BUTTON_BACKWARD = 1u << 3,
+    MOUSE_BUTTON_FORWARD = 1u << 4,
+} hid_mouse_button_bm_t;
+
+typedef struct TU_ATTR_PACKED {
+    uint8_t buttons;
+    int8_t x;
+    int8_t y;
+    int8_t wheel;
+    int8_t pan;
+} hid_mouse_report_t;
+
+#define TUD_HID_DESC_LEN (9 + 9 + 7)
+#define TUD_HID_DESCRIPTOR(_itfnum, _stridx, _boot_protocol, _report_desc_len, _epin, _epsize, _ep_interval) \
+    9, TUSB_DESC_INTERFACE, _itfnum, 0, 1, TUSB_CLASS_HID, (uint8_t)((_boot_protocol) ? (uint8_t)HID_SUBCLASS_BOOT : 0), \
+    _boot_protocol, _stridx, \
+    9, HID_DESC_TYPE_HID, U16_TO_U8S_LE(0x0111), 0, 1, HID_DESC_TYPE_REPORT, U16_TO_U8S_LE(_report_desc_len), \
+    7, TUSB_DESC_ENDPOINT, _epin, TUSB_XFER_INTERRUPT, U16_TO_U8S_LE(_epsize), _ep_interval
+
+typedef enum {
+    HID_REPORT_TYPE_INVALID = 0,
+    HID_REPORT_TYPE_INPUT,
+    HID_REPORT_TYPE_OUTPUT,
+    HID_REPORT_TYPE_FEATURE,
+} hid_report_type_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void hidd_init(void);
+void hidd_reset(uint8_t rhport);
+uint16_t hidd_open(uint8_t rhport, tusb_desc_interface_t const * desc_itf, uint16_t max_len);
+bool hidd_control_xfer_cb(uint8_t rhport, uint8_t stage, tusb_control_request_t const * request);
+bool hidd_xfer_cb(uint8_t rhport, uint8_t ep_addr, xfer_result_t result, uint32_t xferred_bytes);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
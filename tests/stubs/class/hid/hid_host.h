@@ -0,0 +1,37 @@
+#ifndef CLASS_HID_HID_HOST_H_
+#define CLASS_HID_HID_HOST_H_
+
+#include "class/hid/hid.h"
+
+// The tests define the host HID calls the listeners under test make
+
+typedef struct {
+    uint8_t report_id;
+    uint8_t usage;
+    uint16_t usage_page;
+} tuh_hid_report_info_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+uint8_t tuh_hid_interface_protocol(uint8_t dev_addr, uint8_t instance);
+uint8_t tuh_hid_parse_report_descriptor(tuh_hid_report_info_t * reports_info_arr, uint8_t arr_count,
+                                        uint8_t const * desc_report, uint16_t desc_len);
+bool tuh_hid_receive_report(uint8_t dev_addr, uint8_t instance);
+bool tuh_hid_send_report(uint8_t dev_addr, uint8_t instance, uint8_t report_id, const void * report, uint16_t len);
+bool tuh_hid_get_report(uint8_t dev_addr, uint8_t instance, uint8_t report_id, uint8_t report_type, void * report, uint16_t len);
+bool tuh_hid_set_report(uint8_t dev_addr, uint8_t instance, uint8_t report_id, uint8_t report_type, void * report, uint16_t len);
+
+// Callbacks the code under test implements
+void tuh_hid_mount_cb(uint8_t dev_addr, uint8_t instance, uint8_t const * desc_report, uint16_t desc_len);
+void tuh_hid_umount_cb(uint8_t dev_addr, uint8_t instance);
+void tuh_hid_report_received_cb(uint8_t dev_addr, uint8_t instance, uint8_t const * report, uint16_t len);
+void tuh_hid_set_report_complete_cb(uint8_t dev_addr, uint8_t instance, uint8_t report_id, uint8_t report_type, uint16_t len);
+void tuh_hid_get_report_complete_cb(uint8_t dev_addr, uint8_t instance, uint8_t report_id, uint8_t report_type, uint16_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
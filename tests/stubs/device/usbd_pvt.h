@@ -0,0 +1,6 @@
+#ifndef DEVICE_USBD_PVT_H_
+#define DEVICE_USBD_PVT_H_
+
+#include "tusb.h"
+
+#endif
@@ -0,0 +1,40 @@
+#ifndef HARDWARE_ADC_H_
+#define HARDWARE_ADC_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "pico/stdlib.h"
+
+#define ADC_CS_READY_BITS 0x00000100u
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    volatile uint32_t cs;
+    volatile uint32_t result;
+    volatile uint32_t fcs;
+    volatile uint32_t fifo;
+} adc_hw_t;
+
+// Tests that use the ADC provide the registers and an emulation behind these
+extern adc_hw_t * const adc_hw;
+
+void adc_init(void);
+void adc_gpio_init(uint gpio);
+void adc_select_input(uint input);
+uint adc_get_selected_input(void);
+void adc_set_round_robin(uint input_mask);
+void adc_run(bool run);
+uint16_t adc_read(void);
+void adc_fifo_setup(bool en, bool dreq_en, uint16_t dreq_thresh, bool err_in_fifo, bool byte_shift);
+uint8_t adc_fifo_get_level(void);
+void adc_fifo_drain(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
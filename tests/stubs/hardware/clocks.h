@@ -0,0 +1,21 @@
+#ifndef HARDWARE_CLOCKS_H_
+#define HARDWARE_CLOCKS_H_
+
+#include <stdint.h>
+
+enum clock_index {
+    clk_sys = 5,
+};
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Tests that convert cycles provide this
+uint32_t clock_get_hz(enum clock_index clk_index);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,50 @@
+#ifndef HARDWARE_DMA_H_
+#define HARDWARE_DMA_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "pico/stdlib.h"
+
+#define DREQ_ADC 36
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+enum dma_channel_transfer_size {
+    DMA_SIZE_8 = 0,
+    DMA_SIZE_16 = 1,
+    DMA_SIZE_32 = 2
+};
+
+// Address registers as wide as a host pointer
+typedef struct {
+    volatile uintptr_t read_addr;
+    volatile uintptr_t write_addr;
+    volatile uint32_t transfer_count;
+    volatile uint32_t ctrl_trig;
+} dma_channel_hw_t;
+
+typedef struct {
+    uint32_t ctrl;
+} dma_channel_config;
+
+// Tests that use DMA provide an emulation behind these
+int dma_claim_unused_channel(bool required);
+dma_channel_hw_t * dma_channel_hw_addr(uint channel);
+dma_channel_config dma_channel_get_default_config(uint channel);
+void channel_config_set_transfer_data_size(dma_channel_config * c, enum dma_channel_transfer_size size);
+void channel_config_set_read_increment(dma_channel_config * c, bool incr);
+void channel_config_set_write_increment(dma_channel_config * c, bool incr);
+void channel_config_set_ring(dma_channel_config * c, bool write, uint size_bits);
+void channel_config_set_dreq(dma_channel_config * c, uint dreq);
+void dma_channel_configure(uint channel, const dma_channel_config * config, volatile void * write_addr,
+                           const volatile void * read_addr, uint transfer_count, bool trigger);
+void dma_channel_abort(uint channel);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
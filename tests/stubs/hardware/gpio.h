@@ -0,0 +1,23 @@
+#ifndef HARDWARE_GPIO_H_
+#define HARDWARE_GPIO_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define GPIO_IN false
+#define GPIO_OUT true
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Tests that drive pins provide these
+void gpio_init(unsigned int gpio);
+void gpio_set_dir(unsigned int gpio, bool out);
+void gpio_put(unsigned int gpio, bool value);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
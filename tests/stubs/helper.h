@@ -0,0 +1,15 @@
+#ifndef HELPER_H_
+#define HELPER_H_
+
+// Host stand-in for helper.h, without the LED and animation headers it pulls in
+
+#include "pico/time.h"
+#include "BoardConfig.h"
+
+#include <stdint.h>
+
+static inline bool isValidPin(int32_t pin) {
+    int32_t numBank0GPIOS = NUM_BANK0_GPIOS;
+    return pin >= 0 && pin < numBank0GPIOS; }
+
+#endif
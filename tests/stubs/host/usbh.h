@@ -0,0 +1,39 @@
+#ifndef HOST_USBH_H_
+#define HOST_USBH_H_
+
+#include "tusb.h"
+
+// Host side of TinyUSB, the tests define the host calls the code under test makes
+
+#define TUH_CFGID_RPI_PIO_USB_CONFIGURATION 100
+
+typedef struct {
+#if CFG_TUSB_DEBUG >= 2
+    const char * name;
+#endif
+    bool (*init)(void);
+    bool (*open)(uint8_t rhport, uint8_t dev_addr, tusb_desc_interface_t const * desc_itf, uint16_t max_len);
+    bool (*set_config)(uint8_t dev_addr, uint8_t itf_num);
+    bool (*xfer_cb)(uint8_t dev_addr, uint8_t ep_addr, xfer_result_t result, uint32_t xferred_bytes);
+    void (*close)(uint8_t dev_addr);
+} usbh_class_driver_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+bool tuh_configure(uint8_t rhport, uint32_t cfg_id, const void * cfg_param);
+bool tuh_init(uint8_t rhport);
+bool tuh_deinit(uint8_t rhport);
+void tuh_task(void);
+bool tuh_vid_pid_get(uint8_t daddr, uint16_t * vid, uint16_t * pid);
+
+// Callbacks the code under test implements
+void tuh_mount_cb(uint8_t daddr);
+void tuh_umount_cb(uint8_t daddr);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
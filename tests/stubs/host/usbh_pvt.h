@@ -0,0 +1,6 @@
+#ifndef HOST_USBH_PVT_H_
+#define HOST_USBH_PVT_H_
+
+#include "host/usbh.h"
+
+#endif
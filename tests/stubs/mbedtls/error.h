@@ -0,0 +1,6 @@
+#ifndef MBEDTLS_ERROR_H_
+#define MBEDTLS_ERROR_H_
+
+// Included by the PS4 driver, the auth code that uses mbedtls is not built for the host
+
+#endif
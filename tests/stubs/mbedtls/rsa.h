@@ -0,0 +1,10 @@
+#ifndef MBEDTLS_RSA_H_
+#define MBEDTLS_RSA_H_
+
+// Only the type the PS4 auth data embeds, the auth code that uses mbedtls is not built for the host
+
+struct mbedtls_rsa_context {
+    int placeholder;
+};
+
+#endif
@@ -0,0 +1,28 @@
+#ifndef PERIPHERALMANAGER_H_
+#define PERIPHERALMANAGER_H_
+
+// The drivers under test include it without using the I2C or SPI peripherals, the USB host port is always enabled
+
+#include "pio_usb.h"
+
+class PeripheralUSB {
+public:
+    pio_usb_configuration_t * getController() { return &config; }
+private:
+    pio_usb_configuration_t config = {};
+};
+
+class PeripheralManager {
+public:
+    static PeripheralManager& getInstance() {
+        static PeripheralManager instance;
+        return instance;
+    }
+
+    PeripheralUSB * getUSB(uint8_t block) { return &blockUSB0; }
+    bool isUSBEnabled(uint8_t block) { return block == 0; }
+private:
+    PeripheralUSB blockUSB0;
+};
+
+#endif
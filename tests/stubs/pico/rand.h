@@ -0,0 +1,8 @@
+#ifndef PICO_RAND_H_
+#define PICO_RAND_H_
+
+#include <stdint.h>
+
+uint32_t get_rand_32(void);
+
+#endif
@@ -0,0 +1,35 @@
+#ifndef PICO_STDLIB_H_
+#define PICO_STDLIB_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#define NUM_BANK0_GPIOS 30
+
+#ifndef MIN
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
+#endif
+#ifndef MAX
+#define MAX(a, b) ((a) > (b) ? (a) : (b))
+#endif
+
+typedef unsigned int uint;
+typedef uint64_t absolute_time_t;
+static const absolute_time_t nil_time = 0;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Busy-wait body, tests that spin on emulated hardware step it from here
+void tight_loop_contents(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#include "hardware/gpio.h"
+#include "pico/time.h"
+
+#endif
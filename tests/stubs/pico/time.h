@@ -0,0 +1,24 @@
+#ifndef PICO_TIME_H_
+#define PICO_TIME_H_
+
+#include <stdint.h>
+
+#include "pico/stdlib.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Tests that use time provide these
+uint32_t time_us_32(void);
+absolute_time_t get_absolute_time(void);
+uint32_t to_ms_since_boot(absolute_time_t t);
+uint64_t to_us_since_boot(absolute_time_t t);
+void sleep_us(uint64_t us);
+void busy_wait_us_32(uint32_t delay_us);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,19 @@
+#ifndef PICO_UNIQUE_ID_H_
+#define PICO_UNIQUE_ID_H_
+
+#include <stdint.h>
+
+#define PICO_UNIQUE_BOARD_ID_SIZE_BYTES 8
+
+typedef struct {
+    uint8_t id[PICO_UNIQUE_BOARD_ID_SIZE_BYTES];
+} pico_unique_board_id_t;
+
+static inline void pico_get_unique_board_id(pico_unique_board_id_t * id_out)
+{
+    for (uint8_t i = 0; i < PICO_UNIQUE_BOARD_ID_SIZE_BYTES; i++) {
+        id_out->id[i] = 0xE6 - i;
+    }
+}
+
+#endif
@@ -0,0 +1,16 @@
+#ifndef PIO_USB_H_
+#define PIO_USB_H_
+
+// Host stand-in for the PIO USB configuration the host manager hands to TinyUSB
+
+#include <stdint.h>
+
+typedef struct {
+    uint8_t pin_dp;
+} pio_usb_configuration_t;
+
+typedef struct {
+    uint8_t address;
+} usb_device_t;
+
+#endif
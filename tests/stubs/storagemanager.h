@@ -0,0 +1,32 @@
+#ifndef STORAGEMANAGER_H_
+#define STORAGEMANAGER_H_
+
+// Host stand-in for the storage singleton: the drivers under test only read the gamepads, options and mappings
+
+#include "gamepad.h"
+#include "config.pb.h"
+
+class Storage {
+public:
+    static Storage& getInstance() {
+        static Storage instance;
+        return instance;
+    }
+
+    Gamepad * GetGamepad() { return gamepad; }
+    Gamepad * GetProcessedGamepad() { return gamepad; }
+    GpioMappingInfo * getProfilePinMappings() { return pinMappings; }
+    GamepadOptions & getGamepadOptions() { return gamepadOptions; }
+    HotkeyOptions & getHotkeyOptions() { return hotkeyOptions; }
+    KeyboardMapping & getKeyboardMapping() { return keyboardMapping; }
+    AddonOptions & getAddonOptions() { return addonOptions; }
+
+    Gamepad * gamepad = nullptr;
+    GamepadOptions gamepadOptions = {};
+    HotkeyOptions hotkeyOptions = {};
+    KeyboardMapping keyboardMapping = {};
+    AddonOptions addonOptions = {};
+    GpioMappingInfo pinMappings[NUM_BANK0_GPIOS] = {};
+};
+
+#endif
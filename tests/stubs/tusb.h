@@ -0,0 +1,214 @@
+#ifndef TUSB_H_
+#define TUSB_H_
+
+// Host stand-in for the parts of TinyUSB the drivers under test use
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+// Values headers/tusb_config.h refers to
+#define OPT_OS_NONE 1
+#define OPT_OS_PICO 5
+#define OPT_MODE_DEVICE 0x0001
+#define OPT_MODE_HOST 0x0002
+#define OPT_MODE_DEFAULT_SPEED 0x0000
+#define OPT_MODE_FULL_SPEED 0x0400
+#define OPT_MODE_HIGH_SPEED 0x0800
+
+#include "tusb_config.h"
+
+#define TUD_OPT_RHPORT BOARD_TUD_RHPORT
+#define TU_ARRAY_SIZE(_arr) (sizeof(_arr) / sizeof(_arr[0]))
+#define TU_ATTR_WEAK __attribute__((weak))
+#define TU_ATTR_ALWAYS_INLINE __attribute__((always_inline))
+#define TU_LOG_FAILED()
+#define TU_BREAKPOINT()
+#define tu_memclr(buffer, size) memset((buffer), 0, (size))
+#define TU_ATTR_PACKED __attribute__((packed))
+#define TU_ATTR_ALIGNED(x) __attribute__((aligned(x)))
+#define TU_U16_HIGH(u16) ((uint8_t)(((u16) >> 8) & 0x00ff))
+#define TU_U16_LOW(u16) ((uint8_t)((u16) & 0x00ff))
+#define U16_TO_U8S_LE(u16) TU_U16_LOW(u16), TU_U16_HIGH(u16)
+#define TU_GET_3RD_ARG(arg1, arg2, arg3, ...) arg3
+#define TU_VERIFY_1ARG(cond) do { if (!(cond)) return false; } while (0)
+#define TU_VERIFY_2ARGS(cond, ret) do { if (!(cond)) return ret; } while (0)
+#define TU_VERIFY(...) TU_GET_3RD_ARG(__VA_ARGS__, TU_VERIFY_2ARGS, TU_VERIFY_1ARG, UNUSED)(__VA_ARGS__)
+#define TU_ASSERT(...) TU_VERIFY(__VA_ARGS__)
+
+enum {
+    TUSB_DESC_DEVICE = 0x01,
+    TUSB_DESC_CONFIGURATION = 0x02,
+    TUSB_DESC_STRING = 0x03,
+    TUSB_DESC_INTERFACE = 0x04,
+    TUSB_DESC_ENDPOINT = 0x05,
+    TUSB_DESC_DEVICE_QUALIFIER = 0x06,
+};
+
+typedef enum {
+    TUSB_DIR_OUT = 0,
+    TUSB_DIR_IN = 1,
+    TUSB_DIR_IN_MASK = 0x80,
+} tusb_dir_t;
+
+enum {
+    TUSB_CLASS_HID = 3,
+    TUSB_CLASS_VENDOR_SPECIFIC = 0xff,
+};
+
+enum {
+    TUSB_REQ_TYPE_STANDARD = 0,
+    TUSB_REQ_TYPE_CLASS,
+    TUSB_REQ_TYPE_VENDOR,
+};
+
+enum {
+    CONTROL_STAGE_IDLE,
+    CONTROL_STAGE_SETUP,
+    CONTROL_STAGE_DATA,
+    CONTROL_STAGE_ACK,
+};
+
+enum {
+    TUSB_XFER_CONTROL = 0,
+    TUSB_XFER_ISOCHRONOUS,
+    TUSB_XFER_BULK,
+    TUSB_XFER_INTERRUPT,
+};
+
+enum {
+    TUSB_DESC_CONFIG_ATT_REMOTE_WAKEUP = 1u << 5,
+    TUSB_DESC_CONFIG_ATT_SELF_POWERED = 1u << 6,
+};
+
+#define TUD_CONFIG_DESC_LEN 9
+#define TUD_MSC_DESC_LEN (9 + 7 + 7)
+#define TUD_CONFIG_DESCRIPTOR(config_num, _itfcount, _stridx, _total_len, _attribute, _power_ma) \
+    9, TUSB_DESC_CONFIGURATION, U16_TO_U8S_LE(_total_len), _itfcount, config_num, _stridx, \
+    (uint8_t)(1u << 7 | (_attribute)), (uint8_t)((_power_ma) / 2)
+
+typedef struct TU_ATTR_PACKED {
+    uint8_t bLength;
+    uint8_t bDescriptorType;
+    uint16_t bcdUSB;
+    uint8_t bDeviceClass;
+    uint8_t bDeviceSubClass;
+    uint8_t bDeviceProtocol;
+    uint8_t bMaxPacketSize0;
+    uint16_t idVendor;
+    uint16_t idProduct;
+    uint16_t bcdDevice;
+    uint8_t iManufacturer;
+    uint8_t iProduct;
+    uint8_t iSerialNumber;
+    uint8_t bNumConfigurations;
+} tusb_desc_device_t;
+
+typedef struct TU_ATTR_PACKED {
+    uint8_t bLength;
+    uint8_t bDescriptorType;
+    uint8_t bInterfaceNumber;
+    uint8_t bAlternateSetting;
+    uint8_t bNumEndpoints;
+    uint8_t bInterfaceClass;
+    uint8_t bInterfaceSubClass;
+    uint8_t bInterfaceProtocol;
+    uint8_t iInterface;
+} tusb_desc_interface_t;
+
+typedef struct TU_ATTR_PACKED {
+    uint8_t bLength;
+    uint8_t bDescriptorType;
+    uint16_t wTotalLength;
+    uint8_t bNumInterfaces;
+    uint8_t bConfigurationValue;
+    uint8_t iConfiguration;
+    uint8_t bmAttributes;
+    uint8_t bMaxPower;
+} tusb_desc_configuration_t;
+
+typedef struct TU_ATTR_PACKED {
+    uint8_t bLength;
+    uint8_t bDescriptorType;
+    uint8_t bEndpointAddress;
+    struct TU_ATTR_PACKED {
+        uint8_t xfer : 2;
+        uint8_t sync : 2;
+        uint8_t usage : 2;
+        uint8_t : 2;
+    } bmAttributes;
+    uint16_t wMaxPacketSize;
+    uint8_t bInterval;
+} tusb_desc_endpoint_t;
+
+typedef struct TU_ATTR_PACKED {
+    union {
+        struct TU_ATTR_PACKED {
+            uint8_t recipient : 5;
+            uint8_t type : 2;
+            uint8_t direction : 1;
+        } bmRequestType_bit;
+        uint8_t bmRequestType;
+    };
+    uint8_t bRequest;
+    uint16_t wValue;
+    uint16_t wIndex;
+    uint16_t wLength;
+} tusb_control_request_t;
+
+typedef enum {
+    XFER_RESULT_SUCCESS,
+    XFER_RESULT_FAILED,
+    XFER_RESULT_STALLED,
+    XFER_RESULT_TIMEOUT,
+} xfer_result_t;
+
+typedef struct {
+#if CFG_TUSB_DEBUG >= 2
+    const char * name;
+#endif
+    void (*init)(void);
+    void (*reset)(uint8_t rhport);
+    uint16_t (*open)(uint8_t rhport, tusb_desc_interface_t const * desc_intf, uint16_t max_len);
+    bool (*control_xfer_cb)(uint8_t rhport, uint8_t stage, tusb_control_request_t const * request);
+    bool (*xfer_cb)(uint8_t rhport, uint8_t ep_addr, xfer_result_t result, uint32_t xferred_bytes);
+    void (*sof)(uint8_t rhport, uint32_t frame_count);
+} usbd_class_driver_t;
+
+static inline uint8_t tu_desc_len(void const * desc) { return ((uint8_t const *)desc)[0]; }
+static inline uint8_t tu_desc_type(void const * desc) { return ((uint8_t const *)desc)[1]; }
+static inline uint8_t const * tu_desc_next(void const * desc) { return (uint8_t const *)desc + tu_desc_len(desc); }
+static inline uint8_t tu_edpt_number(uint8_t addr) { return (uint8_t)(addr & 0x0f); }
+static inline tusb_dir_t tu_edpt_dir(uint8_t addr) { return (addr & TUSB_DIR_IN_MASK) ? TUSB_DIR_IN : TUSB_DIR_OUT; }
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+bool tud_ready(void);
+bool tud_control_xfer(uint8_t rhport, tusb_control_request_t const * request, void * buffer, uint16_t len);
+bool usbd_edpt_open(uint8_t rhport, tusb_desc_endpoint_t const * desc_ep);
+bool usbd_edpt_claim(uint8_t rhport, uint8_t ep_addr);
+bool usbd_edpt_release(uint8_t rhport, uint8_t ep_addr);
+bool usbd_edpt_xfer(uint8_t rhport, uint8_t ep_addr, uint8_t * buffer, uint16_t total_bytes);
+bool usbd_edpt_busy(uint8_t rhport, uint8_t ep_addr);
+bool usbd_open_edpt_pair(uint8_t rhport, uint8_t const * p_desc, uint8_t ep_count, uint8_t xfer_type, uint8_t * ep_out, uint8_t * ep_in);
+bool tud_suspended(void);
+bool tud_remote_wakeup(void);
+bool tud_hid_ready(void);
+bool tud_hid_report(uint8_t report_id, void const * report, uint16_t len);
+bool tud_hid_n_ready(uint8_t instance);
+bool tud_hid_n_report(uint8_t instance, uint8_t report_id, void const * report, uint16_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#include "class/hid/hid.h"
+
+#if CFG_TUH_ENABLED
+#include "host/usbh.h"
+#include "class/hid/hid_host.h"
+#endif
+
+#endif
@@ -0,0 +1,28 @@
+#ifndef TEST_H_
+#define TEST_H_
+
+#include <cstdio>
+
+// Minimal checks for the host tests, a test binary returns TEST_RESULT() from main() so ctest sees the failures
+
+static int testFailures = 0;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+        testFailures++; \
+    } \
+} while (0)
+
+#define CHECK_EQ(actual, expected) do { \
+    const long long actualValue = (long long)(actual); \
+    const long long expectedValue = (long long)(expected); \
+    if (actualValue != expectedValue) { \
+        printf("%s:%d: %s is %lld, expected %lld\n", __FILE__, __LINE__, #actual, actualValue, expectedValue); \
+        testFailures++; \
+    } \
+} while (0)
+
+#define TEST_RESULT() (testFailures == 0 ? 0 : 1)
+
+#endif
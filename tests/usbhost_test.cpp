@@ -0,0 +1,314 @@
+#include "usbhostmanager.h"
+#include "eventmanager.h"
+#include "drivers/shared/xinput_host.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <functional>
+
+#include "test.h"
+
+// USBHostManager with TinyUSB and the clock simulated: tuh_task() takes as long as the bus work it stands for and
+// delivers the reports of fake devices behind a hub, each listener takes a fixed time per report it is handed.
+// Every report carries a per-device sequence number, so a lost, duplicated or reordered report fails the test.
+
+static uint32_t nowUs = 0;
+static uint32_t taskUs = 0;             // how long the next tuh_task() takes
+static std::function<void()> bus;       // what the next tuh_task() delivers
+
+extern "C" {
+uint32_t time_us_32(void) { return nowUs; }
+void sleep_us(uint64_t us) { nowUs += us; }
+
+bool tuh_configure(uint8_t rhport, uint32_t cfg_id, const void * cfg_param) { return true; }
+bool tuh_init(uint8_t rhport) { return true; }
+bool tuh_deinit(uint8_t rhport) { return true; }
+void tuh_task(void) {
+    nowUs += taskUs;
+    if (bus) bus();
+}
+bool tuh_vid_pid_get(uint8_t daddr, uint16_t * vid, uint16_t * pid) {
+    *vid = 0xF00D;
+    *pid = daddr;
+    return true;
+}
+bool tuh_hid_receive_report(uint8_t dev_addr, uint8_t instance) { return true; }
+
+bool xinputh_init(void) { return true; }
+bool xinputh_open(uint8_t rhport, uint8_t dev_addr, tusb_desc_interface_t const * desc_itf, uint16_t max_len) { return false; }
+bool xinputh_set_config(uint8_t dev_addr, uint8_t itf_num) { return true; }
+bool xinputh_xfer_cb(uint8_t dev_addr, uint8_t ep_addr, xfer_result_t result, uint32_t xferred_bytes) { return true; }
+void xinputh_close(uint8_t dev_addr) {}
+}
+
+void EventManager::triggerEvent(GPEvent * event) { delete event; }
+
+// Claims every interface of one device address
+class FakeListener : public USBListener {
+public:
+    FakeListener(uint8_t devAddr, uint32_t costUs) : devAddr(devAddr), costUs(costUs) {}
+    virtual void setup() {}
+    virtual bool mount(uint8_t dev_addr, uint8_t instance, uint8_t const* desc_report, uint16_t desc_len) { return dev_addr == devAddr; }
+    virtual bool xmount(uint8_t dev_addr, uint8_t instance, uint8_t controllerType, uint8_t subtype) { return dev_addr == devAddr; }
+    virtual void unmount(uint8_t dev_addr) { receivedAtUnmount = received; }
+    virtual void report_received(uint8_t dev_addr, uint8_t instance, uint8_t const* report, uint16_t len) {
+        nowUs += costUs;
+        CHECK_EQ(dev_addr, devAddr);
+        CHECK_EQ(len, USB_HOST_EVENT_REPORT_SIZE);
+        const uint16_t sequence = report[0] | (report[1] << 8);
+        if (sequence != (uint16_t)received) {
+            printf("device %u: report %u handed over as report %u\n", devAddr, sequence, received);
+            testFailures++;
+        }
+        received++;
+        lastReceivedLoop = loop;
+    }
+    virtual void report_sent(uint8_t dev_addr, uint8_t instance, uint8_t const* report, uint16_t len) {}
+    virtual void set_report_complete(uint8_t dev_addr, uint8_t instance, uint8_t report_id, uint8_t report_type, uint16_t len) {}
+    virtual void get_report_complete(uint8_t dev_addr, uint8_t instance, uint8_t report_id, uint8_t report_type, uint16_t len) {}
+
+    const uint8_t devAddr;
+    uint32_t costUs;
+    uint32_t sent = 0;      // reports the fake device delivered for this listener
+    uint32_t received = 0;
+    uint32_t receivedAtUnmount = 0;
+    uint32_t loop = 0;
+    uint32_t lastReceivedLoop = 0;
+};
+
+// A keyboard, a mouse, a HID pad and an XInput pad behind a hub, device 5 is claimed by nobody
+#define UNCLAIMED_DEV_ADDR 5
+static FakeListener keyboard(1, 15);
+static FakeListener mouse(2, 10);
+static FakeListener pad(3, 60);
+static FakeListener xinputPad(4, 40);
+static FakeListener * const devices[] = { &keyboard, &mouse, &pad, &xinputPad };
+static const uint32_t maxListenerUs = 60;
+
+static uint32_t randomState = 0x12345678;
+
+static uint32_t randomNext()
+{
+    randomState ^= randomState << 13;
+    randomState ^= randomState >> 17;
+    randomState ^= randomState << 5;
+    return randomState;
+}
+
+static void deliver(FakeListener & device)
+{
+    uint8_t report[USB_HOST_EVENT_REPORT_SIZE] = {};
+    report[0] = device.sent & 0xFF;
+    report[1] = (device.sent >> 8) & 0xFF;
+    device.sent++;
+    if (&device == &xinputPad) {
+        tuh_xinput_report_received_cb(device.devAddr, 0, report, sizeof(report));
+    } else {
+        tuh_hid_report_received_cb(device.devAddr, 0, report, sizeof(report));
+    }
+}
+
+static void setupHost()
+{
+    USBHostManager & manager = USBHostManager::getInstance();
+    for (FakeListener * device : devices) {
+        manager.pushListener(device);
+    }
+    manager.start();
+
+    static const uint8_t desc[] = { 0x05, 0x01, 0x09, 0x05, 0xA1, 0x01, 0xC0 };
+    for (FakeListener * device : devices) {
+        if (device == &xinputPad) {
+            tuh_xinput_mount_cb(device->devAddr, 0, XBOX360, 0);
+        } else {
+            tuh_hid_mount_cb(device->devAddr, 0, desc, sizeof(desc));
+        }
+    }
+    tuh_hid_mount_cb(UNCLAIMED_DEV_ADDR, 0, desc, sizeof(desc));
+    CHECK_EQ(manager.getDeviceCount(), 4);
+}
+
+static void drain()
+{
+    bus = nullptr;
+    taskUs = 0;
+    USBHostManager::getInstance().flushEvents();
+    for (FakeListener * device : devices) {
+        CHECK_EQ(device->received, device->sent);
+    }
+}
+
+// Interleaved reports reach only the listener that claimed the device, all of them and in order
+static void testRouting()
+{
+    USBHostManager & manager = USBHostManager::getInstance();
+    const uint32_t unclaimedBefore = manager.getUnclaimedEvents();
+    uint32_t unclaimed = 0;
+
+    taskUs = 20;
+    bus = [&]() {
+        for (FakeListener * device : devices) {
+            deliver(*device);
+        }
+        uint8_t report[8] = {};
+        tuh_hid_report_received_cb(UNCLAIMED_DEV_ADDR, 0, report, sizeof(report));
+        unclaimed++;
+    };
+    for (uint32_t i = 0; i < 500; i++) {
+        manager.process();
+    }
+    drain();
+    CHECK_EQ(manager.getUnclaimedEvents() - unclaimedBefore, unclaimed);
+}
+
+// The listener part of process() stays within the budget however much the devices send, the worst-case loop is
+// tuh_task() plus the budget plus one report
+static void testLoopBudget()
+{
+    USBHostManager & manager = USBHostManager::getInstance();
+    const uint32_t overflowsBefore = manager.getQueueOverflows();
+
+    uint32_t busListenerUs = 0;     // listener time spent in tuh_task() on reports handed over because a queue was full
+    uint32_t deliveredUs = 0;       // listener time for everything tuh_task() delivered, what an inline dispatch costs
+    bus = [&]() {
+        const uint32_t start = nowUs;
+        for (FakeListener * device : devices) {
+            // Mostly a report now and then, sometimes the backlog of a whole burst
+            const uint32_t reports = (randomNext() % 16 == 0) ? 1 + randomNext() % 6 : (randomNext() % 3 == 0);
+            for (uint32_t r = 0; r < reports; r++) {
+                deliver(*device);
+                deliveredUs += device->costUs;
+            }
+        }
+        busListenerUs = nowUs - start;
+    };
+
+    uint32_t worstLoopUs = 0;
+    uint32_t worstDispatchUs = 0;
+    uint32_t worstInlineUs = 0;
+    for (uint32_t loop = 0; loop < 100000; loop++) {
+        // Mostly short bus work, now and then an enumeration step
+        taskUs = (randomNext() % 500 == 0) ? 1500 : 20 + randomNext() % 80;
+        busListenerUs = 0;
+        deliveredUs = 0;
+
+        const uint32_t start = nowUs;
+        manager.process();
+        const uint32_t elapsed = nowUs - start;
+
+        const uint32_t taskPartUs = taskUs + busListenerUs;
+        const uint32_t dispatchUs = elapsed - taskPartUs;
+        const uint32_t allowedUs = (taskPartUs < USB_HOST_PROCESS_BUDGET_US ? USB_HOST_PROCESS_BUDGET_US - taskPartUs : 0) +
+            maxListenerUs;
+        if (dispatchUs > allowedUs) {
+            printf("loop %u: %u us of listener work after a %u us tuh_task()\n", loop, dispatchUs, taskPartUs);
+            testFailures++;
+            break;
+        }
+        worstLoopUs = std::max(worstLoopUs, elapsed);
+        worstDispatchUs = std::max(worstDispatchUs, elapsed - taskUs);
+        worstInlineUs = std::max(worstInlineUs, deliveredUs);
+    }
+    CHECK_EQ(manager.getMaxProcessUs(), worstLoopUs);
+    CHECK(manager.getQueueOverflows() > overflowsBefore);
+    printf("worst-case host processing per loop: %u us, listener work %u us of it (%u us if handed over inline), "
+           "%u early handovers\n", worstLoopUs, worstDispatchUs, worstInlineUs,
+           manager.getQueueOverflows() - overflowsBefore);
+    drain();
+}
+
+// A chatty pad cannot keep the keyboard waiting, every device goes first in turn
+static void testFairness()
+{
+    USBHostManager & manager = USBHostManager::getInstance();
+    uint32_t loop = 0;
+    uint32_t keyboardSentLoop = 0;
+    uint32_t worstWait = 0;
+    taskUs = 50;
+    bus = [&]() {
+        for (uint32_t r = 0; r < 3; r++) {
+            deliver(pad);
+        }
+        deliver(xinputPad);
+        if (loop % 8 == 0 && keyboard.received == keyboard.sent) {
+            deliver(keyboard);
+            keyboardSentLoop = loop;
+        }
+    };
+    for (loop = 0; loop < 10000; loop++) {
+        for (FakeListener * device : devices) {
+            device->loop = loop;
+        }
+        const uint32_t before = keyboard.received;
+        manager.process();
+        if (keyboard.received != before) {
+            worstWait = std::max(worstWait, keyboard.lastReceivedLoop - keyboardSentLoop);
+        }
+    }
+    CHECK(worstWait <= 1);
+    drain();
+}
+
+// Mounts and unmounts do not overtake queued reports
+static void testUnmount()
+{
+    USBHostManager & manager = USBHostManager::getInstance();
+    deliver(pad);
+    deliver(pad);
+    tuh_hid_umount_cb(pad.devAddr, 0);
+    CHECK_EQ(pad.receivedAtUnmount, pad.sent);
+    CHECK_EQ(manager.getDeviceCount(), 3);
+
+    // Reports after the unplug are nobody's
+    const uint32_t unclaimedBefore = manager.getUnclaimedEvents();
+    uint8_t report[USB_HOST_EVENT_REPORT_SIZE] = {};
+    tuh_hid_report_received_cb(pad.devAddr, 0, report, sizeof(report));
+    CHECK_EQ(manager.getUnclaimedEvents(), unclaimedBefore + 1);
+
+    static const uint8_t desc[] = { 0x05, 0x01, 0x09, 0x05, 0xA1, 0x01, 0xC0 };
+    tuh_hid_mount_cb(pad.devAddr, 0, desc, sizeof(desc));
+    CHECK_EQ(manager.getDeviceCount(), 4);
+}
+
+// Host cost of queueing and handing over a report, with listeners that do nothing
+static void benchmarkDispatch()
+{
+    USBHostManager & manager = USBHostManager::getInstance();
+    for (FakeListener * device : devices) {
+        device->costUs = 0;
+    }
+    taskUs = 0;
+    bus = [&]() {
+        for (FakeListener * device : devices) {
+            deliver(*device);
+        }
+    };
+
+    const uint32_t loops = 200000;
+    const uint32_t overflowsBefore = manager.getQueueOverflows();
+    const auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < loops; i++) {
+        manager.process();
+    }
+    const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+    uint32_t dropped = 0;
+    for (FakeListener * device : devices) {
+        dropped += device->sent - device->received;
+    }
+    printf("dispatch: %.1f ns per report from 4 devices, %u early handovers, %u dropped\n",
+           (double)elapsed.count() / (loops * 4), manager.getQueueOverflows() - overflowsBefore, dropped);
+    CHECK_EQ(dropped, 0);
+}
+
+int main()
+{
+    setupHost();
+    testRouting();
+    testLoopBudget();
+    testFairness();
+    testUnmount();
+    benchmarkDispatch();
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,201 @@
+#include "usbtelemetry.h"
+#include "storagemanager.h"
+#include "hardware/clocks.h"
+
+#include "test.h"
+
+// The telemetry interface against a fake endpoint that can refuse the claim or the transfer
+
+static bool claimOk = true;
+static bool xferOk = true;
+static uint8_t sentPacket[64];
+static uint16_t sentLength = 0;
+static uint32_t transfers = 0;
+static USBTelemetryStatus controlReply;
+
+extern "C" {
+bool tud_ready(void) { return true; }
+bool tud_control_xfer(uint8_t rhport, tusb_control_request_t const * request, void * buffer, uint16_t len) {
+    memcpy(&controlReply, buffer, len < sizeof(controlReply) ? len : sizeof(controlReply));
+    return true;
+}
+bool usbd_edpt_open(uint8_t rhport, tusb_desc_endpoint_t const * desc_ep) { return true; }
+bool usbd_edpt_claim(uint8_t rhport, uint8_t ep_addr) { return claimOk; }
+bool usbd_edpt_release(uint8_t rhport, uint8_t ep_addr) { return true; }
+bool usbd_edpt_xfer(uint8_t rhport, uint8_t ep_addr, uint8_t * buffer, uint16_t total_bytes) {
+    if (!xferOk) {
+        return false;
+    }
+    memcpy(sentPacket, buffer, total_bytes);
+    sentLength = total_bytes;
+    transfers++;
+    return true;
+}
+
+static uint32_t nowUs = 1000;
+uint32_t time_us_32(void) { return nowUs; }
+uint32_t clock_get_hz(enum clock_index clk_index) { return 125000000; }
+}
+
+static uint32_t pollRate = 0;
+uint32_t get_usb_poll_rate(void) { return pollRate; }
+
+Gamepad::Gamepad() :
+    options(Storage::getInstance().gamepadOptions)
+    , hotkeyOptions(Storage::getInstance().hotkeyOptions)
+{
+}
+
+// Configuration descriptor with one interface using endpoints 0x81 and 0x02
+static uint8_t descriptor[128] = {
+    9, TUSB_DESC_CONFIGURATION, 32, 0, 1, 1, 0, 0x80, 250,
+    9, TUSB_DESC_INTERFACE, 0, 0, 2, TUSB_CLASS_HID, 0, 0, 0,
+    7, TUSB_DESC_ENDPOINT, 0x81, TUSB_XFER_INTERRUPT, 64, 0, 1,
+    7, TUSB_DESC_ENDPOINT, 0x02, TUSB_XFER_INTERRUPT, 64, 0, 1,
+};
+
+static const usbd_class_driver_t * driver = nullptr;
+
+static void testAppendInterface()
+{
+    CHECK(!USBTelemetry::appendInterface(descriptor, 32 + USB_TELEMETRY_DESC_LEN - 1));
+    CHECK(!USBTelemetry::isEnabled());
+
+    CHECK(USBTelemetry::appendInterface(descriptor, sizeof(descriptor)));
+    CHECK(USBTelemetry::isEnabled());
+    const tusb_desc_configuration_t * config = (const tusb_desc_configuration_t *)descriptor;
+    CHECK_EQ(config->wTotalLength, 32 + USB_TELEMETRY_DESC_LEN);
+    CHECK_EQ(config->bNumInterfaces, 2);
+
+    const tusb_desc_interface_t * itf = (const tusb_desc_interface_t *)&descriptor[32];
+    CHECK_EQ(itf->bInterfaceNumber, 1);
+    CHECK_EQ(itf->bInterfaceSubClass, USB_TELEMETRY_SUBCLASS);
+    const tusb_desc_endpoint_t * endpoint = (const tusb_desc_endpoint_t *)tu_desc_next(itf);
+    CHECK_EQ(endpoint->bEndpointAddress, 0x83);
+    CHECK_EQ(endpoint->bmAttributes.xfer, TUSB_XFER_BULK);
+
+    driver = USBTelemetry::getClassDriver();
+    driver->init();
+    CHECK_EQ(driver->open(0, itf, USB_TELEMETRY_DESC_LEN), USB_TELEMETRY_DESC_LEN);
+}
+
+static void completeReports(Gamepad & gamepad, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++) {
+        USBTelemetry::reportQueued(&gamepad);
+        nowUs += 250;
+        USBTelemetry::reportCompleted();
+        nowUs += 750;
+    }
+}
+
+static void testRecordsKeptUntilSent()
+{
+    Gamepad gamepad;
+    completeReports(gamepad, 3);
+
+    // Neither a refused claim nor a refused transfer loses records
+    claimOk = false;
+    USBTelemetry::process();
+    CHECK_EQ(transfers, 0);
+    claimOk = true;
+    xferOk = false;
+    USBTelemetry::process();
+    CHECK_EQ(transfers, 0);
+    xferOk = true;
+
+    USBTelemetry::process();
+    CHECK_EQ(transfers, 1);
+    CHECK_EQ(sentLength, 3 * sizeof(USBTelemetryRecord));
+    USBTelemetryRecord records[3];
+    memcpy(records, sentPacket, sizeof(records));
+    for (uint16_t i = 0; i < 3; i++) {
+        CHECK_EQ(records[i].sequence, i);
+        CHECK_EQ(records[i].completeUs - records[i].queuedUs, 250);
+    }
+
+    // The endpoint is busy until its transfer completes
+    completeReports(gamepad, 1);
+    USBTelemetry::process();
+    CHECK_EQ(transfers, 1);
+    driver->xfer_cb(0, 0x83, XFER_RESULT_SUCCESS, sentLength);
+    USBTelemetry::process();
+    CHECK_EQ(transfers, 2);
+    CHECK_EQ(sentLength, sizeof(USBTelemetryRecord));
+}
+
+static void testPacketsHoldFourRecords()
+{
+    Gamepad gamepad;
+    driver->xfer_cb(0, 0x83, XFER_RESULT_SUCCESS, sentLength);
+    completeReports(gamepad, 6);
+    USBTelemetry::process();
+    CHECK_EQ(sentLength, 64);
+    driver->xfer_cb(0, 0x83, XFER_RESULT_SUCCESS, sentLength);
+    USBTelemetry::process();
+    CHECK_EQ(sentLength, 2 * sizeof(USBTelemetryRecord));
+    driver->xfer_cb(0, 0x83, XFER_RESULT_SUCCESS, sentLength);
+}
+
+static tusb_control_request_t statusRequest()
+{
+    tusb_control_request_t request = {};
+    request.bmRequestType_bit.recipient = 1;
+    request.bmRequestType_bit.type = TUSB_REQ_TYPE_VENDOR;
+    request.bmRequestType_bit.direction = TUSB_DIR_IN;
+    request.bRequest = USB_TELEMETRY_REQUEST_STATUS;
+    request.wLength = sizeof(USBTelemetryStatus);
+    return request;
+}
+
+static void testDropped()
+{
+    Gamepad gamepad;
+    const uint32_t droppedBefore = USBTelemetry::getDropped();
+
+    // A report queued before the previous one completed replaces its record
+    USBTelemetry::reportQueued(&gamepad);
+    USBTelemetry::reportQueued(&gamepad);
+    USBTelemetry::reportCompleted();
+    CHECK_EQ(USBTelemetry::getDropped(), droppedBefore + 1);
+
+    // A full ring drops the newest records
+    completeReports(gamepad, 64);
+    CHECK_EQ(USBTelemetry::getDropped(), droppedBefore + 2);
+
+    const tusb_control_request_t request = statusRequest();
+    CHECK(driver->control_xfer_cb(0, CONTROL_STAGE_SETUP, &request));
+    CHECK_EQ(controlReply.dropped, droppedBefore + 2);
+    CHECK(driver->control_xfer_cb(0, CONTROL_STAGE_ACK, &request));
+
+    // The input scan period, last and longest, and the measured poll rate go out with the status
+    USBTelemetry::inputScanned(151);
+    USBTelemetry::inputScanned(95);
+    pollRate = 998;
+    CHECK(driver->control_xfer_cb(0, CONTROL_STAGE_SETUP, &request));
+    CHECK_EQ(controlReply.inputScanUs, 95u);
+    CHECK_EQ(controlReply.inputScanMaxUs, 151u);
+    CHECK_EQ(controlReply.pollRate, 998u);
+
+    // Report build cost, mean and longest, in ns at the 125 MHz system clock
+    CHECK_EQ(controlReply.reportBuildNs, 0u);
+    USBTelemetry::reportBuilt(250);
+    USBTelemetry::reportBuilt(750);
+    CHECK(driver->control_xfer_cb(0, CONTROL_STAGE_SETUP, &request));
+    CHECK_EQ(controlReply.reportBuildNs, 4000u);
+    CHECK_EQ(controlReply.reportBuildMaxNs, 6000u);
+
+    tusb_control_request_t other = request;
+    other.bRequest = USB_TELEMETRY_REQUEST_STATUS + 1;
+    CHECK(!driver->control_xfer_cb(0, CONTROL_STAGE_SETUP, &other));
+}
+
+int main()
+{
+    testAppendInterface();
+    testRecordsKeptUntilSent();
+    testPacketsHoldFourRecords();
+    testDropped();
+
+    return TEST_RESULT();
+}
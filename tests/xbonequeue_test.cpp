@@ -0,0 +1,196 @@
+#include "drivers/xbone/XBOneReportQueue.h"
+
+#include "test.h"
+
+// The Xbox One driver loop against an IN endpoint that takes one millisecond per transfer: update() drains the queue,
+// process() sends an input report when there is one, and every completion drains the queue again
+
+static const uint8_t INPUT_REPORT = 0xFF;
+
+struct Endpoint {
+    bool busy = false;
+    uint32_t doneAt = 0;
+    uint8_t sent[64];       // first byte of every packet in the order it went out
+    uint32_t sentAt[64];
+    uint32_t count = 0;
+
+    bool send(uint8_t id, uint32_t now) {
+        if (busy || count >= sizeof(sent)) {
+            return false;
+        }
+        busy = true;
+        doneAt = now + 1;
+        sent[count] = id;
+        sentAt[count] = now;
+        count++;
+        return true;
+    }
+};
+
+static void queuePacket(XBOneReportQueue & queue, XboxOneQueuePriority priority, uint8_t id)
+{
+    report_queue_t * item = queue.reserve(priority);
+    CHECK(item != nullptr);
+    if (item != nullptr) {
+        item->report[0] = id;
+        item->len = 1;
+        queue.commit(priority);
+    }
+}
+
+static void drain(XBOneReportQueue & queue, Endpoint & endpoint, uint32_t now)
+{
+    report_queue_t * item = queue.next(now);
+    if (item != nullptr && endpoint.send(item->report[0], now)) {
+        queue.sent(now);
+    }
+}
+
+// One millisecond of the driver, sendInput is true when the input changed since the last report
+static void tick(XBOneReportQueue & queue, Endpoint & endpoint, uint32_t now, bool sendInput)
+{
+    if (endpoint.busy && endpoint.doneAt <= now) {
+        endpoint.busy = false;
+        drain(queue, endpoint, now);
+    }
+    drain(queue, endpoint, now);
+    if (sendInput) {
+        queue.setInputPending(!endpoint.send(INPUT_REPORT, now));
+    } else {
+        queue.setInputPending(false);
+    }
+}
+
+static void testAcksFirst()
+{
+    XBOneReportQueue queue;
+    Endpoint endpoint;
+    queuePacket(queue, XBONE_QUEUE_CONTROL, 1);
+    queuePacket(queue, XBONE_QUEUE_CONTROL, 2);
+    queuePacket(queue, XBONE_QUEUE_ACK, 10);
+    queuePacket(queue, XBONE_QUEUE_ACK, 11);
+
+    for (uint32_t now = 100; now < 200; now++) {
+        tick(queue, endpoint, now, false);
+    }
+    CHECK_EQ(endpoint.count, 4);
+    CHECK_EQ(endpoint.sent[0], 10);
+    CHECK_EQ(endpoint.sent[1], 11);
+    CHECK_EQ(endpoint.sent[2], 1);
+    CHECK_EQ(endpoint.sent[3], 2);
+
+    // Acks go out on back to back completions, control packets keep their gap
+    CHECK_EQ(endpoint.sentAt[1] - endpoint.sentAt[0], 1);
+    CHECK_EQ(endpoint.sentAt[2] - endpoint.sentAt[1], 1);
+    CHECK_EQ(endpoint.sentAt[3] - endpoint.sentAt[2], XBONE_CONTROL_PACKET_GAP);
+}
+
+static void testInputFirst()
+{
+    XBOneReportQueue queue;
+    Endpoint endpoint;
+
+    // Endpoint busy, the input report has to wait for it
+    endpoint.send(0, 0);
+    tick(queue, endpoint, 0, true);
+    queuePacket(queue, XBONE_QUEUE_ACK, 10);
+    CHECK(queue.next(0) == nullptr);
+
+    // The completion does not release the ack ahead of the waiting input report
+    tick(queue, endpoint, 1, true);
+    CHECK_EQ(endpoint.count, 2);
+    CHECK_EQ(endpoint.sent[1], INPUT_REPORT);
+
+    // The ack takes the next completion
+    tick(queue, endpoint, 2, false);
+    CHECK_EQ(endpoint.count, 3);
+    CHECK_EQ(endpoint.sent[2], 10);
+    CHECK_EQ(endpoint.sentAt[2], 2);
+}
+
+static void testCompletionReleasesNext()
+{
+    XBOneReportQueue queue;
+    Endpoint endpoint;
+    queuePacket(queue, XBONE_QUEUE_ACK, 10);
+    tick(queue, endpoint, 50, false);
+    CHECK_EQ(endpoint.count, 1);
+
+    // Queued while the ack is still in flight, out with the completion and not a timer later
+    queuePacket(queue, XBONE_QUEUE_ACK, 11);
+    queuePacket(queue, XBONE_QUEUE_CONTROL, 1);
+    tick(queue, endpoint, 51, false);
+    tick(queue, endpoint, 52, false);
+    CHECK_EQ(endpoint.count, 3);
+    CHECK_EQ(endpoint.sentAt[1], 51);
+    CHECK_EQ(endpoint.sentAt[2], 52);
+}
+
+// Input changing every millisecond while the console sends a burst of packets that need acks
+static void testWorstCaseDelay()
+{
+    XBOneReportQueue queue;
+    Endpoint endpoint;
+    for (uint8_t id = 0; id < XBONE_ACK_QUEUE_SIZE; id++) {
+        queuePacket(queue, XBONE_QUEUE_ACK, 10 + id);
+    }
+    CHECK(queue.full(XBONE_QUEUE_ACK));
+    CHECK(queue.reserve(XBONE_QUEUE_ACK) == nullptr);
+
+    uint32_t inputs = 0;
+    uint32_t acks = 0;
+    uint32_t lastInput = 0;
+    uint32_t maxInputGap = 0;
+    for (uint32_t now = 1000; now < 1100; now++) {
+        tick(queue, endpoint, now, true);
+    }
+    for (uint32_t i = 0; i < endpoint.count; i++) {
+        if (endpoint.sent[i] == INPUT_REPORT) {
+            if (inputs > 0 && endpoint.sentAt[i] - lastInput > maxInputGap) {
+                maxInputGap = endpoint.sentAt[i] - lastInput;
+            }
+            lastInput = endpoint.sentAt[i];
+            inputs++;
+        } else {
+            // In order, and each ack waits for at most one input report per ack ahead of it
+            CHECK_EQ(endpoint.sent[i], 10 + acks);
+            CHECK(endpoint.sentAt[i] - 1000 <= 2 * acks + 1);
+            acks++;
+        }
+    }
+    CHECK_EQ(acks, XBONE_ACK_QUEUE_SIZE);
+    CHECK(queue.next(1100) == nullptr);
+    // Input is never held up by more than the one packet in flight
+    CHECK(maxInputGap <= 2);
+}
+
+static void testClear()
+{
+    XBOneReportQueue queue;
+    queuePacket(queue, XBONE_QUEUE_CONTROL, 1);
+    queue.next(0);
+    queue.sent(0);
+    queuePacket(queue, XBONE_QUEUE_CONTROL, 2);
+    queue.setInputPending(true);
+    queue.clear();
+    CHECK(queue.next(1) == nullptr);
+
+    // After a reset the first control packet does not wait for the gap of the one before
+    queuePacket(queue, XBONE_QUEUE_CONTROL, 3);
+    report_queue_t * item = queue.next(1);
+    CHECK(item != nullptr);
+    if (item != nullptr) {
+        CHECK_EQ(item->report[0], 3);
+    }
+}
+
+int main()
+{
+    testAcksFirst();
+    testInputFirst();
+    testCompletionReleasesNext();
+    testWorstCaseDelay();
+    testClear();
+
+    return TEST_RESULT();
+}
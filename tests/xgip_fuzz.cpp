@@ -0,0 +1,173 @@
+#include "drivers/shared/xgip_protocol.h"
+#include "drivers/xbone/XBOneDescriptors.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "test.h"
+
+// Mutated GIP traffic through XGIPProtocol::parse() under the address and undefined behaviour sanitizers. The seeds
+// are chunked and single transfers generated by XGIPProtocol itself; captured traffic can be added on the command
+// line, one packet per line as hex bytes:
+//   xgip_fuzz capture.txt
+
+typedef std::vector<uint8_t> Packet;
+
+static uint32_t randomState = 0x12345678;
+
+static uint32_t randomNext()
+{
+    randomState ^= randomState << 13;
+    randomState ^= randomState >> 17;
+    randomState ^= randomState << 5;
+    return randomState;
+}
+
+static void generateTransfer(std::vector<Packet> & traffic, uint8_t command, uint16_t len) {
+    static uint8_t payload[1024];
+    for (uint16_t i = 0; i < len; i++) {
+        payload[i] = randomNext();
+    }
+    XGIPProtocol sender;
+    sender.setAttributes(command, randomNext(), 1, len > GIP_MAX_CHUNK_SIZE, randomNext() & 1);
+    sender.setData(payload, len);
+    uint8_t packet[GIP_MAX_CHUNK_SIZE + 6];
+    do {
+        const uint16_t packetLength = sender.generatePacket(packet);
+        traffic.push_back(Packet(packet, packet + packetLength));
+        if (randomNext() % 4 == 0) {
+            const uint16_t ackLength = sender.generateAckPacket(packet);
+            traffic.push_back(Packet(packet, packet + ackLength));
+        }
+    } while (sender.getChunked() && !sender.endOfChunk());
+}
+
+static bool loadCapture(const char * path, std::vector<Packet> & traffic) {
+    FILE * file = fopen(path, "r");
+    if (file == nullptr) {
+        printf("cannot open %s\n", path);
+        return false;
+    }
+    char line[1024];
+    while (fgets(line, sizeof(line), file) != nullptr) {
+        Packet packet;
+        char * cursor = line;
+        char * end;
+        for (unsigned long byte = strtoul(cursor, &end, 16); end != cursor && packet.size() < 64; byte = strtoul(cursor, &end, 16)) {
+            packet.push_back((uint8_t)byte);
+            cursor = end;
+        }
+        if (!packet.empty()) {
+            traffic.push_back(packet);
+        }
+    }
+    fclose(file);
+    return true;
+}
+
+static void mutate(Packet & packet) {
+    switch (randomNext() % 6) {
+        case 0: // flip a bit
+            if (!packet.empty()) {
+                packet[randomNext() % packet.size()] ^= 1 << (randomNext() % 8);
+            }
+            break;
+        case 1: // random byte, most often in the header
+            if (!packet.empty()) {
+                packet[randomNext() % (randomNext() % 2 ? std::min<size_t>(packet.size(), 6) : packet.size())] = randomNext();
+            }
+            break;
+        case 2: // truncate
+            packet.resize(randomNext() % (packet.size() + 1));
+            break;
+        case 3: // extend up to the endpoint size
+            packet.resize(packet.size() + randomNext() % (65 - std::min<size_t>(packet.size(), 64)), (uint8_t)randomNext());
+            packet.resize(std::min<size_t>(packet.size(), 64));
+            break;
+        case 4: // lie about the length
+            if (packet.size() > 3) {
+                packet[3] = randomNext() % 4 == 0 ? randomNext() : packet[3] + (int8_t)(randomNext() % 16 - 8);
+            }
+            break;
+        default: // entirely random
+            packet.resize(randomNext() % 65);
+            for (uint8_t & byte : packet) {
+                byte = randomNext();
+            }
+            break;
+    }
+}
+
+int main(int argc, char ** argv) {
+    std::vector<Packet> seeds;
+    for (int i = 1; i < argc; i++) {
+        if (!loadCapture(argv[i], seeds)) {
+            return 1;
+        }
+    }
+    for (uint16_t len = 1; len <= 1024; len += 1 + randomNext() % 8) {
+        generateTransfer(seeds, GIP_AUTH, len);
+    }
+    generateTransfer(seeds, GIP_DEVICE_DESCRIPTOR, 202);
+    generateTransfer(seeds, GIP_CMD_LED_ON, sizeof(XBOXONE_LED_ON));
+
+    // Runs of consecutive seed packets, some mutated, so chunk state builds up before it is broken
+    XGIPProtocol * receiver = new XGIPProtocol();
+    uint8_t ack[13];
+    uint32_t packets = 0;
+    uint32_t valid = 0;
+    uint32_t completed = 0;
+    for (uint32_t run = 0; run < 100000; run++) {
+        size_t index = randomNext() % seeds.size();
+        const uint32_t runLength = 1 + randomNext() % 24;
+        for (uint32_t i = 0; i < runLength; i++, index = (index + 1) % seeds.size()) {
+            Packet packet = seeds[index];
+            if (randomNext() % 3 == 0) {
+                mutate(packet);
+            }
+            // The endpoint buffer is 64 bytes, parse() sees len of it filled
+            uint8_t endpoint[64];
+            memcpy(endpoint, packet.data(), packet.size());
+            receiver->parse(endpoint, packet.size());
+            packets++;
+
+            if (receiver->validate()) {
+                valid++;
+                if (receiver->ackRequired()) {
+                    receiver->generateAckPacket(ack);
+                }
+                // What XBOneDriver hands on once a transfer is complete has to be inside the data buffer, acks carry
+                // no data
+                if (receiver->getCommand() != GIP_ACK_RESPONSE && (!receiver->getChunked() || receiver->endOfChunk())) {
+                    completed++;
+                    const uint16_t len = receiver->getDataLength();
+                    CHECK(len <= 1024);
+                    volatile uint8_t sink = 0;
+                    for (uint16_t b = 0; b < len && b <= 1024; b++) {
+                        sink ^= receiver->getData()[b];
+                    }
+                }
+            }
+            if (randomNext() % 1000 == 0) {
+                receiver->reset();
+            }
+            if (testFailures > 0) {
+                printf("failed on packet %u:", packets);
+                for (uint8_t byte : packet) {
+                    printf(" %02x", byte);
+                }
+                printf("\n");
+                delete receiver;
+                return TEST_RESULT();
+            }
+        }
+    }
+    delete receiver;
+
+    printf("%u packets, %u valid, %u complete transfers\n", packets, valid, completed);
+    CHECK(completed > 1000);
+
+    return TEST_RESULT();
+}
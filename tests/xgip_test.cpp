@@ -0,0 +1,270 @@
+#include "drivers/shared/xgip_protocol.h"
+#include "drivers/xbone/XBOneDescriptors.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+#include "test.h"
+
+// XGIPProtocol sending to itself: every payload size the auth and descriptor transfers use goes out in chunks and is
+// reassembled by a second instance, which acks the way the console does. Prints the cost of a packet each way
+
+// The device descriptor XBOneDriver sends at boot, the largest chunked transfer before auth
+static const uint8_t xboxOneDescriptor[] = {
+    0x10, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xCA, 0x00,
+    0x8B, 0x00, 0x16, 0x00, 0x1F, 0x00, 0x20, 0x00,
+    0x27, 0x00, 0x2D, 0x00, 0x4A, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x01,
+    0x00, 0x00, 0x00, 0x01, 0x00, 0x01, 0x00, 0x00,
+    0x06, 0x01, 0x02, 0x03, 0x04, 0x06, 0x07, 0x05,
+    0x01, 0x04, 0x05, 0x06, 0x0A, 0x01, 0x1A, 0x00,
+    0x57, 0x69, 0x6E, 0x64, 0x6F, 0x77, 0x73, 0x2E,
+    0x58, 0x62, 0x6F, 0x78, 0x2E, 0x49, 0x6E, 0x70,
+    0x75, 0x74, 0x2E, 0x47, 0x61, 0x6D, 0x65, 0x70,
+    0x61, 0x64, 0x04, 0x56, 0xFF, 0x76, 0x97, 0xFD,
+    0x9B, 0x81, 0x45, 0xAD, 0x45, 0xB6, 0x45, 0xBB,
+    0xA5, 0x26, 0xD6, 0x2C, 0x40, 0x2E, 0x08, 0xDF,
+    0x07, 0xE1, 0x45, 0xA5, 0xAB, 0xA3, 0x12, 0x7A,
+    0xF1, 0x97, 0xB5, 0xE7, 0x1F, 0xF3, 0xB8, 0x86,
+    0x73, 0xE9, 0x40, 0xA9, 0xF8, 0x2F, 0x21, 0x26,
+    0x3A, 0xCF, 0xB7, 0xFE, 0xD2, 0xDD, 0xEC, 0x87,
+    0xD3, 0x94, 0x42, 0xBD, 0x96, 0x1A, 0x71, 0x2E,
+    0x3D, 0xC7, 0x7D, 0x02, 0x17, 0x00, 0x20, 0x20,
+    0x00, 0x01, 0x00, 0x10, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x17, 0x00, 0x09, 0x3C, 0x00,
+    0x01, 0x00, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00};
+
+// Announce, power on and LED packets from the console and the driver, sent whole
+static const uint8_t announcePayload[] = {
+    0x00, 0x2a, 0x00, 0xff, 0xff, 0xff, 0x00, 0x00,
+    0xdf, 0x33, 0x14, 0x00, 0x01, 0x00, 0x01, 0x00,
+    0x17, 0x01, 0x02, 0x00, 0x01, 0x00, 0x01, 0x00,
+    0x01, 0x00, 0x01, 0x00};
+
+static uint32_t randomState = 0x12345678;
+
+static uint32_t randomNext()
+{
+    randomState ^= randomState << 13;
+    randomState ^= randomState >> 17;
+    randomState ^= randomState << 5;
+    return randomState;
+}
+
+struct Transfer {
+    uint32_t packets = 0;
+    uint32_t acks = 0;
+    bool badPacket = false;
+    bool badAck = false;
+};
+
+// Sends payload from one instance to the other packet by packet, the receiver's acks are parsed and checked against
+// what it has received so far
+static Transfer transfer(uint8_t command, const uint8_t * payload, uint16_t len, bool chunked, XGIPProtocol & receiver) {
+    Transfer result;
+    XGIPProtocol sender;
+    sender.setAttributes(command, 1, 1, chunked, 0);
+    CHECK(sender.setData(payload, len));
+
+    uint8_t packet[GIP_MAX_CHUNK_SIZE + 6];
+    uint8_t ack[13];
+    do {
+        const uint16_t packetLength = sender.generatePacket(packet);
+        result.packets++;
+        if (packetLength > sizeof(packet) || packetLength != sender.getPacketLength()) {
+            result.badPacket = true;
+            break;
+        }
+        receiver.parse(packet, packetLength);
+        if (!receiver.validate()) {
+            result.badPacket = true;
+            break;
+        }
+        if (receiver.ackRequired()) {
+            result.acks++;
+            XGIPProtocol ackParser;
+            const uint16_t ackLength = receiver.generateAckPacket(ack);
+            ackParser.parse(ack, ackLength);
+            const uint16_t received = ack[7] | (ack[8] << 8);
+            const uint16_t left = ack[11] | (ack[12] << 8);
+            if (!ackParser.validate() || ackParser.getCommand() != GIP_ACK_RESPONSE || ack[5] != command ||
+                    received > len || (receiver.getChunked() && received + left != len)) {
+                result.badAck = true;
+            }
+        }
+    } while (sender.getChunked() && !sender.endOfChunk());
+    return result;
+}
+
+// Every payload length from 1 byte to the data buffer arrives intact, in packets that fit the endpoint
+static void testRoundTrip() {
+    static uint8_t payload[1024];
+    for (uint8_t & byte : payload) {
+        byte = randomNext();
+    }
+    uint32_t badPackets = 0;
+    uint32_t badAcks = 0;
+    uint32_t badData = 0;
+    for (uint16_t len = 1; len <= sizeof(payload); len++) {
+        XGIPProtocol receiver;
+        const Transfer result = transfer(GIP_AUTH, payload, len, len > GIP_MAX_CHUNK_SIZE, receiver);
+        badPackets += result.badPacket;
+        badAcks += result.badAck;
+        if (receiver.getChunked()) {
+            badData += !receiver.endOfChunk();
+        }
+        if (receiver.getDataLength() != len || memcmp(receiver.getData(), payload, len) != 0) {
+            badData++;
+        }
+        if (len > GIP_MAX_CHUNK_SIZE) {
+            // Data chunks plus the end packet
+            const uint32_t chunks = (len + GIP_MAX_CHUNK_SIZE - 1) / GIP_MAX_CHUNK_SIZE;
+            CHECK_EQ(result.packets, chunks + 1);
+            // Acks on the first chunk, every fifth and a short last one
+            uint32_t acks = 0;
+            for (uint32_t chunk = 0; chunk < chunks; chunk++) {
+                acks += chunk == 0 || (chunk + 1) % 5 == 0 || (chunk == chunks - 1 && len % GIP_MAX_CHUNK_SIZE != 0);
+            }
+            CHECK_EQ(result.acks, acks);
+        } else {
+            CHECK_EQ(result.packets, 1);
+        }
+    }
+    CHECK_EQ(badPackets, 0);
+    CHECK_EQ(badAcks, 0);
+    CHECK_EQ(badData, 0);
+}
+
+// The boot exchange: the descriptor in chunks, then the single packets, through one receiver like the console's
+static void testBootTraffic() {
+    XGIPProtocol receiver;
+    Transfer result = transfer(GIP_DEVICE_DESCRIPTOR, xboxOneDescriptor, sizeof(xboxOneDescriptor), true, receiver);
+    CHECK(!result.badPacket && !result.badAck);
+    CHECK(receiver.endOfChunk());
+    CHECK_EQ(receiver.getDataLength(), sizeof(xboxOneDescriptor));
+    CHECK(memcmp(receiver.getData(), xboxOneDescriptor, sizeof(xboxOneDescriptor)) == 0);
+
+    struct { uint8_t command; const uint8_t * payload; uint16_t len; } singles[] = {
+        { GIP_ANNOUNCE, announcePayload, sizeof(announcePayload) },
+        { GIP_POWER_MODE_DEVICE_CONFIG, XBOXONE_POWER_ON_SINGLE, sizeof(XBOXONE_POWER_ON_SINGLE) },
+        { GIP_CMD_LED_ON, XBOXONE_LED_ON, sizeof(XBOXONE_LED_ON) },
+        { GIP_CMD_RUMBLE, XBOXONE_RUMBLE_ON, sizeof(XBOXONE_RUMBLE_ON) },
+    };
+    for (const auto & single : singles) {
+        result = transfer(single.command, single.payload, single.len, false, receiver);
+        CHECK(!result.badPacket && !result.badAck);
+        CHECK_EQ(result.packets, 1);
+        CHECK_EQ(receiver.getCommand(), single.command);
+        CHECK_EQ(receiver.getDataLength(), single.len);
+        CHECK(memcmp(receiver.getData(), single.payload, single.len) == 0);
+    }
+
+    // A new chunk start drops whatever an unfinished transfer left behind
+    XGIPProtocol sender;
+    sender.setAttributes(GIP_AUTH, 2, 1, 1, 0);
+    sender.setData(xboxOneDescriptor, sizeof(xboxOneDescriptor));
+    uint8_t packet[GIP_MAX_CHUNK_SIZE + 6];
+    receiver.reset();
+    receiver.parse(packet, sender.generatePacket(packet));
+    receiver.parse(packet, sender.generatePacket(packet));
+    result = transfer(GIP_DEVICE_DESCRIPTOR, xboxOneDescriptor, sizeof(xboxOneDescriptor), true, receiver);
+    CHECK(!result.badPacket && !result.badAck);
+    CHECK(receiver.endOfChunk());
+    CHECK(memcmp(receiver.getData(), xboxOneDescriptor, sizeof(xboxOneDescriptor)) == 0);
+}
+
+// Packets that lie about their length are dropped instead of read past the end
+static void testMalformed() {
+    XGIPProtocol receiver;
+    const uint8_t tooShort[] = { GIP_CMD_LED_ON, 0x20, 0x01 };
+    CHECK(!receiver.parse(tooShort, sizeof(tooShort)));
+    CHECK(!receiver.validate());
+
+    const uint8_t longerThanReceived[] = { GIP_CMD_LED_ON, 0x20, 0x01, 0x10, 0x00, 0x01 };
+    receiver.parse(longerThanReceived, sizeof(longerThanReceived));
+    CHECK(!receiver.validate());
+
+    const uint8_t shortAck[] = { GIP_ACK_RESPONSE, 0x20, 0x01, 0x09, 0x00 };
+    receiver.parse(shortAck, sizeof(shortAck));
+    CHECK(!receiver.validate());
+
+    // A chunk claiming 0x3A bytes with only 10 behind the header
+    uint8_t chunk[16] = { GIP_AUTH, 0xF0, 0x01, GIP_MAX_CHUNK_SIZE, 0x00, 0xBA };
+    receiver.parse(chunk, sizeof(chunk));
+    CHECK(!receiver.validate());
+
+    // An end packet that agrees with a chunk start claiming more than was sent does not complete the transfer
+    uint8_t start[GIP_MAX_CHUNK_SIZE + 6] = { GIP_AUTH, 0xF0, 0x01, GIP_MAX_CHUNK_SIZE, 0xFF, 0x7F };
+    const uint8_t end[] = { GIP_AUTH, 0xA0, 0x01, 0x00, 0xFF, 0x7F };
+    receiver.parse(start, sizeof(start));
+    CHECK(receiver.validate());
+    receiver.parse(end, sizeof(end));
+    CHECK(!receiver.validate());
+    CHECK(!receiver.endOfChunk());
+
+    // Continuation chunks keep coming without an end: the data buffer fills and the rest is dropped
+    uint8_t continuation[GIP_MAX_CHUNK_SIZE + 6] = { GIP_AUTH, 0xB0, 0x01, GIP_MAX_CHUNK_SIZE | 0x80, 0x00, 0x00 };
+    receiver.reset();
+    uint32_t accepted = 0;
+    for (uint32_t i = 0; i <= 1024 / GIP_MAX_CHUNK_SIZE; i++) {
+        receiver.parse(continuation, sizeof(continuation));
+        accepted += receiver.validate();
+    }
+    CHECK_EQ(accepted, 1024 / GIP_MAX_CHUNK_SIZE);
+
+    // Payloads larger than the data buffer are refused
+    static uint8_t large[2048];
+    XGIPProtocol sender;
+    CHECK(sender.setData(large, 1024));
+    CHECK(!sender.setData(large, 1025));
+}
+
+// Cost per packet of generating the descriptor transfer and of parsing it back
+static void benchmarkPackets() {
+    static const uint32_t TRANSFERS = 20000;
+    static uint8_t packets[8][GIP_MAX_CHUNK_SIZE + 6];
+    uint16_t lengths[8];
+    uint32_t count = 0;
+    uint32_t sink = 0;
+    XGIPProtocol sender;
+
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < TRANSFERS; i++) {
+        sender.reset();
+        sender.setAttributes(GIP_DEVICE_DESCRIPTOR, 1, 1, 1, 0);
+        sender.setData(xboxOneDescriptor, sizeof(xboxOneDescriptor));
+        count = 0;
+        do {
+            lengths[count] = sender.generatePacket(packets[count]);
+            count++;
+        } while (!sender.endOfChunk());
+        sink += packets[count - 2][7];
+    }
+    const double generateNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / (TRANSFERS * count);
+
+    XGIPProtocol receiver;
+    start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < TRANSFERS; i++) {
+        for (uint32_t p = 0; p < count; p++) {
+            receiver.parse(packets[p], lengths[p]);
+        }
+        sink += receiver.getData()[i % sizeof(xboxOneDescriptor)];
+    }
+    const double parseNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / (TRANSFERS * count);
+
+    printf("descriptor transfer, %u packets: generate %.1f ns, parse %.1f ns per packet (%u)\n", count, generateNs, parseNs, sink & 1);
+}
+
+int main() {
+    testRoundTrip();
+    testBootTraffic();
+    testMalformed();
+    benchmarkPackets();
+
+    return TEST_RESULT();
+}
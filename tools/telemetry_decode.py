@@ -0,0 +1,166 @@
+#!/usr/bin/env python3
+"""Decodes GP2040-CE USB latency telemetry records.
+
+Enable "USB Latency Telemetry" in the web configurator settings, reboot into XInput, Generic HID or
+Composite mode, then run one of:
+
+    telemetry_decode.py --device 045e:028e          read live from the telemetry interface (needs pyusb)
+    telemetry_decode.py capture.bin                 decode a raw capture
+    telemetry_decode.py --simulate 1000 > sim.bin   write synthetic records to test the decoder
+
+Each record is 16 little-endian bytes, see USBTelemetryRecord in headers/usbtelemetry.h. All times
+are the device's microsecond timer.
+"""
+
+import argparse
+import random
+import statistics
+import struct
+import sys
+
+RECORD = struct.Struct('<IIIHH')
+STATUS = struct.Struct('<IIIIII')
+TELEMETRY_SUBCLASS = 0x47
+TELEMETRY_PROTOCOL = 0x54
+REQUEST_STATUS = 0x01
+
+
+def elapsed(start, end):
+    return (end - start) & 0xffffffff
+
+
+def decode(chunks, verbose):
+    latencies = []
+    queueing = []
+    last_sequence = None
+    last_generation = None
+    lost = 0
+    pending = b''
+    for chunk in chunks:
+        pending += chunk
+        count = len(pending) // RECORD.size
+        for offset in range(0, count * RECORD.size, RECORD.size):
+            edge, queued, complete, sequence, generation = RECORD.unpack_from(pending, offset)
+            if last_sequence is not None:
+                lost += (sequence - last_sequence - 1) & 0xffff
+            last_sequence = sequence
+
+            # Keepalive reports repeat the generation, only the first report of a change has an input edge
+            new_input = generation != last_generation
+            last_generation = generation
+            if verbose:
+                print('seq %5u gen %5u edge->queued %6u us edge->complete %6u us%s' % (
+                    sequence, generation, elapsed(edge, queued), elapsed(edge, complete),
+                    '' if new_input else ' (repeat)'))
+            if new_input:
+                latencies.append(elapsed(edge, complete))
+                queueing.append(elapsed(edge, queued))
+        pending = pending[count * RECORD.size:]
+    return latencies, queueing, lost
+
+
+def summarize(name, values):
+    if not values:
+        print('%-16s no samples' % name)
+        return
+    ordered = sorted(values)
+    print('%-16s n=%u min=%u median=%u p99=%u max=%u mean=%.1f us' % (
+        name, len(ordered), ordered[0], statistics.median(ordered),
+        ordered[min(len(ordered) - 1, int(len(ordered) * 0.99))], ordered[-1], statistics.mean(ordered)))
+
+
+def read_file(path):
+    with (sys.stdin.buffer if path == '-' else open(path, 'rb')) as f:
+        while True:
+            data = f.read(4096)
+            if not data:
+                return
+            yield data
+
+
+def read_status(device, interface):
+    # Vendor IN request to the telemetry interface, see USBTelemetryStatus in headers/usbtelemetry.h
+    data = bytes(device.ctrl_transfer(0xc1, REQUEST_STATUS, 0, interface, STATUS.size))
+    dropped, scan, scan_max, poll_rate, build, build_max = STATUS.unpack_from(data)
+    return {'dropped': dropped, 'scan': scan, 'scan_max': scan_max, 'poll_rate': poll_rate,
+            'build': build, 'build_max': build_max}
+
+
+def read_device(ids, status):
+    import usb.core
+    import usb.util
+
+    vid, pid = (int(x, 16) for x in ids.split(':'))
+    device = usb.core.find(idVendor=vid, idProduct=pid)
+    if device is None:
+        sys.exit('device %s not found' % ids)
+    for interface in device.get_active_configuration():
+        if (interface.bInterfaceClass == 0xff and interface.bInterfaceSubClass == TELEMETRY_SUBCLASS and
+                interface.bInterfaceProtocol == TELEMETRY_PROTOCOL):
+            break
+    else:
+        sys.exit('no telemetry interface, enable USB Latency Telemetry and reboot the device')
+
+    # Only the telemetry interface is detached, the gamepad keeps working for the OS
+    if device.is_kernel_driver_active(interface.bInterfaceNumber):
+        device.detach_kernel_driver(interface.bInterfaceNumber)
+    usb.util.claim_interface(device, interface.bInterfaceNumber)
+    endpoint = interface[0]
+    try:
+        while True:
+            try:
+                yield bytes(endpoint.read(endpoint.wMaxPacketSize, timeout=1000))
+            except usb.core.USBTimeoutError:
+                continue
+    except KeyboardInterrupt:
+        return
+    finally:
+        status.update(read_status(device, interface.bInterfaceNumber))
+        usb.util.release_interface(device, interface.bInterfaceNumber)
+
+
+def simulate(count, out):
+    # Mimics the device: 1 kHz polling, input changes on some polls, keepalives repeat the generation
+    now = random.randrange(1 << 32)
+    generation = 1
+    edge = now
+    sequence = 0
+    for _ in range(count):
+        now = (now + 1000) & 0xffffffff
+        if random.random() < 0.3:
+            generation = (generation + 1) & 0xffff
+            edge = (now - random.randrange(50, 900)) & 0xffffffff
+        queued = (now + random.randrange(5, 40)) & 0xffffffff
+        complete = (queued + random.randrange(100, 1000)) & 0xffffffff
+        out.write(RECORD.pack(edge, queued, complete, sequence, generation))
+        sequence = (sequence + 1 + (1 if random.random() < 0.001 else 0)) & 0xffff
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('capture', nargs='?', default='-', help='raw record file, - for stdin')
+    parser.add_argument('--device', metavar='VID:PID', help='read live from the device')
+    parser.add_argument('--simulate', type=int, metavar='N', help='write N synthetic records to stdout')
+    parser.add_argument('-v', '--verbose', action='store_true', help='print every record')
+    args = parser.parse_args()
+
+    if args.simulate is not None:
+        simulate(args.simulate, sys.stdout.buffer)
+        return
+
+    status = {}
+    chunks = read_device(args.device, status) if args.device else read_file(args.capture)
+    latencies, queueing, lost = decode(chunks, args.verbose)
+    summarize('edge->queued', queueing)
+    summarize('edge->complete', latencies)
+    print('records lost    %u' % lost)
+    if status:
+        print('device dropped  %u' % status['dropped'])
+        print('host poll rate  %u Hz' % status['poll_rate'])
+        print('report build    mean=%u max=%u ns' % (status['build'], status['build_max']))
+        if status['scan_max']:
+            print('input scan      last=%u max=%u us' % (status['scan'], status['scan_max']))
+
+
+if __name__ == '__main__':
+    main()
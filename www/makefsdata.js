@@ -54,6 +54,14 @@ const skipCompressionExtensions = new Set(['png', 'json']);
 
 const serverHeader = 'GP2040-CE';
 
+// Vite emits the bundled scripts, styles and imported assets as /assets/[name]-[hash].[ext].
+// Their content can never change under the same name, so browsers may cache them forever instead
+// of re-downloading the whole SPA over RNDIS on every visit. Everything else (index.html, public/*)
+// keeps its name across firmware versions and must be revalidated.
+const hashedAssetPattern = /^\/assets\/.+-[A-Za-z0-9_-]{8}\.[a-z0-9]+$/;
+const immutableCacheControl = 'public, max-age=31536000, immutable';
+const defaultCacheControl = 'no-cache';
+
 const payloadAlignment = 4;
 const hexBytesPerLine = 16;
 
@@ -218,6 +226,14 @@ function makefsdata() {
 		if (isCompressed) {
 			fsdata += createHexString('Content-Encoding: deflate\r\n', true);
 		}
+		fsdata += createHexString(
+			`Cache-Control: ${
+				hashedAssetPattern.test(qualifiedName)
+					? immutableCacheControl
+					: defaultCacheControl
+			}\r\n`,
+			true,
+		);
 		fsdata += createHexString(
 			`Content-Type: ${contentTypes.get(ext) ?? defaultContentType}\r\n\r\n`,
 			true,
@@ -137,6 +137,8 @@ app.get('/api/getGamepadOptions', (req, res) => {
 		usbVendorID: '10C4',
 		usbProductID: '82C0',
 		miniMenuGamepadInput: 1,
+		usbPollingInterval: 0,
+		usbTelemetry: false,
 		hotkey01: {
 			auxMask: 32768,
 			buttonsMask: 66304,
@@ -475,6 +477,12 @@ app.get('/api/getAddonsOptions', (req, res) => {
 		smoothing_factor2: 5,
 		analog_error: 1000,
 		analog_error2: 1000,
+		analog_filter: 0,
+		analog_filter2: 0,
+		filter_min_cutoff: 10,
+		filter_min_cutoff2: 10,
+		filter_beta: 100,
+		filter_beta2: 100,
 		bootselButtonMap: 0,
 		buzzerPin: -1,
 		buzzerEnablePin: -1,
@@ -516,6 +524,7 @@ app.get('/api/getAddonsOptions', (req, res) => {
 		keyboardHostMouseRight: 0,
 		keyboardHostMouseSensitivity: 50,
 		keyboardHostMouseMovement: 0,
+		keyboardHostMouseAcceleration: 0,
 		AnalogInputEnabled: 1,
 		BoardLedAddonEnabled: 1,
 		FocusModeAddonEnabled: 1,
@@ -563,8 +572,10 @@ app.get('/api/getAddonsOptions', (req, res) => {
 		muxSelectPin1: 1,
 		muxSelectPin2: 2,
 		muxSelectPin3: -1,
-		heTriggerSmoothing: 0,
 		heTriggerSmoothingFactor: 5,
+		heTriggerFilterMinCutoff: 10,
+		heTriggerFilterBeta: 100,
+		muxSettleTime: 5,
 		RotaryAddonEnabled: 1,
 		PCF8575AddonEnabled: 1,
 		DRV8833RumbleAddonEnabled: 1,
@@ -620,7 +631,8 @@ app.get('/api/getHETriggerCalibrations', (req, res) => {
 			is_polarized: false,
 			release: 1500,
 			noise: 50, 
-			rapidTrigger: false
+			rapidTrigger: false,
+			filter: 0
 		},
 		{
 			action: 3, 
@@ -630,7 +642,8 @@ app.get('/api/getHETriggerCalibrations', (req, res) => {
 			is_polarized: true,
 			release: 1500,
 			noise: 50, 
-			rapidTrigger: false
+			rapidTrigger: false,
+			filter: 0
 		},
 		{
 			action: 4, 
@@ -640,7 +653,8 @@ app.get('/api/getHETriggerCalibrations', (req, res) => {
 			is_polarized: false,
 			release: 2000,
 			noise: 50, 
-			rapidTrigger: true
+			rapidTrigger: true,
+			filter: 0
 		},
 		{
 			action: 5, 
@@ -650,7 +664,8 @@ app.get('/api/getHETriggerCalibrations', (req, res) => {
 			is_polarized: true,
 			release: 1500,
 			noise: 50, 
-			rapidTrigger: true
+			rapidTrigger: true,
+			filter: 0
 		},
 	);
 	for(var i = 4; i < 32; i++) {
@@ -663,6 +678,7 @@ app.get('/api/getHETriggerCalibrations', (req, res) => {
 			release: 1500,
 			noise: 50,
 			rapidTrigger: false,
+			filter: 0,
 		});
 	}
 	return res.send({triggers});
@@ -898,6 +914,15 @@ app.get('/api/reboot', (req, res) => {
 	return res.send({});
 });
 
+app.get('/api/getUSBHostStats', (req, res) => {
+	return res.send({
+		devices: 2,
+		maxProcessUs: 310,
+		queueOverflows: 0,
+		unclaimedEvents: 12,
+	});
+});
+
 app.get('/api/getMemoryReport', (req, res) => {
 	return res.send({
 		totalFlash: 2048 * 1024,
@@ -906,6 +931,51 @@ app.get('/api/getMemoryReport', (req, res) => {
 		staticAllocs: 200,
 		totalHeap: 2048 * 1024,
 		usedHeap: 1048 * 1024,
+		largestFreeBlock: 900 * 1024,
+		fragmentedHeap: 12 * 1024,
+		trackedHeap: 96 * 1024,
+		peakTrackedHeap: 128 * 1024,
+		bootArenaSize: 12 * 1024,
+		bootArenaUsed: 9 * 1024,
+		bootArenaOverflow: 0,
+		bootArenaInvalidFrees: 0,
+		allocations: [
+			{
+				name: 'System',
+				liveBytes: 40960,
+				peakBytes: 45056,
+				liveCount: 120,
+				allocCount: 480,
+			},
+			{
+				name: 'Driver',
+				liveBytes: 8192,
+				peakBytes: 8192,
+				liveCount: 4,
+				allocCount: 4,
+			},
+			{
+				name: 'WebConfig',
+				liveBytes: 0,
+				peakBytes: 32768,
+				liveCount: 0,
+				allocCount: 210,
+			},
+			{
+				name: 'Events',
+				liveBytes: 512,
+				peakBytes: 1024,
+				liveCount: 12,
+				allocCount: 30,
+			},
+			{
+				name: 'Display',
+				liveBytes: 24576,
+				peakBytes: 28672,
+				liveCount: 64,
+				allocCount: 900,
+			},
+		],
 	});
 });
 
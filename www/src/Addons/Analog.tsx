@@ -23,6 +23,14 @@ const INVERT_MODES = [
 	{ label: 'X/Y Axis', value: 3 },
 ];
 
+const ANALOG_FILTER_MODES = [
+	{ labelKey: 'analog-filter-none', value: 0 },
+	{ labelKey: 'analog-filter-ema', value: 1 },
+	{ labelKey: 'analog-filter-oversample', value: 2 },
+	{ labelKey: 'analog-filter-one-euro', value: 3 },
+	{ labelKey: 'analog-filter-median', value: 4 },
+];
+
 const ANALOG_ERROR_RATES = [
 	{ label: '0%', value: 1000 },
 	{ label: '1%', value: 990 },
@@ -125,6 +133,30 @@ export const analogScheme = {
 		.number()
 		.label('Smoothing Factor 2')
 		.validateRangeWhenValue('AnalogInputEnabled', 0, 100),
+	analog_filter: yup
+		.number()
+		.label('Analog Filter')
+		.validateSelectionWhenValue('AnalogInputEnabled', ANALOG_FILTER_MODES),
+	analog_filter2: yup
+		.number()
+		.label('Analog Filter 2')
+		.validateSelectionWhenValue('AnalogInputEnabled', ANALOG_FILTER_MODES),
+	filter_min_cutoff: yup
+		.number()
+		.label('Filter Min Cutoff')
+		.validateRangeWhenValue('AnalogInputEnabled', 1, 1000),
+	filter_min_cutoff2: yup
+		.number()
+		.label('Filter Min Cutoff 2')
+		.validateRangeWhenValue('AnalogInputEnabled', 1, 1000),
+	filter_beta: yup
+		.number()
+		.label('Filter Beta')
+		.validateRangeWhenValue('AnalogInputEnabled', 0, 10000),
+	filter_beta2: yup
+		.number()
+		.label('Filter Beta 2')
+		.validateRangeWhenValue('AnalogInputEnabled', 0, 10000),
 	analog_error: yup
 		.number()
 		.label('Error Rate')
@@ -177,6 +209,12 @@ export const analogState = {
 	analog_smoothing2: 0,
 	smoothing_factor: 5,
 	smoothing_factor2: 5,
+	analog_filter: 0,
+	analog_filter2: 0,
+	filter_min_cutoff: 10,
+	filter_min_cutoff2: 10,
+	filter_beta: 100,
+	filter_beta2: 100,
 	analog_error: 1,
 	analog_error2: 1,
 };
@@ -310,20 +348,26 @@ const Analog = ({ values, errors, handleChange, handleCheckbox, setFieldValue }:
 									/>
 								</Row>
 								<Row className="mb-3">
-									<FormCheck
-										label={t('AddonsConfig:analog-smoothing')}
-										type="switch"
-										id="Analog_smoothing"
-										className="col-sm-3 ms-3"
-										isInvalid={false}
-										checked={Boolean(values.analog_smoothing)}
+									<FormSelect
+										label={t('AddonsConfig:analog-filter')}
+										name="analog_filter"
+										className="form-select-sm"
+										groupClassName="col-sm-3 mb-3"
+										value={values.analog_filter}
+										error={errors.analog_filter}
+										isInvalid={Boolean(errors.analog_filter)}
 										onChange={(e) => {
-											handleCheckbox('analog_smoothing');
-											handleChange(e);
+											setFieldValue('analog_filter', parseInt(e.target.value));
 										}}
-									/>
+									>
+										{ANALOG_FILTER_MODES.map((o) => (
+											<option key={`analog_filter-option-${o.value}`} value={o.value}>
+												{t(`AddonsConfig:${o.labelKey}`)}
+											</option>
+										))}
+									</FormSelect>
 									<FormControl
-										hidden={!values.analog_smoothing}
+										hidden={values.analog_filter !== 1}
 										type="number"
 										label={t('AddonsConfig:smoothing-factor')}
 										name="smoothing_factor"
@@ -336,6 +380,34 @@ const Analog = ({ values, errors, handleChange, handleCheckbox, setFieldValue }:
 										min={0}
 										max={100}
 									/>
+									<FormControl
+										hidden={values.analog_filter !== 3}
+										type="number"
+										label={t('AddonsConfig:filter-min-cutoff')}
+										name="filter_min_cutoff"
+										className="form-control-sm"
+										groupClassName="col-sm-3 mb-3"
+										value={values.filter_min_cutoff}
+										error={errors.filter_min_cutoff}
+										isInvalid={Boolean(errors.filter_min_cutoff)}
+										onChange={handleChange}
+										min={1}
+										max={1000}
+									/>
+									<FormControl
+										hidden={values.analog_filter !== 3}
+										type="number"
+										label={t('AddonsConfig:filter-beta')}
+										name="filter_beta"
+										className="form-control-sm"
+										groupClassName="col-sm-3 mb-3"
+										value={values.filter_beta}
+										error={errors.filter_beta}
+										isInvalid={Boolean(errors.filter_beta)}
+										onChange={handleChange}
+										min={0}
+										max={10000}
+									/>
 								</Row>
 								<Row className="mb-3">
 									<FormCheck
@@ -595,20 +667,26 @@ const Analog = ({ values, errors, handleChange, handleCheckbox, setFieldValue }:
 									/>
 								</Row>
 								<Row className="mb-3">
-									<FormCheck
-										label={t('AddonsConfig:analog-smoothing')}
-										type="switch"
-										id="Analog_smoothing2"
-										className="col-sm-3 ms-3"
-										isInvalid={false}
-										checked={Boolean(values.analog_smoothing2)}
+									<FormSelect
+										label={t('AddonsConfig:analog-filter')}
+										name="analog_filter2"
+										className="form-select-sm"
+										groupClassName="col-sm-3 mb-3"
+										value={values.analog_filter2}
+										error={errors.analog_filter2}
+										isInvalid={Boolean(errors.analog_filter2)}
 										onChange={(e) => {
-											handleCheckbox('analog_smoothing2');
-											handleChange(e);
+											setFieldValue('analog_filter2', parseInt(e.target.value));
 										}}
-									/>
+									>
+										{ANALOG_FILTER_MODES.map((o) => (
+											<option key={`analog_filter2-option-${o.value}`} value={o.value}>
+												{t(`AddonsConfig:${o.labelKey}`)}
+											</option>
+										))}
+									</FormSelect>
 									<FormControl
-										hidden={!values.analog_smoothing2}
+										hidden={values.analog_filter2 !== 1}
 										type="number"
 										label={t('AddonsConfig:smoothing-factor')}
 										name="smoothing_factor2"
@@ -621,6 +699,34 @@ const Analog = ({ values, errors, handleChange, handleCheckbox, setFieldValue }:
 										min={0}
 										max={100}
 									/>
+									<FormControl
+										hidden={values.analog_filter2 !== 3}
+										type="number"
+										label={t('AddonsConfig:filter-min-cutoff')}
+										name="filter_min_cutoff2"
+										className="form-control-sm"
+										groupClassName="col-sm-3 mb-3"
+										value={values.filter_min_cutoff2}
+										error={errors.filter_min_cutoff2}
+										isInvalid={Boolean(errors.filter_min_cutoff2)}
+										onChange={handleChange}
+										min={1}
+										max={1000}
+									/>
+									<FormControl
+										hidden={values.analog_filter2 !== 3}
+										type="number"
+										label={t('AddonsConfig:filter-beta')}
+										name="filter_beta2"
+										className="form-control-sm"
+										groupClassName="col-sm-3 mb-3"
+										value={values.filter_beta2}
+										error={errors.filter_beta2}
+										isInvalid={Boolean(errors.filter_beta2)}
+										onChange={handleChange}
+										min={0}
+										max={10000}
+									/>
 								</Row>
 								<Row className="mb-3">
 									<FormCheck
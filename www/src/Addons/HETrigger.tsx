@@ -8,7 +8,7 @@ import * as yup from 'yup';
 import invert from 'lodash/invert';
 import omit from 'lodash/omit';
 
-import HECalibration from '../Components/HECalibration';
+import HECalibration, { TRIGGER_FILTER_MODES } from '../Components/HECalibration';
 
 import useHETriggerStore, { Trigger } from '../Store/useHETriggerStore';
 
@@ -53,6 +53,10 @@ export const HETriggerScheme = {
 		.number()
 		.label('Multiplexer Channels')
 		.validateRangeWhenValue('HETriggerEnabled', 0, 16),
+	muxSettleTime: yup
+		.number()
+		.label('Multiplexer Settle Time')
+		.validateRangeWhenValue('HETriggerEnabled', 0, 100),
 	muxADCPin0: yup
 		.number()
 		.label('Multiplexer ADC 0 Pin')
@@ -85,19 +89,24 @@ export const HETriggerScheme = {
 		.number()
 		.label('Multiplexer Select 3 Pin')
 		.validatePinWhenValue('HETriggerEnabled'),
-	heTriggerSmoothing: yup
-		.number()
-		.label('EMA Smoothing')
-		.validateRangeWhenValue('HETriggerEnabled', 0, 1),
 	heTriggerSmoothingFactor: yup
 		.number()
 		.label('EMA Smoothing Factor')
 		.validateRangeWhenValue('HETriggerEnabled', 1, 99),
+	heTriggerFilterMinCutoff: yup
+		.number()
+		.label('Filter Min Cutoff')
+		.validateRangeWhenValue('HETriggerEnabled', 1, 1000),
+	heTriggerFilterBeta: yup
+		.number()
+		.label('Filter Beta')
+		.validateRangeWhenValue('HETriggerEnabled', 0, 10000),
 };
 
 export const HETriggerState = {
 	HETriggerEnabled: 0,
 	muxChannels: 1,
+	muxSettleTime: 5,
 	muxADCPin0: 26,
 	muxADCPin1: 27,
 	muxADCPin2: 28,
@@ -106,8 +115,9 @@ export const HETriggerState = {
 	muxSelectPin1: 1,
 	muxSelectPin2: 2,
 	muxSelectPin3: -1,
-	heTriggerSmoothing: 0,
 	heTriggerSmoothingFactor: 5,
+	heTriggerFilterMinCutoff: 10,
+	heTriggerFilterBeta: 100,
 };
 
 const options = Object.entries(BUTTON_ACTIONS)
@@ -288,6 +298,7 @@ const TriggerActionsForm = ({
 											<th>{t('HETrigger:voltage-table-rapid-trigger-text')}</th>
 											<th>{t('HETrigger:voltage-table-release-text')}</th>
 											<th>{t('HETrigger:voltage-table-noise-text')}</th>
+											<th>{t('HETrigger:voltage-table-filter-text')}</th>
 										</tr>
 									</thead>
 									<tbody>
@@ -303,6 +314,7 @@ const TriggerActionsForm = ({
 											<td>{triggers[key].rapidTrigger ? 'Enabled' : 'Disabled'}</td>
 											<td>{triggers[key].rapidTrigger ? triggers[key].release : 'N/A'}</td>
 											<td>{triggers[key].rapidTrigger ? triggers[key].noise : 'N/A'}</td>
+											<td>{t(`AddonsConfig:${TRIGGER_FILTER_MODES.find((o) => o.value === triggers[key].filter)?.labelKey ?? 'analog-filter-none'}`)}</td>
 										</tr>
 									))}
 									</tbody>
@@ -382,6 +394,20 @@ const HETrigger = ({ values, errors, handleChange, handleCheckbox }: AddonPropTy
 							</option>
 						))}
 					</FormSelect>
+					<FormControl
+						hidden={values.muxChannels <= 1}
+						type="number"
+						label={t('HETrigger:multiplexer-settle-time')}
+						name="muxSettleTime"
+						className="form-control-sm"
+						groupClassName="col-sm-3 mb-3"
+						value={values.muxSettleTime}
+						error={errors.muxSettleTime}
+						isInvalid={Boolean(errors.muxSettleTime)}
+						onChange={handleChange}
+						min={0}
+						max={100}
+					/>
 				</Row>
 				<Row className="mb-3">
 					<FormControl
@@ -494,20 +520,7 @@ const HETrigger = ({ values, errors, handleChange, handleCheckbox }: AddonPropTy
 					</FormSelect>
 				</Row>
 				<Row className="mb-3">
-					<FormCheck
-						label={t('AddonsConfig:analog-smoothing')}
-						type="switch"
-						id="TriggerSmoothingAddonButton"
-						className="col-sm-3 mt-auto mb-auto ms-3"
-						isInvalid={false}
-						checked={Boolean(values.heTriggerSmoothing)}
-						onChange={(e) => {
-							handleCheckbox('heTriggerSmoothing');
-							handleChange(e);
-						}}
-					/>
 					<FormControl
-						hidden={!values.heTriggerSmoothing}
 						type="number"
 						label={t('AddonsConfig:smoothing-factor')}
 						name="heTriggerSmoothingFactor"
@@ -520,6 +533,32 @@ const HETrigger = ({ values, errors, handleChange, handleCheckbox }: AddonPropTy
 						min={1}
 						max={99}
 					/>
+					<FormControl
+						type="number"
+						label={t('AddonsConfig:filter-min-cutoff')}
+						name="heTriggerFilterMinCutoff"
+						className="form-control-sm"
+						groupClassName="col-sm-2 mb-3"
+						value={values.heTriggerFilterMinCutoff}
+						error={errors.heTriggerFilterMinCutoff}
+						isInvalid={Boolean(errors.heTriggerFilterMinCutoff)}
+						onChange={handleChange}
+						min={1}
+						max={1000}
+					/>
+					<FormControl
+						type="number"
+						label={t('AddonsConfig:filter-beta')}
+						name="heTriggerFilterBeta"
+						className="form-control-sm"
+						groupClassName="col-sm-2 mb-3"
+						value={values.heTriggerFilterBeta}
+						error={errors.heTriggerFilterBeta}
+						isInvalid={Boolean(errors.heTriggerFilterBeta)}
+						onChange={handleChange}
+						min={0}
+						max={10000}
+					/>
 				</Row>
 				<Row className="mb-2">
 					<TriggerActionsForm
@@ -14,6 +14,13 @@ import { AppContext } from '../Contexts/AppContext';
 import { BUTTON_MASKS_OPTIONS } from '../Data/Buttons';
 import { AddonPropTypes } from '../Pages/AddonsConfigPage';
 
+const MOUSE_ACCELERATION_OPTIONS = [
+	{ labelKey: 'keyboard-host-mouse-acceleration-none', value: 0 },
+	{ labelKey: 'keyboard-host-mouse-acceleration-low', value: 1 },
+	{ labelKey: 'keyboard-host-mouse-acceleration-medium', value: 2 },
+	{ labelKey: 'keyboard-host-mouse-acceleration-high', value: 3 },
+];
+
 export const keyboardScheme = {
 	KeyboardHostAddonEnabled: yup
 		.number()
@@ -42,6 +49,10 @@ export const keyboardScheme = {
 		),
 	keyboardHostMouseSensitivity: yup.number().required().min(1).max(100),
 	keyboardHostMouseMovement: yup.string().required().oneOf(['0', '1', '2']),
+	keyboardHostMouseAcceleration: yup
+		.number()
+		.required()
+		.oneOf(MOUSE_ACCELERATION_OPTIONS.map((o) => o.value)),
 };
 
 export const keyboardState = {
@@ -52,6 +63,7 @@ export const keyboardState = {
 	KeyboardHostAddonEnabled: 0,
 	keyboardHostMouseSensitivity: 0,
 	keyboardHostMouseMovement: 0,
+	keyboardHostMouseAcceleration: 0,
 };
 
 const excludedButtons = [
@@ -242,6 +254,31 @@ const Keyboard = ({
 							/>
 						</div>
 					</div>
+					<div className="col-sm-3 mb-2">
+						<FormSelect
+							label={t('AddonsConfig:keyboard-host-mouse-acceleration')}
+							name="keyboardHostMouseAcceleration"
+							className="form-select-sm"
+							value={values.keyboardHostMouseAcceleration}
+							error={errors.keyboardHostMouseAcceleration}
+							isInvalid={Boolean(errors.keyboardHostMouseAcceleration)}
+							onChange={(e) => {
+								setFieldValue(
+									'keyboardHostMouseAcceleration',
+									parseInt(e.target.value),
+								);
+							}}
+						>
+							{MOUSE_ACCELERATION_OPTIONS.map((o) => (
+								<option
+									key={`keyboardHostMouseAcceleration-${o.value}`}
+									value={o.value}
+								>
+									{t(`AddonsConfig:${o.labelKey}`)}
+								</option>
+							))}
+						</FormSelect>
+					</div>
 				</Row>
 			</div>
 			{getAvailablePeripherals('usb') ? (
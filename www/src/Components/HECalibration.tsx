@@ -4,6 +4,7 @@ import { useTranslation } from 'react-i18next';
 
 import FormControl from '../Components/FormControl';
 import FormCheck from '../Components/FormCheck';
+import FormSelect from '../Components/FormSelect';
 import WebApi from '../Services/WebApi';
 import useHETriggerStore, { Trigger } from '../Store/useHETriggerStore';
 
@@ -14,6 +15,14 @@ import invert from 'lodash/invert';
 
 const ADC_MAX = 4096;
 
+export const TRIGGER_FILTER_MODES = [
+	{ labelKey: 'analog-filter-none', value: 0 },
+	{ labelKey: 'analog-filter-ema', value: 1 },
+	{ labelKey: 'analog-filter-oversample', value: 2 },
+	{ labelKey: 'analog-filter-one-euro', value: 3 },
+	{ labelKey: 'analog-filter-median', value: 4 },
+];
+
 type HECalibrationProps = {
 	calibrateAllLoop: boolean;
 	calibrationTarget: number;
@@ -59,6 +68,7 @@ const HECalibration = ({
 	const [release, setRelease] = useState(2000);
 	const [noise, setNoise] = useState(50);
 	const [rapidTrigger, setRapidTrigger] = useState(false);
+	const [filter, setFilter] = useState(0);
 
 
 
@@ -114,6 +124,7 @@ const HECalibration = ({
 			release,
 			noise,
 			rapidTrigger,
+			filter,
 		})
 		stopCalibration();
 		if ( calibrateAllLoop ) {
@@ -168,6 +179,7 @@ const HECalibration = ({
 			release,
 			noise,
 			rapidTrigger,
+			filter,
 		});
 		closeModal();
 	};
@@ -197,7 +209,6 @@ const HECalibration = ({
 				muxADCPin1: values['muxADCPin1'],
 				muxADCPin2: values['muxADCPin2'],
 				muxADCPin3: values['muxADCPin3'],
-				heTriggerSmoothing: values['heTriggerSmoothing'],
 				heTriggerSmoothingFactor: values['heTriggerSmoothingFactor'],
 			});
 			updateCalibrationRead(0);
@@ -229,6 +240,7 @@ const HECalibration = ({
 		setRelease(triggers[target.current].release);
 		setNoise(triggers[target.current].noise);
 		setRapidTrigger(triggers[target.current].rapidTrigger);
+		setFilter(triggers[target.current].filter);
 		setPolarity(triggers[target.current].is_polarized);
 	};
 
@@ -241,6 +253,7 @@ const HECalibration = ({
 		setRelease(triggers[target.current].release);
 		setNoise(triggers[target.current].noise);
 		setRapidTrigger(triggers[target.current].rapidTrigger);
+		setFilter(triggers[target.current].filter);
 		setPolarity(triggers[target.current].is_polarized);
 	};
 
@@ -520,6 +533,23 @@ const HECalibration = ({
 							max={ADC_MAX}
 						/></Col>
 					</>}
+				<Col xs={4} className="mb-3">
+					<FormSelect
+						label={t('HETrigger:calibration-filter')}
+						name="filter"
+						className="form-select-sm"
+						value={filter}
+						onChange={(e) => {
+							setFilter(parseInt((e.target as HTMLSelectElement).value));
+						}}
+					>
+						{TRIGGER_FILTER_MODES.map((o, i) => (
+							<option key={`filter-option-${i}`} value={o.value}>
+								{t(`AddonsConfig:${o.labelKey}`)}
+							</option>
+						))}
+					</FormSelect>
+				</Col>
 				<Col xs={12} className="mb-3">
 					{t(`HETrigger:activation-reading-text`)}
 				</Col>
@@ -3,6 +3,7 @@ export default {
 	'desc-header-text': 'Hall Effect Trigger Supports 4-Channel, 8-Channel, and 16-Channel Multiplexers.',
 	'available-pins-text': 'Available ADC pins: {{pins}}',
 	'multiplexer-channel-select': 'Channels Per Multiplexer',
+	'multiplexer-settle-time': 'Multiplexer Settle Time (us)',
 	'direct-no-mux': 'Direct (No Mux)',
 	'4-channels': '４-Channels',
 	'8-channels': '8-Channels',
@@ -28,6 +29,7 @@ export default {
 	'voltage-table-rapid-trigger-text': 'Rapid Trigger',
 	'voltage-table-release-text': 'Rapid Trigger Threshold',
 	'voltage-table-noise-text': 'Rapid Trigger Noise Filter',
+	'voltage-table-filter-text': 'Filter',
 	'voltage-table-disabled-label': '(Disabled)',
 	'overwrite-all-warning': 'Overwrite All Triggers',
 	'overwrite-confirm': 'Confirm Overwrite All Triggers',
@@ -52,6 +54,7 @@ export default {
 	'calibration-trigger-text': 'Trigger Voltage',
 	'calibration-flip-polarity': 'Flip Polarity',
 	'calibration-flip-rapid-trigger': 'Enable Rapid Trigger',
+	'calibration-filter': 'Filter',
 	'calibration-back-button': 'Back',
 	'calibration-first-step': 'We need to calibrate the idle voltage and full press voltage of the hall-effect switch. ' +
 								'After calibration, we can adjust the trigger-activation point to our desired depth. ' +
@@ -59,6 +59,14 @@ export default {
 	'analog-calibration-auto-mode-instruction': 'System will automatically read stick {{stick}} center value on startup. For manual calibration, please uncheck "Auto Calibration" first.',
 	'analog-smoothing': 'Analog Smoothing',
 	'smoothing-factor': 'Smoothing Factor',
+	'analog-filter': 'Filter',
+	'analog-filter-none': 'None',
+	'analog-filter-ema': 'EMA Smoothing',
+	'analog-filter-oversample': 'Oversampling',
+	'analog-filter-one-euro': 'One Euro (adaptive)',
+	'analog-filter-median': 'Median of 3 (spike rejection)',
+	'filter-min-cutoff': 'Min Cutoff (0.1 Hz)',
+	'filter-beta': 'Beta (0.1 Hz per full travel/s)',
 	'analog-error-label': 'Error Rate',
 	'turbo-header-text': 'Turbo',
 	'turbo-button-pin-label': 'Turbo GPIO Pin',
@@ -171,6 +179,11 @@ export default {
 	'keyboard-host-mouse-movement-none': 'None',
 	'keyboard-host-mouse-movement-left-analog': 'Left Analog',
 	'keyboard-host-mouse-movement-right-analog': 'Right Analog',
+	'keyboard-host-mouse-acceleration': 'Mouse Acceleration',
+	'keyboard-host-mouse-acceleration-none': 'None',
+	'keyboard-host-mouse-acceleration-low': 'Low',
+	'keyboard-host-mouse-acceleration-medium': 'Medium',
+	'keyboard-host-mouse-acceleration-high': 'High',
 	'pin-config-moved-to-core-text':
 		'Note: GPIO pins for this add-on are configured in <0>GPIO Pin Mapping</0>',
 	'input-history-header-text': 'Input History',
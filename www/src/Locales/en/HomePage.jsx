@@ -13,5 +13,10 @@ export default {
 	'memory-static-allocations-text': 'Static Allocations',
 	'sub-header-text': 'Please select a menu option to proceed.',
 	'system-stats-header-text': 'System Stats',
+	'usb-host-header-text': 'USB Host',
+	'usb-host-devices-text': 'Claimed interfaces: {{value}}',
+	'usb-host-max-process-text': 'Longest host task: {{us}} µs',
+	'usb-host-queue-overflows-text': 'Reports handed over early: {{value}}',
+	'usb-host-unclaimed-events-text': 'Reports from unclaimed interfaces: {{value}}',
 	'version-text': 'Version',
 };
@@ -13,6 +13,7 @@ export default {
 		'nintendo-switch-pro': 'Nintendo Switch Pro',
 		ps3: 'PS3',
 		generic: 'Generic HID',
+		composite: 'Composite HID (Gamepad + Keyboard)',
 		keyboard: 'Keyboard',
 		ps4: 'PS4',
 		ps5: 'PS5',
@@ -59,6 +60,19 @@ export default {
 	},
 	'profile-label': 'Profile',
 	'debounce-delay-label': 'Debounce Delay in milliseconds',
+	'usb-polling-interval-label': 'USB Polling Interval',
+	'usb-polling-interval-help':
+		'Requested from the host by XInput, Generic HID, Switch, PS4 and PS5 modes. Takes effect after a reboot.',
+	'usb-polling-interval-options': {
+		default: 'Input mode default',
+		'1ms': '1 ms (1000 Hz)',
+		'2ms': '2 ms (500 Hz)',
+		'4ms': '4 ms (250 Hz)',
+		'8ms': '8 ms (125 Hz)',
+	},
+	'usb-telemetry-label': 'USB Latency Telemetry',
+	'usb-telemetry-help':
+		'Adds a vendor interface that reports input-to-USB latency to tools/telemetry_decode.py. XInput, Generic HID and Composite modes only. Takes effect after a reboot.',
 	'mini-menu-gamepad-input': 'Use Gamepad Input for Display Mini Menu',
 	'ps4-mode-explanation-text':
 		'PS4 mode allows GP2040-CE to run as an authenticated PS4 controller.',
@@ -14,6 +14,7 @@ export default function HomePage() {
 		boardConfigProperties,
 		memoryReport,
         stats,
+		usbHostStats,
 		getSystemStats,
 		loading,
 	} = useSystemStats();
@@ -102,6 +103,22 @@ export default function HomePage() {
 							memoryReport.percentageHeap
 						}%`}
 					/>
+
+					<strong className="system-text">
+						{t('HomePage:usb-host-header-text')}
+					</strong>
+					<div className="system-text">
+						{t('HomePage:usb-host-devices-text', { value: usbHostStats.devices })}
+					</div>
+					<div className="system-text">
+						{t('HomePage:usb-host-max-process-text', { us: usbHostStats.maxProcessUs })}
+					</div>
+					<div className="system-text">
+						{t('HomePage:usb-host-queue-overflows-text', { value: usbHostStats.queueOverflows })}
+					</div>
+					<div className="system-text">
+						{t('HomePage:usb-host-unclaimed-events-text', { value: usbHostStats.unclaimedEvents })}
+					</div>
 				</div>
 			</Section>
 		</div>
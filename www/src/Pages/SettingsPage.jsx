@@ -202,6 +202,7 @@ const INPUT_MODES = [
 	{ labelKey: 'input-mode-options.nintendo-switch-pro', value: 15, group: 'primary' },
 	{ labelKey: 'input-mode-options.keyboard', value: 3, group: 'primary' },
 	{ labelKey: 'input-mode-options.generic', value: 14, group: 'primary' },
+	{ labelKey: 'input-mode-options.composite', value: 17, group: 'primary' },
 	{ labelKey: 'input-mode-options.mdmini', value: 6, group: 'mini' },
 	{ labelKey: 'input-mode-options.neogeo', value: 7, group: 'mini' },
 	{ labelKey: 'input-mode-options.pcemini', value: 8, group: 'mini' },
@@ -248,6 +249,7 @@ const INPUT_BOOT_MODES = [
 	{ labelKey: 'input-mode-options.nintendo-switch-pro', value: 15, group: 'primary' },
 	{ labelKey: 'input-mode-options.keyboard', value: 3, group: 'primary' },
 	{ labelKey: 'input-mode-options.generic', value: 14, group: 'primary' },
+	{ labelKey: 'input-mode-options.composite', value: 17, group: 'primary' },
 	{ labelKey: 'input-mode-options.mdmini', value: 6, group: 'mini' },
 	{ labelKey: 'input-mode-options.neogeo', value: 7, group: 'mini' },
 	{ labelKey: 'input-mode-options.pcemini', value: 8, group: 'mini' },
@@ -285,6 +287,14 @@ const PS4_ID_MODES = [
 	{ labelKey: 'ps4-id-mode-options.emulation', value: 1 },
 ];
 
+const USB_POLLING_INTERVALS = [
+	{ labelKey: 'usb-polling-interval-options.default', value: 0 },
+	{ labelKey: 'usb-polling-interval-options.1ms', value: 1 },
+	{ labelKey: 'usb-polling-interval-options.2ms', value: 2 },
+	{ labelKey: 'usb-polling-interval-options.4ms', value: 4 },
+	{ labelKey: 'usb-polling-interval-options.8ms', value: 8 },
+];
+
 const AUTHENTICATION_TYPES = [
 	{ labelKey: 'input-mode-authentication.none', value: 0 },
 	{ labelKey: 'input-mode-authentication.key', value: 1 },
@@ -477,6 +487,12 @@ const schema = yup.object().shape({
 		.oneOf(AUTHENTICATION_TYPES.map((o) => o.value))
 		.label('X-Input Authentication Type'),
 	debounceDelay: yup.number().required().label('Debounce Delay'),
+	usbPollingInterval: yup
+		.number()
+		.required()
+		.oneOf(USB_POLLING_INTERVALS.map((o) => o.value))
+		.label('USB Polling Interval'),
+	usbTelemetry: yup.boolean().required().label('USB Latency Telemetry'),
 	miniMenuGamepadInput: yup.number().required().label('Mini Menu'),
 	inputModeB1: yup
 		.number()
@@ -561,6 +577,8 @@ const FormContext = ({ setButtonLabels, setKeyMappings }) => {
 		if (!!values.ps4ControllerIDMode)
 			values.ps4ControllerIDMode = parseInt(values.ps4ControllerIDMode);
 		if (!!values.inputDeviceType) values.inputDeviceType = parseInt(values.inputDeviceType);
+		if (!!values.usbPollingInterval)
+			values.usbPollingInterval = parseInt(values.usbPollingInterval);
 
 		setButtonLabels({
 			swapTpShareLabels:
@@ -1751,6 +1769,49 @@ export default function SettingsPage() {
 															/>
 														</Col>
 													</Form.Group>
+													<Form.Group className="row mb-3">
+														<Form.Label>
+															{t('SettingsPage:usb-polling-interval-label')}
+														</Form.Label>
+														<Col sm={3}>
+															<Form.Select
+																name="usbPollingInterval"
+																className="form-select-sm"
+																value={values.usbPollingInterval}
+																onChange={handleChange}
+																isInvalid={errors.usbPollingInterval}
+															>
+																{USB_POLLING_INTERVALS.map((o) => (
+																	<option
+																		key={`usb-polling-interval-${o.value}`}
+																		value={o.value}
+																	>
+																		{t('SettingsPage:' + o.labelKey)}
+																	</option>
+																))}
+															</Form.Select>
+															<Form.Text muted>
+																{t('SettingsPage:usb-polling-interval-help')}
+															</Form.Text>
+														</Col>
+													</Form.Group>
+													<Form.Group className="row mb-3">
+														<Col sm={5}>
+															<Form.Check
+																label={t('SettingsPage:usb-telemetry-label')}
+																type="switch"
+																id="usbTelemetry"
+																isInvalid={false}
+																checked={Boolean(values.usbTelemetry)}
+																onChange={(e) => {
+																	setFieldValue('usbTelemetry', e.target.checked);
+																}}
+															/>
+															<Form.Text muted>
+																{t('SettingsPage:usb-telemetry-help')}
+															</Form.Text>
+														</Col>
+													</Form.Group>
 													<Form.Group className="row mb-5">
 														<Col sm={5}>
 															<Form.Check
@@ -12,6 +12,7 @@ export type Trigger = {
 	release: number;
 	noise: number;
 	rapidTrigger: boolean;
+	filter: number;
 };
 
 type State = {
@@ -35,7 +36,8 @@ const INITIAL_STATE: State = {
 		is_polarized: false,
 		release:2000,
 		noise:50,
-		rapidTrigger:false
+		rapidTrigger:false,
+		filter:0
 	})),
 	loadingTriggers: false,
 };
@@ -28,6 +28,12 @@ type State = {
 		build: string;
 		buildType: string;
 	};
+	usbHostStats: {
+		devices: number;
+		maxProcessUs: number;
+		queueOverflows: number;
+		unclaimedEvents: number;
+	};
 	loading: boolean;
 	error: boolean;
 };
@@ -59,6 +65,12 @@ const INITIAL_STATE: State = {
 		build: '',
 		buildType: '',
 	},
+	usbHostStats: {
+		devices: 0,
+		maxProcessUs: 0,
+		queueOverflows: 0,
+		unclaimedEvents: 0,
+	},
 	loading: false,
 	error: false,
 };
@@ -69,9 +81,10 @@ const useSystemStats = create<State & Actions>()((set) => ({
 		set({ loading: true });
 
 		try {
-			const [firmwareVersion, memoryReport, latestRelease] = await Promise.all([
+			const [firmwareVersion, memoryReport, usbHostStats, latestRelease] = await Promise.all([
 				fetch(`${baseUrl}/api/getFirmwareVersion`).then((res) => res.json()),
 				fetch(`${baseUrl}/api/getMemoryReport`).then((res) => res.json()),
+				fetch(`${baseUrl}/api/getUSBHostStats`).then((res) => res.json()),
 				fetch(
 					'https://api.github.com/repos/OpenStickCommunity/GP2040-CE/releases/latest',
 				).then((res) => res.json()),
@@ -115,6 +128,12 @@ const useSystemStats = create<State & Actions>()((set) => ({
 					build: firmwareVersion.boardBuild,
 					buildType: firmwareVersion.boardBuildType,
 				},
+				usbHostStats: {
+					devices: usbHostStats.devices,
+					maxProcessUs: usbHostStats.maxProcessUs,
+					queueOverflows: usbHostStats.queueOverflows,
+					unclaimedEvents: usbHostStats.unclaimedEvents,
+				},
 				loading: false,
 			});
 		} catch (error) {